@@ -0,0 +1,68 @@
+
+#pragma once
+
+#include "utility/mappedFile.hpp"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum AssetType : uint32_t
+{
+    AssetRaw = 0,
+    AssetMesh = 1,
+    AssetTexture = 2,
+    AssetShader = 3,
+};
+
+/** Memory-mapped archive of aligned, optionally LZ4-compressed asset blobs indexed by a table of contents */
+class AssetPack
+{
+public:
+    static uint32_t constexpr MAGIC = 0x4B505648; // "HVPK"
+    static uint32_t constexpr VERSION = 1;
+    static uint64_t constexpr ALIGNMENT = 64;
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t nEntries;
+        uint64_t tocOffset;
+    };
+
+    struct Entry
+    {
+        char name[64];
+        AssetType type;
+        uint32_t compressed;
+        uint64_t offset;
+        uint64_t storedSize;
+        uint64_t size;
+    };
+
+    struct Input
+    {
+        std::string name;
+        AssetType type;
+        std::vector<char> data;
+        bool compress;
+    };
+
+private:
+    MappedFile file;
+    std::unordered_map<std::string, Entry const *> entries;
+
+public:
+    AssetPack(std::string const &filename);
+
+    bool contains(std::string const &name) const;
+    Entry const &getEntry(std::string const &name) const;
+    std::vector<std::string> getNames() const;
+
+    char const *view(std::string const &name) const;
+    void read(std::string const &name, void *destination) const;
+    std::vector<char> read(std::string const &name) const;
+
+    static void write(std::string const &filename, std::vector<Input> const &inputs);
+};
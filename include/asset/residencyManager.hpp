@@ -0,0 +1,56 @@
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class PhysicalDevice;
+class MeshLoader;
+class Mesh;
+
+/** Streams meshes in on demand without stalling the frame and evicts the least recently used ones once device memory exceeds a budget */
+class ResidencyManager
+{
+private:
+    struct Resident
+    {
+        Mesh *mesh;
+        uint64_t lastUsedFrame;
+        std::list<std::string>::iterator lruPosition;
+    };
+
+private:
+    MeshLoader *meshLoader;
+    Mesh *fallback;
+    VkDeviceSize budget;
+    uint64_t framesInFlight;
+    VkDeviceSize residentSize = 0;
+    std::list<std::string> lru;
+    std::unordered_map<std::string, Resident> residents;
+    std::unordered_set<std::string> streaming;
+
+public:
+    /** Fallback is drawn in place of meshes still streaming in and stays owned by the caller */
+    ResidencyManager(MeshLoader *meshLoader, Mesh *fallback, VkDeviceSize budget, int framesInFlight);
+    ~ResidencyManager();
+
+    /** Returns the mesh if resident, otherwise queues it to stream in and returns the fallback meanwhile */
+    Mesh *acquire(std::string const &name, uint64_t frame);
+    void prefetch(std::vector<std::string> const &names, uint64_t frame);
+
+    /** Takes in meshes whose upload has completed and evicts meshes left over budget once the frames in flight that used them have finished, called once a frame */
+    void collect(uint64_t frame);
+    VkDeviceSize getResidentSize() const;
+    VkDeviceSize getBudget() const;
+
+    static VkDeviceSize getDefaultBudget(PhysicalDevice const *physicalDevice);
+
+private:
+    void insert(std::string const &name, Mesh *mesh, uint64_t frame);
+    void evict(uint64_t frame);
+};
@@ -0,0 +1,90 @@
+
+#pragma once
+
+#include "command/commandBuffer.hpp"
+#include "frame/frame.hpp"
+#include "memory/attachment.hpp"
+#include "memory/typedBuffer.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <functional>
+#include <vector>
+
+class Device;
+class PhysicalDevice;
+class CommandPool;
+class DescriptorSetLayout;
+class DescriptorPool;
+class DescriptorSet;
+class RenderPass;
+class Pipeline;
+class Mesh;
+
+/** Renders many small independent views per submission by packing them into the tiles of an offscreen atlas */
+class BatchRenderer
+{
+public:
+    using ViewSink = std::function<void(uint32_t viewIndex, uint8_t const *pixels, uint32_t rowPitch)>;
+
+private:
+    /** Everything one in-flight batch needs, so the next batch can be recorded while this one renders */
+    struct Slot
+    {
+        Device const *device;
+        CommandBuffer commandBuffer;
+        VkFence fence;
+        Attachment target;
+        Attachment depth;
+        VkFramebuffer framebuffer;
+        TypedBuffer<uint8_t> uniformBuffer;
+        TypedBuffer<uint8_t> readbackBuffer;
+        uint8_t const *readbackData;
+        DescriptorSet const &descriptorSet;
+        uint32_t firstView = 0;
+        uint32_t nViews = 0;
+        bool pending = false;
+
+        Slot(Device const *device, PhysicalDevice const *physicalDevice, CommandPool *commandPool, RenderPass const *renderPass, VkExtent2D const &atlasExtent, VkDeviceSize const &uniformSize, DescriptorSet &descriptorSet);
+        ~Slot();
+    };
+
+private:
+    Device const *device;
+    Mesh const *mesh;
+
+    VkExtent2D viewExtent;
+    VkExtent2D atlasExtent;
+    uint32_t columns;
+    uint32_t rows;
+    VkDeviceSize uniformStride;
+    std::vector<uint8_t> uniformStaging;
+    std::vector<uint32_t> viewLods;
+
+    DescriptorSetLayout *descriptorSetLayout;
+    DescriptorPool *descriptorPool;
+    RenderPass *renderPass;
+    Pipeline *pipeline;
+    std::vector<Slot *> slots;
+
+public:
+    static VkFormat constexpr FORMAT = VK_FORMAT_R8G8B8A8_UNORM;
+
+public:
+    BatchRenderer
+    (
+        Device const *device, PhysicalDevice const *physicalDevice, CommandPool *commandPool,
+        Mesh const *mesh, VkExtent2D const &viewExtent, uint32_t viewsPerBatch, int nSlots=2
+    );
+    ~BatchRenderer();
+
+    uint32_t getViewsPerBatch() const;
+    VkExtent2D const &getAtlasExtent() const;
+
+    void render(std::vector<UniformObject> const &views, ViewSink const &sink);
+
+private:
+    void submit(Slot *slot, UniformObject const *views, uint32_t nViews, uint32_t firstView);
+    void drain(Slot *slot, ViewSink const &sink);
+    VkOffset2D getTileOffset(uint32_t tile) const;
+};
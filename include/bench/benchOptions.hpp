@@ -0,0 +1,20 @@
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+/** Benchmark command line of --name value pairs, lists comma separated */
+class BenchOptions
+{
+private:
+    std::map<std::string, std::string> values;
+
+public:
+    BenchOptions(int argc, char **argv);
+
+    std::string get(std::string const &name, std::string const &fallback) const;
+    double getNumber(std::string const &name, double fallback) const;
+    std::vector<std::string> getList(std::string const &name, std::string const &fallback) const;
+};
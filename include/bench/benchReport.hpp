@@ -0,0 +1,36 @@
+
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+/** Benchmark results as CSV or JSON, and regression checks of a run against a stored JSON baseline */
+namespace benchReport
+{
+    /** Only metrics with a direction are compared against baselines, the rest are too noisy to gate on */
+    enum Direction { Informational, LowerIsBetter, HigherIsBetter };
+
+    struct Metric
+    {
+        std::string name;
+        double value;
+        Direction direction = Informational;
+    };
+
+    struct Result
+    {
+        std::string scenario;
+        std::vector<Metric> metrics;
+    };
+
+    void writeCsv(std::ostream &stream, std::vector<Result> const &results);
+    void writeJson(std::ostream &stream, std::vector<Result> const &results);
+    void write(std::string const &filename, std::vector<Result> const &results);
+
+    /** Reads results written by writeJson, directions are taken from the current run when compared */
+    std::vector<Result> readJson(std::string const &filename);
+
+    /** Describes every directed metric worse than its baseline by more than threshold, a fraction of the baseline */
+    std::vector<std::string> compare(std::vector<Result> const &results, std::vector<Result> const &baseline, double threshold);
+}
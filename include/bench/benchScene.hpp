@@ -0,0 +1,53 @@
+
+#pragma once
+
+#include "mesh/meshData.hpp"
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+/** Procedural benchmark scenes, a grid of identical spheres seen from a seeded camera path that is the same on every platform */
+namespace benchScene
+{
+    /** Offscreen frames have nothing to present, so fifo paces submissions to a virtual vertical blank instead */
+    enum PresentMode { Immediate, Fifo };
+
+    struct Scenario
+    {
+        uint32_t nObjects;
+        uint32_t nVertices;
+        int framesInFlight;
+        PresentMode presentMode;
+
+        /** Stable key used to match baselines, such as o100_v5000_f2_immediate */
+        std::string getName() const;
+    };
+
+    PresentMode parsePresentMode(std::string const &name);
+    char const *getName(PresentMode presentMode);
+
+    /** Sphere of radius 0.5 with at least nVertices vertices, coloured by its normals */
+    MeshData makeSphere(uint32_t nVertices);
+
+    /** Model matrices of nObjects spheres packed in a cube grid centred on the origin */
+    std::vector<glm::mat4> layoutObjects(uint32_t nObjects);
+
+    /** Radius of a sphere enclosing every object of layoutObjects */
+    float getSceneRadius(uint32_t nObjects);
+
+    /** Looping path through waypoints drawn around the scene from seed, looking at its centre */
+    class CameraPath
+    {
+    private:
+        std::vector<glm::vec3> waypoints;
+        uint32_t framesPerWaypoint;
+
+    public:
+        CameraPath(uint32_t seed, float distance, uint32_t nWaypoints=8, uint32_t framesPerWaypoint=60);
+
+        /** Depends only on the frame index, never on timing */
+        glm::mat4 getView(uint32_t frame) const;
+    };
+}
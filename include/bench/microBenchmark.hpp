@@ -0,0 +1,53 @@
+
+#pragma once
+
+#include "bench/benchReport.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
+
+/** Minimal microbenchmark harness: bodies run their own loop in batches sized to a time budget, reported per iteration */
+namespace microBenchmark
+{
+    struct Settings
+    {
+        double minBatchSeconds = 0.01;
+        uint32_t repetitions = 10;
+    };
+
+    struct Measurement
+    {
+        std::string name;
+        uint64_t iterations;
+        double minNs;
+        double medianNs;
+        double meanNs;
+        double bytesPerSecond;
+    };
+
+    /** Body runs the given number of iterations, bytesPerIteration adds throughput to the measurement */
+    using Body = std::function<void(uint64_t iterations)>;
+
+    Measurement run(std::string const &name, Body const &body, Settings const &settings, uint64_t bytesPerIteration=0);
+
+    /** Median time is gated against baselines, the minimum and throughput are informational */
+    benchReport::Result toResult(Measurement const &measurement);
+
+    /** Keeps a value the optimiser would otherwise discard, along with the work producing it */
+    template<class T>
+    inline void doNotOptimize(T const &value)
+    {
+#ifdef _MSC_VER
+        char const volatile sink = *reinterpret_cast<char const volatile *>(&value);
+        (void)sink;
+        _ReadWriteBarrier();
+#else
+        asm volatile("" : : "r,m"(value) : "memory");
+#endif
+    }
+}
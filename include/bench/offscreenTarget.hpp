@@ -0,0 +1,32 @@
+
+#pragma once
+
+#include "memory/attachment.hpp"
+
+#include <vulkan/vulkan.h>
+
+class Device;
+class PhysicalDevice;
+class RenderPass;
+
+/** Colour and depth attachments with a framebuffer for rendering without a swapchain */
+class OffscreenTarget
+{
+private:
+    Device const *device;
+    Attachment colour;
+    Attachment depth;
+    VkFramebuffer framebuffer;
+
+public:
+    static VkFormat constexpr FORMAT = VK_FORMAT_R8G8B8A8_UNORM;
+
+public:
+    OffscreenTarget(Device const *device, PhysicalDevice const *physicalDevice, RenderPass const *renderPass, VkExtent2D const &extent);
+    OffscreenTarget(OffscreenTarget const &) = delete;
+    ~OffscreenTarget();
+
+    Attachment const &getColour() const;
+    VkFramebuffer const &getFramebuffer() const;
+    VkExtent2D const &getExtent() const;
+};
@@ -0,0 +1,30 @@
+
+#pragma once
+
+#include "bench/benchReport.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <string>
+
+class Device;
+class PhysicalDevice;
+class CommandPool;
+
+/** Headless end-to-end check of virtual texturing, drawing a receding plane through a low-resolution feedback pass and a full-resolution sampling pass */
+namespace virtualTextureCheck
+{
+    struct Settings
+    {
+        uint32_t frames;
+        VkExtent2D extent;
+        uint32_t cachePagesWide;
+        std::string filename;
+    };
+
+    /** Paged texture the check reads when none is given, a checkerboard under a gradient written to the temporary directory */
+    std::string writeDefaultTexture(uint32_t size=2048);
+
+    /** Passes once feedback read back on the host has requested pages and they have been streamed into the cache */
+    benchReport::Result run(Device const *device, PhysicalDevice const *physicalDevice, CommandPool *commandPool, Settings const &settings, bool &passed);
+}
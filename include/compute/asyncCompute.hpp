@@ -0,0 +1,43 @@
+
+#pragma once
+
+#include "command/commandBuffer.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <functional>
+#include <vector>
+
+class Device;
+class PhysicalDevice;
+class CommandPool;
+
+/**
+ * Per-frame compute work on the compute-only queue where the device has one, handed to graphics through a semaphore
+ * so it runs alongside rasterization of the frame before rather than queueing behind it
+ */
+class AsyncCompute
+{
+private:
+    Device const *device;
+    PhysicalDevice const *physicalDevice;
+    CommandPool *commandPool;
+    std::vector<CommandBuffer> commandBuffers;
+    std::vector<VkSemaphore> finishedSemaphores;
+
+public:
+    AsyncCompute(Device const *device, PhysicalDevice const *physicalDevice, int nFrames);
+    AsyncCompute(AsyncCompute const &) = delete;
+    ~AsyncCompute();
+
+    uint32_t getFrameCount() const;
+
+    /** Families of the queues buffers passed from compute to graphics are used on, for sharing them concurrently */
+    std::vector<uint32_t> getQueueFamilies() const;
+
+    /**
+     * Records and submits a frame's compute work once that frame's fence has been waited on,
+     * graphics then waits on the returned semaphore in the same frame before reading the results
+     */
+    VkSemaphore submit(uint64_t frameIndex, std::function<void(VkCommandBuffer const &commandBuffer)> commands);
+};
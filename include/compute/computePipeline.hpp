@@ -0,0 +1,28 @@
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+class Device;
+class ShaderModule;
+class DescriptorSetLayout;
+
+class ComputePipeline
+{
+private:
+    Device const *device;
+    VkPipeline handle;
+    VkPipelineLayout pipelineLayout;
+
+public:
+    ComputePipeline(Device const *device, ShaderModule const &shaderModule, std::vector<DescriptorSetLayout const *> const &descriptorSetLayouts, std::vector<VkPushConstantRange> const &pushConstantRanges={});
+    ComputePipeline(ComputePipeline const &) = delete;
+    ~ComputePipeline();
+    VkPipeline const &getHandle() const;
+    VkPipelineLayout const &getLayout() const;
+
+    /** Workgroups needed to cover count invocations in groups of groupSize */
+    static uint32_t getGroupCount(uint32_t count, uint32_t groupSize);
+};
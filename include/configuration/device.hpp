@@ -13,10 +13,25 @@ class Device
 private:
     VkDevice handle;
     VkQueue mainQueue;
+    VkQueue computeQueue;
+    PFN_vkCmdPushDescriptorSetKHR cmdPushDescriptorSet = nullptr;
+    PFN_vkCmdBeginRendering cmdBeginRendering = nullptr;
+    PFN_vkCmdEndRendering cmdEndRendering = nullptr;
+    PFN_vkCmdPipelineBarrier2 cmdPipelineBarrier2 = nullptr;
 
 public:
     Device(PhysicalDevice const *physicalDevice, std::vector<const char*> const &validationLayers, std::vector<const char*> const &extensions);
     ~Device();
     VkDevice const &getHandle() const;
-    Queue getMainQueue();
+    Queue getMainQueue() const;
+
+    /** Queue of the compute-only family where there is one, otherwise the main queue */
+    Queue getComputeQueue() const;
+    PFN_vkCmdPushDescriptorSetKHR getCmdPushDescriptorSet() const;
+
+    /** Entry points of 1.3 dynamic rendering and synchronization2, null unless the physical device supports both */
+    bool supportsDynamicRendering() const;
+    PFN_vkCmdBeginRendering getCmdBeginRendering() const;
+    PFN_vkCmdEndRendering getCmdEndRendering() const;
+    PFN_vkCmdPipelineBarrier2 getCmdPipelineBarrier2() const;
 };
@@ -10,6 +10,7 @@ class Instance
 {
 private:
     VkInstance handle;
+    uint32_t apiVersion;
 
 public:
     Instance(char const *appName, std::vector<const char *> const &validationLayers, VkDebugUtilsMessengerCreateInfoEXT const &debugMessengerCreateInfo);
@@ -17,6 +18,9 @@ public:
     
     VkInstance const &getHandle() const;
 
+    /** Highest version up to 1.3 the loader offers, 1.0 before instance versioning existed */
+    uint32_t getApiVersion() const;
+
 private:
     bool checkValidationLayerSupport(std::vector<const char *> const &validationLayers);
     std::vector<char const *> getRequiredExtensions();
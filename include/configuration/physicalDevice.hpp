@@ -13,14 +13,37 @@ class PhysicalDevice
 private:
     VkPhysicalDevice handle;
     uint32_t mainQueueFamilyIndex;
+    uint32_t computeQueueFamilyIndex;
+    VkPhysicalDeviceProperties properties;
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptorIndexingFeatures;
+    VkPhysicalDeviceDescriptorIndexingPropertiesEXT descriptorIndexingProperties;
+    bool dynamicRendering = false;
 
 public:
     PhysicalDevice(Instance const *instance, Surface const *surface, std::vector<const char*> const &deviceExtensions);
     VkPhysicalDevice const &getHandle() const;
     uint32_t getMainQueueFamilyIndex() const;
 
+    /** Compute-only family whose queue runs alongside the main one where the device has it, otherwise the main family */
+    uint32_t getComputeQueueFamilyIndex() const;
+    bool hasAsyncCompute() const;
+    VkPhysicalDeviceProperties const &getProperties() const;
+    VkPhysicalDeviceDescriptorIndexingPropertiesEXT const &getDescriptorIndexingProperties() const;
+    bool supportsBindless() const;
+
+    /** Dynamic rendering and synchronization2, both core in 1.3, usable through this instance */
+    bool supportsDynamicRendering() const;
+    uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+    uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties, VkMemoryPropertyFlags preferred) const;
+    VkFormat findDepthFormat() const;
+    bool supportsFormat(VkFormat format, VkFormatFeatureFlags features) const;
+    bool supportsExtension(char const *extensionName) const;
+
 private:
     static bool checkDeviceSuitability(VkPhysicalDevice const &physicalDeviceHandle, Surface const *surface, std::vector<const char*> const &deviceExtensions);
     static uint32_t calcMainQueueFamilyIndex(VkPhysicalDevice const &physicalDeviceHandle, Surface const *surface);
+    static uint32_t calcComputeQueueFamilyIndex(VkPhysicalDevice const &physicalDeviceHandle, uint32_t mainQueueFamilyIndex);
     static bool checkDeviceExtensionSupport(VkPhysicalDevice const &physicalDeviceHandle, std::vector<const char*> const &deviceExtensions);
+    void queryDescriptorIndexing(Instance const *instance);
+    void queryDynamicRendering(Instance const *instance);
 };
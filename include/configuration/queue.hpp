@@ -20,7 +20,12 @@ private:
 
 public:
     VkQueue const &getHandle() const;
-    void submit(Device const *device, CommandBuffer const &commandBuffer);
-    void drawSubmit(Device const *device, Frame const &frame);
+    void submit(Device const *device, CommandBuffer const &commandBuffer, VkFence const &fence=VK_NULL_HANDLE);
+
+    /** Signals a semaphore work on another queue waits on, for handing results over without blocking the host */
+    void submit(Device const *device, CommandBuffer const &commandBuffer, VkSemaphore const &signalSemaphore);
+
+    /** Also waits on another queue's semaphore, when given, before the stages that read what it produced */
+    void drawSubmit(Device const *device, Frame const &frame, VkSemaphore const &waitSemaphore=VK_NULL_HANDLE, VkPipelineStageFlags waitStages=0);
     void present(Swapchain const *swapchain, Frame const &frame, Image const &image);
 };
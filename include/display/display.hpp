@@ -1,11 +1,14 @@
 
 #pragma once
 
-#include "memory/typedBuffer.hpp"
-
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
+#include "render/renderGraph.hpp"
+
+#include <chrono>
+#include <string>
+
 class Window;
 class Instance;
 class DebugMessenger;
@@ -16,6 +19,21 @@ class DescriptorSetLayout;
 class Swapchain;
 class CommandPool;
 class FramePool;
+class DeletionQueue;
+class Mesh;
+class MeshLoader;
+class ResidencyManager;
+class AssetPack;
+class RenderQueue;
+class DeferredRenderer;
+class AsyncCompute;
+class Pipeline;
+class BindlessTable;
+class TextureLoader;
+class Texture;
+class GpuProfiler;
+class PipelineStatistics;
+class FrameMetrics;
 
 enum BufferingStrategy
 {
@@ -28,23 +46,45 @@ class Display
 {
 private:
     Window *window;
+    AssetPack *assetPack;
     Instance *instance;
     DebugMessenger *debugMessenger;
     Surface *surface;
     PhysicalDevice *physicalDevice;
     Device *device;
     DescriptorSetLayout *descriptorSetLayout;
+    BindlessTable *bindlessTable;
     Swapchain *swapchain;
     CommandPool *commandPool;
     FramePool *framePool;
+    DeletionQueue *deletionQueue;
+    uint64_t frameIndex = 0;
     
-    TypedBuffer<Vertex> *vertexBuffer;
-    TypedBuffer<uint16_t> *indexBuffer;
+    MeshLoader *meshLoader;
+    ResidencyManager *residencyManager;
+    std::string meshName;
+    Mesh *fallbackMesh;
+    Mesh *mesh;
+    TextureLoader *textureLoader;
+    Texture *texture;
+    uint32_t textureIndex = UINT32_MAX;
+    RenderQueue *renderQueue;
+    RenderGraph *renderGraph;
+    DeferredRenderer *deferredRenderer;
+    AsyncCompute *asyncCompute;
+    RenderGraph::Resource backbuffer;
+    RenderGraph::Resource depth;
+    VkImageView graphDepthView = VK_NULL_HANDLE;
+    GpuProfiler *gpuProfiler;
+    PipelineStatistics *pipelineStatistics;
+    FrameMetrics *frameMetrics;
+    std::chrono::steady_clock::time_point lastPresent{};
 
     bool framebufferResized = false;
+    bool traceKeyDown = false;
 
 public:
-    Display(int windowWidth, int windowHeight, char const *title, BufferingStrategy bufferingStrategy=DoubleBuffering, bool enableValidationLayers=false);
+    Display(int windowWidth, int windowHeight, char const *title, BufferingStrategy bufferingStrategy=DoubleBuffering, bool enableValidationLayers=false, char const *meshFilename=nullptr, bool deferred=false);
     ~Display();
 
     void tick();
@@ -53,4 +93,6 @@ public:
 private:
     static void framebufferResizeCallback(GLFWwindow *window, int width, int height);
     void drawFrame();
+    void buildRenderGraph();
+    void recordOpaque(VkCommandBuffer const &commandBuffer, Pipeline const *pipeline);
 };
@@ -11,6 +11,8 @@ class Device;
 class CommandPool;
 class PhysicalDevice;
 class DescriptorSet;
+class DescriptorSetLayout;
+class DescriptorAllocator;
 
 struct UniformObject
 {
@@ -19,6 +21,21 @@ struct UniformObject
     alignas(16) glm::mat4 proj;
 };
 
+/** Per-draw data pushed as constants, within the 128 bytes every device guarantees */
+struct DrawConstants
+{
+    alignas(16) glm::mat4 model;
+    uint32_t objectId;
+    uint32_t textureIndex = UINT32_MAX;
+    uint32_t bufferIndex = UINT32_MAX;
+    alignas(16) glm::mat3x4 normalMatrix = glm::mat3x4(1.0f);
+
+    static VkPushConstantRange getRange();
+
+    /** Inverse transpose of a model matrix, taken before any dequantization as normals are stored unit length */
+    static glm::mat3x4 getNormalMatrix(glm::mat4 const &model);
+};
+
 /** Stores all per-frame-in-flight data necessary */
 class Frame
 {
@@ -29,10 +46,11 @@ private:
     VkSemaphore renderFinishedSemaphore;
     VkFence inFlightFence;
     TypedBuffer<UniformObject> uniformObjectBuffer;
-    DescriptorSet const &descriptorSet;
+    DescriptorSet const *descriptorSet;
+    DescriptorAllocator *transientDescriptors;
 
 public:
-    Frame(Device const *device, CommandPool *commandPool, PhysicalDevice const *physicalDevice, DescriptorSet &descriptorSet);
+    Frame(Device const *device, CommandPool *commandPool, PhysicalDevice const *physicalDevice, DescriptorAllocator *descriptorAllocator, DescriptorSetLayout const *descriptorSetLayout);
     Frame(Frame &&old);
     ~Frame();
     
@@ -41,9 +59,11 @@ public:
     VkSemaphore const &getImageAvailableSemaphore() const;
     VkSemaphore const &getRenderFinishedSemaphore() const;
     VkFence const &getInFlightFence() const;
-    DescriptorSet const &getDescriptorSet() const;
+    DescriptorSet const *getDescriptorSet() const;
+    TypedBuffer<UniformObject> const &getUniformBuffer() const;
+    DescriptorAllocator &getTransientDescriptors();
 
-    void waitForReady(Device const *device) const;
+    void waitForReady(Device const *device);
 
     void updateUniform(UniformObject const &uniform);
 };
@@ -2,7 +2,7 @@
 #pragma once
 
 #include "frame/frame.hpp"
-#include "memory/descriptorPool.hpp"
+#include "memory/descriptorAllocator.hpp"
 
 #include <vulkan/vulkan.h>
 
@@ -17,9 +17,10 @@ class FramePool
 {
 private:
     std::vector<Frame> frames;
-    DescriptorPool descriptorPool;
+    DescriptorAllocator *descriptorAllocator;
 
 public:
     FramePool(Device const *device, CommandPool *commandPool, PhysicalDevice const *physicalDevice, int nFrames, DescriptorSetLayout const *descriptorSetLayout);
+    ~FramePool();
     Frame &nextFrame();
 };
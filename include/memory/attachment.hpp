@@ -0,0 +1,33 @@
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+class Device;
+class PhysicalDevice;
+
+/** Device-local image and view usable as a render target outside the swapchain */
+class Attachment
+{
+private:
+    Device const *device;
+    VkImage image;
+    VkDeviceMemory memory;
+    VkImageView imageView;
+    VkFormat format;
+    VkExtent2D extent;
+
+public:
+    Attachment
+    (
+        Device const *device, PhysicalDevice const *physicalDevice, VkFormat const &format, VkExtent2D const &extent,
+        VkImageUsageFlags const &usage, VkImageAspectFlags const &aspect
+    );
+    Attachment(Attachment &&old);
+    ~Attachment();
+
+    VkImage const &getImage() const;
+    VkImageView const &getImageView() const;
+    VkFormat const &getFormat() const;
+    VkExtent2D const &getExtent() const;
+};
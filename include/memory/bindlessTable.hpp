@@ -0,0 +1,59 @@
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+class Device;
+class PhysicalDevice;
+class DescriptorSetLayout;
+class VoidBuffer;
+class DeletionQueue;
+
+/** One update-after-bind descriptor set of every sampled image and storage buffer, which shaders address by index */
+class BindlessTable
+{
+public:
+    static uint32_t constexpr IMAGE_BINDING = 0;
+    static uint32_t constexpr BUFFER_BINDING = 1;
+    static uint32_t constexpr INVALID_INDEX = UINT32_MAX;
+
+private:
+    /** Hands out slot indices, reusing freed ones before growing */
+    struct Slots
+    {
+        uint32_t capacity;
+        uint32_t next = 0;
+        std::vector<uint32_t> freed;
+
+        uint32_t acquire();
+        void release(uint32_t index);
+    };
+
+    Device const *device;
+    DeletionQueue *deletionQueue;
+    DescriptorSetLayout *layout;
+    VkDescriptorPool pool;
+    VkDescriptorSet set;
+    Slots images;
+    Slots buffers;
+
+public:
+    /** Removed slots wait out the frames in flight on the deletion queue before reuse when given one */
+    BindlessTable(Device const *device, PhysicalDevice const *physicalDevice, DeletionQueue *deletionQueue=nullptr, uint32_t imageCapacity=4096, uint32_t bufferCapacity=1024);
+    ~BindlessTable();
+
+    DescriptorSetLayout const *getLayout() const;
+    VkDescriptorSet const &getSet() const;
+
+    // Slots are written immediately, even while the set is bound in pending command buffers
+    uint32_t addImage(VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout=VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    uint32_t addBuffer(VoidBuffer const &buffer, VkDeviceSize offset=0, VkDeviceSize range=VK_WHOLE_SIZE);
+
+    // Removing recycles the index once no frame in flight can still read it, or straight away without a deletion queue
+    void removeImage(uint32_t index);
+    void removeBuffer(uint32_t index);
+
+    void bind(VkCommandBuffer const &commandBuffer, VkPipelineLayout const &pipelineLayout, uint32_t setIndex, VkPipelineBindPoint bindPoint=VK_PIPELINE_BIND_POINT_GRAPHICS) const;
+};
@@ -0,0 +1,44 @@
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+/** Defers destroying resources until every frame in flight that may have used them has completed, instead of waiting for the device to idle */
+class DeletionQueue
+{
+private:
+    struct Entry
+    {
+        uint64_t frame;
+        std::function<void()> destroy;
+    };
+
+private:
+    uint64_t framesInFlight;
+    uint64_t frame = 0;
+    std::deque<Entry> entries;
+
+public:
+    DeletionQueue(int framesInFlight);
+    DeletionQueue(DeletionQueue const &) = delete;
+    ~DeletionQueue();
+
+    /** Starts the given frame once its fence has been waited on, destroying what frames that have since left flight retired */
+    void collect(uint64_t frame);
+
+    /** Queues destruction of something last used by the current frame */
+    void retire(std::function<void()> destroy);
+
+    template<class T>
+    void retire(T *object)
+    {
+        retire([object]() { delete object; });
+    }
+
+    /** Destroys everything still queued, the device having been waited on */
+    void flush();
+
+    size_t getPending() const;
+};
@@ -0,0 +1,82 @@
+
+#pragma once
+
+#include "memory/descriptorSet.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <unordered_map>
+#include <vector>
+
+class Device;
+class DescriptorSetLayout;
+class VoidBuffer;
+
+/** Allocates descriptor sets from a chain of pools that grows on exhaustion and resets wholesale, caching sets by layout and bound resources */
+class DescriptorAllocator
+{
+public:
+    /** One resource written to a binding, the buffer or image half used depending on type */
+    struct Binding
+    {
+        uint32_t binding;
+        VkDescriptorType type;
+        VkDescriptorBufferInfo buffer;
+        VkDescriptorImageInfo image;
+
+        static Binding ofBuffer(uint32_t binding, VkDescriptorType type, VoidBuffer const &buffer, VkDeviceSize offset=0, VkDeviceSize range=VK_WHOLE_SIZE);
+        static Binding ofImage(uint32_t binding, VkDescriptorType type, VkImageView imageView, VkSampler sampler, VkImageLayout layout=VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        bool operator==(Binding const &other) const;
+    };
+
+    struct Statistics
+    {
+        uint32_t pools;
+        uint32_t allocations;
+        uint32_t cacheHits;
+        uint32_t cacheMisses;
+    };
+
+    /** Descriptors of each type budgeted per set when sizing pools */
+    static std::vector<VkDescriptorPoolSize> const DEFAULT_SIZES;
+
+private:
+    struct CacheEntry
+    {
+        VkDescriptorSetLayout layout;
+        std::vector<Binding> bindings;
+        DescriptorSet set;
+    };
+
+    Device const *device;
+    std::vector<VkDescriptorPoolSize> sizesPerSet;
+    uint32_t setsPerPool;
+    VkDescriptorPool current = VK_NULL_HANDLE;
+    std::vector<VkDescriptorPool> usedPools;
+    std::vector<VkDescriptorPool> freePools;
+    std::unordered_multimap<size_t, CacheEntry> cache;
+    Statistics statistics{};
+
+public:
+    static uint32_t constexpr MAX_SETS_PER_POOL = 4096;
+
+public:
+    DescriptorAllocator(Device const *device, uint32_t setsPerPool=64, std::vector<VkDescriptorPoolSize> const &sizesPerSet=DEFAULT_SIZES);
+    DescriptorAllocator(DescriptorAllocator const &) = delete;
+    ~DescriptorAllocator();
+
+    /** Fresh set, left for the caller to write */
+    DescriptorSet allocate(DescriptorSetLayout const *layout);
+
+    /** Set with these resources bound, written only the first time this combination is asked for since the last reset */
+    DescriptorSet const *get(DescriptorSetLayout const *layout, std::vector<Binding> const &bindings);
+
+    /** Returns every set to its pool at once, only safe once the GPU is done with all of them */
+    void reset();
+
+    Statistics const &getStatistics() const;
+
+private:
+    VkDescriptorPool createPool();
+    VkDescriptorPool nextPool();
+};
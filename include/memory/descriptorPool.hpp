@@ -18,7 +18,7 @@ private:
     std::vector<DescriptorSet> descriptorSets;
 
 public:
-    DescriptorPool(Device const *device, int nDescriptorSets, DescriptorSetLayout const *descriptorSetLayout);
+    DescriptorPool(Device const *device, int nDescriptorSets, DescriptorSetLayout const *descriptorSetLayout, VkDescriptorType const &type=VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
     ~DescriptorPool();
 
     VkDescriptorPool const &getHandle();
@@ -16,5 +16,5 @@ public:
     
     VkDescriptorSet const &getHandle() const;
 
-    void bindToBuffer(Device const *device, VoidBuffer const &buffer);
+    void bindToBuffer(Device const *device, VoidBuffer const &buffer, VkDescriptorType const &type=VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VkDeviceSize const &range=VK_WHOLE_SIZE);
 };
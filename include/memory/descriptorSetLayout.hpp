@@ -3,6 +3,8 @@
 
 #include <vulkan/vulkan.h>
 
+#include <vector>
+
 class Device;
 
 class DescriptorSetLayout
@@ -10,10 +12,19 @@ class DescriptorSetLayout
 private:
     Device const *device;
     VkDescriptorSetLayout handle;
+    VkDescriptorSetLayoutCreateFlags flags;
 
 public:
-    DescriptorSetLayout(Device const *device);
+    DescriptorSetLayout(Device const *device, VkDescriptorType const &type=VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VkDescriptorSetLayoutCreateFlags flags=0);
+    DescriptorSetLayout
+    (
+        Device const *device, std::vector<VkDescriptorSetLayoutBinding> const &bindings, VkDescriptorSetLayoutCreateFlags flags=0,
+        std::vector<VkDescriptorBindingFlagsEXT> const &bindingFlags={}
+    );
     ~DescriptorSetLayout();
 
     VkDescriptorSetLayout const &getHandle() const;
+
+    /** Push descriptor layouts are written into command buffers and can't be allocated from pools */
+    bool isPushDescriptor() const;
 };
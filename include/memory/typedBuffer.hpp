@@ -13,9 +13,9 @@ public:
     TypedBuffer
     (
         Device const *device, PhysicalDevice const *physicalDevice, VkDeviceSize const &size,
-        VkBufferUsageFlags const &usage, VkMemoryPropertyFlags const &properties
+        VkBufferUsageFlags const &usage, VkMemoryPropertyFlags const &properties, std::vector<uint32_t> const &queueFamilies={}
     )
-        : VoidBuffer (device, physicalDevice, size, usage, properties)
+        : VoidBuffer (device, physicalDevice, size, usage, properties, queueFamilies)
     { }
 
     TypedBuffer(TypedBuffer &&old) : VoidBuffer(std::move(old))
@@ -26,6 +26,8 @@ public:
         return size / sizeof(T);
     }
 
+    using VoidBuffer::memcpy;
+
     void memcpy(std::vector<T> const &sourceData)
     {
         VoidBuffer::memcpy(util::vecsizeof(sourceData), sourceData.data());
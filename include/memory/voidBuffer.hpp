@@ -23,10 +23,11 @@ protected:
     VkDeviceSize const size;
 
 protected:
+    /** Shared concurrently when used by more than one queue family, sparing ownership transfers between queues */
     VoidBuffer
     (
         Device const *device, PhysicalDevice const *physicalDevice, VkDeviceSize const &size,
-        VkBufferUsageFlags const &usage, VkMemoryPropertyFlags const &properties
+        VkBufferUsageFlags const &usage, VkMemoryPropertyFlags const &properties, std::vector<uint32_t> const &queueFamilies={}
     );
 
 public:
@@ -37,5 +38,8 @@ public:
     uint32_t getOffset() const;
     VkDeviceSize getSize() const;
     void memcpy(size_t sourceDataSize, void const *sourceData);
+    void *map();
+    void unmap();
     void transfer(CommandPool *commandPool, Queue queue, VoidBuffer const &sourceBuffer);
+    void recordTransfer(VkCommandBuffer const &commandBuffer, VoidBuffer const &sourceBuffer);
 };
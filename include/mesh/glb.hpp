@@ -0,0 +1,10 @@
+
+#pragma once
+
+#include "mesh/meshData.hpp"
+
+/** Binary glTF 2.0 parsing: triangle primitives of every mesh merged into one triangle list, node transforms ignored */
+namespace glb
+{
+    MeshData parse(char const *data, size_t size);
+}
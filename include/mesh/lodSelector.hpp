@@ -0,0 +1,20 @@
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+
+class Mesh;
+
+/** Picks each frame the coarsest LOD whose simplification error projects to at most a pixel threshold */
+class LodSelector
+{
+private:
+    float pixelsPerUnit;
+    float pixelThreshold;
+
+public:
+    LodSelector(glm::mat4 const &proj, VkExtent2D const &viewportExtent, float pixelThreshold=1.0f);
+
+    uint32_t select(Mesh const *mesh, glm::mat4 const &modelView) const;
+};
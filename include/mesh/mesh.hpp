@@ -0,0 +1,48 @@
+
+#pragma once
+
+#include "memory/typedBuffer.hpp"
+#include "mesh/meshData.hpp"
+#include "vertex/quantize.hpp"
+#include "vertex/vertexLayout.hpp"
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+class Device;
+class PhysicalDevice;
+
+/** Device-local vertex and index buffers of one triangle list and its coarser LODs, vertices packed in a VertexLayout */
+class Mesh
+{
+private:
+    VertexLayout layout;
+    quantize::Dequantization dequantization;
+    TypedBuffer<char> vertexBuffer;
+    TypedBuffer<char> indexBuffer;
+    VkIndexType indexType;
+    std::vector<MeshData::Lod> lods;
+    MeshData::Bounds bounds;
+
+public:
+    Mesh
+    (
+        Device const *device, PhysicalDevice const *physicalDevice, VertexLayout const &layout, quantize::Dequantization const &dequantization,
+        uint32_t nVertices, uint32_t nIndices, std::vector<MeshData::Lod> const &lods, MeshData::Bounds const &bounds
+    );
+
+    TypedBuffer<char> &getVertexBuffer();
+    TypedBuffer<char> &getIndexBuffer();
+    VkIndexType getIndexType() const;
+    VertexLayout const &getLayout() const;
+    glm::mat4 getDequantizationTransform() const;
+    uint32_t getNIndices() const;
+    uint32_t getNLods() const;
+    MeshData::Lod const &getLod(uint32_t level) const;
+    MeshData::Bounds const &getBounds() const;
+    VkDeviceSize getSize() const;
+
+    void bind(VkCommandBuffer const &commandBuffer) const;
+};
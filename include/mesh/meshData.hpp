@@ -0,0 +1,40 @@
+
+#pragma once
+
+#include "vertex/vertex.hpp"
+
+#include <string>
+#include <vector>
+
+/** CPU-side triangle list, as produced by the text/interchange format parsers */
+struct MeshData
+{
+    /** Contiguous index range of one detail level and its object-space simplification error */
+    struct Lod
+    {
+        uint32_t firstIndex;
+        uint32_t nIndices;
+        float error;
+    };
+
+    /** Object-space bounding sphere */
+    struct Bounds
+    {
+        glm::vec3 centre;
+        float radius;
+    };
+
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<Lod> lods;
+
+    static MeshData parse(std::string const &filename);
+
+    /** Detail levels finest first, a single level covering every index if none were generated */
+    std::vector<Lod> getLods() const;
+    Bounds computeBounds() const;
+
+    /** Narrowest index width addressing every vertex, 2 or 4 bytes */
+    static uint32_t getIndexSize(uint64_t nVertices);
+    void writeIndices(void *destination) const;
+};
@@ -0,0 +1,38 @@
+
+#pragma once
+
+#include "mesh/meshData.hpp"
+#include "vertex/quantize.hpp"
+
+#include <string>
+
+/** Native binary mesh format: a header and LOD table followed by aligned vertex and index blobs laid out exactly as uploaded, vertices packed in any VertexLayout and indices as narrow as the vertex count allows */
+namespace meshFormat
+{
+    uint32_t constexpr MAGIC = 0x4D535648; // "HVSM"
+    uint32_t constexpr VERSION = 4;
+    uint64_t constexpr ALIGNMENT = 16;
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t vertexStride;
+        uint32_t indexSize;
+        uint64_t nVertices;
+        uint64_t nIndices;
+        uint64_t vertexOffset;
+        uint64_t indexOffset;
+        uint32_t vertexLayout;
+        quantize::Dequantization dequantization;
+        MeshData::Bounds bounds;
+        uint32_t nLods;
+        uint64_t lodOffset;
+    };
+
+    Header const &readHeader(char const *data, size_t size);
+    std::vector<MeshData::Lod> readLods(char const *data, Header const &header);
+    std::vector<char> serialize(MeshData const &meshData, VertexLayout const &layout=VertexLayout::FLOAT);
+    MeshData deserialize(char const *data, size_t size);
+    void write(std::string const &filename, MeshData const &meshData, VertexLayout const &layout=VertexLayout::FLOAT);
+}
@@ -0,0 +1,91 @@
+
+#pragma once
+
+#include "command/commandBuffer.hpp"
+#include "mesh/meshData.hpp"
+#include "memory/typedBuffer.hpp"
+#include "vertex/quantize.hpp"
+#include "vertex/vertexLayout.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class Device;
+class PhysicalDevice;
+class CommandPool;
+class Mesh;
+class AssetPack;
+
+/** Loads .obj, .glb and native .mesh files, or packed meshes, in parallel and uploads them to the device in one submission, packed in one VertexLayout; interchange formats are optimised and given LODs on load */
+class MeshLoader
+{
+private:
+    /** Host-visible copy of a mesh awaiting transfer */
+    struct StagedMesh
+    {
+        TypedBuffer<char> vertices;
+        TypedBuffer<char> indices;
+        quantize::Dequantization dequantization;
+        std::vector<MeshData::Lod> lods;
+        MeshData::Bounds bounds;
+    };
+
+    /** Upload submitted by poll, complete once its fence signals */
+    struct Batch
+    {
+        std::vector<std::string> names;
+        std::vector<StagedMesh> staged;
+        std::vector<Mesh *> meshes;
+        CommandBuffer commandBuffer;
+        VkFence fence;
+    };
+
+private:
+    Device const *device;
+    PhysicalDevice const *physicalDevice;
+    CommandPool *commandPool;
+    AssetPack const *assetPack;
+    VertexLayout layout;
+
+    // Worker staging requested files in the background
+    std::thread stagingThread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::string> requests;
+    std::vector<std::pair<std::string, StagedMesh>> ready;
+    std::exception_ptr error;
+    bool stopping = false;
+
+    std::list<Batch> batches;
+
+public:
+    MeshLoader(Device const *device, PhysicalDevice const *physicalDevice, CommandPool *commandPool, AssetPack const *assetPack=nullptr, VertexLayout const &layout=VertexLayout::FLOAT);
+    ~MeshLoader();
+
+    Mesh *load(std::string const &filename) const;
+    std::vector<Mesh *> load(std::vector<std::string> const &filenames) const;
+    Mesh *upload(MeshData const &meshData) const;
+
+    /** Queues a file to be parsed and staged on the worker thread */
+    void loadAsync(std::string const &filename);
+
+    /** Submits everything staged since the last call as one batch and returns meshes whose upload has completed, call once per frame */
+    std::vector<std::pair<std::string, Mesh *>> poll();
+
+private:
+    StagedMesh stage(std::string const &filename) const;
+    StagedMesh stage(MeshData const &meshData) const;
+    StagedMesh stageNative(char const *data, size_t size) const;
+    StagedMesh createStaging(uint64_t nVertices, uint64_t nIndices, quantize::Dequantization const &dequantization) const;
+    std::vector<Mesh *> createMeshes(std::vector<StagedMesh> const &stagedMeshes) const;
+    void recordUpload(VkCommandBuffer const &commandBuffer, StagedMesh const &staged, Mesh *mesh) const;
+    std::vector<Mesh *> upload(std::vector<StagedMesh> const &stagedMeshes) const;
+    void work();
+};
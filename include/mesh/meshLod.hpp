@@ -0,0 +1,18 @@
+
+#pragma once
+
+#include "mesh/meshData.hpp"
+
+#include <vector>
+
+/** Import-time level of detail generation by quadric error edge collapse onto existing vertices */
+namespace meshLod
+{
+    uint32_t constexpr MAX_LEVELS = 5;
+
+    /** Collapses edges until at most targetIndexCount indices remain or the next collapse exceeds maxError, reporting the error reached */
+    std::vector<uint32_t> simplify(std::vector<uint32_t> const &indices, std::vector<Vertex> const &vertices, size_t targetIndexCount, float maxError, float &error);
+
+    /** Appends coarser levels after an optimised mesh's indices, each reducing the previous by about reduction and sharing its vertices */
+    void generate(MeshData &meshData, uint32_t maxLevels=MAX_LEVELS, float reduction=0.5f);
+}
@@ -0,0 +1,29 @@
+
+#pragma once
+
+#include "mesh/meshData.hpp"
+
+#include <vector>
+
+/** Import-time triangle and vertex reordering for post-transform cache, overdraw and fetch locality */
+namespace meshOptimizer
+{
+    uint32_t constexpr CACHE_SIZE = 16;
+
+    /** Post-transform cache efficiency under a FIFO cache: transformed vertices per triangle and per unique vertex */
+    struct Statistics
+    {
+        float acmr;
+        float atvr;
+    };
+
+    Statistics analyze(std::vector<uint32_t> const &indices, size_t nVertices, uint32_t cacheSize=CACHE_SIZE);
+
+    // Individual passes, run in this order
+    std::vector<uint32_t> optimizeVertexCache(std::vector<uint32_t> &indices, size_t nVertices, uint32_t cacheSize=CACHE_SIZE);
+    void optimizeOverdraw(std::vector<uint32_t> &indices, std::vector<Vertex> const &vertices, std::vector<uint32_t> const &clusters, float threshold=1.05f, uint32_t cacheSize=CACHE_SIZE);
+    void optimizeVertexFetch(MeshData &meshData);
+
+    /** Runs every pass, allowing overdraw ordering to cost up to threshold times the optimised ACMR */
+    void optimize(MeshData &meshData, float threshold=1.05f);
+}
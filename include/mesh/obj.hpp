@@ -0,0 +1,10 @@
+
+#pragma once
+
+#include "mesh/meshData.hpp"
+
+/** Wavefront OBJ parsing: positions, optional per-position colours and normals, polygon faces fan-triangulated */
+namespace obj
+{
+    MeshData parse(char const *data, size_t size);
+}
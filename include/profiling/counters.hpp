@@ -0,0 +1,28 @@
+
+#pragma once
+
+#include <cstdint>
+
+/** Engine-wide monotonic event counters, incremented from any thread with relaxed atomics */
+namespace counters
+{
+    enum Counter
+    {
+        Draws,
+        Binds,
+        BytesUploaded,
+        PipelineCreations,
+        VertexInvocations,
+        ClippingInvocations,
+        ClippingPrimitives,
+        FragmentInvocations,
+        SamplesPassed,
+        COUNTER_COUNT
+    };
+
+    void add(Counter counter, uint64_t amount=1);
+    uint64_t get(Counter counter);
+
+    /** Snake case name used by exporters */
+    char const *getName(Counter counter);
+}
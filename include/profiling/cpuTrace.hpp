@@ -0,0 +1,76 @@
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#if defined(_M_X64) || defined(__x86_64__)
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #else
+        #include <x86intrin.h>
+    #endif
+#endif
+
+/** Scoped CPU zones recorded into per-thread buffers without locks, dumped as Chrome trace JSON for chrome://tracing or Perfetto */
+namespace cpuTrace
+{
+    uint32_t constexpr EVENTS_PER_THREAD = 1 << 16;
+
+    /** Completed zone, name must outlive the trace such as a string literal */
+    struct Event
+    {
+        char const *name;
+        uint64_t start;
+        uint64_t end;
+    };
+
+    /** Timestamp in ticks of the TSC where there is one, otherwise steady clock nanoseconds, converted when dumped */
+    inline uint64_t now()
+    {
+#if defined(_M_X64) || defined(__x86_64__)
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    void record(Event const &event);
+
+    /** Times its own lifetime */
+    class Zone
+    {
+    private:
+        char const *name;
+        uint64_t start;
+
+    public:
+        Zone(char const *name) : name(name), start(now())
+        { }
+
+        ~Zone()
+        {
+            record(Event{ .name = name, .start = start, .end = now() });
+        }
+    };
+
+    void setThreadName(std::string const &name);
+    void setEnabled(bool enabled);
+
+    // Snapshot of every thread's most recent EVENTS_PER_THREAD zones, safe while other threads keep recording
+    void writeJson(std::ostream &stream);
+    void dump(std::string const &filename);
+}
+
+// Zones compile to nothing unless tracing is enabled in the build
+#ifdef ENABLE_TRACING
+    #define TRACE_CONCAT_IMPL(a, b) a##b
+    #define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+    #define TRACE_ZONE(name) cpuTrace::Zone TRACE_CONCAT(traceZone, __LINE__)(name)
+    #define TRACE_THREAD(name) cpuTrace::setThreadName(name)
+#else
+    #define TRACE_ZONE(name) ((void)0)
+    #define TRACE_THREAD(name) ((void)0)
+#endif
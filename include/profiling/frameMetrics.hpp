@@ -0,0 +1,80 @@
+
+#pragma once
+
+#include "profiling/counters.hpp"
+#include "profiling/histogram.hpp"
+
+#include <chrono>
+#include <ostream>
+#include <string>
+
+/** Per-frame CPU time, GPU time and present interval distributions with stutter and counter totals, periodically written for dashboards */
+class FrameMetrics
+{
+public:
+    enum Series { CpuTime, GpuTime, PresentInterval, SERIES_COUNT };
+    enum Format { Prometheus, Csv };
+
+    /** A present interval this many times the running average counts as a stutter */
+    static double constexpr STUTTER_FACTOR = 2.0;
+    static double constexpr AVERAGE_WEIGHT = 0.05;
+
+    struct Summary
+    {
+        uint64_t frames;
+        double meanMs;
+        double p50Ms;
+        double p95Ms;
+        double p99Ms;
+        double maxMs;
+    };
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    /** Cumulative since startup, as Prometheus summaries expect alongside windowed quantiles */
+    struct Total
+    {
+        uint64_t count = 0;
+        double sum = 0.0;
+    };
+
+private:
+    std::string filename;
+    Format format;
+    double exportSeconds;
+
+    Histogram histograms[SERIES_COUNT];
+    Total totals[SERIES_COUNT];
+    double averageInterval = 0.0;
+    uint64_t stutters = 0;
+    uint64_t totalStutters = 0;
+    uint64_t intervalStart[counters::COUNTER_COUNT] {};
+    Clock::time_point startTime;
+    Clock::time_point intervalTime;
+    bool csvStarted = false;
+
+public:
+    /** Writes to filename every exportSeconds when one is given, Prometheus files are replaced while CSV files gain a row */
+    FrameMetrics(std::string const &filename="", Format format=Prometheus, double exportSeconds=10.0);
+
+    /** Negative GPU times, such as before the first timestamps resolve, are left out */
+    void recordFrame(double cpuMs, double gpuMs, double presentIntervalMs);
+
+    // Queries over the current interval
+    Summary getSummary(Series series) const;
+    uint64_t getStutters() const;
+    uint64_t getCounter(counters::Counter counter) const;
+    double getIntervalSeconds() const;
+
+    /** Exports the interval once exportSeconds have passed and returns true, leaving it queryable until reset */
+    bool update();
+    void reset();
+
+    void writePrometheus(std::ostream &stream) const;
+    void writeCsvHeader(std::ostream &stream) const;
+    void writeCsvRow(std::ostream &stream) const;
+    void exportFile();
+
+    static char const *getName(Series series);
+};
@@ -0,0 +1,89 @@
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Device;
+class PhysicalDevice;
+
+/** Times named, nestable scopes of command buffers with timestamp queries, one query pool per frame in flight read back once that frame's fence has signalled */
+class GpuProfiler
+{
+public:
+    static uint32_t constexpr MAX_SCOPES = 64;
+    static uint32_t constexpr WINDOW = 120;
+
+    struct Result
+    {
+        std::string name;
+        uint32_t depth;
+        double lastMs;
+        double averageMs;
+        double minMs;
+        double maxMs;
+    };
+
+private:
+    struct Scope
+    {
+        uint32_t timing;
+        uint32_t depth;
+    };
+
+    struct FrameQueries
+    {
+        VkQueryPool pool;
+        std::vector<Scope> scopes;
+        bool recorded = false;
+    };
+
+    /** Last WINDOW durations of one scope */
+    struct Timing
+    {
+        std::string name;
+        uint32_t depth;
+        std::vector<double> samples;
+        size_t next = 0;
+        double last = 0.0;
+    };
+
+private:
+    Device const *device;
+    bool supported;
+    double timestampPeriod;
+    uint64_t validMask;
+    std::vector<FrameQueries> frames;
+    uint64_t frameCount = 0;
+    FrameQueries *current = nullptr;
+    std::vector<uint32_t> openScopes;
+    std::vector<Timing> timings;
+    std::unordered_map<std::string, uint32_t> timingIds;
+
+public:
+    GpuProfiler(Device const *device, PhysicalDevice const *physicalDevice, int framesInFlight);
+    ~GpuProfiler();
+
+    /** Collects the results this frame's queries held last time round, then resets them and opens the frame scope; call first in the command buffer, after the frame's fence */
+    void beginFrame(VkCommandBuffer const &commandBuffer);
+    void endFrame(VkCommandBuffer const &commandBuffer);
+
+    void beginScope(VkCommandBuffer const &commandBuffer, std::string const &name);
+    void endScope(VkCommandBuffer const &commandBuffer);
+
+    bool isSupported() const;
+    std::vector<Result> getResults() const;
+
+    /** Duration of the most recently resolved frame, negative until one has */
+    double getFrameMs() const;
+
+    void writeJson(std::ostream &stream) const;
+    void exportJson(std::string const &filename) const;
+
+private:
+    void collect(FrameQueries &queries);
+};
@@ -0,0 +1,37 @@
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/** Log-linear histogram of millisecond durations, each power of two split into SUB_BUCKETS so percentiles are within about 3% */
+class Histogram
+{
+public:
+    static uint32_t constexpr SUB_BUCKETS = 32;
+    static int constexpr MIN_EXPONENT = -10;
+    static int constexpr MAX_EXPONENT = 17;
+
+private:
+    std::vector<uint64_t> buckets;
+    uint64_t count = 0;
+    double sum = 0.0;
+    double max = 0.0;
+
+public:
+    Histogram();
+
+    void record(double milliseconds);
+    void reset();
+
+    uint64_t getCount() const;
+    double getMean() const;
+    double getMax() const;
+
+    /** Value below which the fraction p of samples fall, as the midpoint of its bucket */
+    double getPercentile(double p) const;
+
+private:
+    static uint32_t getBucket(double milliseconds);
+    static double getBucketMidpoint(uint32_t bucket);
+};
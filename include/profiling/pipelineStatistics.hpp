@@ -0,0 +1,79 @@
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Device;
+class PhysicalDevice;
+
+/** Counts the work of named passes with pipeline statistics and occlusion queries, one pool of each per frame in flight read back once that frame's fence has signalled */
+class PipelineStatistics
+{
+public:
+    static uint32_t constexpr MAX_PASSES = 16;
+
+    /** Results in the order Vulkan writes them, by statistic bit */
+    enum Statistic { VertexInvocations, ClippingInvocations, ClippingPrimitives, FragmentInvocations, STATISTIC_COUNT };
+
+    struct Result
+    {
+        std::string name;
+        uint64_t statistics[STATISTIC_COUNT];
+        uint64_t samplesPassed;
+        uint64_t pixels;
+
+        /** Fragment shader invocations per pixel of the render area */
+        double getOverdraw() const;
+    };
+
+private:
+    struct Pass
+    {
+        uint32_t result;
+        uint64_t pixels;
+    };
+
+    struct FrameQueries
+    {
+        VkQueryPool statisticsPool = VK_NULL_HANDLE;
+        VkQueryPool occlusionPool = VK_NULL_HANDLE;
+        std::vector<Pass> passes;
+        bool recorded = false;
+    };
+
+private:
+    Device const *device;
+    bool statisticsSupported;
+    bool occlusionPrecise;
+    std::vector<FrameQueries> frames;
+    uint64_t frameCount = 0;
+    FrameQueries *current = nullptr;
+    bool open = false;
+    std::vector<Result> results;
+    std::unordered_map<std::string, uint32_t> resultIds;
+
+public:
+    PipelineStatistics(Device const *device, PhysicalDevice const *physicalDevice, int framesInFlight);
+    ~PipelineStatistics();
+
+    /** Collects the results this frame's queries held last time round, then resets them; call in the command buffer outside any render pass, after the frame's fence */
+    void beginFrame(VkCommandBuffer const &commandBuffer);
+
+    /** Brackets one pass inside its render pass, pixels being its render area */
+    void beginPass(VkCommandBuffer const &commandBuffer, std::string const &name, VkExtent2D const &extent);
+    void endPass(VkCommandBuffer const &commandBuffer);
+
+    bool isSupported() const;
+
+    /** Most recently resolved frame of each pass, samples passed are only counted where occlusion queries are precise */
+    std::vector<Result> const &getResults() const;
+
+    static char const *getName(Statistic statistic);
+
+private:
+    void collect(FrameQueries &queries);
+};
@@ -0,0 +1,106 @@
+
+#pragma once
+
+#include "vertex/vertexLayout.hpp"
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+class Device;
+class PhysicalDevice;
+class DescriptorSetLayout;
+class AssetPack;
+class DeletionQueue;
+class Swapchain;
+class RenderPass;
+class Pipeline;
+class Attachment;
+class Image;
+class Frame;
+class AsyncCompute;
+class ComputePipeline;
+class DescriptorAllocator;
+class DescriptorSet;
+class PipelineStatistics;
+template<class T> class TypedBuffer;
+
+/** Light read by the lighting subpass, falling off to nothing at its radius */
+struct PointLight
+{
+    alignas(16) glm::vec4 positionRadius;
+    alignas(16) glm::vec4 colour;
+};
+
+/**
+ * Deferred shading in one render pass: geometry fills a G-buffer of transient, lazily allocated attachments,
+ * then a fullscreen subpass reads them as input attachments and shades each pixel once with every light
+ */
+class DeferredRenderer
+{
+public:
+    /** Albedo with coverage in alpha, world-space normal and world-space position */
+    static std::vector<VkFormat> const G_BUFFER_FORMATS;
+
+private:
+    Device const *device;
+    PhysicalDevice const *physicalDevice;
+    DescriptorSetLayout const *descriptorSetLayout;
+    DescriptorSetLayout const *bindlessLayout;
+    AssetPack const *assetPack;
+    DeletionQueue *deletionQueue;
+    VertexLayout vertexLayout;
+    DescriptorSetLayout *lightingLayout;
+    TypedBuffer<PointLight> *lightBuffer;
+    TypedBuffer<PointLight> const *currentLights;
+
+    // Lights moved on the compute queue each frame, one copy per frame in flight so graphics never reads one being written
+    AsyncCompute *asyncCompute;
+    DescriptorSetLayout *animateLayout = nullptr;
+    ComputePipeline *animatePipeline = nullptr;
+    DescriptorAllocator *animateDescriptors = nullptr;
+    std::vector<TypedBuffer<PointLight> *> animatedLights;
+    std::vector<DescriptorSet const *> animateSets;
+
+    // Follow the swapchain, rebuilt whenever its depth attachment is replaced
+    VkImageView depthView = VK_NULL_HANDLE;
+    VkExtent2D extent{};
+    RenderPass *renderPass = nullptr;
+    Pipeline *geometryPipeline = nullptr;
+    Pipeline *lightingPipeline = nullptr;
+    std::vector<Attachment *> gBuffer;
+    std::unordered_map<VkImageView, VkFramebuffer> framebuffers;
+    PipelineStatistics *statistics = nullptr;
+
+public:
+    /**
+     * Geometry pipelines share the forward pipeline's set layouts, uniforms at set 0 and the bindless table at set 1 when given,
+     * and need a vertex layout with octahedral normals; lights stay where they are placed unless given compute to animate them with
+     */
+    DeferredRenderer(Device const *device, PhysicalDevice const *physicalDevice, DescriptorSetLayout const *descriptorSetLayout, VertexLayout const &vertexLayout, std::vector<PointLight> const &lights, AssetPack const *assetPack=nullptr, DescriptorSetLayout const *bindlessLayout=nullptr, DeletionQueue *deletionQueue=nullptr, AsyncCompute *asyncCompute=nullptr);
+    DeferredRenderer(DeferredRenderer const &) = delete;
+    ~DeferredRenderer();
+
+    /** Matches the swapchain after acquisition, replacing the pass, pipelines and G-buffer if it was recreated */
+    void prepare(Swapchain const *swapchain);
+
+    RenderPass *getRenderPass();
+    Pipeline const *getGeometryPipeline() const;
+
+    /** Counts geometry and lighting as separate passes, queries beginning and ending within each subpass */
+    void setStatistics(PipelineStatistics *statistics);
+
+    /** Moves this frame's lights on the compute queue, returning the semaphore the lighting subpass must wait on, or null if they are static */
+    VkSemaphore animate(uint64_t frameIndex, float time);
+
+    /** Records geometry into the G-buffer subpass, then lights the image in the next */
+    void run(Image const &image, Frame &frame, VkCommandBuffer const &commandBuffer, std::function<void()> geometry);
+
+private:
+    std::function<void()> release();
+    VkFramebuffer getFramebuffer(VkImageView const &imageView, VkImageView const &swapchainDepthView);
+    std::vector<char> readShader(char const *filename) const;
+};
@@ -0,0 +1,22 @@
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/** Stable least-significant-digit radix sort of 64-bit keys carrying a 32-bit payload */
+namespace radixSort
+{
+    struct Entry
+    {
+        uint64_t key;
+        uint32_t value;
+    };
+
+    /** Inputs smaller than this are sorted on the calling thread, spawning workers would cost more than the sort */
+    size_t constexpr PARALLEL_THRESHOLD = 1 << 14;
+
+    /** Sorts 8 bits per pass, skipping bytes every key shares; nThreads=0 uses every hardware thread for large inputs */
+    void sort(std::vector<Entry> &entries, std::vector<Entry> &scratch, uint32_t nThreads=0);
+}
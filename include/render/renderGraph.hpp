@@ -0,0 +1,177 @@
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+class Device;
+class PhysicalDevice;
+class DeletionQueue;
+class PipelineStatistics;
+
+/**
+ * Frame graph: passes declare the images and buffers they use, compilation culls passes nothing consumes,
+ * works out the barriers between the rest and lets transient images with disjoint lifetimes share memory
+ */
+class RenderGraph
+{
+public:
+    using Resource = uint32_t;
+    using Record = std::function<void(VkCommandBuffer const &commandBuffer)>;
+
+    /** How a pass uses a resource, attachments making it a graphics pass the graph begins rendering for */
+    enum Access
+    {
+        ColourAttachment,
+        DepthAttachment,
+        FragmentSampled,
+        ComputeSampled,
+        ComputeRead,
+        ComputeWrite,
+        VertexRead,
+        IndirectRead,
+        TransferRead,
+        TransferWrite,
+        ACCESS_COUNT
+    };
+
+    struct Use
+    {
+        Resource resource;
+        Access access;
+    };
+
+private:
+    struct ResourceState
+    {
+        VkImageLayout layout;
+        VkPipelineStageFlags stages;
+        VkAccessFlags access;
+        bool written;
+    };
+
+    struct ResourceInfo
+    {
+        std::string name;
+        bool isImage;
+        bool imported;
+        VkFormat format;
+        VkExtent2D extent;
+        VkImageAspectFlags aspect;
+        VkImageLayout initialLayout;
+        VkImageLayout finalLayout;
+
+        // Bound by the caller for imported resources, created at compile time for transient ones
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView imageView = VK_NULL_HANDLE;
+        VkBuffer buffer = VK_NULL_HANDLE;
+
+        // Found at compile time
+        VkImageUsageFlags usage = 0;
+        uint32_t firstPass = UINT32_MAX;
+        uint32_t lastPass = 0;
+        uint32_t block = UINT32_MAX;
+        ResourceState last{};
+    };
+
+    struct Barrier
+    {
+        Resource resource;
+        VkImageLayout oldLayout;
+        VkImageLayout newLayout;
+        VkAccessFlags srcAccess;
+        VkAccessFlags dstAccess;
+    };
+
+    struct Pass
+    {
+        std::string name;
+        std::vector<Use> uses;
+        Record record;
+
+        // Found at compile time
+        bool culled = false;
+        VkPipelineStageFlags srcStages = 0;
+        VkPipelineStageFlags dstStages = 0;
+        std::vector<Barrier> barriers;
+        std::vector<Resource> colourAttachments;
+        Resource depthAttachment = UINT32_MAX;
+        std::vector<VkAttachmentLoadOp> loadOps;
+        std::vector<VkAttachmentStoreOp> storeOps;
+        VkRenderPass renderPass = VK_NULL_HANDLE;
+        std::map<std::vector<VkImageView>, VkFramebuffer> framebuffers;
+    };
+
+    /** Memory shared by transient images whose lifetimes never overlap */
+    struct Block
+    {
+        VkDeviceSize size;
+        uint32_t memoryTypeBits;
+        std::vector<Resource> resources;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+    };
+
+private:
+    Device const *device;
+    PhysicalDevice const *physicalDevice;
+    DeletionQueue *deletionQueue;
+    PipelineStatistics *statistics = nullptr;
+    std::vector<ResourceInfo> resources;
+    std::vector<Pass> passes;
+    std::vector<Block> blocks;
+    std::vector<Barrier> finalBarriers;
+    VkPipelineStageFlags finalSrcStages = 0;
+    bool compiled = false;
+
+public:
+    /** Compiled objects are retired to the deletion queue when given one on reset, otherwise destroyed straight away */
+    RenderGraph(Device const *device, PhysicalDevice const *physicalDevice, DeletionQueue *deletionQueue=nullptr);
+    RenderGraph(RenderGraph const &) = delete;
+    ~RenderGraph();
+
+    /** Image created and owned by the graph, its memory shared with others not alive at the same time */
+    Resource createImage(std::string const &name, VkFormat format, VkExtent2D const &extent, VkImageAspectFlags aspect);
+
+    /** Image owned elsewhere and bound each frame, arriving in initialLayout and left in finalLayout, which if undefined discards it */
+    Resource importImage(std::string const &name, VkFormat format, VkExtent2D const &extent, VkImageAspectFlags aspect, VkImageLayout initialLayout, VkImageLayout finalLayout);
+    Resource importBuffer(std::string const &name);
+
+    void addPass(std::string const &name, std::vector<Use> const &uses, Record record);
+
+    /** Orders passes, places barriers and allocates transient images, once per configuration */
+    void compile();
+
+    /** Drops passes, resources and compiled objects, ready to declare the next configuration */
+    void reset();
+
+    void setImage(Resource resource, VkImage image, VkImageView imageView);
+    void setBuffer(Resource resource, VkBuffer buffer);
+    VkImage getImage(Resource resource) const;
+    VkImageView getImageView(Resource resource) const;
+
+    /** Brackets every graphics pass with queries under its name */
+    void setStatistics(PipelineStatistics *statistics);
+
+    void execute(VkCommandBuffer const &commandBuffer);
+
+    bool isCompiled() const;
+    uint32_t getPassCount() const;
+    uint32_t getCulledCount() const;
+    uint32_t getBarrierCount() const;
+    VkDeviceSize getTransientSize() const;
+
+private:
+    void cull();
+    void placeBarriers();
+    void allocateTransients();
+    void createRenderPasses();
+    VkFramebuffer getFramebuffer(Pass &pass);
+    void beginRendering(VkCommandBuffer const &commandBuffer, Pass &pass, VkExtent2D const &extent);
+    void endRendering(VkCommandBuffer const &commandBuffer, Pass const &pass);
+    void discard();
+    std::function<void()> release();
+};
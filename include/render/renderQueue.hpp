@@ -0,0 +1,76 @@
+
+#pragma once
+
+#include "render/radixSort.hpp"
+#include "frame/frame.hpp"
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+
+#include <unordered_map>
+#include <vector>
+
+class Device;
+class Pipeline;
+class DescriptorSet;
+class VoidBuffer;
+class Mesh;
+
+/** Draws of one frame ordered by a 64-bit state key, recorded with only the binds that change between neighbours */
+class RenderQueue
+{
+public:
+    /** Uniforms come from a bound material set, or when that is null are pushed straight from the uniform buffer */
+    struct Draw
+    {
+        Pipeline const *pipeline;
+        DescriptorSet const *material;
+        VoidBuffer const *uniforms;
+        Mesh const *mesh;
+        uint32_t lod;
+        DrawConstants constants;
+    };
+
+    /** Binds issued and skipped by the last record */
+    struct Statistics
+    {
+        uint32_t draws;
+        uint32_t pipelineBinds;
+        uint32_t materialBinds;
+        uint32_t meshBinds;
+        uint32_t bindsAvoided;
+    };
+
+    // Key fields from most to least significant, depth last so each state group is drawn front to back
+    static uint32_t constexpr PASS_BITS = 4;
+    static uint32_t constexpr PIPELINE_BITS = 10;
+    static uint32_t constexpr MATERIAL_BITS = 14;
+    static uint32_t constexpr MESH_BITS = 12;
+    static uint32_t constexpr DEPTH_BITS = 24;
+    static_assert(PASS_BITS + PIPELINE_BITS + MATERIAL_BITS + MESH_BITS + DEPTH_BITS == 64);
+
+private:
+    Device const *device;
+    std::vector<Draw> draws;
+    std::vector<radixSort::Entry> entries;
+    std::vector<radixSort::Entry> scratch;
+    std::unordered_map<void const *, uint32_t> pipelineIds;
+    std::unordered_map<void const *, uint32_t> materialIds;
+    std::unordered_map<void const *, uint32_t> meshIds;
+    Statistics statistics{};
+
+public:
+    RenderQueue(Device const *device);
+
+    void clear();
+    void submit(uint32_t pass, Draw const &draw, glm::mat4 const &modelView);
+    void sort();
+    void record(VkCommandBuffer const &commandBuffer);
+
+    Statistics const &getStatistics() const;
+
+    static uint64_t makeKey(uint32_t pass, uint32_t pipelineId, uint32_t materialId, uint32_t meshId, float depth);
+
+private:
+    static uint32_t getId(std::unordered_map<void const *, uint32_t> &ids, void const *object, uint32_t bits);
+};
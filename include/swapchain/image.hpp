@@ -8,9 +8,8 @@ class Image
 public:
     VkImage const &image;
     VkImageView const &imageView;
-    VkFramebuffer const &framebuffer;
     uint32_t const index;
 
 public:
-    Image(VkImage const &image, VkImageView const &imageView, VkFramebuffer const &framebuffer, uint32_t const index);
+    Image(VkImage const &image, VkImageView const &imageView, uint32_t const index);
 };
@@ -1,8 +1,12 @@
 
 #pragma once
 
+#include "vertex/vertexInput.hpp"
+
 #include <vulkan/vulkan.h>
 
+#include <vector>
+
 class Device;
 class ShaderModule;
 class RenderPass;
@@ -16,7 +20,7 @@ private:
     VkPipelineLayout pipelineLayout;
 
 public:
-    Pipeline(Device const *device, ShaderModule const &vertShaderModule, ShaderModule const &fragShaderModule, RenderPass const *renderPass, VkExtent2D const &viewportExtent, DescriptorSetLayout const *descriptorSetLayout);
+    Pipeline(Device const *device, ShaderModule const &vertShaderModule, ShaderModule const &fragShaderModule, RenderPass const *renderPass, VkExtent2D const &viewportExtent, std::vector<DescriptorSetLayout const *> const &descriptorSetLayouts, vertexInput::State const &vertexInput, bool dynamicViewport=false, std::vector<VkPushConstantRange> const &pushConstantRanges={}, uint32_t subpass=0);
     ~Pipeline();
     VkPipeline const &getHandle() const;
     VkPipelineLayout const &getLayout() const;
@@ -4,21 +4,46 @@
 #include <vulkan/vulkan.h>
 
 #include <functional>
+#include <string>
+#include <vector>
 
 class Device;
-class Swapchain;
-class Image;
+class PipelineStatistics;
 
 class RenderPass
 {
 private:
     Device const *device;
-    VkRenderPass handle;
+    VkRenderPass handle = VK_NULL_HANDLE;
+    VkFormat format;
+    VkFormat depthFormat;
+    VkImageLayout finalLayout;
+    std::vector<VkFormat> gBufferFormats;
+    PipelineStatistics *statistics = nullptr;
+    std::string name;
 
 public:
-    RenderPass(Device const *device, VkFormat const &format);
+    /** Dynamic passes only describe formats for pipelines, whoever records them beginning rendering on image views, so have no render pass object and cannot run */
+    RenderPass(Device const *device, VkFormat const &format, VkFormat const &depthFormat=VK_FORMAT_UNDEFINED, VkImageLayout const &finalLayout=VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, bool dynamic=false);
+
+    /** Deferred pass: subpass 0 fills the G-buffer attachments, following colour and depth, which subpass 1 reads as input attachments to shade colour */
+    RenderPass(Device const *device, VkFormat const &format, VkFormat const &depthFormat, std::vector<VkFormat> const &gBufferFormats, VkImageLayout const &finalLayout=VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
     ~RenderPass();
     VkRenderPass const &getHandle() const;
+    VkFormat const &getFormat() const;
+    VkFormat const &getDepthFormat() const;
+    bool hasDepth() const;
+    bool isDynamic() const;
+    std::vector<VkFormat> const &getGBufferFormats() const;
+    uint32_t getSubpassCount() const;
+    uint32_t getColourAttachmentCount(uint32_t subpass=0) const;
+    bool usesDepth(uint32_t subpass=0) const;
+
+    /** Counts the work of every run under the given name, until set to nullptr; single-subpass passes only, as queries cannot span subpasses */
+    void setStatistics(PipelineStatistics *statistics, std::string const &name);
+
+    void run(VkFramebuffer const &framebuffer, VkExtent2D const &extent, VkCommandBuffer const &commandBuffer, std::function<void()> commands);
 
-    void run(Swapchain const *swapchain, Image const &image, VkCommandBuffer const &commandBuffer, std::function<void()> commands);
+    /** Moves commands recorded within run on to the next subpass */
+    void nextSubpass(VkCommandBuffer const &commandBuffer) const;
 };
@@ -4,6 +4,9 @@
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
+#include "vertex/vertexLayout.hpp"
+
+#include <functional>
 #include <vector>
 
 class Device;
@@ -15,35 +18,44 @@ class Pipeline;
 class Image;
 class Frame;
 class DescriptorSetLayout;
+class AssetPack;
+class Attachment;
+class DeletionQueue;
 
 class Swapchain
 {
 private:
-    VkSwapchainKHR handle;
+    VkSwapchainKHR handle = VK_NULL_HANDLE;
     Device const *device;
+    AssetPack const *assetPack;
+    DescriptorSetLayout const *bindlessLayout;
+    DeletionQueue *deletionQueue;
+    VertexLayout vertexLayout;
 
     VkFormat format;
     VkExtent2D extent;
 
-    RenderPass *renderPass;
-    Pipeline *pipeline;
+    Attachment *depthAttachment;
+    RenderPass *renderPass = nullptr;
+    Pipeline *pipeline = nullptr;
 
     std::vector<VkImage> images;
     std::vector<VkImageView> imageViews;
-    std::vector<VkFramebuffer> framebuffers;
 
 public:
-    Swapchain(Device const *device, PhysicalDevice const *physicalDevice, Window const *window, Surface const *surface, DescriptorSetLayout const *descriptorSetLayout);
+    /** Recreation retires the old objects to the deletion queue when given one, otherwise it waits for the device to idle */
+    Swapchain(Device const *device, PhysicalDevice const *physicalDevice, Window const *window, Surface const *surface, DescriptorSetLayout const *descriptorSetLayout, VertexLayout const &vertexLayout, AssetPack const *assetPack=nullptr, DescriptorSetLayout const *bindlessLayout=nullptr, DeletionQueue *deletionQueue=nullptr);
     ~Swapchain();
     VkSwapchainKHR const &getHandle() const;
     VkExtent2D const &getExtent() const;
     RenderPass *getRenderPass();
     Pipeline const *getPipeline() const;
+    Attachment const *getDepthAttachment() const;
     Image const acquireNextImage(Frame const &frame, bool &framebufferResized, PhysicalDevice const *physicalDevice, Window const *window, Surface const *surface, DescriptorSetLayout const *descriptorSetLayout);
 
 private:
     void create(PhysicalDevice const *physicalDevice, Window const *window, Surface const *surface, DescriptorSetLayout const *descriptorSetLayout);
-    void destroy();
+    std::function<void()> release();
     void recreate(PhysicalDevice const *physicalDevice, Window const *window, Surface const *surface, DescriptorSetLayout const *descriptorSetLayout);
 
     // Creation stages
@@ -52,5 +64,6 @@ private:
     static VkPresentModeKHR choosePresentMode(std::vector<VkPresentModeKHR> const &availablePresentModes);
     static VkExtent2D chooseExtent(VkSurfaceCapabilitiesKHR const &capabilities, Window const *window);
     void createImageViews();
-    void createFramebuffers();
+    void createDepthAttachment(PhysicalDevice const *physicalDevice);
+    std::vector<char> readShader(char const *filename) const;
 };
@@ -0,0 +1,22 @@
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstddef>
+#include <cstdint>
+
+/** CPU decoding of BC1 to BC5 blocks into RGBA8, for devices without block compression support */
+namespace blockDecoder
+{
+    bool canDecode(VkFormat format);
+
+    /** RGBA8 format holding decoded texels, keeping sRGB encoding */
+    VkFormat getDecodedFormat(VkFormat format);
+
+    /** Bytes of compressed data covering a level */
+    size_t getEncodedSize(VkFormat format, uint32_t width, uint32_t height);
+
+    /** Writes width*height tightly packed RGBA8 texels */
+    void decode(VkFormat format, char const *data, uint32_t width, uint32_t height, void *destination);
+}
@@ -0,0 +1,65 @@
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+/** KTX2 container parsing for single-layer 2D textures stored without supercompression, levels referenced in place */
+namespace ktx2
+{
+    struct Header
+    {
+        uint8_t identifier[12];
+        uint32_t vkFormat;
+        uint32_t typeSize;
+        uint32_t pixelWidth;
+        uint32_t pixelHeight;
+        uint32_t pixelDepth;
+        uint32_t layerCount;
+        uint32_t faceCount;
+        uint32_t levelCount;
+        uint32_t supercompressionScheme;
+        uint32_t dfdByteOffset;
+        uint32_t dfdByteLength;
+        uint32_t kvdByteOffset;
+        uint32_t kvdByteLength;
+        uint64_t sgdByteOffset;
+        uint64_t sgdByteLength;
+    };
+
+    struct LevelIndex
+    {
+        uint64_t byteOffset;
+        uint64_t byteLength;
+        uint64_t uncompressedByteLength;
+    };
+
+    /** One mip level, largest first */
+    struct Level
+    {
+        char const *data;
+        uint64_t size;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    struct Texture
+    {
+        VkFormat format;
+        uint32_t width;
+        uint32_t height;
+        std::vector<Level> levels;
+        bool generateMips;
+    };
+
+    uint32_t constexpr MAX_LEVELS = 32;
+
+    bool isKtx2(char const *data, size_t size);
+
+    /** Checks every level holds at least the bytes its extent needs in the texture's format */
+    Texture parse(char const *data, size_t size);
+
+    /** Bytes a tightly packed level of this extent takes, or 0 for formats without a known block layout */
+    uint64_t getLevelSize(VkFormat format, uint32_t width, uint32_t height);
+}
@@ -0,0 +1,44 @@
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <string>
+#include <vector>
+
+/** Native paged texture format for virtual texturing: a square power-of-two mip chain cut into equal pages, stored level by level in row-major order so any page is read in place */
+namespace pageFile
+{
+    uint32_t constexpr MAGIC = 0x54565648; // "HVVT"
+    uint32_t constexpr VERSION = 1;
+    uint64_t constexpr ALIGNMENT = 64;
+    uint32_t constexpr MAX_LEVELS = 16;
+    uint32_t constexpr MAX_PAGE_SIZE = 4096;
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t format;
+        uint32_t pageSize;
+        uint32_t size;
+        uint32_t nLevels;
+        uint64_t pageBytes;
+        uint64_t pageOffset;
+    };
+
+    Header const &readHeader(char const *data, size_t size);
+
+    /** Pages are stored as 4-byte RGBA or BGRA texels, 8 bits per channel */
+    bool isSupportedFormat(VkFormat format);
+
+    // Page addressing, levels after the first start where the previous one ends
+    uint32_t getPagesWide(Header const &header, uint32_t level);
+    uint32_t getLevelOffset(Header const &header, uint32_t level);
+    uint32_t getPageCount(Header const &header);
+    char const *getPage(char const *data, Header const &header, uint32_t pageIndex);
+
+    /** Box-filters RGBA8 texels down to a single page and cuts every level into pages */
+    std::vector<char> serialize(std::vector<uint8_t> const &texels, uint32_t size, uint32_t pageSize=128, VkFormat format=VK_FORMAT_R8G8B8A8_SRGB);
+    void write(std::string const &filename, std::vector<uint8_t> const &texels, uint32_t size, uint32_t pageSize=128, VkFormat format=VK_FORMAT_R8G8B8A8_SRGB);
+}
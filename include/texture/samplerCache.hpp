@@ -0,0 +1,55 @@
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <unordered_map>
+
+class Device;
+
+/** Deduplicates samplers and image views by their create info, so identical requests share one handle */
+class SamplerCache
+{
+public:
+    struct Statistics
+    {
+        size_t samplers;
+        size_t imageViews;
+        size_t cacheHits;
+    };
+
+private:
+    struct SamplerEntry
+    {
+        VkSamplerCreateInfo info;
+        VkSampler sampler;
+    };
+
+    struct ImageViewEntry
+    {
+        VkImageViewCreateInfo info;
+        VkImageView imageView;
+    };
+
+private:
+    Device const *device;
+    std::unordered_multimap<size_t, SamplerEntry> samplers;
+    std::unordered_multimap<size_t, ImageViewEntry> imageViews;
+    size_t cacheHits = 0;
+
+public:
+    SamplerCache(Device const *device);
+    ~SamplerCache();
+
+    // Chained create infos are not supported, pNext must be null
+    VkSampler getSampler(VkSamplerCreateInfo const &info);
+    VkImageView getImageView(VkImageViewCreateInfo const &info);
+
+    /** Destroys every view of an image, before the image itself is destroyed */
+    void releaseImageViews(VkImage image);
+
+    Statistics getStatistics() const;
+
+    /** Trilinear repeating sampler with anisotropic filtering up to maxAnisotropy, disabled at 1 */
+    static VkSamplerCreateInfo linear(float maxAnisotropy=1.0f);
+};
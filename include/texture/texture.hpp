@@ -0,0 +1,37 @@
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+class Device;
+class PhysicalDevice;
+class SamplerCache;
+
+/** Device-local sampled image with a full mip chain view, filled by TextureLoader */
+class Texture
+{
+private:
+    Device const *device;
+    SamplerCache *samplerCache;
+    VkImage image;
+    VkDeviceMemory memory;
+    VkImageView imageView;
+    VkFormat format;
+    VkExtent2D extent;
+    uint32_t mipLevels;
+    VkDeviceSize size;
+
+public:
+    Texture(Device const *device, PhysicalDevice const *physicalDevice, SamplerCache *samplerCache, VkFormat format, VkExtent2D const &extent, uint32_t mipLevels, VkImageUsageFlags usage);
+    ~Texture();
+
+    VkImage const &getImage() const;
+    VkImageView const &getImageView() const;
+    VkFormat getFormat() const;
+    VkExtent2D const &getExtent() const;
+    uint32_t getMipLevels() const;
+    VkDeviceSize getSize() const;
+
+    /** Levels in a full chain down to 1x1 */
+    static uint32_t countMipLevels(VkExtent2D const &extent);
+};
@@ -0,0 +1,93 @@
+
+#pragma once
+
+#include "command/commandBuffer.hpp"
+#include "memory/typedBuffer.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class Device;
+class PhysicalDevice;
+class CommandPool;
+class AssetPack;
+class SamplerCache;
+class Texture;
+
+/** Loads KTX2 textures, or packed ones, keeping block compression the device supports and decoding BC1 to BC5 otherwise, uploading batches in one submission and blitting missing mips */
+class TextureLoader
+{
+private:
+    /** Host-visible copy of every stored level awaiting transfer */
+    struct StagedTexture
+    {
+        struct Level
+        {
+            VkDeviceSize offset;
+            VkExtent2D extent;
+        };
+
+        TypedBuffer<char> staging;
+        VkFormat format;
+        VkExtent2D extent;
+        std::vector<Level> levels;
+        uint32_t mipLevels;
+    };
+
+    /** Upload submitted by poll, complete once its fence signals */
+    struct Batch
+    {
+        std::vector<std::string> names;
+        std::vector<StagedTexture> staged;
+        std::vector<Texture *> textures;
+        CommandBuffer commandBuffer;
+        VkFence fence;
+    };
+
+private:
+    Device const *device;
+    PhysicalDevice const *physicalDevice;
+    CommandPool *commandPool;
+    AssetPack const *assetPack;
+    SamplerCache *samplerCache;
+
+    // Worker staging requested files in the background
+    std::thread stagingThread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::string> requests;
+    std::vector<std::pair<std::string, StagedTexture>> ready;
+    std::exception_ptr error;
+    bool stopping = false;
+
+    std::list<Batch> batches;
+
+public:
+    TextureLoader(Device const *device, PhysicalDevice const *physicalDevice, CommandPool *commandPool, AssetPack const *assetPack=nullptr);
+    ~TextureLoader();
+
+    Texture *load(std::string const &filename);
+    std::vector<Texture *> load(std::vector<std::string> const &filenames);
+
+    /** Queues a file to be read and staged on the worker thread */
+    void loadAsync(std::string const &filename);
+
+    /** Submits everything staged since the last call as one batch and returns textures whose upload has completed, call once per frame */
+    std::vector<std::pair<std::string, Texture *>> poll();
+
+    SamplerCache *getSamplerCache() const;
+
+private:
+    StagedTexture stage(std::string const &filename) const;
+    StagedTexture stage(char const *data, size_t size) const;
+    std::vector<Texture *> createTextures(std::vector<StagedTexture> const &staged) const;
+    void recordUpload(VkCommandBuffer const &commandBuffer, StagedTexture const &staged, Texture const *texture) const;
+    void work();
+};
@@ -0,0 +1,133 @@
+
+#pragma once
+
+#include "texture/pageFile.hpp"
+#include "memory/descriptorAllocator.hpp"
+#include "memory/typedBuffer.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class Device;
+class PhysicalDevice;
+class SamplerCache;
+class AssetPack;
+class MappedFile;
+class Texture;
+class DescriptorSetLayout;
+
+/** Streams pages of a paged texture into a fixed cache texture as GPU feedback requests them, evicting least recently used pages; shaders sample it through virtualTexture.glsl */
+class VirtualTexture
+{
+public:
+    static uint32_t constexpr INVALID_ENTRY = UINT32_MAX;
+    static uint32_t constexpr MAX_UPLOADS_PER_FRAME = 16;
+    static uint32_t constexpr FEEDBACK_DIVISOR = 8;
+
+    /** Header of the indirection buffer, laid out as std430 declares it */
+    struct Parameters
+    {
+        uint32_t pagesWide;
+        uint32_t pageSize;
+        uint32_t cachePagesWide;
+        uint32_t nLevels;
+        uint32_t feedbackLodBias;
+        uint32_t levelOffsets[pageFile::MAX_LEVELS];
+    };
+
+    struct Statistics
+    {
+        uint32_t residentPages;
+        uint32_t requests;
+        uint32_t uploads;
+        uint32_t evictions;
+    };
+
+private:
+    struct Slot
+    {
+        uint32_t page;
+        uint64_t lastUsedFrame;
+        std::list<uint32_t>::iterator lruPosition;
+    };
+
+    /** Buffers one frame in flight reads and writes, touched again only once that frame's fence has signalled */
+    struct FrameResources
+    {
+        TypedBuffer<char> indirection;
+        TypedBuffer<uint32_t> feedback;
+        TypedBuffer<char> staging;
+        std::vector<std::pair<uint32_t, VkDeviceSize>> uploads;
+    };
+
+private:
+    Device const *device;
+    MappedFile *file;
+    char const *data;
+    pageFile::Header header;
+    uint32_t cachePagesWide;
+    uint64_t framesInFlight;
+    Texture *cache;
+    VkSampler sampler;
+    DescriptorSetLayout *layout;
+    std::vector<FrameResources> frames;
+    FrameResources *current = nullptr;
+    uint64_t currentFrame = 0;
+    bool cacheInitialized = false;
+
+    // Residency, each page pointing at its cache slot or INVALID_ENTRY
+    std::vector<uint32_t> pageSlots;
+    std::vector<bool> pending;
+    std::vector<Slot> slots;
+    std::list<uint32_t> lru;
+    std::vector<uint32_t> freeSlots;
+    std::deque<std::pair<uint32_t, uint64_t>> retiringSlots;
+    std::vector<uint32_t> indirection;
+    Statistics statistics{};
+
+    // Loader thread reading requested pages out of the file
+    std::thread loaderThread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<uint32_t> requests;
+    std::deque<std::pair<uint32_t, std::vector<char>>> loaded;
+    bool stopping = false;
+
+public:
+    VirtualTexture
+    (
+        Device const *device, PhysicalDevice const *physicalDevice, SamplerCache *samplerCache, std::string const &filename,
+        AssetPack const *assetPack=nullptr, uint32_t cachePagesWide=16, int framesInFlight=2
+    );
+    ~VirtualTexture();
+
+    /** Reads back the feedback this frame's buffers collected last time round and stages newly loaded pages, once the frame's fence has signalled */
+    void update(uint64_t frame);
+
+    /** Copies pages staged by update into the cache, outside any render pass and before draws sample it */
+    void recordUploads(VkCommandBuffer const &commandBuffer);
+
+    /** Makes the feedback pass's writes visible to the host, after that pass ends */
+    void recordFeedbackBarrier(VkCommandBuffer const &commandBuffer) const;
+
+    /** Size of the low-resolution target the feedback pass renders to */
+    static VkExtent2D getFeedbackExtent(VkExtent2D extent);
+
+    DescriptorSetLayout const *getLayout() const;
+    std::vector<DescriptorAllocator::Binding> getBindings() const;
+    Texture const *getCache() const;
+    Statistics const &getStatistics() const;
+
+private:
+    void readFeedback();
+    void stageLoadedPages();
+    void evict(uint32_t count);
+    void rebuildIndirection();
+    void load();
+};
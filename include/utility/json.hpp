@@ -0,0 +1,36 @@
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/** Minimal JSON document model, enough for asset metadata such as glTF, plus string quoting for writers */
+namespace json
+{
+    class Value
+    {
+    public:
+        enum Type { Null, Bool, Number, String, Array, Object };
+
+    public:
+        Type type = Null;
+        bool boolean = false;
+        double number = 0.0;
+        std::string string;
+        std::vector<Value> array;
+        std::vector<std::pair<std::string, Value>> object;
+
+    public:
+        bool has(std::string const &key) const;
+        Value const &operator[](std::string const &key) const;
+        Value const &operator[](size_t index) const;
+        size_t size() const;
+        double asNumber(double fallback=0.0) const;
+    };
+
+    Value parse(char const *data, size_t size);
+
+    /** Quoted and escaped string literal */
+    std::string quote(std::string const &text);
+}
@@ -0,0 +1,12 @@
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/** LZ4 block format compression, used for packed asset blobs */
+namespace lz4
+{
+    std::vector<char> compress(char const *source, size_t sourceSize);
+    void decompress(char const *source, size_t sourceSize, char *destination, size_t destinationSize);
+}
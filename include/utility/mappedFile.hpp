@@ -0,0 +1,26 @@
+
+#pragma once
+
+#include <string>
+
+/** Read-only memory mapping of a whole file, letting the OS page data in on demand instead of copying it */
+class MappedFile
+{
+private:
+    char const *data;
+    size_t size;
+#ifdef _WIN32
+    void *fileHandle;
+    void *mappingHandle;
+#else
+    int fileDescriptor;
+#endif
+
+public:
+    MappedFile(std::string const &filename);
+    MappedFile(MappedFile &&old);
+    ~MappedFile();
+
+    char const *getData() const;
+    size_t getSize() const;
+};
@@ -1,13 +1,20 @@
 
 #pragma once
 
+#include <functional>
 #include <vector>
 
 namespace util
 {
     template<class T>
-    size_t vecsizeof(std::vector<T> vector)
+    size_t vecsizeof(std::vector<T> const &vector)
     {
         return vector.size() * sizeof(T);
     }
+
+    template<class T>
+    void hashCombine(size_t &seed, T const &value)
+    {
+        seed ^= std::hash<T>{}(value) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+    }
 };
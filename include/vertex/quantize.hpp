@@ -0,0 +1,37 @@
+
+#pragma once
+
+#include "vertex/vertex.hpp"
+#include "vertex/vertexLayout.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/** Conversions between float vertices and the packed attribute formats of a VertexLayout */
+namespace quantize
+{
+    /** Affine map from stored positions back to object space, folded into the model matrix */
+    struct Dequantization
+    {
+        glm::vec3 offset;
+        glm::vec3 scale;
+
+        static Dequantization const IDENTITY;
+        glm::mat4 getTransform() const;
+    };
+
+    // Scalar attribute conversions
+    uint16_t toHalf(float value);
+    float fromHalf(uint16_t value);
+    int16_t toSnorm16(float value);
+    float fromSnorm16(int16_t value);
+    uint8_t toUnorm8(float value);
+    glm::vec2 encodeOctahedral(glm::vec3 normal);
+    glm::vec3 decodeOctahedral(glm::vec2 encoded);
+
+    // Whole vertex arrays, tightly packed at the layout's stride
+    Dequantization computeDequantization(std::vector<Vertex> const &vertices, VertexLayout const &layout);
+    void encode(std::vector<Vertex> const &vertices, VertexLayout const &layout, Dequantization const &dequantization, void *destination, bool simd=true);
+    std::vector<Vertex> decode(void const *data, size_t nVertices, VertexLayout const &layout, Dequantization const &dequantization);
+}
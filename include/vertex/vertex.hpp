@@ -1,21 +1,29 @@
 
 #pragma once
 
+#include "vertex/vertexInput.hpp"
+
 #include <vulkan/vulkan.h>
 #include <glm/glm.hpp>
 
-#include <vector>
-
 class Vertex
 {
 public:
-    glm::vec2 position;
+    glm::vec3 position;
     glm::vec3 colour;
+    glm::vec3 normal;
 
 public:
-    static VkVertexInputBindingDescription getBindingDescription();
-    static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions();
+    Vertex(glm::vec3 position, glm::vec3 colour, glm::vec3 normal=glm::vec3(0.0f, 0.0f, 1.0f));
+};
 
-public:
-    Vertex(glm::vec2 position, glm::vec3 colour);
+template<>
+struct vertexInput::Attributes<Vertex>
+{
+    static constexpr std::array value
+    {
+        VERTEX_ATTRIBUTE(Vertex, position),
+        VERTEX_ATTRIBUTE(Vertex, colour),
+        VERTEX_ATTRIBUTE(Vertex, normal)
+    };
 };
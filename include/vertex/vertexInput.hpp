@@ -0,0 +1,121 @@
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <span>
+
+/** Declares a vertex struct member as an attribute, its format deduced from the member's type */
+#define VERTEX_ATTRIBUTE(Type, member) \
+    vertexInput::attribute<decltype(Type::member)>(static_cast<uint32_t>(offsetof(Type, member)))
+
+/** Compile-time vertex input descriptions derived from the member lists of vertex structs */
+namespace vertexInput
+{
+    /** Vulkan format of an attribute type and how many locations it spans, specialise for new types */
+    template<class T>
+    struct Format;
+
+    template<> struct Format<float>     { static constexpr VkFormat value = VK_FORMAT_R32_SFLOAT;          static constexpr uint32_t nLocations = 1; };
+    template<> struct Format<glm::vec2> { static constexpr VkFormat value = VK_FORMAT_R32G32_SFLOAT;       static constexpr uint32_t nLocations = 1; };
+    template<> struct Format<glm::vec3> { static constexpr VkFormat value = VK_FORMAT_R32G32B32_SFLOAT;    static constexpr uint32_t nLocations = 1; };
+    template<> struct Format<glm::vec4> { static constexpr VkFormat value = VK_FORMAT_R32G32B32A32_SFLOAT; static constexpr uint32_t nLocations = 1; };
+    template<> struct Format<uint32_t>  { static constexpr VkFormat value = VK_FORMAT_R32_UINT;            static constexpr uint32_t nLocations = 1; };
+    template<> struct Format<glm::mat4> { static constexpr VkFormat value = VK_FORMAT_R32G32B32A32_SFLOAT; static constexpr uint32_t nLocations = 4; };
+
+    /** One member of a vertex struct, matrices spanning consecutive locations */
+    struct Attribute
+    {
+        VkFormat format;
+        uint32_t offset;
+        uint32_t nLocations;
+        uint32_t size;
+    };
+
+    template<class T>
+    constexpr Attribute attribute(uint32_t offset)
+    {
+        return Attribute{ Format<T>::value, offset, Format<T>::nLocations, static_cast<uint32_t>(sizeof(T)) };
+    }
+
+    /** Member list of a vertex struct, specialise with VERTEX_ATTRIBUTE; a bare attribute type is its own single member */
+    template<class T>
+    struct Attributes
+    {
+        static constexpr std::array value { attribute<T>(0) };
+    };
+
+    /** One vertex buffer binding of struct T, advanced per vertex or per instance */
+    template<class T, VkVertexInputRate InputRate=VK_VERTEX_INPUT_RATE_VERTEX>
+    struct Binding
+    {
+        using Type = T;
+        static constexpr VkVertexInputRate inputRate = InputRate;
+    };
+
+    /** Non-owning view of the descriptions a pipeline consumes */
+    struct State
+    {
+        std::span<VkVertexInputBindingDescription const> bindings;
+        std::span<VkVertexInputAttributeDescription const> attributes;
+    };
+
+    template<class T>
+    constexpr uint32_t countLocations()
+    {
+        uint32_t count = 0;
+        for (Attribute const &attribute : Attributes<T>::value)
+            count += attribute.nLocations;
+        return count;
+    }
+
+    /** Bindings numbered in order, attribute locations numbered consecutively across them */
+    template<class... Bindings>
+    struct Description
+    {
+        static constexpr uint32_t N_ATTRIBUTES = (countLocations<typename Bindings::Type>() + ...);
+
+        static constexpr std::array<VkVertexInputBindingDescription, sizeof...(Bindings)> BINDINGS = []()
+        {
+            uint32_t binding = 0;
+            return std::array<VkVertexInputBindingDescription, sizeof...(Bindings)>
+            {
+                VkVertexInputBindingDescription
+                {
+                    .binding = binding++,
+                    .stride = static_cast<uint32_t>(sizeof(typename Bindings::Type)),
+                    .inputRate = Bindings::inputRate
+                }...
+            };
+        }();
+
+        static constexpr std::array<VkVertexInputAttributeDescription, N_ATTRIBUTES> ATTRIBUTES = []()
+        {
+            std::array<VkVertexInputAttributeDescription, N_ATTRIBUTES> attributes{};
+            uint32_t binding = 0, location = 0;
+            auto addBinding = [&]<class T>()
+            {
+                for (Attribute const &attribute : Attributes<T>::value)
+                    for (uint32_t i=0; i<attribute.nLocations; i++)
+                    {
+                        attributes[location] = VkVertexInputAttributeDescription
+                        {
+                            .location = location,
+                            .binding = binding,
+                            .format = attribute.format,
+                            .offset = attribute.offset + i*(attribute.size/attribute.nLocations)
+                        };
+                        location++;
+                    }
+                binding++;
+            };
+            (addBinding.template operator()<typename Bindings::Type>(), ...);
+            return attributes;
+        }();
+
+        static constexpr State STATE { BINDINGS, ATTRIBUTES };
+    };
+}
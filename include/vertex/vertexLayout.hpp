@@ -0,0 +1,53 @@
+
+#pragma once
+
+#include "vertex/vertexInput.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <string>
+
+/** Storage format of each attribute in a packed vertex buffer, attributes in Vertex order */
+struct VertexLayout
+{
+    enum Position : uint8_t
+    {
+        PositionFloat = 0,   // R32G32B32_SFLOAT
+        PositionHalf = 1,    // R16G16B16A16_SFLOAT
+        PositionSnorm16 = 2, // R16G16B16A16_SNORM, normalised to the mesh's bounds
+    };
+
+    enum Colour : uint8_t
+    {
+        ColourFloat = 0,     // R32G32B32_SFLOAT
+        ColourUnorm8 = 1,    // R8G8B8A8_UNORM
+    };
+
+    enum Normal : uint8_t
+    {
+        NormalFloat = 0,     // R32G32B32_SFLOAT
+        NormalOctahedral = 1 // R16G16_SNORM octahedral map, decoded in the shader
+    };
+
+    Position position;
+    Colour colour;
+    Normal normal;
+
+    static VertexLayout const FLOAT;
+    static VertexLayout const HALF;
+    static VertexLayout const COMPACT;
+
+    static VertexLayout fromName(std::string const &name);
+    static VertexLayout unpack(uint32_t packed);
+    uint32_t pack() const;
+    char const *getName() const;
+
+    uint32_t getStride() const;
+    uint32_t getPositionOffset() const;
+    uint32_t getColourOffset() const;
+    uint32_t getNormalOffset() const;
+
+    vertexInput::State const &getVertexInput() const;
+
+    bool operator==(VertexLayout const &other) const = default;
+};
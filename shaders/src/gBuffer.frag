@@ -0,0 +1,34 @@
+
+#version 450
+
+#ifdef BINDLESS
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Every sampled image in the bindless table, addressed by the draw's texture index
+layout(set = 1, binding = 0) uniform sampler2D textures[];
+#endif
+
+layout(location = 0) in vec3 fragColor;
+layout(location = 1) in vec3 fragPosition;
+layout(location = 2) in vec3 fragNormal;
+layout(location = 3) in vec2 fragTexCoord;
+layout(location = 4) flat in uint fragTextureIndex;
+
+layout(location = 0) out vec4 outAlbedo;
+layout(location = 1) out vec4 outNormal;
+layout(location = 2) out vec4 outPosition;
+
+const uint INVALID_INDEX = 0xFFFFFFFFu;
+
+void main() {
+    vec3 albedo = fragColor;
+#ifdef BINDLESS
+    if (fragTextureIndex != INVALID_INDEX)
+        albedo *= texture(textures[nonuniformEXT(fragTextureIndex)], fragTexCoord).rgb;
+#endif
+
+    // Albedo alpha marks covered pixels, the rest are left to the clear colour
+    outAlbedo = vec4(albedo, 1.0);
+    outNormal = vec4(normalize(fragNormal), 0.0);
+    outPosition = vec4(fragPosition, 1.0);
+}
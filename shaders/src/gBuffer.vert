@@ -0,0 +1,46 @@
+
+#version 450
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+layout(push_constant) uniform DrawConstants {
+    mat4 model;
+    uint objectId;
+    uint textureIndex;
+    uint bufferIndex;
+    mat3 normalMatrix;
+} draw;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+layout(location = 2) in vec2 inNormal;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec3 fragPosition;
+layout(location = 2) out vec3 fragNormal;
+layout(location = 3) out vec2 fragTexCoord;
+layout(location = 4) flat out uint fragTextureIndex;
+
+// Normals arrive octahedral encoded, as in the compact vertex layout
+vec3 decodeOctahedral(vec2 encoded) {
+    vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    if (normal.z < 0.0)
+        normal.xy = (1.0 - abs(encoded.yx)) * vec2(encoded.x >= 0.0 ? 1.0 : -1.0, encoded.y >= 0.0 ? 1.0 : -1.0);
+    return normalize(normal);
+}
+
+void main() {
+    vec4 world = draw.model * vec4(inPosition, 1.0);
+    gl_Position = ubo.proj * ubo.view * world;
+    fragColor = inColor;
+    fragPosition = world.xyz;
+    fragNormal = draw.normalMatrix * decodeOctahedral(inNormal);
+
+    // Meshes carry no texture coordinates, so project the stored positions onto their xy plane
+    fragTexCoord = inPosition.xy * 0.5 + 0.5;
+    fragTextureIndex = draw.textureIndex;
+}
@@ -0,0 +1,42 @@
+
+#version 450
+
+layout(input_attachment_index = 0, binding = 0) uniform subpassInput gAlbedo;
+layout(input_attachment_index = 1, binding = 1) uniform subpassInput gNormal;
+layout(input_attachment_index = 2, binding = 2) uniform subpassInput gPosition;
+
+struct PointLight {
+    vec4 positionRadius;
+    vec4 colour;
+};
+
+layout(std430, binding = 3) readonly buffer Lights {
+    PointLight lights[];
+};
+
+layout(location = 0) out vec4 outColor;
+
+const vec3 AMBIENT = vec3(0.05);
+
+void main() {
+    vec4 albedo = subpassLoad(gAlbedo);
+    if (albedo.a == 0.0) {
+        outColor = vec4(0.0, 0.0, 0.0, 1.0);
+        return;
+    }
+    vec3 normal = normalize(subpassLoad(gNormal).xyz);
+    vec3 position = subpassLoad(gPosition).xyz;
+
+    // Every light shades the pixel once, falling off to nothing at its radius
+    vec3 lit = AMBIENT;
+    for (int i=0; i<lights.length(); i++) {
+        vec3 toLight = lights[i].positionRadius.xyz - position;
+        float distance = length(toLight);
+        float radius = lights[i].positionRadius.w;
+        if (distance >= radius)
+            continue;
+        float falloff = 1.0 - distance / radius;
+        lit += lights[i].colour.rgb * max(dot(normal, toLight / distance), 0.0) * falloff * falloff;
+    }
+    outColor = vec4(albedo.rgb * lit, 1.0);
+}
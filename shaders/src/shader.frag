@@ -1,10 +1,26 @@
 
 #version 450
 
+#ifdef BINDLESS
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Every sampled image in the bindless table, addressed by the draw's texture index
+layout(set = 1, binding = 0) uniform sampler2D textures[];
+#endif
+
 layout(location = 0) in vec3 fragColor;
+layout(location = 1) in vec2 fragTexCoord;
+layout(location = 2) flat in uint fragTextureIndex;
 
 layout(location = 0) out vec4 outColor;
 
+const uint INVALID_INDEX = 0xFFFFFFFFu;
+
 void main() {
-    outColor = vec4(fragColor, 1.0);
+    vec3 colour = fragColor;
+#ifdef BINDLESS
+    if (fragTextureIndex != INVALID_INDEX)
+        colour *= texture(textures[nonuniformEXT(fragTextureIndex)], fragTexCoord).rgb;
+#endif
+    outColor = vec4(colour, 1.0);
 }
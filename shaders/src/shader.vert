@@ -7,12 +7,25 @@ layout(binding = 0) uniform UniformBufferObject {
     mat4 proj;
 } ubo;
 
-layout(location = 0) in vec2 inPosition;
+layout(push_constant) uniform DrawConstants {
+    mat4 model;
+    uint objectId;
+    uint textureIndex;
+    uint bufferIndex;
+} draw;
+
+layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
 
 layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) flat out uint fragTextureIndex;
 
 void main() {
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 0.0, 1.0);
+    gl_Position = ubo.proj * ubo.view * draw.model * vec4(inPosition, 1.0);
     fragColor = inColor;
+
+    // Meshes carry no texture coordinates, so project the stored positions onto their xy plane
+    fragTexCoord = inPosition.xy * 0.5 + 0.5;
+    fragTextureIndex = draw.textureIndex;
 }
@@ -0,0 +1,51 @@
+
+// Virtual texture lookup through VirtualTexture's cache, indirection table and feedback buffer, include after defining VT_SET
+
+layout(set = VT_SET, binding = 0) uniform sampler2D vtCache;
+
+layout(std430, set = VT_SET, binding = 1) readonly buffer VtIndirection {
+    uint pagesWide;
+    uint pageSize;
+    uint cachePagesWide;
+    uint nLevels;
+    uint feedbackLodBias;
+    uint levelOffsets[16];
+    uint entries[];
+} vtIndirection;
+
+layout(std430, set = VT_SET, binding = 2) writeonly buffer VtFeedback {
+    uint requested[];
+} vtFeedback;
+
+// Mip level of the virtual texture a fragment needs, from screen-space derivatives less a bias for lower-resolution targets
+uint vtLevel(vec2 uv, float lodBias) {
+    vec2 texels = uv * float(vtIndirection.pagesWide * vtIndirection.pageSize);
+    vec2 dx = dFdx(texels), dy = dFdy(texels);
+    float lod = 0.5 * log2(max(dot(dx, dx), dot(dy, dy))) - lodBias;
+    return uint(clamp(floor(lod), 0.0, float(vtIndirection.nLevels - 1u)));
+}
+
+uint vtPageIndex(vec2 uv, uint level) {
+    uint wide = vtIndirection.pagesWide >> level;
+    uvec2 page = min(uvec2(fract(uv) * float(wide)), uvec2(wide - 1u));
+    return vtIndirection.levelOffsets[level] + page.y * wide + page.x;
+}
+
+// Records the page a fragment needs, from the feedback pass rendered at 1/FEEDBACK_DIVISOR of the screen
+void vtRequest(vec2 uv) {
+    uint level = vtLevel(uv, float(vtIndirection.feedbackLodBias));
+    vtFeedback.requested[vtPageIndex(uv, level)] = 1u;
+}
+
+// Samples the finest resident page covering uv, filtering clamped inside the page as pages carry no borders
+vec4 vtSample(vec2 uv) {
+    uint entry = vtIndirection.entries[vtPageIndex(uv, vtLevel(uv, 0.0))];
+    if (entry == 0xFFFFFFFFu)
+        return vec4(0.0);
+    vec2 slot = vec2(entry & 0xFFu, (entry >> 8) & 0xFFu);
+    uint residentLevel = entry >> 16;
+    vec2 local = fract(fract(uv) * float(vtIndirection.pagesWide >> residentLevel));
+    float inset = 0.5 / float(vtIndirection.pageSize);
+    local = clamp(local, vec2(inset), vec2(1.0 - inset));
+    return textureLod(vtCache, (slot + local) / float(vtIndirection.cachePagesWide), 0.0);
+}
@@ -0,0 +1,28 @@
+
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+#define VT_SET 0
+#include "virtualTexture.glsl"
+
+layout(push_constant) uniform Scroll {
+    vec2 offset;
+} scroll;
+
+layout(location = 0) in vec2 screen;
+
+layout(location = 0) out vec4 outColor;
+
+const float HORIZON = 0.3;
+
+// Ground plane receding to a horizon, so one frame needs every level from the finest near the bottom to the coarsest far away
+void main() {
+    float distance = 1.0 / max(screen.y - HORIZON, 0.01);
+    vec2 uv = vec2((screen.x - 0.5) * distance, distance) * 0.25 + scroll.offset;
+#ifdef FEEDBACK
+    vtRequest(uv);
+    outColor = vec4(0.0);
+#else
+    outColor = vtSample(uv);
+#endif
+}
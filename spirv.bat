@@ -2,4 +2,14 @@
 @echo off
 if not exist ".\shaders\bin\" mkdir ".\shaders\bin\"
 C:/VulkanSDK/1.3.211.0/Bin/glslc.exe shaders/src/shader.vert -o shaders/bin/shader.vert.spv
-C:/VulkanSDK/1.3.211.0/Bin/glslc.exe shaders/src/shader.frag -o shaders/bin/shader.frag.spv
\ No newline at end of file
+C:/VulkanSDK/1.3.211.0/Bin/glslc.exe shaders/src/shader.frag -o shaders/bin/shader.frag.spv
+C:/VulkanSDK/1.3.211.0/Bin/glslc.exe -DBINDLESS shaders/src/shader.frag -o shaders/bin/shaderBindless.frag.spv
+C:/VulkanSDK/1.3.211.0/Bin/glslc.exe shaders/src/gBuffer.vert -o shaders/bin/gBuffer.vert.spv
+C:/VulkanSDK/1.3.211.0/Bin/glslc.exe shaders/src/gBuffer.frag -o shaders/bin/gBuffer.frag.spv
+C:/VulkanSDK/1.3.211.0/Bin/glslc.exe -DBINDLESS shaders/src/gBuffer.frag -o shaders/bin/gBufferBindless.frag.spv
+C:/VulkanSDK/1.3.211.0/Bin/glslc.exe shaders/src/lighting.vert -o shaders/bin/lighting.vert.spv
+C:/VulkanSDK/1.3.211.0/Bin/glslc.exe shaders/src/lighting.frag -o shaders/bin/lighting.frag.spv
+C:/VulkanSDK/1.3.211.0/Bin/glslc.exe shaders/src/animateLights.comp -o shaders/bin/animateLights.comp.spv
+C:/VulkanSDK/1.3.211.0/Bin/glslc.exe shaders/src/vtPlane.vert -o shaders/bin/vtPlane.vert.spv
+C:/VulkanSDK/1.3.211.0/Bin/glslc.exe shaders/src/vtPlane.frag -o shaders/bin/vtPlane.frag.spv
+C:/VulkanSDK/1.3.211.0/Bin/glslc.exe -DFEEDBACK shaders/src/vtPlane.frag -o shaders/bin/vtPlaneFeedback.frag.spv
\ No newline at end of file
@@ -0,0 +1,131 @@
+
+#include "asset/assetPack.hpp"
+
+#include "utility/lz4.hpp"
+
+#include <cstring>
+#include <exception>
+#include <fstream>
+
+AssetPack::AssetPack(std::string const &filename) : file(filename)
+{
+    // Validate header
+    if (file.getSize() < sizeof(Header))
+        throw std::exception("Asset pack truncated.");
+    Header const &header = *reinterpret_cast<Header const *>(file.getData());
+    if (header.magic != MAGIC || header.version != VERSION)
+        throw std::exception("Not an asset pack or unsupported version.");
+    if (header.tocOffset > file.getSize() || header.nEntries > (file.getSize() - header.tocOffset) / sizeof(Entry))
+        throw std::exception("Asset pack table of contents truncated.");
+
+    // Index table of contents in place
+    Entry const *toc = reinterpret_cast<Entry const *>(file.getData() + header.tocOffset);
+    for (uint64_t i=0; i<header.nEntries; i++)
+    {
+        Entry const &entry = toc[i];
+        if (entry.offset > file.getSize() || entry.storedSize > file.getSize() - entry.offset || entry.name[sizeof(entry.name)-1] != '\0')
+            throw std::exception("Asset pack entry corrupt.");
+        entries[entry.name] = &entry;
+    }
+}
+
+bool AssetPack::contains(std::string const &name) const
+{
+    return entries.count(name) != 0;
+}
+
+AssetPack::Entry const &AssetPack::getEntry(std::string const &name) const
+{
+    auto iterator = entries.find(name);
+    if (iterator == entries.end())
+        throw std::exception("Asset not found in pack.");
+    return *iterator->second;
+}
+
+std::vector<std::string> AssetPack::getNames() const
+{
+    std::vector<std::string> names;
+    for (auto const &[name, entry] : entries)
+        names.push_back(name);
+    return names;
+}
+
+char const *AssetPack::view(std::string const &name) const
+{
+    // Only stored blobs can be used in place
+    Entry const &entry = getEntry(name);
+    if (entry.compressed)
+        throw std::exception("Compressed asset can't be viewed in place.");
+    return file.getData() + entry.offset;
+}
+
+void AssetPack::read(std::string const &name, void *destination) const
+{
+    Entry const &entry = getEntry(name);
+    if (entry.compressed)
+        lz4::decompress(file.getData() + entry.offset, entry.storedSize, static_cast<char *>(destination), entry.size);
+    else
+        std::memcpy(destination, file.getData() + entry.offset, entry.size);
+}
+
+std::vector<char> AssetPack::read(std::string const &name) const
+{
+    std::vector<char> data(getEntry(name).size);
+    read(name, data.data());
+    return data;
+}
+
+void AssetPack::write(std::string const &filename, std::vector<Input> const &inputs)
+{
+    std::ofstream output(filename, std::ios::binary);
+    if (!output.is_open())
+        throw std::exception("Failed to open asset pack for writing.");
+
+    // Reserve header, filled in once table of contents position is known
+    Header header
+    {
+        .magic = MAGIC,
+        .version = VERSION,
+        .nEntries = inputs.size()
+    };
+    output.write(reinterpret_cast<char const *>(&header), sizeof(Header));
+
+    // Write aligned blobs, keeping compressed form only when it's smaller
+    std::vector<Entry> toc;
+    char const padding[ALIGNMENT] = {};
+    uint64_t position = sizeof(Header);
+    for (Input const &input : inputs)
+    {
+        if (input.name.size() >= sizeof(Entry::name))
+            throw std::exception("Asset name too long for pack.");
+
+        std::vector<char> compressed;
+        if (input.compress)
+            compressed = lz4::compress(input.data.data(), input.data.size());
+        bool useCompressed = input.compress && compressed.size() < input.data.size();
+        std::vector<char> const &stored = useCompressed ? compressed : input.data;
+
+        uint64_t alignedPosition = (position + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        output.write(padding, alignedPosition - position);
+        output.write(stored.data(), stored.size());
+        position = alignedPosition + stored.size();
+
+        Entry entry
+        {
+            .type = input.type,
+            .compressed = useCompressed,
+            .offset = alignedPosition,
+            .storedSize = stored.size(),
+            .size = input.data.size()
+        };
+        std::strncpy(entry.name, input.name.c_str(), sizeof(entry.name));
+        toc.push_back(entry);
+    }
+
+    // Write table of contents then patch header
+    header.tocOffset = (position + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    output.write(padding, header.tocOffset - position);
+    output.write(reinterpret_cast<char const *>(toc.data()), toc.size() * sizeof(Entry));
+    output.seekp(0);
+    output.write(reinterpret_cast<char const *>(&header), sizeof(Header));
+}
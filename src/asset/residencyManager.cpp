@@ -0,0 +1,108 @@
+
+#include "asset/residencyManager.hpp"
+
+#include "configuration/physicalDevice.hpp"
+#include "mesh/mesh.hpp"
+#include "mesh/meshLoader.hpp"
+
+#include <algorithm>
+
+ResidencyManager::ResidencyManager(MeshLoader *meshLoader, Mesh *fallback, VkDeviceSize budget, int framesInFlight)
+    : meshLoader(meshLoader), fallback(fallback), budget(budget), framesInFlight(framesInFlight)
+{ }
+
+ResidencyManager::~ResidencyManager()
+{
+    for (auto &[name, resident] : residents)
+        delete resident.mesh;
+}
+
+Mesh *ResidencyManager::acquire(std::string const &name, uint64_t frame)
+{
+    // Mark resident mesh as most recently used
+    auto iterator = residents.find(name);
+    if (iterator != residents.end())
+    {
+        iterator->second.lastUsedFrame = frame;
+        lru.splice(lru.begin(), lru, iterator->second.lruPosition);
+        return iterator->second.mesh;
+    }
+
+    // Stream in missing mesh in the background, parsed off this thread and uploaded behind a fence
+    if (streaming.insert(name).second)
+        meshLoader->loadAsync(name);
+    return fallback;
+}
+
+void ResidencyManager::prefetch(std::vector<std::string> const &names, uint64_t frame)
+{
+    // Load all missing meshes together so parsing runs in parallel and uploads share one submission
+    std::vector<std::string> missing;
+    for (std::string const &name : names)
+        if (residents.count(name) == 0 && streaming.count(name) == 0)
+            missing.push_back(name);
+    if (missing.empty())
+        return;
+
+    std::vector<Mesh *> meshes = meshLoader->load(missing);
+    for (size_t i=0; i<missing.size(); i++)
+        insert(missing[i], meshes[i], frame);
+}
+
+void ResidencyManager::collect(uint64_t frame)
+{
+    // Meshes arriving were last wanted while streaming, so count them as used now
+    for (auto &[name, mesh] : meshLoader->poll())
+    {
+        streaming.erase(name);
+        insert(name, mesh, frame);
+    }
+    evict(frame);
+}
+
+VkDeviceSize ResidencyManager::getResidentSize() const
+{
+    return residentSize;
+}
+
+VkDeviceSize ResidencyManager::getBudget() const
+{
+    return budget;
+}
+
+VkDeviceSize ResidencyManager::getDefaultBudget(PhysicalDevice const *physicalDevice)
+{
+    // Three quarters of the largest device-local heap, leaving room for attachments and other allocations
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice->getHandle(), &memoryProperties);
+    VkDeviceSize largestHeap = 0;
+    for (uint32_t i=0; i<memoryProperties.memoryHeapCount; i++)
+        if (memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+            largestHeap = std::max(largestHeap, memoryProperties.memoryHeaps[i].size);
+    return largestHeap / 4 * 3;
+}
+
+void ResidencyManager::insert(std::string const &name, Mesh *mesh, uint64_t frame)
+{
+    lru.push_front(name);
+    residents[name] = Resident{ mesh, frame, lru.begin() };
+    residentSize += mesh->getSize();
+    evict(frame);
+}
+
+void ResidencyManager::evict(uint64_t frame)
+{
+    // Free least recently used meshes that no frame in flight can still reference
+    for (auto position = lru.end(); residentSize > budget && position != lru.begin(); )
+    {
+        position--;
+        Resident &resident = residents[*position];
+        if (resident.lastUsedFrame + framesInFlight > frame)
+            continue;
+
+        residentSize -= resident.mesh->getSize();
+        delete resident.mesh;
+        residents.erase(*position);
+        position = lru.erase(position);
+    }
+}
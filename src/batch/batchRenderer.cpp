@@ -0,0 +1,274 @@
+
+#include "batch/batchRenderer.hpp"
+
+#include "configuration/device.hpp"
+#include "configuration/physicalDevice.hpp"
+#include "configuration/queue.hpp"
+#include "configuration/shaderModule.hpp"
+#include "command/commandPool.hpp"
+#include "memory/descriptorSetLayout.hpp"
+#include "memory/descriptorPool.hpp"
+#include "memory/descriptorSet.hpp"
+#include "swapchain/renderPass.hpp"
+#include "swapchain/pipeline.hpp"
+#include "mesh/mesh.hpp"
+#include "mesh/lodSelector.hpp"
+#include "utility/check.hpp"
+#include "utility/io.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+BatchRenderer::Slot::Slot(Device const *device, PhysicalDevice const *physicalDevice, CommandPool *commandPool, RenderPass const *renderPass, VkExtent2D const &atlasExtent, VkDeviceSize const &uniformSize, DescriptorSet &descriptorSet)
+  : device(device),
+    commandBuffer(commandPool->allocateNewBuffer()),
+    target(device, physicalDevice, FORMAT, atlasExtent, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT|VK_IMAGE_USAGE_TRANSFER_SRC_BIT, VK_IMAGE_ASPECT_COLOR_BIT),
+    depth(device, physicalDevice, renderPass->getDepthFormat(), atlasExtent, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT|VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT, VK_IMAGE_ASPECT_DEPTH_BIT),
+    uniformBuffer(device, physicalDevice, uniformSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT|VK_MEMORY_PROPERTY_HOST_COHERENT_BIT),
+    readbackBuffer(device, physicalDevice, atlasExtent.width*atlasExtent.height*4, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT|VK_MEMORY_PROPERTY_HOST_COHERENT_BIT),
+    descriptorSet(descriptorSet)
+{
+    // Link descriptor set and per-view uniforms, one UniformObject visible per dynamic offset
+    descriptorSet.bindToBuffer(device, uniformBuffer, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, sizeof(UniformObject));
+
+    // Keep readback memory mapped so results can be streamed out without remapping each batch
+    readbackData = static_cast<uint8_t const *>(readbackBuffer.map());
+
+    // Create framebuffer over atlas and its depth
+    VkImageView attachments[] = { target.getImageView(), depth.getImageView() };
+    VkFramebufferCreateInfo framebufferInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+        .renderPass = renderPass->getHandle(),
+        .attachmentCount = 2,
+        .pAttachments = attachments,
+        .width = atlasExtent.width,
+        .height = atlasExtent.height,
+        .layers = 1
+    };
+    check::fail( vkCreateFramebuffer(device->getHandle(), &framebufferInfo, nullptr, &framebuffer), "vkCreateFramebuffer failed." );
+
+    // Create fence, signalled once batch is rendered and copied back
+    VkFenceCreateInfo fenceInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO
+    };
+    check::fail( vkCreateFence(device->getHandle(), &fenceInfo, nullptr, &fence), "vkCreateFence failed." );
+}
+
+BatchRenderer::Slot::~Slot()
+{
+    readbackBuffer.unmap();
+    vkDestroyFence(device->getHandle(), fence, nullptr);
+    vkDestroyFramebuffer(device->getHandle(), framebuffer, nullptr);
+}
+
+BatchRenderer::BatchRenderer
+(
+    Device const *device, PhysicalDevice const *physicalDevice, CommandPool *commandPool,
+    Mesh const *mesh, VkExtent2D const &viewExtent, uint32_t viewsPerBatch, int nSlots
+) : device(device), mesh(mesh), viewExtent(viewExtent)
+{
+    // Lay tiles out in a near-square grid within the device's image size limit
+    uint32_t const maxDimension = physicalDevice->getProperties().limits.maxImageDimension2D;
+    check::zero(viewsPerBatch, "BatchRenderer needs at least one view per batch.");
+    columns = std::min( static_cast<uint32_t>(std::ceil(std::sqrt(viewsPerBatch))), maxDimension/viewExtent.width );
+    check::zero(columns, "BatchRenderer view wider than maximum image dimension.");
+    rows = (viewsPerBatch + columns - 1) / columns;
+    if (rows*viewExtent.height > maxDimension)
+        throw std::exception("BatchRenderer atlas exceeds maximum image dimension.");
+    atlasExtent = { columns*viewExtent.width, rows*viewExtent.height };
+
+    // Pad per-view uniforms to the device's dynamic offset alignment
+    VkDeviceSize const alignment = physicalDevice->getProperties().limits.minUniformBufferOffsetAlignment;
+    uniformStride = (sizeof(UniformObject) + alignment - 1) / alignment * alignment;
+    uniformStaging.resize(getViewsPerBatch() * uniformStride);
+    viewLods.resize(getViewsPerBatch());
+
+    // Create shared descriptor, render pass and pipeline state
+    descriptorSetLayout = new DescriptorSetLayout(device, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC);
+    descriptorPool = new DescriptorPool(device, nSlots, descriptorSetLayout, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC);
+    renderPass = new RenderPass(device, FORMAT, physicalDevice->findDepthFormat(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+    pipeline = new Pipeline(
+        device,
+        ShaderModule(device, io::readFile("shaders/bin/shader.vert.spv", std::ios::binary)),
+        ShaderModule(device, io::readFile("shaders/bin/shader.frag.spv", std::ios::binary)),
+        renderPass, viewExtent, { descriptorSetLayout }, mesh->getLayout().getVertexInput(), true, { DrawConstants::getRange() }
+    );
+
+    // Create in-flight slots
+    for (int i=0; i<nSlots; i++)
+        slots.push_back(new Slot(device, physicalDevice, commandPool, renderPass, atlasExtent, uniformStaging.size(), descriptorPool->getDescriptorSets()[i]));
+}
+
+BatchRenderer::~BatchRenderer()
+{
+    // Wait for outstanding batches
+    for (Slot *slot : slots)
+        if (slot->pending)
+            vkWaitForFences(device->getHandle(), 1, &slot->fence, VK_TRUE, UINT64_MAX);
+
+    for (Slot *slot : slots)
+        delete slot;
+    delete pipeline;
+    delete renderPass;
+    delete descriptorPool;
+    delete descriptorSetLayout;
+}
+
+uint32_t BatchRenderer::getViewsPerBatch() const
+{
+    return columns * rows;
+}
+
+VkExtent2D const &BatchRenderer::getAtlasExtent() const
+{
+    return atlasExtent;
+}
+
+void BatchRenderer::render(std::vector<UniformObject> const &views, ViewSink const &sink)
+{
+    // Round-robin batches over slots, streaming out each slot's previous batch before it is reused
+    size_t nextSlot = 0;
+    for (uint32_t firstView=0; firstView<views.size(); firstView+=getViewsPerBatch())
+    {
+        Slot *slot = slots[nextSlot];
+        nextSlot = (nextSlot+1) % slots.size();
+
+        if (slot->pending)
+            drain(slot, sink);
+
+        uint32_t nViews = std::min<uint32_t>(getViewsPerBatch(), views.size()-firstView);
+        submit(slot, views.data()+firstView, nViews, firstView);
+    }
+
+    // Stream out remaining batches in submission order
+    for (size_t i=0; i<slots.size(); i++)
+    {
+        Slot *slot = slots[(nextSlot+i) % slots.size()];
+        if (slot->pending)
+            drain(slot, sink);
+    }
+}
+
+void BatchRenderer::submit(Slot *slot, UniformObject const *views, uint32_t nViews, uint32_t firstView)
+{
+    // Pick each view's LOD and upload its uniforms, model matrices are pushed per draw instead
+    for (uint32_t i=0; i<nViews; i++)
+    {
+        viewLods[i] = LodSelector(views[i].proj, viewExtent).select(mesh, views[i].view * views[i].model);
+        std::memcpy(uniformStaging.data() + i*uniformStride, &views[i], sizeof(UniformObject));
+    }
+    slot->uniformBuffer.memcpy(nViews*uniformStride, uniformStaging.data());
+
+    // Record every view of the batch into one command buffer
+    glm::mat4 const dequantization = mesh->getDequantizationTransform();
+    uint32_t const usedRows = (nViews + columns - 1) / columns;
+    slot->commandBuffer.record([&](VkCommandBuffer const &commandBuffer)
+    {
+        renderPass->run(slot->framebuffer, atlasExtent, commandBuffer, [&]()
+        {
+            // Bind state shared by all views
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->getHandle());
+            mesh->bind(commandBuffer);
+
+            for (uint32_t i=0; i<nViews; i++)
+            {
+                // Restrict rasterisation to this view's tile
+                VkOffset2D tileOffset = getTileOffset(i);
+                VkViewport viewport
+                {
+                    .x = (float) tileOffset.x,
+                    .y = (float) tileOffset.y,
+                    .width = (float) viewExtent.width,
+                    .height = (float) viewExtent.height,
+                    .minDepth = 0.0f,
+                    .maxDepth = 1.0f
+                };
+                VkRect2D scissor
+                {
+                    .offset = tileOffset,
+                    .extent = viewExtent
+                };
+                vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+                vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+                // Select this view's uniforms, push its model matrix with the mesh's position dequantization folded in, and draw
+                uint32_t dynamicOffset = static_cast<uint32_t>(i*uniformStride);
+                vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->getLayout(), 0, 1, &slot->descriptorSet.getHandle(), 1, &dynamicOffset);
+                DrawConstants constants
+                {
+                    .model = views[i].model * dequantization,
+                    .objectId = firstView + i
+                };
+                vkCmdPushConstants(commandBuffer, pipeline->getLayout(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(DrawConstants), &constants);
+                MeshData::Lod const &lod = mesh->getLod(viewLods[i]);
+                vkCmdDrawIndexed(commandBuffer, lod.nIndices, 1, lod.firstIndex, 0, 0);
+            }
+        });
+
+        // Copy used rows of the atlas into readback memory
+        VkBufferImageCopy region
+        {
+            .bufferOffset = 0,
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource
+            {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .mipLevel = 0,
+                .baseArrayLayer = 0,
+                .layerCount = 1
+            },
+            .imageOffset = {0, 0, 0},
+            .imageExtent = { atlasExtent.width, usedRows*viewExtent.height, 1 }
+        };
+        vkCmdCopyImageToBuffer(commandBuffer, slot->target.getImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot->readbackBuffer.getHandle(), 1, &region);
+
+        // Make copied pixels visible to the host
+        VkBufferMemoryBarrier barrier
+        {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .buffer = slot->readbackBuffer.getHandle(),
+            .offset = 0,
+            .size = VK_WHOLE_SIZE
+        };
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+    }, true);
+
+    // Submit without waiting, completion is picked up when the slot is drained
+    vkResetFences(device->getHandle(), 1, &slot->fence);
+    device->getMainQueue().submit(device, slot->commandBuffer, slot->fence);
+    slot->firstView = firstView;
+    slot->nViews = nViews;
+    slot->pending = true;
+}
+
+void BatchRenderer::drain(Slot *slot, ViewSink const &sink)
+{
+    // Wait for batch to finish rendering and copying
+    vkWaitForFences(device->getHandle(), 1, &slot->fence, VK_TRUE, UINT64_MAX);
+
+    // Hand each tile to the sink in place
+    uint32_t const rowPitch = atlasExtent.width * 4;
+    for (uint32_t i=0; i<slot->nViews; i++)
+    {
+        VkOffset2D tileOffset = getTileOffset(i);
+        sink(slot->firstView + i, slot->readbackData + tileOffset.y*rowPitch + tileOffset.x*4, rowPitch);
+    }
+    slot->pending = false;
+}
+
+VkOffset2D BatchRenderer::getTileOffset(uint32_t tile) const
+{
+    return VkOffset2D
+    {
+        static_cast<int32_t>((tile % columns) * viewExtent.width),
+        static_cast<int32_t>((tile / columns) * viewExtent.height)
+    };
+}
@@ -0,0 +1,37 @@
+
+#include "bench/benchOptions.hpp"
+
+#include <exception>
+#include <sstream>
+
+BenchOptions::BenchOptions(int argc, char **argv)
+{
+    for (int i=1; i<argc; i++)
+    {
+        std::string name = argv[i];
+        if (!name.starts_with("--") || i+1 == argc)
+            throw std::exception("Expected --name value arguments.");
+        values[name.substr(2)] = argv[++i];
+    }
+}
+
+std::string BenchOptions::get(std::string const &name, std::string const &fallback) const
+{
+    auto it = values.find(name);
+    return it == values.end() ? fallback : it->second;
+}
+
+double BenchOptions::getNumber(std::string const &name, double fallback) const
+{
+    auto it = values.find(name);
+    return it == values.end() ? fallback : std::stod(it->second);
+}
+
+std::vector<std::string> BenchOptions::getList(std::string const &name, std::string const &fallback) const
+{
+    std::vector<std::string> list;
+    std::stringstream stream(get(name, fallback));
+    for (std::string item; std::getline(stream, item, ',');)
+        list.push_back(item);
+    return list;
+}
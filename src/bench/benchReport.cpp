@@ -0,0 +1,97 @@
+
+#include "bench/benchReport.hpp"
+
+#include "utility/io.hpp"
+#include "utility/json.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+void benchReport::writeCsv(std::ostream &stream, std::vector<Result> const &results)
+{
+    // Columns follow the first result, every scenario reports the same metrics
+    stream << "scenario";
+    if (!results.empty())
+        for (Metric const &metric : results[0].metrics)
+            stream << "," << metric.name;
+    stream << "\n" << std::fixed << std::setprecision(4);
+    for (Result const &result : results)
+    {
+        stream << result.scenario;
+        for (Metric const &metric : result.metrics)
+            stream << "," << metric.value;
+        stream << "\n";
+    }
+}
+
+void benchReport::writeJson(std::ostream &stream, std::vector<Result> const &results)
+{
+    stream << "{\n  \"results\": [" << std::fixed << std::setprecision(4);
+    for (size_t i=0; i<results.size(); i++)
+    {
+        stream << (i == 0 ? "\n" : ",\n") << "    { \"scenario\": " << json::quote(results[i].scenario) << ", \"metrics\": {";
+        for (size_t j=0; j<results[i].metrics.size(); j++)
+            stream << (j == 0 ? " " : ", ") << json::quote(results[i].metrics[j].name) << ": " << results[i].metrics[j].value;
+        stream << " } }";
+    }
+    stream << "\n  ]\n}\n";
+}
+
+void benchReport::write(std::string const &filename, std::vector<Result> const &results)
+{
+    std::ofstream file(filename);
+    if (!file)
+        throw std::exception("Failed to open benchmark report for writing.");
+    if (filename.ends_with(".csv"))
+        writeCsv(file, results);
+    else
+        writeJson(file, results);
+}
+
+std::vector<benchReport::Result> benchReport::readJson(std::string const &filename)
+{
+    std::vector<char> data = io::readFile(filename, std::ios::binary);
+    json::Value const document = json::parse(data.data(), data.size());
+    std::vector<Result> results;
+    for (size_t i=0; i<document["results"].size(); i++)
+    {
+        json::Value const &entry = document["results"][i];
+        Result result { .scenario = entry["scenario"].string };
+        for (auto const &[name, value] : entry["metrics"].object)
+            result.metrics.push_back(Metric{ .name = name, .value = value.asNumber() });
+        results.push_back(result);
+    }
+    return results;
+}
+
+std::vector<std::string> benchReport::compare(std::vector<Result> const &results, std::vector<Result> const &baseline, double threshold)
+{
+    std::vector<std::string> regressions;
+    for (Result const &result : results)
+    {
+        // Scenarios new since the baseline have nothing to regress against
+        auto base = std::find_if(baseline.begin(), baseline.end(), [&](Result const &other) { return other.scenario == result.scenario; });
+        if (base == baseline.end())
+            continue;
+
+        for (Metric const &metric : result.metrics)
+        {
+            auto baseMetric = std::find_if(base->metrics.begin(), base->metrics.end(), [&](Metric const &other) { return other.name == metric.name; });
+            if (metric.direction == Informational || baseMetric == base->metrics.end() || baseMetric->value <= 0.0)
+                continue;
+
+            double const change = (metric.value - baseMetric->value) / baseMetric->value;
+            bool const regressed = metric.direction == LowerIsBetter ? change > threshold : -change > threshold;
+            if (!regressed)
+                continue;
+            std::ostringstream message;
+            message << std::fixed << std::setprecision(3) << result.scenario << " " << metric.name << ": " << metric.value
+                    << " against baseline " << baseMetric->value << " (" << std::showpos << 100.0*change << "%)";
+            regressions.push_back(message.str());
+        }
+    }
+    return regressions;
+}
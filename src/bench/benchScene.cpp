@@ -0,0 +1,116 @@
+
+#include "bench/benchScene.hpp"
+
+#define GLM_FORCE_RADIANS
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+#include <exception>
+#include <random>
+
+namespace
+{
+    float constexpr SPACING = 1.5f;
+
+    uint32_t getGridSide(uint32_t nObjects)
+    {
+        uint32_t side = 1;
+        while (side*side*side < nObjects)
+            side++;
+        return side;
+    }
+
+    /** Uniform in [0, 1), derived from mt19937's output directly as library distributions differ between platforms */
+    float nextUnit(std::mt19937 &random)
+    {
+        return static_cast<float>(random() / 4294967296.0);
+    }
+}
+
+std::string benchScene::Scenario::getName() const
+{
+    return "o" + std::to_string(nObjects) + "_v" + std::to_string(nVertices) + "_f" + std::to_string(framesInFlight) + "_" + benchScene::getName(presentMode);
+}
+
+benchScene::PresentMode benchScene::parsePresentMode(std::string const &name)
+{
+    if (name == "immediate") return Immediate;
+    if (name == "fifo") return Fifo;
+    throw std::exception("Unknown present mode, expected immediate or fifo.");
+}
+
+char const *benchScene::getName(PresentMode presentMode)
+{
+    return presentMode == Fifo ? "fifo" : "immediate";
+}
+
+MeshData benchScene::makeSphere(uint32_t nVertices)
+{
+    // Smallest UV sphere, twice as many segments as rings, with enough vertices
+    uint32_t rings = 2;
+    while ((rings+1) * (2*rings+1) < nVertices)
+        rings++;
+    uint32_t const segments = 2*rings;
+
+    MeshData meshData;
+    for (uint32_t ring=0; ring<=rings; ring++)
+        for (uint32_t segment=0; segment<=segments; segment++)
+        {
+            float theta = glm::pi<float>() * ring / rings, phi = 2.0f * glm::pi<float>() * segment / segments;
+            glm::vec3 normal(std::sin(theta)*std::cos(phi), std::sin(theta)*std::sin(phi), std::cos(theta));
+            meshData.vertices.emplace_back(normal * 0.5f, normal*0.5f + glm::vec3(0.5f), normal);
+        }
+    for (uint32_t ring=0; ring<rings; ring++)
+        for (uint32_t segment=0; segment<segments; segment++)
+        {
+            uint32_t corner = ring*(segments+1) + segment;
+            meshData.indices.insert(meshData.indices.end(), { corner, corner+segments+1, corner+1, corner+1, corner+segments+1, corner+segments+2 });
+        }
+    return meshData;
+}
+
+std::vector<glm::mat4> benchScene::layoutObjects(uint32_t nObjects)
+{
+    uint32_t const side = getGridSide(nObjects);
+    float const offset = (side-1) * SPACING * 0.5f;
+    std::vector<glm::mat4> models;
+    models.reserve(nObjects);
+    for (uint32_t i=0; i<nObjects; i++)
+    {
+        glm::vec3 position(i % side, (i / side) % side, i / (side*side));
+        models.push_back(glm::translate(glm::mat4(1.0f), position*SPACING - glm::vec3(offset)));
+    }
+    return models;
+}
+
+float benchScene::getSceneRadius(uint32_t nObjects)
+{
+    return std::sqrt(3.0f) * (getGridSide(nObjects)-1) * SPACING * 0.5f + 0.5f;
+}
+
+benchScene::CameraPath::CameraPath(uint32_t seed, float distance, uint32_t nWaypoints, uint32_t framesPerWaypoint) : framesPerWaypoint(framesPerWaypoint)
+{
+    // Directions kept away from the poles so the up vector stays valid
+    std::mt19937 random(seed);
+    for (uint32_t i=0; i<nWaypoints; i++)
+    {
+        float z = 1.6f*nextUnit(random) - 0.8f, phi = 2.0f * glm::pi<float>() * nextUnit(random);
+        float scale = distance * (0.8f + 0.4f*nextUnit(random));
+        float ring = std::sqrt(1.0f - z*z);
+        waypoints.push_back(glm::vec3(ring*std::cos(phi), ring*std::sin(phi), z) * scale);
+    }
+}
+
+glm::mat4 benchScene::CameraPath::getView(uint32_t frame) const
+{
+    // Ease between consecutive waypoints, wrapping back to the first, and keep the interpolated distance so the path never cuts through the scene
+    uint32_t const segment = (frame / framesPerWaypoint) % waypoints.size();
+    float t = static_cast<float>(frame % framesPerWaypoint) / framesPerWaypoint;
+    t = t*t*(3.0f - 2.0f*t);
+    glm::vec3 const &from = waypoints[segment], &to = waypoints[(segment+1) % waypoints.size()];
+    glm::vec3 eye = from*(1.0f - t) + to*t;
+    float const length = glm::length(eye);
+    if (length > 1e-3f)
+        eye = eye * ((glm::length(from)*(1.0f - t) + glm::length(to)*t) / length);
+    return glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+}
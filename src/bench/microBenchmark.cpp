@@ -0,0 +1,60 @@
+
+#include "bench/microBenchmark.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+#include <vector>
+
+namespace
+{
+    double timeBatch(microBenchmark::Body const &body, uint64_t iterations)
+    {
+        auto start = std::chrono::steady_clock::now();
+        body(iterations);
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+microBenchmark::Measurement microBenchmark::run(std::string const &name, Body const &body, Settings const &settings, uint64_t bytesPerIteration)
+{
+    // Grow the batch until it fills the budget, which also warms caches and lazily created state
+    uint64_t iterations = 1;
+    for (double seconds = timeBatch(body, iterations); seconds < settings.minBatchSeconds; seconds = timeBatch(body, iterations))
+    {
+        double const scale = seconds > 0.0 ? std::min(10.0, 1.5 * settings.minBatchSeconds / seconds) : 10.0;
+        iterations = std::max(iterations + 1, static_cast<uint64_t>(iterations * scale));
+    }
+
+    // Time repeated batches, the median resisting interference and the minimum approaching the true cost
+    std::vector<double> samples;
+    for (uint32_t i=0; i<std::max(settings.repetitions, 1u); i++)
+        samples.push_back(timeBatch(body, iterations) * 1e9 / iterations);
+    std::sort(samples.begin(), samples.end());
+    double const median = samples[samples.size()/2];
+    return Measurement
+    {
+        .name = name,
+        .iterations = iterations,
+        .minNs = samples.front(),
+        .medianNs = median,
+        .meanNs = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size(),
+        .bytesPerSecond = bytesPerIteration * 1e9 / median
+    };
+}
+
+benchReport::Result microBenchmark::toResult(Measurement const &measurement)
+{
+    return benchReport::Result
+    {
+        .scenario = measurement.name,
+        .metrics
+        {
+            { "iterations", static_cast<double>(measurement.iterations) },
+            { "median_ns", measurement.medianNs, benchReport::LowerIsBetter },
+            { "min_ns", measurement.minNs },
+            { "mean_ns", measurement.meanNs },
+            { "bytes_per_second", measurement.bytesPerSecond }
+        }
+    };
+}
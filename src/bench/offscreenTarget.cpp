@@ -0,0 +1,46 @@
+
+#include "bench/offscreenTarget.hpp"
+
+#include "configuration/device.hpp"
+#include "swapchain/renderPass.hpp"
+#include "utility/check.hpp"
+
+OffscreenTarget::OffscreenTarget(Device const *device, PhysicalDevice const *physicalDevice, RenderPass const *renderPass, VkExtent2D const &extent)
+  : device(device),
+    colour(device, physicalDevice, FORMAT, extent, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT|VK_IMAGE_USAGE_TRANSFER_SRC_BIT, VK_IMAGE_ASPECT_COLOR_BIT),
+    depth(device, physicalDevice, renderPass->getDepthFormat(), extent, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT|VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT, VK_IMAGE_ASPECT_DEPTH_BIT)
+{
+    // Create framebuffer over both attachments
+    VkImageView attachments[] = { colour.getImageView(), depth.getImageView() };
+    VkFramebufferCreateInfo framebufferInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+        .renderPass = renderPass->getHandle(),
+        .attachmentCount = 2,
+        .pAttachments = attachments,
+        .width = extent.width,
+        .height = extent.height,
+        .layers = 1
+    };
+    check::fail( vkCreateFramebuffer(device->getHandle(), &framebufferInfo, nullptr, &framebuffer), "vkCreateFramebuffer failed." );
+}
+
+OffscreenTarget::~OffscreenTarget()
+{
+    vkDestroyFramebuffer(device->getHandle(), framebuffer, nullptr);
+}
+
+Attachment const &OffscreenTarget::getColour() const
+{
+    return colour;
+}
+
+VkFramebuffer const &OffscreenTarget::getFramebuffer() const
+{
+    return framebuffer;
+}
+
+VkExtent2D const &OffscreenTarget::getExtent() const
+{
+    return colour.getExtent();
+}
@@ -0,0 +1,132 @@
+
+#include "bench/virtualTextureCheck.hpp"
+
+#include "bench/offscreenTarget.hpp"
+#include "configuration/device.hpp"
+#include "configuration/physicalDevice.hpp"
+#include "configuration/queue.hpp"
+#include "configuration/shaderModule.hpp"
+#include "frame/frame.hpp"
+#include "memory/descriptorAllocator.hpp"
+#include "swapchain/pipeline.hpp"
+#include "swapchain/renderPass.hpp"
+#include "texture/pageFile.hpp"
+#include "texture/samplerCache.hpp"
+#include "texture/virtualTexture.hpp"
+#include "utility/io.hpp"
+
+#include <glm/glm.hpp>
+
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    int constexpr FRAMES_IN_FLIGHT = 2;
+    float constexpr SCROLL_PER_FRAME = 0.005f;
+}
+
+std::string virtualTextureCheck::writeDefaultTexture(uint32_t size)
+{
+    // Checkerboard fine enough for every level to differ, under a gradient telling pages apart
+    std::vector<uint8_t> texels(static_cast<size_t>(size) * size * 4);
+    for (uint32_t y=0; y<size; y++)
+        for (uint32_t x=0; x<size; x++)
+        {
+            uint8_t const checker = ((x / 16 + y / 16) & 1) ? 255 : 64;
+            uint8_t *texel = &texels[(static_cast<size_t>(y) * size + x) * 4];
+            texel[0] = static_cast<uint8_t>(checker * x / size);
+            texel[1] = static_cast<uint8_t>(checker * y / size);
+            texel[2] = checker;
+            texel[3] = 255;
+        }
+
+    std::string const filename = (std::filesystem::temp_directory_path() / "helloVulkanBench.vtex").string();
+    pageFile::write(filename, texels, size);
+    return filename;
+}
+
+benchReport::Result virtualTextureCheck::run(Device const *device, PhysicalDevice const *physicalDevice, CommandPool *commandPool, Settings const &settings, bool &passed)
+{
+    SamplerCache samplerCache(device);
+    VirtualTexture virtualTexture(device, physicalDevice, &samplerCache, settings.filename, nullptr, settings.cachePagesWide, FRAMES_IN_FLIGHT);
+
+    // Feedback renders the plane at a fraction of the resolution it is sampled at, both passes taking the texture's set and a scroll offset
+    VkExtent2D const feedbackExtent = VirtualTexture::getFeedbackExtent(settings.extent);
+    RenderPass renderPass(device, OffscreenTarget::FORMAT, physicalDevice->findDepthFormat(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+    VkPushConstantRange const scrollRange{ .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT, .offset = 0, .size = sizeof(glm::vec2) };
+    ShaderModule const vertShaderModule(device, io::readFile("shaders/bin/vtPlane.vert.spv", std::ios::binary));
+    Pipeline feedbackPipeline(
+        device, vertShaderModule, ShaderModule(device, io::readFile("shaders/bin/vtPlaneFeedback.frag.spv", std::ios::binary)),
+        &renderPass, feedbackExtent, { virtualTexture.getLayout() }, vertexInput::State{}, false, { scrollRange }
+    );
+    Pipeline samplePipeline(
+        device, vertShaderModule, ShaderModule(device, io::readFile("shaders/bin/vtPlane.frag.spv", std::ios::binary)),
+        &renderPass, settings.extent, { virtualTexture.getLayout() }, vertexInput::State{}, false, { scrollRange }
+    );
+
+    // Frames in flight, each with its own targets
+    std::vector<Frame> frames;
+    std::vector<std::unique_ptr<OffscreenTarget>> feedbackTargets, sampleTargets;
+    for (int i=0; i<FRAMES_IN_FLIGHT; i++)
+    {
+        frames.push_back(Frame(device, commandPool, physicalDevice, nullptr, nullptr));
+        feedbackTargets.push_back(std::make_unique<OffscreenTarget>(device, physicalDevice, &renderPass, feedbackExtent));
+        sampleTargets.push_back(std::make_unique<OffscreenTarget>(device, physicalDevice, &renderPass, settings.extent));
+    }
+
+    auto draw = [&](Pipeline const &pipeline, DescriptorSet const *set, glm::vec2 const &scroll, VkCommandBuffer const &commandBuffer)
+    {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.getHandle());
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.getLayout(), 0, 1, &set->getHandle(), 0, nullptr);
+        vkCmdPushConstants(commandBuffer, pipeline.getLayout(), VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(glm::vec2), &scroll);
+        vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+    };
+
+    for (uint32_t frameIndex=0; frameIndex<settings.frames; frameIndex++)
+    {
+        Frame &frame = frames[frameIndex % FRAMES_IN_FLIGHT];
+        frame.waitForReady(device);
+
+        // Feedback this frame's buffers collected last time round is complete once its fence has signalled
+        virtualTexture.update(frameIndex);
+        DescriptorSet const *set = frame.getTransientDescriptors().get(virtualTexture.getLayout(), virtualTexture.getBindings());
+        glm::vec2 const scroll(0.0f, frameIndex * SCROLL_PER_FRAME);
+
+        // Upload, request pages at low resolution and hand the requests to the host, then sample what is resident
+        frame.getCommandBuffer().record([&](VkCommandBuffer const &commandBuffer)
+        {
+            virtualTexture.recordUploads(commandBuffer);
+            renderPass.run(feedbackTargets[frameIndex % FRAMES_IN_FLIGHT]->getFramebuffer(), feedbackExtent, commandBuffer, [&]()
+            {
+                draw(feedbackPipeline, set, scroll, commandBuffer);
+            });
+            virtualTexture.recordFeedbackBarrier(commandBuffer);
+            renderPass.run(sampleTargets[frameIndex % FRAMES_IN_FLIGHT]->getFramebuffer(), settings.extent, commandBuffer, [&]()
+            {
+                draw(samplePipeline, set, scroll, commandBuffer);
+            });
+        });
+        vkResetFences(device->getHandle(), 1, &frame.getInFlightFence());
+        device->getMainQueue().submit(device, frame.getCommandBuffer(), frame.getInFlightFence());
+    }
+    vkDeviceWaitIdle(device->getHandle());
+
+    // The coarsest page is queued without feedback, so anything requested came back from the GPU
+    VirtualTexture::Statistics const &statistics = virtualTexture.getStatistics();
+    passed = statistics.requests > 0 && statistics.uploads > 1;
+    return benchReport::Result
+    {
+        .scenario = "virtual_texture",
+        .metrics
+        {
+            { "frames", static_cast<double>(settings.frames) },
+            { "feedback_pixels", static_cast<double>(feedbackExtent.width * feedbackExtent.height) },
+            { "resident_pages", static_cast<double>(statistics.residentPages) },
+            { "requests", static_cast<double>(statistics.requests) },
+            { "uploads", static_cast<double>(statistics.uploads) },
+            { "evictions", static_cast<double>(statistics.evictions) }
+        }
+    };
+}
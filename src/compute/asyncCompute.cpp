@@ -0,0 +1,60 @@
+
+#include "compute/asyncCompute.hpp"
+
+#include "configuration/device.hpp"
+#include "configuration/physicalDevice.hpp"
+#include "configuration/queue.hpp"
+#include "command/commandPool.hpp"
+#include "profiling/cpuTrace.hpp"
+#include "utility/check.hpp"
+
+AsyncCompute::AsyncCompute(Device const *device, PhysicalDevice const *physicalDevice, int nFrames) : device(device), physicalDevice(physicalDevice)
+{
+    // Command buffers must come from a pool of the family they are submitted to
+    commandPool = new CommandPool(device, physicalDevice->getComputeQueueFamilyIndex(), nFrames);
+
+    // One command buffer and semaphore per frame in flight, reused once the frame's fence says graphics is done with them
+    VkSemaphoreCreateInfo semaphoreInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO
+    };
+    commandBuffers.reserve(nFrames);
+    finishedSemaphores.resize(nFrames);
+    for (int i=0; i<nFrames; i++)
+    {
+        commandBuffers.push_back(commandPool->allocateNewBuffer());
+        check::fail( vkCreateSemaphore(device->getHandle(), &semaphoreInfo, nullptr, &finishedSemaphores[i]), "vkCreateSemaphore failed." );
+    }
+}
+
+AsyncCompute::~AsyncCompute()
+{
+    for (VkSemaphore const &semaphore : finishedSemaphores)
+        vkDestroySemaphore(device->getHandle(), semaphore, nullptr);
+    commandBuffers.clear();
+    delete commandPool;
+}
+
+uint32_t AsyncCompute::getFrameCount() const
+{
+    return static_cast<uint32_t>(commandBuffers.size());
+}
+
+std::vector<uint32_t> AsyncCompute::getQueueFamilies() const
+{
+    if (!physicalDevice->hasAsyncCompute())
+        return { physicalDevice->getMainQueueFamilyIndex() };
+    return { physicalDevice->getMainQueueFamilyIndex(), physicalDevice->getComputeQueueFamilyIndex() };
+}
+
+VkSemaphore AsyncCompute::submit(uint64_t frameIndex, std::function<void(VkCommandBuffer const &commandBuffer)> commands)
+{
+    TRACE_ZONE("AsyncCompute::submit");
+    CommandBuffer &commandBuffer = commandBuffers[frameIndex % commandBuffers.size()];
+    VkSemaphore const &finishedSemaphore = finishedSemaphores[frameIndex % finishedSemaphores.size()];
+
+    // Without a compute-only family this lands on the main queue ahead of the frame, still correct but serialized
+    commandBuffer.record(commands, true);
+    device->getComputeQueue().submit(device, commandBuffer, finishedSemaphore);
+    return finishedSemaphore;
+}
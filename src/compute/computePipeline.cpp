@@ -0,0 +1,63 @@
+
+#include "compute/computePipeline.hpp"
+
+#include "configuration/device.hpp"
+#include "configuration/shaderModule.hpp"
+#include "memory/descriptorSetLayout.hpp"
+#include "utility/check.hpp"
+#include "profiling/counters.hpp"
+
+ComputePipeline::ComputePipeline(Device const *device, ShaderModule const &shaderModule, std::vector<DescriptorSetLayout const *> const &descriptorSetLayouts, std::vector<VkPushConstantRange> const &pushConstantRanges) : device(device)
+{
+    // Create pipeline layout, one descriptor set per layout in order
+    std::vector<VkDescriptorSetLayout> setLayouts;
+    for (DescriptorSetLayout const *descriptorSetLayout : descriptorSetLayouts)
+        setLayouts.push_back(descriptorSetLayout->getHandle());
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount = static_cast<uint32_t>(setLayouts.size()),
+        .pSetLayouts = setLayouts.data(),
+        .pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size()),
+        .pPushConstantRanges = pushConstantRanges.data()
+    };
+    check::fail( vkCreatePipelineLayout(device->getHandle(), &pipelineLayoutInfo, nullptr, &pipelineLayout), "vkCreatePipelineLayout failed." );
+
+    // Create pipeline, a single compute stage with no fixed-function state
+    VkComputePipelineCreateInfo pipelineInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .stage = VkPipelineShaderStageCreateInfo
+        {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+            .module = shaderModule.getHandle(),
+            .pName = "main"
+        },
+        .layout = pipelineLayout,
+        .basePipelineHandle = VK_NULL_HANDLE
+    };
+    check::fail( vkCreateComputePipelines(device->getHandle(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &handle), "vkCreateComputePipelines failed." );
+    counters::add(counters::PipelineCreations);
+}
+
+ComputePipeline::~ComputePipeline()
+{
+    vkDestroyPipeline(device->getHandle(), handle, nullptr);
+    vkDestroyPipelineLayout(device->getHandle(), pipelineLayout, nullptr);
+}
+
+VkPipeline const &ComputePipeline::getHandle() const
+{
+    return handle;
+}
+
+VkPipelineLayout const &ComputePipeline::getLayout() const
+{
+    return pipelineLayout;
+}
+
+uint32_t ComputePipeline::getGroupCount(uint32_t count, uint32_t groupSize)
+{
+    return (count + groupSize - 1) / groupSize;
+}
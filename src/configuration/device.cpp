@@ -5,9 +5,12 @@
 #include "configuration/queue.hpp"
 #include "utility/check.hpp"
 
+#include <algorithm>
+#include <string>
+
 Device::Device(PhysicalDevice const *physicalDevice, std::vector<const char*> const &validationLayers, std::vector<const char*> const &extensions)
 {
-    // Create array of queues (just main queue for now)
+    // Create array of queues, the main queue and a compute queue when the device has a compute-only family
     float const queuePriority = 1.0f;
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos
     {
@@ -19,12 +22,59 @@ Device::Device(PhysicalDevice const *physicalDevice, std::vector<const char*> co
             .pQueuePriorities = &queuePriority
         }
     };
+    if (physicalDevice->hasAsyncCompute())
+        queueCreateInfos.push_back(VkDeviceQueueCreateInfo
+        {
+            .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+            .queueFamilyIndex = physicalDevice->getComputeQueueFamilyIndex(),
+            .queueCount = 1,
+            .pQueuePriorities = &queuePriority
+        });
 
-    // Create logical device
+    // Enable the descriptor indexing features bindless tables rely on when their extension is requested
+    auto requested = [&](char const *name)
+    {
+        return std::any_of(extensions.begin(), extensions.end(), [&](char const *extension) { return std::string(extension) == name; });
+    };
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptorIndexingFeatures
+    {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT,
+        .shaderSampledImageArrayNonUniformIndexing = VK_TRUE,
+        .shaderStorageBufferArrayNonUniformIndexing = VK_TRUE,
+        .descriptorBindingSampledImageUpdateAfterBind = VK_TRUE,
+        .descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE,
+        .descriptorBindingUpdateUnusedWhilePending = VK_TRUE,
+        .descriptorBindingPartiallyBound = VK_TRUE,
+        .runtimeDescriptorArray = VK_TRUE
+    };
+
+    // Enable fragment shader stores where available, virtual texture feedback needs them, and the queries pipeline statistics rely on
+    VkPhysicalDeviceFeatures supportedFeatures;
+    vkGetPhysicalDeviceFeatures(physicalDevice->getHandle(), &supportedFeatures);
     VkPhysicalDeviceFeatures deviceFeatures{};
+    deviceFeatures.fragmentStoresAndAtomics = supportedFeatures.fragmentStoresAndAtomics;
+    deviceFeatures.pipelineStatisticsQuery = supportedFeatures.pipelineStatisticsQuery;
+    deviceFeatures.occlusionQueryPrecise = supportedFeatures.occlusionQueryPrecise;
+
+    // Enable dynamic rendering and synchronization2 wherever 1.3 offers them, chained after descriptor indexing
+    VkPhysicalDeviceVulkan13Features vulkan13Features
+    {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
+        .synchronization2 = VK_TRUE,
+        .dynamicRendering = VK_TRUE
+    };
+    void *features = physicalDevice->supportsDynamicRendering() ? &vulkan13Features : nullptr;
+    if (requested(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME))
+    {
+        descriptorIndexingFeatures.pNext = features;
+        features = &descriptorIndexingFeatures;
+    }
+
+    // Create logical device
     VkDeviceCreateInfo createInfo
     {
         .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+        .pNext = features,
         .queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size()),
         .pQueueCreateInfos = queueCreateInfos.data(),
         .enabledLayerCount = static_cast<uint32_t>(validationLayers.size()),
@@ -37,6 +87,19 @@ Device::Device(PhysicalDevice const *physicalDevice, std::vector<const char*> co
 
     // Get generated queues
     vkGetDeviceQueue(handle, physicalDevice->getMainQueueFamilyIndex(), 0, &mainQueue);
+    vkGetDeviceQueue(handle, physicalDevice->getComputeQueueFamilyIndex(), 0, &computeQueue);
+
+    // Load push descriptor entry point if it was enabled
+    if (requested(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME))
+        cmdPushDescriptorSet = reinterpret_cast<PFN_vkCmdPushDescriptorSetKHR>(vkGetDeviceProcAddr(handle, "vkCmdPushDescriptorSetKHR"));
+
+    // Load core 1.3 rendering entry points if they were enabled
+    if (physicalDevice->supportsDynamicRendering())
+    {
+        cmdBeginRendering = reinterpret_cast<PFN_vkCmdBeginRendering>(vkGetDeviceProcAddr(handle, "vkCmdBeginRendering"));
+        cmdEndRendering = reinterpret_cast<PFN_vkCmdEndRendering>(vkGetDeviceProcAddr(handle, "vkCmdEndRendering"));
+        cmdPipelineBarrier2 = reinterpret_cast<PFN_vkCmdPipelineBarrier2>(vkGetDeviceProcAddr(handle, "vkCmdPipelineBarrier2"));
+    }
 }
 
 Device::~Device()
@@ -49,7 +112,37 @@ VkDevice const &Device::getHandle() const
     return handle;
 }
 
-Queue Device::getMainQueue()
+Queue Device::getMainQueue() const
 {
     return Queue(mainQueue);
 }
+
+Queue Device::getComputeQueue() const
+{
+    return Queue(computeQueue);
+}
+
+PFN_vkCmdPushDescriptorSetKHR Device::getCmdPushDescriptorSet() const
+{
+    return cmdPushDescriptorSet;
+}
+
+bool Device::supportsDynamicRendering() const
+{
+    return cmdBeginRendering != nullptr && cmdEndRendering != nullptr && cmdPipelineBarrier2 != nullptr;
+}
+
+PFN_vkCmdBeginRendering Device::getCmdBeginRendering() const
+{
+    return cmdBeginRendering;
+}
+
+PFN_vkCmdEndRendering Device::getCmdEndRendering() const
+{
+    return cmdEndRendering;
+}
+
+PFN_vkCmdPipelineBarrier2 Device::getCmdPipelineBarrier2() const
+{
+    return cmdPipelineBarrier2;
+}
@@ -3,6 +3,7 @@
 
 #include "utility/check.hpp"
 
+#include <algorithm>
 #include <set>
 #include <string>
 
@@ -12,6 +13,12 @@ Instance::Instance(char const *appName, std::vector<const char *> const &validat
     if (!checkValidationLayerSupport(validationLayers))
         throw std::exception("Validation layers not supported.");
 
+    // Request up to 1.3 for dynamic rendering, 1.0 loaders lacking vkEnumerateInstanceVersion
+    apiVersion = VK_API_VERSION_1_0;
+    auto enumerateInstanceVersion = reinterpret_cast<PFN_vkEnumerateInstanceVersion>(vkGetInstanceProcAddr(nullptr, "vkEnumerateInstanceVersion"));
+    if (enumerateInstanceVersion != nullptr && enumerateInstanceVersion(&apiVersion) == VK_SUCCESS)
+        apiVersion = std::min<uint32_t>(apiVersion, VK_API_VERSION_1_3);
+
     // Generate create info
     VkApplicationInfo appInfo
     {
@@ -20,7 +27,7 @@ Instance::Instance(char const *appName, std::vector<const char *> const &validat
         .applicationVersion = VK_MAKE_VERSION(1, 0, 0),
         .pEngineName = "No Engine",
         .engineVersion = VK_MAKE_VERSION(1, 0, 0),
-        .apiVersion = VK_API_VERSION_1_0
+        .apiVersion = apiVersion
     };
     std::vector<const char *> extensions = getRequiredExtensions();
     VkInstanceCreateInfo instanceCreateInfo
@@ -48,6 +55,11 @@ VkInstance const &Instance::getHandle() const
     return handle;
 }
 
+uint32_t Instance::getApiVersion() const
+{
+    return apiVersion;
+}
+
 bool Instance::checkValidationLayerSupport(std::vector<const char *> const &validationLayers)
 {
     // Get available layers
@@ -80,5 +92,14 @@ std::vector<char const *> Instance::getRequiredExtensions()
     // Add debug extension
     extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
 
+    // Add physical device properties 2 where available, optional device extensions such as push descriptors need it on Vulkan 1.0
+    uint32_t nAvailableExtensions;
+    vkEnumerateInstanceExtensionProperties(nullptr, &nAvailableExtensions, nullptr);
+    std::vector<VkExtensionProperties> availableExtensions(nAvailableExtensions);
+    vkEnumerateInstanceExtensionProperties(nullptr, &nAvailableExtensions, availableExtensions.data());
+    for (VkExtensionProperties const &availableExtension : availableExtensions)
+        if (std::string(availableExtension.extensionName) == VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME)
+            extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+
     return extensions;
 }
@@ -25,13 +25,17 @@ PhysicalDevice::PhysicalDevice(Instance const *instance, Surface const *surface,
             // Set handle
             handle = physicalDeviceHandle;
 
-            // Cache main queue family index
+            // Cache main and compute queue family indices
             mainQueueFamilyIndex = calcMainQueueFamilyIndex(handle, surface);
+            computeQueueFamilyIndex = calcComputeQueueFamilyIndex(handle, mainQueueFamilyIndex);
 
-            // Display device name
-            VkPhysicalDeviceProperties physicalDeviceProperties;
-            vkGetPhysicalDeviceProperties(handle, &physicalDeviceProperties);
-            std::cout << "Selected device: " << physicalDeviceProperties.deviceName << std::endl;
+            // Cache properties and display device name
+            vkGetPhysicalDeviceProperties(handle, &properties);
+            std::cout << "Selected device: " << properties.deviceName << std::endl;
+
+            // Cache optional descriptor indexing and dynamic rendering support
+            queryDescriptorIndexing(instance);
+            queryDynamicRendering(instance);
             return;
         }
     }
@@ -50,6 +54,94 @@ uint32_t PhysicalDevice::getMainQueueFamilyIndex() const
     return mainQueueFamilyIndex;
 }
 
+uint32_t PhysicalDevice::getComputeQueueFamilyIndex() const
+{
+    return computeQueueFamilyIndex;
+}
+
+bool PhysicalDevice::hasAsyncCompute() const
+{
+    return computeQueueFamilyIndex != mainQueueFamilyIndex;
+}
+
+VkPhysicalDeviceProperties const &PhysicalDevice::getProperties() const
+{
+    return properties;
+}
+
+VkPhysicalDeviceDescriptorIndexingPropertiesEXT const &PhysicalDevice::getDescriptorIndexingProperties() const
+{
+    return descriptorIndexingProperties;
+}
+
+bool PhysicalDevice::supportsBindless() const
+{
+    return descriptorIndexingFeatures.runtimeDescriptorArray
+        && descriptorIndexingFeatures.descriptorBindingPartiallyBound
+        && descriptorIndexingFeatures.descriptorBindingUpdateUnusedWhilePending
+        && descriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind
+        && descriptorIndexingFeatures.descriptorBindingStorageBufferUpdateAfterBind
+        && descriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing
+        && descriptorIndexingFeatures.shaderStorageBufferArrayNonUniformIndexing;
+}
+
+bool PhysicalDevice::supportsDynamicRendering() const
+{
+    return dynamicRendering;
+}
+
+uint32_t PhysicalDevice::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
+{
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(handle, &memoryProperties);
+
+    for (int i=0; i<memoryProperties.memoryTypeCount; i++)
+        if ( (typeFilter&(1<<i)) && ((memoryProperties.memoryTypes[i].propertyFlags&properties)==properties) )
+            return i;
+
+    throw std::exception("Failed to find suitable memory type.");
+}
+
+uint32_t PhysicalDevice::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties, VkMemoryPropertyFlags preferred) const
+{
+    // Take a type with the preferred properties too if there is one
+    try
+    {
+        return findMemoryType(typeFilter, properties | preferred);
+    }
+    catch(std::exception const &e)
+    {
+        return findMemoryType(typeFilter, properties);
+    }
+}
+
+VkFormat PhysicalDevice::findDepthFormat() const
+{
+    // Pick the most precise format usable as an optimally tiled depth attachment
+    for (VkFormat format : { VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT, VK_FORMAT_D16_UNORM })
+    {
+        VkFormatProperties formatProperties;
+        vkGetPhysicalDeviceFormatProperties(handle, format, &formatProperties);
+        if (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT)
+            return format;
+    }
+
+    throw std::exception("Failed to find supported depth format.");
+}
+
+bool PhysicalDevice::supportsFormat(VkFormat format, VkFormatFeatureFlags features) const
+{
+    // Check every requested feature with optimal tiling
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(handle, format, &formatProperties);
+    return (formatProperties.optimalTilingFeatures & features) == features;
+}
+
+bool PhysicalDevice::supportsExtension(char const *extensionName) const
+{
+    return checkDeviceExtensionSupport(handle, { extensionName });
+}
+
 bool PhysicalDevice::checkDeviceSuitability(VkPhysicalDevice const &physicalDeviceHandle, Surface const *surface, std::vector<const char*> const &deviceExtensions)
 {
     // Check queue support
@@ -66,8 +158,8 @@ bool PhysicalDevice::checkDeviceSuitability(VkPhysicalDevice const &physicalDevi
     if ( !checkDeviceExtensionSupport(physicalDeviceHandle, deviceExtensions) )
         return false;
 
-    // Check swapchain support
-    if (surface->getFormats(physicalDeviceHandle).empty() || surface->getPresentModes(physicalDeviceHandle).empty())
+    // Check swapchain support (headless devices have no surface to present to)
+    if (surface != nullptr && (surface->getFormats(physicalDeviceHandle).empty() || surface->getPresentModes(physicalDeviceHandle).empty()))
         return false;
 
     return true;
@@ -86,13 +178,30 @@ uint32_t PhysicalDevice::calcMainQueueFamilyIndex(VkPhysicalDevice const &physic
         if (
             queueFamilies[i].queueFlags&VK_QUEUE_GRAPHICS_BIT &&
             queueFamilies[i].queueFlags&VK_QUEUE_TRANSFER_BIT &&
-            surface->getPresentSupport(physicalDeviceHandle, i)
+            (surface == nullptr || surface->getPresentSupport(physicalDeviceHandle, i))
         )
             return i;
 
     throw std::exception("Couldn't find a queue family with graphics, transfer and present capabilities.");
 }
 
+uint32_t PhysicalDevice::calcComputeQueueFamilyIndex(VkPhysicalDevice const &physicalDeviceHandle, uint32_t mainQueueFamilyIndex)
+{
+    // Retrieve queue families
+    uint32_t nQueueFamilies = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDeviceHandle, &nQueueFamilies, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(nQueueFamilies);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDeviceHandle, &nQueueFamilies, queueFamilies.data());
+
+    // A family without graphics is scheduled separately from rasterization, so its work can overlap it
+    for (uint32_t i=0; i<queueFamilies.size(); i++)
+        if (queueFamilies[i].queueFlags&VK_QUEUE_COMPUTE_BIT && !(queueFamilies[i].queueFlags&VK_QUEUE_GRAPHICS_BIT))
+            return i;
+
+    // Graphics families always support compute, so fall back to submitting on the main queue
+    return mainQueueFamilyIndex;
+}
+
 bool PhysicalDevice::checkDeviceExtensionSupport(VkPhysicalDevice const &physicalDeviceHandle, std::vector<const char*> const &deviceExtensions)
 {
     // Get available extensions
@@ -113,3 +222,49 @@ bool PhysicalDevice::checkDeviceExtensionSupport(VkPhysicalDevice const &physica
     
     return true;
 }
+
+void PhysicalDevice::queryDescriptorIndexing(Instance const *instance)
+{
+    descriptorIndexingFeatures = VkPhysicalDeviceDescriptorIndexingFeaturesEXT{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT };
+    descriptorIndexingProperties = VkPhysicalDeviceDescriptorIndexingPropertiesEXT{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT };
+
+    // Needs the extensions and the instance's properties 2 entry points, otherwise everything reads as unsupported
+    auto getFeatures2 = reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(vkGetInstanceProcAddr(instance->getHandle(), "vkGetPhysicalDeviceFeatures2KHR"));
+    auto getProperties2 = reinterpret_cast<PFN_vkGetPhysicalDeviceProperties2KHR>(vkGetInstanceProcAddr(instance->getHandle(), "vkGetPhysicalDeviceProperties2KHR"));
+    if (getFeatures2 == nullptr || getProperties2 == nullptr || !checkDeviceExtensionSupport(handle, { VK_KHR_MAINTENANCE3_EXTENSION_NAME, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME }))
+        return;
+
+    VkPhysicalDeviceFeatures2KHR features
+    {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR,
+        .pNext = &descriptorIndexingFeatures
+    };
+    getFeatures2(handle, &features);
+    VkPhysicalDeviceProperties2KHR properties2
+    {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR,
+        .pNext = &descriptorIndexingProperties
+    };
+    getProperties2(handle, &properties2);
+    descriptorIndexingFeatures.pNext = nullptr;
+    descriptorIndexingProperties.pNext = nullptr;
+}
+
+void PhysicalDevice::queryDynamicRendering(Instance const *instance)
+{
+    // Both the instance and the device must be on 1.3 for its features to be usable
+    if (instance->getApiVersion() < VK_API_VERSION_1_3 || properties.apiVersion < VK_API_VERSION_1_3)
+        return;
+    auto getFeatures2 = reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2>(vkGetInstanceProcAddr(instance->getHandle(), "vkGetPhysicalDeviceFeatures2"));
+    if (getFeatures2 == nullptr)
+        return;
+
+    VkPhysicalDeviceVulkan13Features features13{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES };
+    VkPhysicalDeviceFeatures2 features
+    {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+        .pNext = &features13
+    };
+    getFeatures2(handle, &features);
+    dynamicRendering = features13.dynamicRendering && features13.synchronization2;
+}
@@ -7,6 +7,7 @@
 #include "swapchain/image.hpp"
 #include "frame/frame.hpp"
 #include "command/commandBuffer.hpp"
+#include "profiling/cpuTrace.hpp"
 #include "utility/check.hpp"
 
 #include <vector>
@@ -19,28 +20,49 @@ VkQueue const &Queue::getHandle() const
     return handle;
 }
 
-void Queue::submit(Device const *device, CommandBuffer const &commandBuffer)
+void Queue::submit(Device const *device, CommandBuffer const &commandBuffer, VkFence const &fence)
 {
+    TRACE_ZONE("Queue::submit");
     VkSubmitInfo submitInfo
     {
         .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
         .commandBufferCount = 1,
         .pCommandBuffers = &commandBuffer.getHandle()
     };
+    check::fail( vkQueueSubmit(handle, 1, &submitInfo, fence), "vkQueueSubmit failed." );
+}
+
+void Queue::submit(Device const *device, CommandBuffer const &commandBuffer, VkSemaphore const &signalSemaphore)
+{
+    TRACE_ZONE("Queue::submit");
+    VkSubmitInfo submitInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &commandBuffer.getHandle(),
+        .signalSemaphoreCount = 1,
+        .pSignalSemaphores = &signalSemaphore
+    };
     check::fail( vkQueueSubmit(handle, 1, &submitInfo, VK_NULL_HANDLE), "vkQueueSubmit failed." );
 }
 
-void Queue::drawSubmit(Device const *device, Frame const &frame)
+void Queue::drawSubmit(Device const *device, Frame const &frame, VkSemaphore const &waitSemaphore, VkPipelineStageFlags waitStages)
 {
+    TRACE_ZONE("Queue::drawSubmit");
     std::vector<VkSemaphore> waitSemaphores = {frame.getImageAvailableSemaphore()};
-    std::vector<VkPipelineStageFlags> waitStages = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
+    std::vector<VkPipelineStageFlags> waitStageMasks = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
+    if (waitSemaphore != VK_NULL_HANDLE)
+    {
+        waitSemaphores.push_back(waitSemaphore);
+        waitStageMasks.push_back(waitStages);
+    }
     std::vector<VkSemaphore> signalSemaphores = {frame.getRenderFinishedSemaphore()};
     VkSubmitInfo submitInfo
     {
         .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
         .waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size()),
         .pWaitSemaphores = waitSemaphores.data(),
-        .pWaitDstStageMask = waitStages.data(),
+        .pWaitDstStageMask = waitStageMasks.data(),
         .commandBufferCount = 1,
         .pCommandBuffers = &frame.getCommandBuffer().getHandle(),
         .signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores.size()),
@@ -52,6 +74,7 @@ void Queue::drawSubmit(Device const *device, Frame const &frame)
 
 void Queue::present(Swapchain const *swapchain, Frame const &frame, Image const &image)
 {
+    TRACE_ZONE("Queue::present");
     std::vector<VkSwapchainKHR> swapchains = {swapchain->getHandle()};
     std::vector<VkSemaphore> waitSemaphores = {frame.getRenderFinishedSemaphore()};
     VkPresentInfoKHR presentInfo
@@ -0,0 +1,87 @@
+
+#include "batch/batchRenderer.hpp"
+#include "configuration/instance.hpp"
+#include "configuration/debugMessenger.hpp"
+#include "configuration/physicalDevice.hpp"
+#include "configuration/device.hpp"
+#include "command/commandPool.hpp"
+#include "mesh/mesh.hpp"
+#include "mesh/meshLoader.hpp"
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+
+/** Measures offscreen batch rendering throughput in views per second: [nViews] [viewSize] [viewsPerBatch] */
+int main(int argc, char **argv)
+{
+    int const nViews        = (argc>=2) ? std::atoi(argv[1]) : 20000;
+    int const viewSize      = (argc>=3) ? std::atoi(argv[2]) : 64;
+    int const viewsPerBatch = (argc>=4) ? std::atoi(argv[3]) : 1024;
+    try
+    {
+        // Init headless Vulkan
+        Instance instance("HelloVulkanBatch", {}, DebugMessenger::debugMessengerCreateInfo);
+        PhysicalDevice physicalDevice(&instance, nullptr, {});
+        Device device(&physicalDevice, {}, {});
+        CommandPool commandPool(&device, physicalDevice.getMainQueueFamilyIndex(), 1);
+
+        // Upload shared geometry
+        std::unique_ptr<Mesh> mesh(MeshLoader(&device, &physicalDevice, &commandPool).upload(MeshData
+        {
+            .vertices
+            {
+                {{-0.5f, -0.5f, 0.0f}, {1.0f, 0.0f, 0.0f}},
+                {{0.5f, -0.5f, 0.0f}, {0.0f, 1.0f, 0.0f}},
+                {{0.5f, 0.5f, 0.0f}, {0.0f, 0.0f, 1.0f}},
+                {{-0.5f, 0.5f, 0.0f}, {1.0f, 1.0f, 1.0f}}
+            },
+            .indices { 0, 1, 2, 2, 3, 0 }
+        }));
+
+        BatchRenderer batchRenderer(&device, &physicalDevice, &commandPool, mesh.get(), {(uint32_t) viewSize, (uint32_t) viewSize}, viewsPerBatch);
+
+        // One camera per view, orbiting the quad
+        std::vector<UniformObject> views(nViews);
+        for (int i=0; i<nViews; i++)
+        {
+            float angle = i * (glm::radians(360.0f) / nViews);
+            views[i] = UniformObject
+            {
+                .model = glm::rotate(glm::mat4(1.0f), angle, glm::vec3(0.0f, 0.0f, 1.0f)),
+                .view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f)),
+                .proj = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 10.0f)
+            };
+            views[i].proj[1][1] *= -1;
+        }
+
+        // Consume every view so readback can't be skipped
+        uint64_t checksum = 0;
+        BatchRenderer::ViewSink sink = [&](uint32_t viewIndex, uint8_t const *pixels, uint32_t rowPitch)
+        {
+            checksum += pixels[(viewSize/2)*rowPitch + (viewSize/2)*4];
+        };
+
+        // Warm up, then time a full run
+        batchRenderer.render(std::vector<UniformObject>(views.begin(), views.begin() + std::min<int>(nViews, 2*batchRenderer.getViewsPerBatch())), sink);
+        auto start = std::chrono::high_resolution_clock::now();
+        batchRenderer.render(views, sink);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        double seconds = std::chrono::duration<double>(end-start).count();
+        std::cout << "Atlas: " << batchRenderer.getAtlasExtent().width << "x" << batchRenderer.getAtlasExtent().height << ", " << batchRenderer.getViewsPerBatch() << " views per batch." << std::endl;
+        std::cout << "Rendered " << nViews << " " << viewSize << "x" << viewSize << " views in " << seconds << "s: " << std::floor(nViews/seconds) << " views/s (checksum " << checksum << ")." << std::endl;
+    }
+    catch (std::exception const &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,279 @@
+
+#include "bench/benchOptions.hpp"
+#include "bench/benchReport.hpp"
+#include "bench/benchScene.hpp"
+#include "bench/offscreenTarget.hpp"
+#include "bench/virtualTextureCheck.hpp"
+#include "configuration/instance.hpp"
+#include "configuration/debugMessenger.hpp"
+#include "configuration/physicalDevice.hpp"
+#include "configuration/device.hpp"
+#include "configuration/queue.hpp"
+#include "configuration/shaderModule.hpp"
+#include "command/commandPool.hpp"
+#include "frame/frame.hpp"
+#include "memory/descriptorAllocator.hpp"
+#include "memory/descriptorSetLayout.hpp"
+#include "mesh/mesh.hpp"
+#include "mesh/meshLoader.hpp"
+#include "profiling/counters.hpp"
+#include "profiling/frameMetrics.hpp"
+#include "profiling/gpuProfiler.hpp"
+#include "profiling/pipelineStatistics.hpp"
+#include "render/renderQueue.hpp"
+#include "swapchain/pipeline.hpp"
+#include "swapchain/renderPass.hpp"
+#include "utility/io.hpp"
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace
+{
+    struct Settings
+    {
+        uint32_t warmupFrames;
+        uint32_t frames;
+        VkExtent2D extent;
+        uint32_t seed;
+        double refreshRate;
+    };
+
+    /** Renders one scenario offscreen through the engine's render queue, measuring the frames after warm-up */
+    benchReport::Result run(Device const *device, PhysicalDevice const *physicalDevice, CommandPool *commandPool, benchScene::Scenario const &scenario, Settings const &settings)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        // Scene and the state drawing it
+        MeshData const sphere = benchScene::makeSphere(scenario.nVertices);
+        std::unique_ptr<Mesh> mesh(MeshLoader(device, physicalDevice, commandPool).upload(sphere));
+        std::vector<glm::mat4> const models = benchScene::layoutObjects(scenario.nObjects);
+        benchScene::CameraPath const cameraPath(settings.seed, 2.5f * benchScene::getSceneRadius(scenario.nObjects) + 1.0f);
+        DescriptorSetLayout descriptorSetLayout(device);
+        RenderPass renderPass(device, OffscreenTarget::FORMAT, physicalDevice->findDepthFormat(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+        Pipeline pipeline(
+            device,
+            ShaderModule(device, io::readFile("shaders/bin/shader.vert.spv", std::ios::binary)),
+            ShaderModule(device, io::readFile("shaders/bin/shader.frag.spv", std::ios::binary)),
+            &renderPass, settings.extent, { &descriptorSetLayout }, mesh->getLayout().getVertexInput(), false, { DrawConstants::getRange() }
+        );
+
+        // Frames in flight, each with its own targets
+        DescriptorAllocator descriptorAllocator(device, scenario.framesInFlight);
+        std::vector<Frame> frames;
+        std::vector<std::unique_ptr<OffscreenTarget>> targets;
+        for (int i=0; i<scenario.framesInFlight; i++)
+        {
+            frames.push_back(Frame(device, commandPool, physicalDevice, &descriptorAllocator, &descriptorSetLayout));
+            targets.push_back(std::make_unique<OffscreenTarget>(device, physicalDevice, &renderPass, settings.extent));
+        }
+        RenderQueue renderQueue(device);
+        GpuProfiler gpuProfiler(device, physicalDevice, scenario.framesInFlight);
+        PipelineStatistics pipelineStatistics(device, physicalDevice, scenario.framesInFlight);
+        renderPass.setStatistics(&pipelineStatistics, "Scene");
+        FrameMetrics frameMetrics;
+
+        glm::mat4 proj = glm::perspective(glm::radians(45.0f), settings.extent.width / (float) settings.extent.height, 0.1f, 1000.0f);
+        proj[1][1] *= -1;
+        Clock::duration const vblank = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / settings.refreshRate));
+        Clock::time_point start = Clock::now(), lastPresent{};
+        for (uint32_t frameIndex=0; frameIndex<settings.warmupFrames+settings.frames; frameIndex++)
+        {
+            // Measure from here on, warm-up having settled caches, clocks and allocations
+            if (frameIndex == settings.warmupFrames)
+            {
+                frameMetrics.reset();
+                start = Clock::now();
+            }
+
+            Clock::time_point const frameStart = Clock::now();
+            Frame &frame = frames[frameIndex % frames.size()];
+            OffscreenTarget const &target = *targets[frameIndex % targets.size()];
+            frame.waitForReady(device);
+            Clock::duration const blocked = Clock::now() - frameStart;
+
+            // Queue every object, the camera fixed by frame index alone
+            glm::mat4 const view = cameraPath.getView(frameIndex);
+            frame.updateUniform(UniformObject{ .model = glm::mat4(1.0f), .view = view, .proj = proj });
+            renderQueue.clear();
+            for (uint32_t object=0; object<scenario.nObjects; object++)
+                renderQueue.submit(0, RenderQueue::Draw
+                {
+                    .pipeline = &pipeline,
+                    .material = frame.getDescriptorSet(),
+                    .uniforms = &frame.getUniformBuffer(),
+                    .mesh = mesh.get(),
+                    .lod = 0,
+                    .constants
+                    {
+                        .model = models[object] * mesh->getDequantizationTransform(),
+                        .objectId = object
+                    }
+                }, view * models[object]);
+            renderQueue.sort();
+
+            // Record and submit, nothing waits on an image so the frame's fence is all that's signalled
+            frame.getCommandBuffer().record([&](VkCommandBuffer const &commandBuffer)
+            {
+                gpuProfiler.beginFrame(commandBuffer);
+                pipelineStatistics.beginFrame(commandBuffer);
+                renderPass.run(target.getFramebuffer(), settings.extent, commandBuffer, [&]()
+                {
+                    renderQueue.record(commandBuffer);
+                });
+                gpuProfiler.endFrame(commandBuffer);
+            });
+            vkResetFences(device->getHandle(), 1, &frame.getInFlightFence());
+            device->getMainQueue().submit(device, frame.getCommandBuffer(), frame.getInFlightFence());
+            Clock::time_point const submitted = Clock::now();
+
+            // Fifo holds each frame until the next virtual vertical blank
+            if (scenario.presentMode == benchScene::Fifo)
+                std::this_thread::sleep_until(start + ((submitted - start) / vblank + 1) * vblank);
+
+            Clock::time_point const presentTime = Clock::now();
+            double const cpuMs = std::chrono::duration<double, std::milli>(submitted - frameStart - blocked).count();
+            double const intervalMs = lastPresent == Clock::time_point{} ? -1.0 : std::chrono::duration<double, std::milli>(presentTime - lastPresent).count();
+            frameMetrics.recordFrame(cpuMs, gpuProfiler.getFrameMs(), intervalMs);
+            lastPresent = presentTime;
+        }
+        vkDeviceWaitIdle(device->getHandle());
+        double const seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        // Gate on medians and throughput, tails and counts are reported but too noisy to fail on
+        FrameMetrics::Summary const cpu = frameMetrics.getSummary(FrameMetrics::CpuTime);
+        FrameMetrics::Summary const gpu = frameMetrics.getSummary(FrameMetrics::GpuTime);
+        FrameMetrics::Summary const interval = frameMetrics.getSummary(FrameMetrics::PresentInterval);
+        uint32_t const nFrames = std::max(settings.frames, 1u);
+        return benchReport::Result
+        {
+            .scenario = scenario.getName(),
+            .metrics
+            {
+                { "objects", static_cast<double>(scenario.nObjects) },
+                { "vertices", static_cast<double>(sphere.vertices.size()) },
+                { "frames_in_flight", static_cast<double>(scenario.framesInFlight) },
+                { "frames", static_cast<double>(settings.frames) },
+                { "fps", settings.frames / seconds, benchReport::HigherIsBetter },
+                { "frame_p50_ms", interval.p50Ms, benchReport::LowerIsBetter },
+                { "frame_p95_ms", interval.p95Ms, benchReport::LowerIsBetter },
+                { "frame_p99_ms", interval.p99Ms },
+                { "frame_max_ms", interval.maxMs },
+                { "cpu_p50_ms", cpu.p50Ms, benchReport::LowerIsBetter },
+                { "cpu_p99_ms", cpu.p99Ms },
+                { "gpu_p50_ms", gpu.p50Ms, gpuProfiler.isSupported() ? benchReport::LowerIsBetter : benchReport::Informational },
+                { "gpu_p99_ms", gpu.p99Ms },
+                { "stutters", static_cast<double>(frameMetrics.getStutters()) },
+                { "draws_per_frame", static_cast<double>(frameMetrics.getCounter(counters::Draws)) / nFrames },
+                { "binds_per_frame", static_cast<double>(frameMetrics.getCounter(counters::Binds)) / nFrames },
+                { "vertex_invocations_per_frame", static_cast<double>(frameMetrics.getCounter(counters::VertexInvocations)) / nFrames },
+                { "fragment_invocations_per_frame", static_cast<double>(frameMetrics.getCounter(counters::FragmentInvocations)) / nFrames },
+                { "overdraw", static_cast<double>(frameMetrics.getCounter(counters::FragmentInvocations)) / nFrames / (settings.extent.width * settings.extent.height) }
+            }
+        };
+    }
+}
+
+/**
+ * Renders parameterised scenes offscreen and reports frame time statistics, failing when a baseline comparison regresses:
+ * [--objects 1,100,1000] [--vertices 500,5000] [--frames-in-flight 2] [--present immediate] [--frames 300] [--warmup 60]
+ * [--width 1280] [--height 720] [--seed 1] [--refresh 60] [--csv file] [--json file] [--baseline file] [--threshold 0.1]
+ * [--virtual-texture file], a generated texture checked when no file is given
+ */
+int main(int argc, char **argv)
+{
+    try
+    {
+        BenchOptions const options(argc, argv);
+        Settings const settings
+        {
+            .warmupFrames = static_cast<uint32_t>(options.getNumber("warmup", 60)),
+            .frames = static_cast<uint32_t>(options.getNumber("frames", 300)),
+            .extent = { static_cast<uint32_t>(options.getNumber("width", 1280)), static_cast<uint32_t>(options.getNumber("height", 720)) },
+            .seed = static_cast<uint32_t>(options.getNumber("seed", 1)),
+            .refreshRate = options.getNumber("refresh", 60.0)
+        };
+
+        // Every combination of the listed parameters
+        std::vector<benchScene::Scenario> scenarios;
+        for (std::string const &objects : options.getList("objects", "1,100,1000"))
+            for (std::string const &vertices : options.getList("vertices", "500,5000"))
+                for (std::string const &framesInFlight : options.getList("frames-in-flight", "2"))
+                    for (std::string const &presentMode : options.getList("present", "immediate"))
+                        scenarios.push_back(benchScene::Scenario
+                        {
+                            .nObjects = static_cast<uint32_t>(std::stoul(objects)),
+                            .nVertices = static_cast<uint32_t>(std::stoul(vertices)),
+                            .framesInFlight = std::stoi(framesInFlight),
+                            .presentMode = benchScene::parsePresentMode(presentMode)
+                        });
+
+        // Init headless Vulkan, needing nothing a software implementation such as lavapipe lacks
+        Instance instance("HelloVulkanBench", {}, DebugMessenger::debugMessengerCreateInfo);
+        PhysicalDevice physicalDevice(&instance, nullptr, {});
+        Device device(&physicalDevice, {}, {});
+        CommandPool commandPool(&device, physicalDevice.getMainQueueFamilyIndex(), 1);
+
+        std::vector<benchReport::Result> results;
+        for (benchScene::Scenario const &scenario : scenarios)
+        {
+            results.push_back(run(&device, &physicalDevice, &commandPool, scenario, settings));
+            std::cout << scenario.getName() << ":";
+            for (benchReport::Metric const &metric : results.back().metrics)
+                if (metric.direction != benchReport::Informational)
+                    std::cout << " " << metric.name << " " << metric.value;
+            std::cout << std::endl;
+        }
+
+        // Stream a paged texture through GPU feedback, reported alongside the scenarios
+        std::string virtualTextureFilename = options.get("virtual-texture", "");
+        if (virtualTextureFilename.empty())
+            virtualTextureFilename = virtualTextureCheck::writeDefaultTexture();
+        bool virtualTexturePassed = false;
+        results.push_back(virtualTextureCheck::run(&device, &physicalDevice, &commandPool, virtualTextureCheck::Settings
+        {
+            .frames = settings.frames,
+            .extent = settings.extent,
+            .cachePagesWide = 4,
+            .filename = virtualTextureFilename
+        }, virtualTexturePassed));
+
+        if (std::string csv = options.get("csv", ""); !csv.empty())
+            benchReport::write(csv, results);
+        if (std::string json = options.get("json", ""); !json.empty())
+            benchReport::write(json, results);
+
+        // Fail outright when feedback never made it back to the host
+        if (!virtualTexturePassed)
+        {
+            std::cerr << "Virtual texture feedback requested or streamed no pages." << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        // Fail the run when any gated metric is worse than the baseline by more than the threshold
+        if (std::string baseline = options.get("baseline", ""); !baseline.empty())
+        {
+            std::vector<std::string> regressions = benchReport::compare(results, benchReport::readJson(baseline), options.getNumber("threshold", 0.1));
+            for (std::string const &regression : regressions)
+                std::cerr << "Regression: " << regression << std::endl;
+            if (!regressions.empty())
+                return EXIT_FAILURE;
+            std::cout << "No regressions against " << baseline << "." << std::endl;
+        }
+    }
+    catch (std::exception const &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
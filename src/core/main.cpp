@@ -6,9 +6,11 @@
 int main(int argc, char **argv)
 {
     bool disableValidationLayers = (argc>=2) && (strcmp(argv[1], "noval")==0);
+    char const *meshFilename = (argc>=3) ? argv[2] : nullptr;
+    bool deferred = (argc>=4) && (strcmp(argv[3], "deferred")==0);
     try
     {
-        Display display{1000, 600, "HelloVulkan", BufferingStrategy::TripleBuffering, !disableValidationLayers};
+        Display display{1000, 600, "HelloVulkan", BufferingStrategy::TripleBuffering, !disableValidationLayers, meshFilename, deferred};
         while (!display.shouldClose())
             display.tick();
     }
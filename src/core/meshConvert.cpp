@@ -0,0 +1,44 @@
+
+#include "mesh/meshData.hpp"
+#include "mesh/meshFormat.hpp"
+#include "mesh/meshOptimizer.hpp"
+#include "mesh/meshLod.hpp"
+
+#include <iostream>
+
+/** Optimises, simplifies into LODs and converts an .obj or .glb file into the native .mesh format: <input> <output.mesh> [float|half|compact] */
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <input.obj|input.glb> <output.mesh> [float|half|compact]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        VertexLayout layout = (argc >= 4) ? VertexLayout::fromName(argv[3]) : VertexLayout::FLOAT;
+        MeshData meshData = MeshData::parse(argv[1]);
+
+        // Reorder for cache, overdraw and fetch locality, reporting cache efficiency
+        meshOptimizer::Statistics before = meshOptimizer::analyze(meshData.indices, meshData.vertices.size());
+        meshOptimizer::optimize(meshData);
+        meshOptimizer::Statistics after = meshOptimizer::analyze(meshData.indices, meshData.vertices.size());
+        std::cout << "ACMR " << before.acmr << " -> " << after.acmr << ", ATVR " << before.atvr << " -> " << after.atvr << "." << std::endl;
+
+        // Append coarser levels sharing the same vertices
+        meshLod::generate(meshData);
+        for (size_t i=0; i<meshData.lods.size(); i++)
+            std::cout << "LOD " << i << ": " << meshData.lods[i].nIndices/3 << " triangles, error " << meshData.lods[i].error << "." << std::endl;
+
+        meshFormat::write(argv[2], meshData, layout);
+        std::cout << "Wrote " << meshData.vertices.size() << " " << layout.getName() << " vertices (" << layout.getStride() << " bytes each), " << meshData.indices.size()/3 << " triangles over all LODs with " << MeshData::getIndexSize(meshData.vertices.size())*8 << "-bit indices." << std::endl;
+    }
+    catch (std::exception const &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,238 @@
+
+#include "bench/benchOptions.hpp"
+#include "bench/benchReport.hpp"
+#include "bench/benchScene.hpp"
+#include "bench/microBenchmark.hpp"
+#include "bench/offscreenTarget.hpp"
+#include "configuration/instance.hpp"
+#include "configuration/debugMessenger.hpp"
+#include "configuration/physicalDevice.hpp"
+#include "configuration/device.hpp"
+#include "configuration/shaderModule.hpp"
+#include "command/commandPool.hpp"
+#include "command/commandBuffer.hpp"
+#include "frame/frame.hpp"
+#include "memory/descriptorAllocator.hpp"
+#include "memory/descriptorSet.hpp"
+#include "memory/descriptorSetLayout.hpp"
+#include "memory/typedBuffer.hpp"
+#include "mesh/lodSelector.hpp"
+#include "mesh/mesh.hpp"
+#include "mesh/meshLoader.hpp"
+#include "swapchain/pipeline.hpp"
+#include "swapchain/renderPass.hpp"
+#include "vertex/quantize.hpp"
+#include "vertex/vertexLayout.hpp"
+#include "utility/io.hpp"
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace
+{
+    struct Benchmark
+    {
+        std::string name;
+        microBenchmark::Body body;
+        uint64_t bytesPerIteration = 0;
+    };
+}
+
+/**
+ * Times CPU-side hot paths in isolation, failing when a baseline comparison regresses:
+ * [--filter substring] [--min-time 0.01] [--repetitions 10] [--csv file] [--json file] [--baseline file] [--threshold 0.1]
+ */
+int main(int argc, char **argv)
+{
+    try
+    {
+        BenchOptions const options(argc, argv);
+        microBenchmark::Settings const settings
+        {
+            .minBatchSeconds = options.getNumber("min-time", 0.01),
+            .repetitions = static_cast<uint32_t>(options.getNumber("repetitions", 10))
+        };
+
+        // Init headless Vulkan, the paths below only ever touch the CPU side of the driver
+        Instance instance("HelloVulkanMicroBench", {}, DebugMessenger::debugMessengerCreateInfo);
+        PhysicalDevice physicalDevice(&instance, nullptr, {});
+        Device device(&physicalDevice, {}, {});
+        CommandPool commandPool(&device, physicalDevice.getMainQueueFamilyIndex(), 1);
+
+        // State shared by the benchmarks, as the interactive renderer sets it up
+        VkExtent2D const extent { 1280, 720 };
+        MeshData const sphere = benchScene::makeSphere(5000);
+        std::unique_ptr<Mesh> mesh(MeshLoader(&device, &physicalDevice, &commandPool).upload(sphere));
+        DescriptorSetLayout descriptorSetLayout(&device);
+        DescriptorAllocator descriptorAllocator(&device, 1);
+        Frame frame(&device, &commandPool, &physicalDevice, &descriptorAllocator, &descriptorSetLayout);
+        RenderPass renderPass(&device, OffscreenTarget::FORMAT, physicalDevice.findDepthFormat(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+        OffscreenTarget target(&device, &physicalDevice, &renderPass, extent);
+        Pipeline pipeline(
+            &device,
+            ShaderModule(&device, io::readFile("shaders/bin/shader.vert.spv", std::ios::binary)),
+            ShaderModule(&device, io::readFile("shaders/bin/shader.frag.spv", std::ios::binary)),
+            &renderPass, extent, { &descriptorSetLayout }, mesh->getLayout().getVertexInput(), false, { DrawConstants::getRange() }
+        );
+        CommandBuffer commandBuffer = commandPool.allocateNewBuffer();
+
+        std::vector<Benchmark> benchmarks;
+
+        // Per-frame uniform upload
+        benchmarks.push_back(Benchmark{ "Frame::updateUniform", [&](uint64_t iterations)
+        {
+            UniformObject uniform { .model = glm::mat4(1.0f), .view = glm::mat4(1.0f), .proj = glm::mat4(1.0f) };
+            for (uint64_t i=0; i<iterations; i++)
+            {
+                uniform.model[3][0] = static_cast<float>(i);
+                frame.updateUniform(uniform);
+            }
+        }, sizeof(UniformObject) });
+
+        // Recording a render pass of N draws, binding once and pushing constants per draw as the render queue does
+        for (uint32_t nDraws : { 1u, 100u, 1000u, 10000u })
+            benchmarks.push_back(Benchmark{ "CommandBuffer::record/" + std::to_string(nDraws), [&, nDraws](uint64_t iterations)
+            {
+                DrawConstants constants { .model = glm::mat4(1.0f), .objectId = 0 };
+                for (uint64_t i=0; i<iterations; i++)
+                    commandBuffer.record([&](VkCommandBuffer const &handle)
+                    {
+                        renderPass.run(target.getFramebuffer(), extent, handle, [&]()
+                        {
+                            vkCmdBindPipeline(handle, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.getHandle());
+                            vkCmdBindDescriptorSets(handle, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.getLayout(), 0, 1, &frame.getDescriptorSet()->getHandle(), 0, nullptr);
+                            mesh->bind(handle);
+                            for (uint32_t draw=0; draw<nDraws; draw++)
+                            {
+                                constants.objectId = draw;
+                                vkCmdPushConstants(handle, pipeline.getLayout(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(DrawConstants), &constants);
+                                vkCmdDrawIndexed(handle, mesh->getNIndices(), 1, 0, 0, 0);
+                            }
+                        });
+                    });
+            } });
+
+        // Host-visible buffer writes, mapping per call as VoidBuffer::memcpy does, against copying into memory kept mapped
+        std::vector<std::unique_ptr<TypedBuffer<char>>> buffers;
+        for (size_t size : { size_t(64), size_t(4) << 10, size_t(256) << 10, size_t(16) << 20 })
+        {
+            buffers.push_back(std::make_unique<TypedBuffer<char>>(&device, &physicalDevice, size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT|VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT|VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
+            TypedBuffer<char> *buffer = buffers.back().get();
+            auto source = std::make_shared<std::vector<char>>(size, 1);
+            benchmarks.push_back(Benchmark{ "VoidBuffer::memcpy/" + std::to_string(size), [buffer, source](uint64_t iterations)
+            {
+                for (uint64_t i=0; i<iterations; i++)
+                    buffer->memcpy(source->size(), source->data());
+            }, size });
+            benchmarks.push_back(Benchmark{ "mapped memcpy/" + std::to_string(size), [buffer, source](uint64_t iterations)
+            {
+                void *mapped = buffer->map();
+                for (uint64_t i=0; i<iterations; i++)
+                {
+                    std::memcpy(mapped, source->data(), source->size());
+                    microBenchmark::doNotOptimize(mapped);
+                }
+                buffer->unmap();
+            }, size });
+        }
+
+        // Memory type lookup, made for every buffer and image created
+        benchmarks.push_back(Benchmark{ "PhysicalDevice::findMemoryType", [&](uint64_t iterations)
+        {
+            for (uint64_t i=0; i<iterations; i++)
+                microBenchmark::doNotOptimize(physicalDevice.findMemoryType(UINT32_MAX, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT|VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
+        } });
+        benchmarks.push_back(Benchmark{ "PhysicalDevice::findMemoryType/preferred", [&](uint64_t iterations)
+        {
+            for (uint64_t i=0; i<iterations; i++)
+                microBenchmark::doNotOptimize(physicalDevice.findMemoryType(UINT32_MAX, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT));
+        } });
+
+        // Vertex input descriptions for pipeline creation, and packing vertices into each layout
+        for (VertexLayout const &layout : { VertexLayout::FLOAT, VertexLayout::HALF, VertexLayout::COMPACT })
+        {
+            benchmarks.push_back(Benchmark{ std::string("VertexLayout::getVertexInput/") + layout.getName(), [layout](uint64_t iterations)
+            {
+                for (uint64_t i=0; i<iterations; i++)
+                    microBenchmark::doNotOptimize(layout.getVertexInput().attributes.data());
+            } });
+            auto packed = std::make_shared<std::vector<char>>(sphere.vertices.size() * layout.getStride());
+            quantize::Dequantization const dequantization = quantize::computeDequantization(sphere.vertices, layout);
+            for (bool simd : { false, true })
+                benchmarks.push_back(Benchmark{ std::string("quantize::encode/") + layout.getName() + (simd ? "/simd" : "/scalar"), [&sphere, layout, dequantization, packed, simd](uint64_t iterations)
+                {
+                    for (uint64_t i=0; i<iterations; i++)
+                    {
+                        quantize::encode(sphere.vertices, layout, dequantization, packed->data(), simd);
+                        microBenchmark::doNotOptimize(packed->data());
+                    }
+                }, sphere.vertices.size() * sizeof(Vertex) });
+        }
+
+        // The camera, model and LOD maths of one drawFrame
+        benchmarks.push_back(Benchmark{ "drawFrame matrices", [&](uint64_t iterations)
+        {
+            for (uint64_t i=0; i<iterations; i++)
+            {
+                float deltaTime = i * 0.001f;
+                glm::mat4 model = glm::rotate(glm::mat4(1.0f), deltaTime * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+                UniformObject uniform
+                {
+                    .model = model * mesh->getDequantizationTransform(),
+                    .view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f)),
+                    .proj = glm::perspective(glm::radians(45.0f), extent.width / (float) extent.height, 0.1f, 10.0f)
+                };
+                uniform.proj[1][1] *= -1;
+                microBenchmark::doNotOptimize(uniform);
+                microBenchmark::doNotOptimize(LodSelector(uniform.proj, extent).select(mesh.get(), uniform.view * model));
+            }
+        } });
+
+        // Run those matching the filter
+        std::string const filter = options.get("filter", "");
+        std::vector<benchReport::Result> results;
+        std::cout << std::fixed << std::setprecision(1);
+        for (Benchmark const &benchmark : benchmarks)
+        {
+            if (benchmark.name.find(filter) == std::string::npos)
+                continue;
+            microBenchmark::Measurement const measurement = microBenchmark::run(benchmark.name, benchmark.body, settings, benchmark.bytesPerIteration);
+            results.push_back(microBenchmark::toResult(measurement));
+            std::cout << std::left << std::setw(44) << measurement.name << std::right << std::setw(14) << measurement.medianNs << " ns"
+                      << std::setw(14) << measurement.minNs << " ns min" << std::setw(12) << measurement.iterations << " iterations";
+            if (benchmark.bytesPerIteration > 0)
+                std::cout << std::setw(10) << measurement.bytesPerSecond / 1e9 << " GB/s";
+            std::cout << std::endl;
+        }
+
+        if (std::string csv = options.get("csv", ""); !csv.empty())
+            benchReport::write(csv, results);
+        if (std::string json = options.get("json", ""); !json.empty())
+            benchReport::write(json, results);
+
+        // Fail the run when any median is slower than the baseline by more than the threshold
+        if (std::string baseline = options.get("baseline", ""); !baseline.empty())
+        {
+            std::vector<std::string> regressions = benchReport::compare(results, benchReport::readJson(baseline), options.getNumber("threshold", 0.1));
+            for (std::string const &regression : regressions)
+                std::cerr << "Regression: " << regression << std::endl;
+            if (!regressions.empty())
+                return EXIT_FAILURE;
+            std::cout << "No regressions against " << baseline << "." << std::endl;
+        }
+    }
+    catch (std::exception const &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,78 @@
+
+#include "asset/assetPack.hpp"
+#include "mesh/meshData.hpp"
+#include "mesh/meshFormat.hpp"
+#include "mesh/meshOptimizer.hpp"
+#include "mesh/meshLod.hpp"
+#include "utility/io.hpp"
+
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+    AssetType inferType(std::string const &filename)
+    {
+        if (filename.ends_with(".spv"))
+            return AssetShader;
+        if (filename.ends_with(".obj") || filename.ends_with(".glb") || filename.ends_with(".mesh"))
+            return AssetMesh;
+        if (filename.ends_with(".ktx2") || filename.ends_with(".png"))
+            return AssetTexture;
+        return AssetRaw;
+    }
+}
+
+/** Packs files into a single asset archive, optimising, simplifying and converting meshes to the native format: <output.pack> [--compress] [--layout=float|half|compact] <files...> */
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <output.pack> [--compress] [--layout=float|half|compact] <files...>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        // Gather inputs, stored under the path they are requested by at runtime
+        bool compress = false;
+        VertexLayout layout = VertexLayout::FLOAT;
+        std::vector<AssetPack::Input> inputs;
+        for (int i=2; i<argc; i++)
+        {
+            if (std::strcmp(argv[i], "--compress") == 0)
+            {
+                compress = true;
+                continue;
+            }
+            if (std::strncmp(argv[i], "--layout=", 9) == 0)
+            {
+                layout = VertexLayout::fromName(argv[i] + 9);
+                continue;
+            }
+            std::string filename = argv[i];
+            AssetType type = inferType(filename);
+            std::vector<char> data;
+            if (type == AssetMesh && !filename.ends_with(".mesh"))
+            {
+                MeshData meshData = MeshData::parse(filename);
+                meshOptimizer::optimize(meshData);
+                meshLod::generate(meshData);
+                data = meshFormat::serialize(meshData, layout);
+            }
+            else
+                data = io::readFile(filename, std::ios::binary);
+            inputs.push_back(AssetPack::Input{ .name = filename, .type = type, .data = std::move(data), .compress = compress });
+        }
+
+        AssetPack::write(argv[1], inputs);
+        std::cout << "Packed " << inputs.size() << " assets into " << argv[1] << "." << std::endl;
+    }
+    catch (std::exception const &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
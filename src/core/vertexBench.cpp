@@ -0,0 +1,142 @@
+
+#include "batch/batchRenderer.hpp"
+#include "configuration/instance.hpp"
+#include "configuration/debugMessenger.hpp"
+#include "configuration/physicalDevice.hpp"
+#include "configuration/device.hpp"
+#include "command/commandPool.hpp"
+#include "mesh/mesh.hpp"
+#include "mesh/meshData.hpp"
+#include "mesh/meshLoader.hpp"
+#include "vertex/quantize.hpp"
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace
+{
+    /** Dense UV sphere coloured by its normals, large enough to be vertex-fetch bound */
+    MeshData makeSphere(uint32_t resolution)
+    {
+        MeshData meshData;
+        for (uint32_t row=0; row<=resolution; row++)
+            for (uint32_t column=0; column<=resolution; column++)
+            {
+                float theta = glm::pi<float>() * row / resolution, phi = 2.0f * glm::pi<float>() * column / resolution;
+                glm::vec3 normal(std::sin(theta)*std::cos(phi), std::sin(theta)*std::sin(phi), std::cos(theta));
+                meshData.vertices.emplace_back(normal * 0.75f, normal*0.5f + glm::vec3(0.5f), normal);
+            }
+        for (uint32_t row=0; row<resolution; row++)
+            for (uint32_t column=0; column<resolution; column++)
+            {
+                uint32_t corner = row*(resolution+1) + column;
+                meshData.indices.insert(meshData.indices.end(), { corner, corner+resolution+1, corner+1, corner+1, corner+resolution+1, corner+resolution+2 });
+            }
+        return meshData;
+    }
+
+    /** Best of several runs, in milliseconds */
+    template<class F>
+    double time(F const &function, int repetitions=5)
+    {
+        double best = INFINITY;
+        for (int i=0; i<repetitions; i++)
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            function();
+            auto end = std::chrono::high_resolution_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::milli>(end-start).count());
+        }
+        return best;
+    }
+}
+
+/** Compares vertex layouts by size, encode speed, precision and render throughput: [mesh file] [nViews] [viewSize] */
+int main(int argc, char **argv)
+{
+    int const nViews   = (argc>=3) ? std::atoi(argv[2]) : 2000;
+    int const viewSize = (argc>=4) ? std::atoi(argv[3]) : 128;
+    VertexLayout const layouts[] = { VertexLayout::FLOAT, VertexLayout::HALF, VertexLayout::COMPACT };
+    try
+    {
+        MeshData meshData = (argc>=2) ? MeshData::parse(argv[1]) : makeSphere(512);
+        std::cout << meshData.vertices.size() << " vertices, " << meshData.indices.size()/3 << " triangles." << std::endl;
+
+        // Compare size, scalar and SIMD encode time and round-trip error on the CPU
+        std::cout << std::fixed << std::setprecision(3);
+        for (VertexLayout const &layout : layouts)
+        {
+            quantize::Dequantization dequantization = quantize::computeDequantization(meshData.vertices, layout);
+            std::vector<char> packed(meshData.vertices.size() * layout.getStride());
+            double scalar = time([&]() { quantize::encode(meshData.vertices, layout, dequantization, packed.data(), false); });
+            double simd = time([&]() { quantize::encode(meshData.vertices, layout, dequantization, packed.data(), true); });
+
+            std::vector<Vertex> decoded = quantize::decode(packed.data(), meshData.vertices.size(), layout, dequantization);
+            float positionError = 0.0f, normalError = 0.0f;
+            for (size_t i=0; i<decoded.size(); i++)
+            {
+                positionError = std::max(positionError, glm::length(decoded[i].position - meshData.vertices[i].position));
+                normalError = std::max(normalError, std::acos(std::clamp(glm::dot(decoded[i].normal, meshData.vertices[i].normal), -1.0f, 1.0f)));
+            }
+
+            std::cout << std::setw(8) << layout.getName() << ": " << layout.getStride() << " B/vertex, "
+                      << packed.size() / 1048576.0 << " MiB (" << float(sizeof(Vertex)) / layout.getStride() << "x smaller), "
+                      << "encode " << scalar << " ms scalar / " << simd << " ms SIMD, "
+                      << "max error " << positionError << " position / " << glm::degrees(normalError) << " deg normal." << std::endl;
+        }
+
+        // Init headless Vulkan
+        Instance instance("HelloVulkanVertexBench", {}, DebugMessenger::debugMessengerCreateInfo);
+        PhysicalDevice physicalDevice(&instance, nullptr, {});
+        Device device(&physicalDevice, {}, {});
+        CommandPool commandPool(&device, physicalDevice.getMainQueueFamilyIndex(), 1);
+
+        // One camera per view, orbiting the mesh
+        std::vector<UniformObject> views(nViews);
+        for (int i=0; i<nViews; i++)
+        {
+            float angle = i * (glm::radians(360.0f) / nViews);
+            views[i] = UniformObject
+            {
+                .model = glm::rotate(glm::mat4(1.0f), angle, glm::vec3(0.0f, 0.0f, 1.0f)),
+                .view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f)),
+                .proj = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 10.0f)
+            };
+            views[i].proj[1][1] *= -1;
+        }
+
+        // Time rendering the same views from each layout
+        for (VertexLayout const &layout : layouts)
+        {
+            std::unique_ptr<Mesh> mesh(MeshLoader(&device, &physicalDevice, &commandPool, nullptr, layout).upload(meshData));
+            BatchRenderer batchRenderer(&device, &physicalDevice, &commandPool, mesh.get(), {(uint32_t) viewSize, (uint32_t) viewSize}, 256);
+
+            uint64_t checksum = 0;
+            BatchRenderer::ViewSink sink = [&](uint32_t viewIndex, uint8_t const *pixels, uint32_t rowPitch)
+            {
+                checksum += pixels[(viewSize/2)*rowPitch + (viewSize/2)*4];
+            };
+            batchRenderer.render(std::vector<UniformObject>(views.begin(), views.begin() + std::min<int>(nViews, batchRenderer.getViewsPerBatch())), sink);
+            double seconds = time([&]() { batchRenderer.render(views, sink); }, 1) / 1000.0;
+
+            std::cout << std::setw(8) << layout.getName() << ": " << mesh->getSize() / 1048576.0 << " MiB on device, "
+                      << std::floor(nViews/seconds) << " views/s (checksum " << checksum << ")." << std::endl;
+        }
+    }
+    catch (std::exception const &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -14,71 +14,165 @@
 #include "swapchain/pipeline.hpp"
 #include "swapchain/renderPass.hpp"
 #include "vertex/vertex.hpp"
-#include "memory/typedBuffer.hpp"
+#include "mesh/mesh.hpp"
+#include "mesh/meshLoader.hpp"
+#include "mesh/lodSelector.hpp"
+#include "render/renderQueue.hpp"
+#include "render/renderGraph.hpp"
+#include "render/deferredRenderer.hpp"
+#include "compute/asyncCompute.hpp"
+#include "memory/attachment.hpp"
+#include "asset/assetPack.hpp"
+#include "asset/residencyManager.hpp"
 #include "frame/framePool.hpp"
+#include "memory/deletionQueue.hpp"
 #include "frame/frame.hpp"
 #include "memory/descriptorSetLayout.hpp"
-#include "utility/util.hpp"
+#include "memory/bindlessTable.hpp"
+#include "texture/textureLoader.hpp"
+#include "texture/texture.hpp"
+#include "texture/samplerCache.hpp"
+#include "profiling/gpuProfiler.hpp"
+#include "profiling/cpuTrace.hpp"
+#include "profiling/counters.hpp"
+#include "profiling/frameMetrics.hpp"
+#include "profiling/pipelineStatistics.hpp"
 
 #define GLM_FORCE_RADIANS
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <algorithm>
 #include <chrono>
+#include <filesystem>
 
 std::vector<const char *> const VALIDATION_LAYERS{ "VK_LAYER_KHRONOS_validation" };
 std::vector<const char *> const DEVICE_EXTENSIONS{ VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+char const *const ASSET_PACK_FILENAME = "assets.pack";
+char const *const GPU_PROFILE_FILENAME = "gpuProfile.json";
+char const *const CPU_TRACE_FILENAME = "cpuTrace.json";
+char const *const METRICS_FILENAME = "metrics.prom";
+char const *const TEXTURE_FILENAME = "textures/albedo.ktx2";
+double const METRICS_SECONDS = 5.0;
+VertexLayout const VERTEX_LAYOUT = VertexLayout::COMPACT;
+int const DEFERRED_LIGHTS_PER_SIDE = 16;
+
+namespace
+{
+    /** Grid of small coloured lights hovering over the mesh, enough that forward shading each would be costly */
+    std::vector<PointLight> createLights(int perSide)
+    {
+        std::vector<PointLight> lights;
+        for (int y=0; y<perSide; y++)
+            for (int x=0; x<perSide; x++)
+            {
+                glm::vec2 const position = glm::vec2(x, y) / float(perSide - 1) * 2.0f - 1.0f;
+                float const hue = float(y*perSide + x) * 0.618034f;
+                glm::vec3 const colour = glm::clamp(glm::abs(glm::fract(glm::vec3(hue) + glm::vec3(0.0f, 2.0f/3.0f, 1.0f/3.0f)) * 6.0f - 3.0f) - 1.0f, 0.0f, 1.0f);
+                lights.push_back(PointLight{ .positionRadius = glm::vec4(position, 0.3f, 0.5f), .colour = glm::vec4(colour, 1.0f) });
+            }
+        return lights;
+    }
+}
 
-Display::Display(int windowWidth, int windowHeight, char const *title, BufferingStrategy bufferingStrategy, bool enableValidationLayers)
+Display::Display(int windowWidth, int windowHeight, char const *title, BufferingStrategy bufferingStrategy, bool enableValidationLayers, char const *meshFilename, bool deferred)
 {
+    TRACE_THREAD("Main");
+
     // Optionally enable validations layers
     std::vector<const char *> activeValidationLayers = enableValidationLayers ? VALIDATION_LAYERS : std::vector<const char *>{};
 
     // Init GLFW
     window = new Window(windowWidth, windowHeight, title, framebufferResizeCallback, this);
 
+    // Map asset pack if one was shipped, falling back to loose files otherwise
+    assetPack = std::filesystem::exists(ASSET_PACK_FILENAME) ? new AssetPack(ASSET_PACK_FILENAME) : nullptr;
+
     // Init Vulkan
     instance = new Instance(title, activeValidationLayers, DebugMessenger::debugMessengerCreateInfo);
     debugMessenger = new DebugMessenger(instance);
     surface = new Surface(instance, window);
     physicalDevice = new PhysicalDevice(instance, surface, DEVICE_EXTENSIONS);
-    device = new Device(physicalDevice, activeValidationLayers, DEVICE_EXTENSIONS);
-    descriptorSetLayout = new DescriptorSetLayout(device);
-    swapchain = new Swapchain(device, physicalDevice, window, surface, descriptorSetLayout);
+
+    // Push uniforms into command buffers where supported, sparing per-frame descriptor sets
+    std::vector<const char *> deviceExtensions = DEVICE_EXTENSIONS;
+    bool const pushDescriptors = physicalDevice->supportsExtension(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+    if (pushDescriptors)
+        deviceExtensions.push_back(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+
+    // Address images and storage buffers by index through one bindless set where supported
+    bool const bindless = physicalDevice->supportsBindless();
+    if (bindless)
+    {
+        deviceExtensions.push_back(VK_KHR_MAINTENANCE3_EXTENSION_NAME);
+        deviceExtensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+    }
+    device = new Device(physicalDevice, activeValidationLayers, deviceExtensions);
+    descriptorSetLayout = new DescriptorSetLayout(device, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, pushDescriptors ? VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR : 0);
+
+    // Resources replaced mid-run are destroyed once the frames in flight are done with them, rather than after an idle wait
+    deletionQueue = new DeletionQueue(bufferingStrategy);
+    bindlessTable = bindless ? new BindlessTable(device, physicalDevice, deletionQueue) : nullptr;
+    swapchain = new Swapchain(device, physicalDevice, window, surface, descriptorSetLayout, VERTEX_LAYOUT, assetPack, bindless ? bindlessTable->getLayout() : nullptr, deletionQueue);
     commandPool = new CommandPool(device, physicalDevice->getMainQueueFamilyIndex(), bufferingStrategy);
     framePool = new FramePool(device, commandPool, physicalDevice, bufferingStrategy, descriptorSetLayout);
 
-    // Create vertices
-    const std::vector<Vertex> vertices
+    // Keep the requested mesh resident under a device memory budget, streamed back in if evicted, drawing a quad while it streams or when none was requested
+    meshLoader = new MeshLoader(device, physicalDevice, commandPool, assetPack, VERTEX_LAYOUT);
+    fallbackMesh = meshLoader->upload(MeshData
     {
-        {{-0.5f, -0.5f}, {1.0f, 0.0f, 0.0f}},
-        {{0.5f, -0.5f}, {0.0f, 1.0f, 0.0f}},
-        {{0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}},
-        {{-0.5f, 0.5f}, {1.0f, 1.0f, 1.0f}}
-    };
+        .vertices
+        {
+            {{-0.5f, -0.5f, 0.0f}, {1.0f, 0.0f, 0.0f}},
+            {{0.5f, -0.5f, 0.0f}, {0.0f, 1.0f, 0.0f}},
+            {{0.5f, 0.5f, 0.0f}, {0.0f, 0.0f, 1.0f}},
+            {{-0.5f, 0.5f, 0.0f}, {1.0f, 1.0f, 1.0f}}
+        },
+        .indices
+        {
+            0, 1, 2,
+            2, 3, 0
+        }
+    });
+    residencyManager = meshFilename != nullptr ? new ResidencyManager(meshLoader, fallbackMesh, ResidencyManager::getDefaultBudget(physicalDevice), bufferingStrategy) : nullptr;
+    if (residencyManager != nullptr)
+    {
+        meshName = meshFilename;
+        residencyManager->prefetch({ meshName }, frameIndex);
+        mesh = residencyManager->acquire(meshName, frameIndex);
+    }
+    else
+        mesh = fallbackMesh;
 
-    // Create staging buffer and copy over data
-    TypedBuffer<Vertex> vertexStagingBuffer(device, physicalDevice, util::vecsizeof(vertices), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT|VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-    vertexStagingBuffer.memcpy(vertices);
+    // Tint the mesh with a texture addressed through the bindless table, when the device has one and the texture was shipped
+    textureLoader = bindless ? new TextureLoader(device, physicalDevice, commandPool, assetPack) : nullptr;
+    texture = nullptr;
+    if (textureLoader != nullptr && ((assetPack != nullptr && assetPack->contains(TEXTURE_FILENAME)) || std::filesystem::exists(TEXTURE_FILENAME)))
+    {
+        texture = textureLoader->load(TEXTURE_FILENAME);
+        textureIndex = bindlessTable->addImage(texture->getImageView(), textureLoader->getSamplerCache()->getSampler(SamplerCache::linear()));
+    }
 
-    // Create vertex buffer and transfer data
-    vertexBuffer = new TypedBuffer<Vertex>(device, physicalDevice, util::vecsizeof(vertices), VK_BUFFER_USAGE_TRANSFER_DST_BIT|VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-    vertexBuffer->transfer(commandPool, device->getMainQueue(), vertexStagingBuffer);
+    // Create per-frame draw queue
+    renderQueue = new RenderQueue(device);
 
-    // Create indices
-    const std::vector<uint16_t> indices
-    {
-        0, 1, 2,
-        2, 3, 0
-    };
-    
-    // Create staging buffer and copy over data
-    TypedBuffer<uint16_t> indexStagingBuffer(device, physicalDevice, util::vecsizeof(indices), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT|VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-    indexStagingBuffer.memcpy(indices);
+    // Passes declare what they use and the graph places barriers between them, built once the swapchain is known
+    renderGraph = new RenderGraph(device, physicalDevice, deletionQueue);
+
+    // Optionally shade through a G-buffer kept in tile memory, so many lights cost one pass over the pixels, moving them on the compute queue meanwhile
+    asyncCompute = deferred ? new AsyncCompute(device, physicalDevice, bufferingStrategy) : nullptr;
+    deferredRenderer = deferred ? new DeferredRenderer(device, physicalDevice, descriptorSetLayout, VERTEX_LAYOUT, createLights(DEFERRED_LIGHTS_PER_SIDE), assetPack, bindless ? bindlessTable->getLayout() : nullptr, deletionQueue, asyncCompute) : nullptr;
+
+    // Time passes on the GPU, each frame in flight with its own queries
+    gpuProfiler = new GpuProfiler(device, physicalDevice, bufferingStrategy);
+
+    // Count vertex and fragment work of the main pass, to spot overdraw and wasted vertex shading
+    pipelineStatistics = new PipelineStatistics(device, physicalDevice, bufferingStrategy);
+    if (deferredRenderer != nullptr)
+        deferredRenderer->setStatistics(pipelineStatistics);
 
-    // Create index buffer and transfer data
-    indexBuffer = new TypedBuffer<uint16_t>(device, physicalDevice, util::vecsizeof(indices), VK_BUFFER_USAGE_TRANSFER_DST_BIT|VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-    indexBuffer->transfer(commandPool, device->getMainQueue(), indexStagingBuffer);
+    // Frame time distributions and counters, scraped from a Prometheus text file
+    frameMetrics = new FrameMetrics(METRICS_FILENAME, FrameMetrics::Prometheus, METRICS_SECONDS);
 }
 
 void Display::framebufferResizeCallback(GLFWwindow *window, int width, int height)
@@ -92,20 +186,37 @@ Display::~Display()
     // Wait until idle
     vkDeviceWaitIdle(device->getHandle());
 
-    // Destroy buffer
-    delete indexBuffer;
-    delete vertexBuffer;
+    // Export GPU timings gathered over the run
+    if (gpuProfiler->isSupported())
+        gpuProfiler->exportJson(GPU_PROFILE_FILENAME);
+    delete gpuProfiler;
+    delete pipelineStatistics;
+    delete frameMetrics;
+
+    // Destroy mesh
+    delete deferredRenderer;
+    delete asyncCompute;
+    delete renderGraph;
+    delete renderQueue;
+    delete residencyManager;
+    delete meshLoader;
+    delete fallbackMesh;
+    delete texture;
+    delete textureLoader;
 
     // Destroy Vulkan objects
     delete framePool;
     delete commandPool;
     delete swapchain;
+    delete deletionQueue;
+    delete bindlessTable;
     delete descriptorSetLayout;
     delete device;
     delete physicalDevice;
     delete surface;
     delete debugMessenger;
     delete instance;
+    delete assetPack;
 
     // Destroy GLFW window
     delete window;
@@ -113,9 +224,7 @@ Display::~Display()
 
 void Display::tick()
 {
-    // Record start time
-    static int ticks = 0;
-    static auto start = std::chrono::high_resolution_clock::now();
+    TRACE_ZONE("Display::tick");
 
     // Poll for GLFW input updates
     glfwPollEvents();
@@ -123,13 +232,34 @@ void Display::tick()
     // Draw frame
     drawFrame();
 
-    // Display framerate
-    ticks++;
-    if (ticks%5000==0)
+    // Dump CPU zones on demand, once per press
+    bool const traceKey = glfwGetKey(window->getHandle(), GLFW_KEY_F12) == GLFW_PRESS;
+    if (traceKey && !traceKeyDown)
+    {
+        cpuTrace::dump(CPU_TRACE_FILENAME);
+        std::cout << "CPU trace written to " << CPU_TRACE_FILENAME << "." << std::endl;
+    }
+    traceKeyDown = traceKey;
+
+    // Report frame time percentiles each metrics interval, once exported
+    if (frameMetrics->update())
     {
-        auto now = std::chrono::high_resolution_clock::now();
-        long long nano = std::chrono::duration_cast<std::chrono::nanoseconds>(now-start).count();
-        std::cout << "Framerate: " << std::floor(ticks/(nano/1000000000.0)) << "Hz." << std::endl;
+        for (int series=0; series<FrameMetrics::SERIES_COUNT; series++)
+        {
+            FrameMetrics::Summary const summary = frameMetrics->getSummary(static_cast<FrameMetrics::Series>(series));
+            std::cout << FrameMetrics::getName(static_cast<FrameMetrics::Series>(series)) << ": " << summary.p50Ms << "ms p50, " << summary.p95Ms << "ms p95, "
+                      << summary.p99Ms << "ms p99, " << summary.maxMs << "ms max over " << summary.frames << " frames." << std::endl;
+        }
+        uint64_t const frames = std::max<uint64_t>(frameMetrics->getSummary(FrameMetrics::CpuTime).frames, 1);
+        std::cout << frameMetrics->getStutters() << " stutters, " << frameMetrics->getCounter(counters::Draws) / frames << " draws and "
+                  << renderQueue->getStatistics().bindsAvoided << " binds avoided per frame." << std::endl;
+        for (GpuProfiler::Result const &result : gpuProfiler->getResults())
+            std::cout << std::string(2 + 2*result.depth, ' ') << result.name << ": " << result.averageMs << "ms average, " << result.maxMs << "ms max." << std::endl;
+        for (PipelineStatistics::Result const &result : pipelineStatistics->getResults())
+            std::cout << "  " << result.name << " pass: " << result.statistics[PipelineStatistics::VertexInvocations] << " vertex and "
+                      << result.statistics[PipelineStatistics::FragmentInvocations] << " fragment invocations, " << result.getOverdraw() << "x overdraw, "
+                      << result.statistics[PipelineStatistics::ClippingPrimitives] << " of " << result.statistics[PipelineStatistics::ClippingInvocations] << " primitives past clipping." << std::endl;
+        frameMetrics->reset();
     }
 }
 
@@ -140,17 +270,31 @@ bool Display::shouldClose() const
 
 void Display::drawFrame()
 {
+    TRACE_ZONE("Display::drawFrame");
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point const frameStart = Clock::now();
+
     // Get next frame and wait till ready
     Frame &frame = framePool->nextFrame();
     frame.waitForReady(device);
+    deletionQueue->collect(frameIndex);
+
+    // Take in meshes that finished streaming and evict what the finished frames left over budget, then mark the mesh used by this frame, drawing the fallback while an evicted one streams back
+    if (residencyManager != nullptr)
+    {
+        residencyManager->collect(frameIndex);
+        mesh = residencyManager->acquire(meshName, frameIndex);
+    }
+    Clock::duration blocked = Clock::now() - frameStart;
 
     // Update uniforms
     static auto startTime = std::chrono::high_resolution_clock::now();
     auto currentTime = std::chrono::high_resolution_clock::now();
     float deltaTime = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
+    glm::mat4 model = glm::rotate(glm::mat4(1.0f), deltaTime * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
     UniformObject uniform
     {
-        .model = glm::rotate(glm::mat4(1.0f), deltaTime * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f)),
+        .model = model * mesh->getDequantizationTransform(),
         .view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f)),
         .proj = glm::perspective(glm::radians(45.0f), swapchain->getExtent().width / (float) swapchain->getExtent().height, 0.1f, 10.0f)
     };
@@ -158,35 +302,101 @@ void Display::drawFrame()
     frame.updateUniform(uniform);
 
     // Acquire valid image from swapchain
+    Clock::time_point const acquireStart = Clock::now();
     Image image = swapchain->acquireNextImage(frame, framebufferResized, physicalDevice, window, surface, descriptorSetLayout);
+    blocked += Clock::now() - acquireStart;
+
+    // Recreating the swapchain replaces its depth attachment, and may change the extent and format the graph or deferred pass was built for
+    Pipeline const *pipeline = swapchain->getPipeline();
+    VkSemaphore computeFinished = VK_NULL_HANDLE;
+    if (deferredRenderer != nullptr)
+    {
+        computeFinished = deferredRenderer->animate(frameIndex, deltaTime);
+        deferredRenderer->prepare(swapchain);
+        pipeline = deferredRenderer->getGeometryPipeline();
+    }
+    else
+    {
+        if (swapchain->getDepthAttachment()->getImageView() != graphDepthView)
+            buildRenderGraph();
+        renderGraph->setImage(backbuffer, image.image, image.imageView);
+        renderGraph->setImage(depth, swapchain->getDepthAttachment()->getImage(), swapchain->getDepthAttachment()->getImageView());
+    }
+
+    // Queue opaque draws at their projected-error LOD and sort by state then depth, after acquiring as that may rebuild the pipeline
+    renderQueue->clear();
+    renderQueue->submit(0, RenderQueue::Draw
+    {
+        .pipeline = pipeline,
+        .material = frame.getDescriptorSet(),
+        .uniforms = &frame.getUniformBuffer(),
+        .mesh = mesh,
+        .lod = LodSelector(uniform.proj, swapchain->getExtent()).select(mesh, uniform.view * model),
+        .constants
+        {
+            .model = model * mesh->getDequantizationTransform(),
+            .objectId = 0,
+            .textureIndex = textureIndex,
+            .normalMatrix = DrawConstants::getNormalMatrix(model)
+        }
+    }, uniform.view * model);
+    renderQueue->sort();
 
     // Record commands into command buffer
     frame.getCommandBuffer().record([&](VkCommandBuffer const &commandBuffer)
     {
-        swapchain->getRenderPass()->run(swapchain, image, commandBuffer, [&]()
-        {
-            // Bind graphics pipeline with relevant shaders
-            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, swapchain->getPipeline()->getHandle());
+        TRACE_ZONE("Display::record");
+        gpuProfiler->beginFrame(commandBuffer);
+        pipelineStatistics->beginFrame(commandBuffer);
+        gpuProfiler->beginScope(commandBuffer, "Render pass");
+        if (deferredRenderer != nullptr)
+            deferredRenderer->run(image, frame, commandBuffer, [&]() { recordOpaque(commandBuffer, pipeline); });
+        else
+            renderGraph->execute(commandBuffer);
+        gpuProfiler->endScope(commandBuffer);
+        gpuProfiler->endFrame(commandBuffer);
+    });
 
-            // Bind vertex buffers
-            std::vector<VkBuffer> vertexBuffers { vertexBuffer->getHandle() };
-            std::vector<VkDeviceSize> vertexOffsets   { vertexBuffer->getOffset() };
-            vkCmdBindVertexBuffers(commandBuffer, 0, vertexBuffers.size(), vertexBuffers.data(), vertexOffsets.data());
+    // Submit command buffer to main queue, lighting waiting on the lights moved by compute
+    device->getMainQueue().drawSubmit(device, frame, computeFinished, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    
+    // Present image
+    device->getMainQueue().present(swapchain, frame, image);
 
-            // Bind index buffer
-            vkCmdBindIndexBuffer(commandBuffer, indexBuffer->getHandle(), 0, VK_INDEX_TYPE_UINT16);
+    // CPU time leaves out blocking on the fence and acquire, GPU time lags by the frames in flight
+    Clock::time_point const presentTime = Clock::now();
+    double const cpuMs = std::chrono::duration<double, std::milli>(presentTime - frameStart - blocked).count();
+    double const intervalMs = lastPresent == Clock::time_point{} ? -1.0 : std::chrono::duration<double, std::milli>(presentTime - lastPresent).count();
+    frameMetrics->recordFrame(cpuMs, gpuProfiler->getFrameMs(), intervalMs);
+    lastPresent = presentTime;
+    frameIndex++;
+}
+
+void Display::buildRenderGraph()
+{
+    TRACE_ZONE("Display::buildRenderGraph");
+    Attachment const *depthAttachment = swapchain->getDepthAttachment();
+    graphDepthView = depthAttachment->getImageView();
+    renderGraph->reset();
 
-            // Bind uniform
-            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, swapchain->getPipeline()->getLayout(), 0, 1, &frame.getDescriptorSet().getHandle(), 0, nullptr);
+    // The swapchain image is presented afterwards, while depth is only needed within the frame
+    backbuffer = renderGraph->importImage("Backbuffer", swapchain->getRenderPass()->getFormat(), swapchain->getExtent(), VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+    depth = renderGraph->importImage("Depth", depthAttachment->getFormat(), swapchain->getExtent(), VK_IMAGE_ASPECT_DEPTH_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_UNDEFINED);
 
-            // Draw triangles
-            vkCmdDrawIndexed(commandBuffer, indexBuffer->getNElements(), 1, 0, 0, 0);
-        });
+    renderGraph->addPass("Main", { { backbuffer, RenderGraph::ColourAttachment }, { depth, RenderGraph::DepthAttachment } }, [this](VkCommandBuffer const &commandBuffer)
+    {
+        recordOpaque(commandBuffer, swapchain->getPipeline());
     });
+    renderGraph->setStatistics(pipelineStatistics);
+    renderGraph->compile();
+}
 
-    // Submit command buffer to main queue
-    device->getMainQueue().drawSubmit(device, frame);
-    
-    // Present image
-    device->getMainQueue().present(swapchain, frame, image);
+void Display::recordOpaque(VkCommandBuffer const &commandBuffer, Pipeline const *pipeline)
+{
+    // Bind the bindless table once, it stays bound across pipelines sharing its set index
+    if (bindlessTable != nullptr)
+        bindlessTable->bind(commandBuffer, pipeline->getLayout(), 1);
+
+    // Bind pipelines, uniforms and buffers only where they change, and draw
+    renderQueue->record(commandBuffer);
 }
@@ -5,16 +5,35 @@
 #include "command/commandPool.hpp"
 #include "configuration/physicalDevice.hpp"
 #include "memory/descriptorSet.hpp"
+#include "memory/descriptorAllocator.hpp"
 #include "utility/check.hpp"
+#include "profiling/cpuTrace.hpp"
 
-Frame::Frame(Device const *device, CommandPool *commandPool, PhysicalDevice const *physicalDevice, DescriptorSet &descriptorSet)
+VkPushConstantRange DrawConstants::getRange()
+{
+    return VkPushConstantRange
+    {
+        .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+        .offset = 0,
+        .size = sizeof(DrawConstants)
+    };
+}
+
+glm::mat3x4 DrawConstants::getNormalMatrix(glm::mat4 const &model)
+{
+    return glm::mat3x4(glm::transpose(glm::inverse(glm::mat3(model))));
+}
+
+Frame::Frame(Device const *device, CommandPool *commandPool, PhysicalDevice const *physicalDevice, DescriptorAllocator *descriptorAllocator, DescriptorSetLayout const *descriptorSetLayout)
   : device(device),
     commandBuffer(commandPool->allocateNewBuffer()),
     uniformObjectBuffer(device, physicalDevice, sizeof(UniformObject), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT|VK_MEMORY_PROPERTY_HOST_COHERENT_BIT),
-    descriptorSet(descriptorSet)
+    descriptorSet(nullptr),
+    transientDescriptors(new DescriptorAllocator(device))
 {
-    // Link descriptor set and buffer
-    descriptorSet.bindToBuffer(device, uniformObjectBuffer);
+    // Get a set linked to the uniform buffer, unless the buffer is pushed at record time instead
+    if (descriptorAllocator != nullptr)
+        descriptorSet = descriptorAllocator->get(descriptorSetLayout, { DescriptorAllocator::Binding::ofBuffer(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, uniformObjectBuffer) });
 
     // Create sync objects
     static VkSemaphoreCreateInfo semaphoreInfo
@@ -38,8 +57,10 @@ Frame::Frame(Frame &&old)
     renderFinishedSemaphore(old.renderFinishedSemaphore),
     inFlightFence(old.inFlightFence),
     uniformObjectBuffer(std::move(old.uniformObjectBuffer)),
-    descriptorSet(old.descriptorSet)
+    descriptorSet(old.descriptorSet),
+    transientDescriptors(old.transientDescriptors)
 {
+    old.transientDescriptors = nullptr;
     old.imageAvailableSemaphore = VK_NULL_HANDLE;
     old.renderFinishedSemaphore = VK_NULL_HANDLE;
     old.inFlightFence = VK_NULL_HANDLE;
@@ -50,6 +71,7 @@ Frame::~Frame()
     vkDestroySemaphore(device->getHandle(), renderFinishedSemaphore, nullptr);
     vkDestroySemaphore(device->getHandle(), imageAvailableSemaphore, nullptr);
     vkDestroyFence(device->getHandle(), inFlightFence, nullptr);
+    delete transientDescriptors;
 }
 
 CommandBuffer const &Frame::getCommandBuffer() const
@@ -77,18 +99,33 @@ VkFence const &Frame::getInFlightFence() const
     return inFlightFence;
 }
 
-DescriptorSet const &Frame::getDescriptorSet() const
+DescriptorSet const *Frame::getDescriptorSet() const
 {
     return descriptorSet;
 }
 
-void Frame::waitForReady(Device const *device) const
+TypedBuffer<UniformObject> const &Frame::getUniformBuffer() const
 {
+    return uniformObjectBuffer;
+}
+
+DescriptorAllocator &Frame::getTransientDescriptors()
+{
+    return *transientDescriptors;
+}
+
+void Frame::waitForReady(Device const *device)
+{
+    TRACE_ZONE("Frame::waitForReady");
     vkWaitForFences(device->getHandle(), 1, &inFlightFence, VK_TRUE, UINT64_MAX);
+
+    // The GPU is done with this frame's previous use, so its transient sets can all be recycled
+    transientDescriptors->reset();
 }
 
 void Frame::updateUniform(UniformObject const &uniform)
 {
+    TRACE_ZONE("Frame::updateUniform");
     std::vector<UniformObject> data { uniform };
     uniformObjectBuffer.memcpy(data);
 }
@@ -4,13 +4,21 @@
 #include "configuration/device.hpp"
 #include "configuration/physicalDevice.hpp"
 #include "command/commandPool.hpp"
+#include "memory/descriptorSetLayout.hpp"
 
 FramePool::FramePool(Device const *device, CommandPool *commandPool, PhysicalDevice const *physicalDevice, int nFrames, DescriptorSetLayout const *descriptorSetLayout)
-    : descriptorPool(device, nFrames, descriptorSetLayout)
 {
+    // Long-lived sets shared by the frames, push descriptor layouts have none to allocate
+    descriptorAllocator = descriptorSetLayout->isPushDescriptor() ? nullptr : new DescriptorAllocator(device, nFrames);
+
     frames.reserve(nFrames);
     for (int i=0; i<nFrames; i++)
-        frames.push_back(Frame(device, commandPool, physicalDevice, descriptorPool.getDescriptorSets()[i]));
+        frames.push_back(Frame(device, commandPool, physicalDevice, descriptorAllocator, descriptorSetLayout));
+}
+
+FramePool::~FramePool()
+{
+    delete descriptorAllocator;
 }
 
 Frame &FramePool::nextFrame()
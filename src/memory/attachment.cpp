@@ -0,0 +1,101 @@
+
+#include "memory/attachment.hpp"
+
+#include "configuration/device.hpp"
+#include "configuration/physicalDevice.hpp"
+#include "utility/check.hpp"
+
+Attachment::Attachment
+(
+    Device const *device, PhysicalDevice const *physicalDevice, VkFormat const &format, VkExtent2D const &extent,
+    VkImageUsageFlags const &usage, VkImageAspectFlags const &aspect
+) : device(device), format(format), extent(extent)
+{
+    // Create image
+    VkImageCreateInfo imageInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .imageType = VK_IMAGE_TYPE_2D,
+        .format = format,
+        .extent = { extent.width, extent.height, 1 },
+        .mipLevels = 1,
+        .arrayLayers = 1,
+        .samples = VK_SAMPLE_COUNT_1_BIT,
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .usage = usage,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
+    };
+    check::fail( vkCreateImage(device->getHandle(), &imageInfo, nullptr, &image), "vkCreateImage failed." );
+
+    // Allocate and bind memory, lazily where supported for transient attachments that never leave tile memory
+    VkMemoryRequirements memoryRequirements;
+    vkGetImageMemoryRequirements(device->getHandle(), image, &memoryRequirements);
+    VkMemoryPropertyFlags const preferred = (usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT) ? VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT : 0;
+    VkMemoryAllocateInfo allocInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .allocationSize = memoryRequirements.size,
+        .memoryTypeIndex = physicalDevice->findMemoryType(memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, preferred)
+    };
+    check::fail( vkAllocateMemory(device->getHandle(), &allocInfo, nullptr, &memory), "vkAllocateMemory failed." );
+    vkBindImageMemory(device->getHandle(), image, memory, 0);
+
+    // Create image view
+    VkImageViewCreateInfo viewInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+        .image = image,
+        .viewType = VK_IMAGE_VIEW_TYPE_2D,
+        .format = format,
+        .subresourceRange
+        {
+            .aspectMask = aspect,
+            .baseMipLevel = 0,
+            .levelCount = 1,
+            .baseArrayLayer = 0,
+            .layerCount = 1
+        }
+    };
+    check::fail( vkCreateImageView(device->getHandle(), &viewInfo, nullptr, &imageView), "vkCreateImageView failed." );
+}
+
+Attachment::Attachment(Attachment &&old)
+  : device(old.device),
+    image(old.image),
+    memory(old.memory),
+    imageView(old.imageView),
+    format(old.format),
+    extent(old.extent)
+{
+    old.image = VK_NULL_HANDLE;
+    old.memory = VK_NULL_HANDLE;
+    old.imageView = VK_NULL_HANDLE;
+}
+
+Attachment::~Attachment()
+{
+    vkDestroyImageView(device->getHandle(), imageView, nullptr);
+    vkDestroyImage(device->getHandle(), image, nullptr);
+    vkFreeMemory(device->getHandle(), memory, nullptr);
+}
+
+VkImage const &Attachment::getImage() const
+{
+    return image;
+}
+
+VkImageView const &Attachment::getImageView() const
+{
+    return imageView;
+}
+
+VkFormat const &Attachment::getFormat() const
+{
+    return format;
+}
+
+VkExtent2D const &Attachment::getExtent() const
+{
+    return extent;
+}
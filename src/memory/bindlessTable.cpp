@@ -0,0 +1,168 @@
+
+#include "memory/bindlessTable.hpp"
+
+#include "configuration/device.hpp"
+#include "configuration/physicalDevice.hpp"
+#include "memory/descriptorSetLayout.hpp"
+#include "memory/voidBuffer.hpp"
+#include "memory/deletionQueue.hpp"
+#include "utility/check.hpp"
+
+#include <algorithm>
+
+uint32_t BindlessTable::Slots::acquire()
+{
+    if (!freed.empty())
+    {
+        uint32_t index = freed.back();
+        freed.pop_back();
+        return index;
+    }
+    if (next == capacity)
+        throw std::exception("Bindless table full.");
+    return next++;
+}
+
+void BindlessTable::Slots::release(uint32_t index)
+{
+    freed.push_back(index);
+}
+
+BindlessTable::BindlessTable(Device const *device, PhysicalDevice const *physicalDevice, DeletionQueue *deletionQueue, uint32_t imageCapacity, uint32_t bufferCapacity) : device(device), deletionQueue(deletionQueue)
+{
+    // Fit within what the device allows a stage to see through update-after-bind sets
+    VkPhysicalDeviceDescriptorIndexingPropertiesEXT const &limits = physicalDevice->getDescriptorIndexingProperties();
+    images.capacity = std::min(imageCapacity, limits.maxPerStageDescriptorUpdateAfterBindSampledImages);
+    buffers.capacity = std::min(bufferCapacity, limits.maxPerStageDescriptorUpdateAfterBindStorageBuffers);
+
+    // Create layout of two partially bound arrays, updatable while in use
+    std::vector<VkDescriptorSetLayoutBinding> bindings
+    {
+        VkDescriptorSetLayoutBinding
+        {
+            .binding = IMAGE_BINDING,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount = images.capacity,
+            .stageFlags = VK_SHADER_STAGE_ALL
+        },
+        VkDescriptorSetLayoutBinding
+        {
+            .binding = BUFFER_BINDING,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = buffers.capacity,
+            .stageFlags = VK_SHADER_STAGE_ALL
+        }
+    };
+    VkDescriptorBindingFlagsEXT const bindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT;
+    layout = new DescriptorSetLayout(device, bindings, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT, { bindingFlags, bindingFlags });
+
+    // Create pool holding just this set
+    std::vector<VkDescriptorPoolSize> poolSizes
+    {
+        { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, images.capacity },
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, buffers.capacity }
+    };
+    VkDescriptorPoolCreateInfo poolInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT,
+        .maxSets = 1,
+        .poolSizeCount = static_cast<uint32_t>(poolSizes.size()),
+        .pPoolSizes = poolSizes.data()
+    };
+    check::fail( vkCreateDescriptorPool(device->getHandle(), &poolInfo, nullptr, &pool), "vkCreateDescriptorPool failed." );
+
+    // Allocate set
+    VkDescriptorSetAllocateInfo allocInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool = pool,
+        .descriptorSetCount = 1,
+        .pSetLayouts = &layout->getHandle()
+    };
+    check::fail( vkAllocateDescriptorSets(device->getHandle(), &allocInfo, &set), "vkAllocateDescriptorSets failed." );
+}
+
+BindlessTable::~BindlessTable()
+{
+    vkDestroyDescriptorPool(device->getHandle(), pool, nullptr);
+    delete layout;
+}
+
+DescriptorSetLayout const *BindlessTable::getLayout() const
+{
+    return layout;
+}
+
+VkDescriptorSet const &BindlessTable::getSet() const
+{
+    return set;
+}
+
+uint32_t BindlessTable::addImage(VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout)
+{
+    uint32_t index = images.acquire();
+    VkDescriptorImageInfo imageInfo
+    {
+        .sampler = sampler,
+        .imageView = imageView,
+        .imageLayout = imageLayout
+    };
+    VkWriteDescriptorSet descriptorWrite
+    {
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .dstSet = set,
+        .dstBinding = IMAGE_BINDING,
+        .dstArrayElement = index,
+        .descriptorCount = 1,
+        .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        .pImageInfo = &imageInfo
+    };
+    vkUpdateDescriptorSets(device->getHandle(), 1, &descriptorWrite, 0, nullptr);
+    return index;
+}
+
+uint32_t BindlessTable::addBuffer(VoidBuffer const &buffer, VkDeviceSize offset, VkDeviceSize range)
+{
+    uint32_t index = buffers.acquire();
+    VkDescriptorBufferInfo bufferInfo
+    {
+        .buffer = buffer.getHandle(),
+        .offset = offset,
+        .range = range
+    };
+    VkWriteDescriptorSet descriptorWrite
+    {
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .dstSet = set,
+        .dstBinding = BUFFER_BINDING,
+        .dstArrayElement = index,
+        .descriptorCount = 1,
+        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .pBufferInfo = &bufferInfo
+    };
+    vkUpdateDescriptorSets(device->getHandle(), 1, &descriptorWrite, 0, nullptr);
+    return index;
+}
+
+void BindlessTable::removeImage(uint32_t index)
+{
+    // Rewriting the slot while pending frames index it would have them read the new resource
+    if (deletionQueue != nullptr)
+        deletionQueue->retire([this, index]() { images.release(index); });
+    else
+        images.release(index);
+}
+
+void BindlessTable::removeBuffer(uint32_t index)
+{
+    if (deletionQueue != nullptr)
+        deletionQueue->retire([this, index]() { buffers.release(index); });
+    else
+        buffers.release(index);
+}
+
+void BindlessTable::bind(VkCommandBuffer const &commandBuffer, VkPipelineLayout const &pipelineLayout, uint32_t setIndex, VkPipelineBindPoint bindPoint) const
+{
+    vkCmdBindDescriptorSets(commandBuffer, bindPoint, pipelineLayout, setIndex, 1, &set, 0, nullptr);
+}
@@ -0,0 +1,42 @@
+
+#include "memory/deletionQueue.hpp"
+
+#include "profiling/cpuTrace.hpp"
+
+DeletionQueue::DeletionQueue(int framesInFlight) : framesInFlight(framesInFlight)
+{ }
+
+DeletionQueue::~DeletionQueue()
+{
+    flush();
+}
+
+void DeletionQueue::collect(uint64_t frame)
+{
+    TRACE_ZONE("DeletionQueue::collect");
+    this->frame = frame;
+
+    // Entries are in frame order, so stop at the first that a frame in flight may still use
+    while (!entries.empty() && entries.front().frame + framesInFlight <= frame)
+    {
+        entries.front().destroy();
+        entries.pop_front();
+    }
+}
+
+void DeletionQueue::retire(std::function<void()> destroy)
+{
+    entries.push_back(Entry{ .frame = frame, .destroy = std::move(destroy) });
+}
+
+void DeletionQueue::flush()
+{
+    for (Entry &entry : entries)
+        entry.destroy();
+    entries.clear();
+}
+
+size_t DeletionQueue::getPending() const
+{
+    return entries.size();
+}
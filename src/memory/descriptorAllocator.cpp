@@ -0,0 +1,180 @@
+
+#include "memory/descriptorAllocator.hpp"
+
+#include "configuration/device.hpp"
+#include "memory/descriptorSetLayout.hpp"
+#include "memory/voidBuffer.hpp"
+#include "utility/check.hpp"
+#include "utility/util.hpp"
+
+#include <algorithm>
+
+std::vector<VkDescriptorPoolSize> const DescriptorAllocator::DEFAULT_SIZES
+{
+    { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2 },
+    { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1 },
+    { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2 },
+    { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4 },
+    { VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 4 }
+};
+
+DescriptorAllocator::Binding DescriptorAllocator::Binding::ofBuffer(uint32_t binding, VkDescriptorType type, VoidBuffer const &buffer, VkDeviceSize offset, VkDeviceSize range)
+{
+    return Binding{ .binding = binding, .type = type, .buffer = { buffer.getHandle(), offset, range }, .image = {} };
+}
+
+DescriptorAllocator::Binding DescriptorAllocator::Binding::ofImage(uint32_t binding, VkDescriptorType type, VkImageView imageView, VkSampler sampler, VkImageLayout layout)
+{
+    return Binding{ .binding = binding, .type = type, .buffer = {}, .image = { sampler, imageView, layout } };
+}
+
+bool DescriptorAllocator::Binding::operator==(Binding const &other) const
+{
+    return binding == other.binding && type == other.type
+        && buffer.buffer == other.buffer.buffer && buffer.offset == other.buffer.offset && buffer.range == other.buffer.range
+        && image.sampler == other.image.sampler && image.imageView == other.image.imageView && image.imageLayout == other.image.imageLayout;
+}
+
+DescriptorAllocator::DescriptorAllocator(Device const *device, uint32_t setsPerPool, std::vector<VkDescriptorPoolSize> const &sizesPerSet)
+    : device(device), sizesPerSet(sizesPerSet), setsPerPool(setsPerPool)
+{ }
+
+DescriptorAllocator::~DescriptorAllocator()
+{
+    for (VkDescriptorPool pool : usedPools)
+        vkDestroyDescriptorPool(device->getHandle(), pool, nullptr);
+    for (VkDescriptorPool pool : freePools)
+        vkDestroyDescriptorPool(device->getHandle(), pool, nullptr);
+}
+
+DescriptorSet DescriptorAllocator::allocate(DescriptorSetLayout const *layout)
+{
+    if (current == VK_NULL_HANDLE)
+        current = nextPool();
+
+    // Move on to a new pool whenever the current one runs out
+    VkDescriptorSetAllocateInfo allocInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool = current,
+        .descriptorSetCount = 1,
+        .pSetLayouts = &layout->getHandle()
+    };
+    VkDescriptorSet handle;
+    VkResult result = vkAllocateDescriptorSets(device->getHandle(), &allocInfo, &handle);
+    if (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL)
+    {
+        current = nextPool();
+        allocInfo.descriptorPool = current;
+        result = vkAllocateDescriptorSets(device->getHandle(), &allocInfo, &handle);
+    }
+    check::fail(result, "vkAllocateDescriptorSets failed.");
+
+    statistics.allocations++;
+    return DescriptorSet(handle);
+}
+
+DescriptorSet const *DescriptorAllocator::get(DescriptorSetLayout const *layout, std::vector<Binding> const &bindings)
+{
+    // Hash layout and every bound resource
+    size_t hash = 0;
+    util::hashCombine(hash, layout->getHandle());
+    for (Binding const &binding : bindings)
+    {
+        util::hashCombine(hash, binding.binding);
+        util::hashCombine(hash, binding.type);
+        util::hashCombine(hash, binding.buffer.buffer);
+        util::hashCombine(hash, binding.buffer.offset);
+        util::hashCombine(hash, binding.buffer.range);
+        util::hashCombine(hash, binding.image.sampler);
+        util::hashCombine(hash, binding.image.imageView);
+        util::hashCombine(hash, binding.image.imageLayout);
+    }
+
+    // Reuse an identical set
+    auto [begin, end] = cache.equal_range(hash);
+    for (auto it=begin; it!=end; it++)
+        if (it->second.layout == layout->getHandle() && it->second.bindings == bindings)
+        {
+            statistics.cacheHits++;
+            return &it->second.set;
+        }
+
+    // Otherwise allocate and write one
+    statistics.cacheMisses++;
+    DescriptorSet set = allocate(layout);
+    std::vector<VkWriteDescriptorSet> writes;
+    writes.reserve(bindings.size());
+    for (Binding const &binding : bindings)
+    {
+        bool const isImage = binding.image.imageView != VK_NULL_HANDLE || binding.image.sampler != VK_NULL_HANDLE;
+        writes.push_back(VkWriteDescriptorSet
+        {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = set.getHandle(),
+            .dstBinding = binding.binding,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = binding.type,
+            .pImageInfo = isImage ? &binding.image : nullptr,
+            .pBufferInfo = isImage ? nullptr : &binding.buffer
+        });
+    }
+    vkUpdateDescriptorSets(device->getHandle(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    auto it = cache.emplace(hash, CacheEntry{ .layout = layout->getHandle(), .bindings = bindings, .set = set });
+    return &it->second.set;
+}
+
+void DescriptorAllocator::reset()
+{
+    // Recycle every pool handed out since the last reset
+    if (current != VK_NULL_HANDLE)
+        usedPools.push_back(current);
+    for (VkDescriptorPool pool : usedPools)
+    {
+        vkResetDescriptorPool(device->getHandle(), pool, 0);
+        freePools.push_back(pool);
+    }
+    usedPools.clear();
+    current = VK_NULL_HANDLE;
+    cache.clear();
+}
+
+DescriptorAllocator::Statistics const &DescriptorAllocator::getStatistics() const
+{
+    return statistics;
+}
+
+VkDescriptorPool DescriptorAllocator::createPool()
+{
+    // Budget each descriptor type for a full pool of sets
+    std::vector<VkDescriptorPoolSize> poolSizes = sizesPerSet;
+    for (VkDescriptorPoolSize &poolSize : poolSizes)
+        poolSize.descriptorCount *= setsPerPool;
+    VkDescriptorPoolCreateInfo poolInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .maxSets = setsPerPool,
+        .poolSizeCount = static_cast<uint32_t>(poolSizes.size()),
+        .pPoolSizes = poolSizes.data()
+    };
+    VkDescriptorPool pool;
+    check::fail( vkCreateDescriptorPool(device->getHandle(), &poolInfo, nullptr, &pool), "vkCreateDescriptorPool failed." );
+
+    // Grow later pools so long-running demand settles on few of them
+    setsPerPool = std::min(setsPerPool*2, MAX_SETS_PER_POOL);
+    statistics.pools++;
+    return pool;
+}
+
+VkDescriptorPool DescriptorAllocator::nextPool()
+{
+    // Retire the exhausted pool and prefer a recycled one over creating another
+    if (current != VK_NULL_HANDLE)
+        usedPools.push_back(current);
+    if (freePools.empty())
+        return createPool();
+    VkDescriptorPool pool = freePools.back();
+    freePools.pop_back();
+    return pool;
+}
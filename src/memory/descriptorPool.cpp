@@ -5,12 +5,12 @@
 #include "memory/descriptorSetLayout.hpp"
 #include "utility/check.hpp"
 
-DescriptorPool::DescriptorPool(Device const *device, int nDescriptorSets, DescriptorSetLayout const *descriptorSetLayout) : device(device)
+DescriptorPool::DescriptorPool(Device const *device, int nDescriptorSets, DescriptorSetLayout const *descriptorSetLayout, VkDescriptorType const &type) : device(device)
 {
     // Create pool
     VkDescriptorPoolSize poolSize
     {
-        poolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+        poolSize.type = type,
         poolSize.descriptorCount = static_cast<uint32_t>(nDescriptorSets)
     };
     VkDescriptorPoolCreateInfo poolInfo
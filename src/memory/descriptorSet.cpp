@@ -12,13 +12,13 @@ VkDescriptorSet const &DescriptorSet::getHandle() const
     return handle;
 }
 
-void DescriptorSet::bindToBuffer(Device const *device, VoidBuffer const &buffer)
+void DescriptorSet::bindToBuffer(Device const *device, VoidBuffer const &buffer, VkDescriptorType const &type, VkDeviceSize const &range)
 {
     VkDescriptorBufferInfo bufferInfo
     {
         .buffer = buffer.getHandle(),
         .offset = 0,
-        .range = buffer.getSize()
+        .range = range
     };
     VkWriteDescriptorSet descriptorWrite
     {
@@ -27,7 +27,7 @@ void DescriptorSet::bindToBuffer(Device const *device, VoidBuffer const &buffer)
         .dstBinding = 0,
         .dstArrayElement = 0,
         .descriptorCount = 1,
-        .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+        .descriptorType = type,
         .pBufferInfo = &bufferInfo
     };
     vkUpdateDescriptorSets(device->getHandle(), 1, &descriptorWrite, 0, nullptr);
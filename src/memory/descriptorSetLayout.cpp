@@ -4,20 +4,36 @@
 #include "configuration/device.hpp"
 #include "utility/check.hpp"
 
-DescriptorSetLayout::DescriptorSetLayout(Device const *device) : device(device)
-{
-    VkDescriptorSetLayoutBinding uboLayoutBinding
+DescriptorSetLayout::DescriptorSetLayout(Device const *device, VkDescriptorType const &type, VkDescriptorSetLayoutCreateFlags flags)
+    : DescriptorSetLayout(device, { VkDescriptorSetLayoutBinding
     {
         .binding = 0,
-        .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+        .descriptorType = type,
         .descriptorCount = 1,
         .stageFlags = VK_SHADER_STAGE_VERTEX_BIT
+    } }, flags)
+{ }
+
+DescriptorSetLayout::DescriptorSetLayout
+(
+    Device const *device, std::vector<VkDescriptorSetLayoutBinding> const &bindings, VkDescriptorSetLayoutCreateFlags flags,
+    std::vector<VkDescriptorBindingFlagsEXT> const &bindingFlags
+) : device(device), flags(flags)
+{
+    // Per-binding flags such as partially bound or update after bind, one per binding when given
+    VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT,
+        .bindingCount = static_cast<uint32_t>(bindingFlags.size()),
+        .pBindingFlags = bindingFlags.data()
     };
     VkDescriptorSetLayoutCreateInfo layoutInfo
     {
         .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-        .bindingCount = 1,
-        .pBindings = &uboLayoutBinding
+        .pNext = bindingFlags.empty() ? nullptr : &bindingFlagsInfo,
+        .flags = flags,
+        .bindingCount = static_cast<uint32_t>(bindings.size()),
+        .pBindings = bindings.data()
     };
     check::fail( vkCreateDescriptorSetLayout(device->getHandle(), &layoutInfo, nullptr, &handle), "vkCreateDescriptorSetLayout" );
 };
@@ -31,3 +47,8 @@ VkDescriptorSetLayout const &DescriptorSetLayout::getHandle() const
 {
     return handle;
 }
+
+bool DescriptorSetLayout::isPushDescriptor() const
+{
+    return flags & VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
+}
@@ -6,23 +6,12 @@
 #include "command/commandBuffer.hpp"
 #include "configuration/queue.hpp"
 #include "utility/check.hpp"
-
-uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties, PhysicalDevice const *physicalDevice)
-{
-    VkPhysicalDeviceMemoryProperties memoryProperties;
-    vkGetPhysicalDeviceMemoryProperties(physicalDevice->getHandle(), &memoryProperties);
-
-    for (int i=0; i<memoryProperties.memoryTypeCount; i++)
-        if ( (typeFilter&(1<<i)) && ((memoryProperties.memoryTypes[i].propertyFlags&properties)==properties) )
-            return i;
-
-    throw std::exception("Failed to find suitable memory type.");
-}
+#include "profiling/counters.hpp"
 
 VoidBuffer::VoidBuffer
 (
     Device const *device, PhysicalDevice const *physicalDevice, VkDeviceSize const &size,
-    VkBufferUsageFlags const &usage, VkMemoryPropertyFlags const &properties
+    VkBufferUsageFlags const &usage, VkMemoryPropertyFlags const &properties, std::vector<uint32_t> const &queueFamilies
 ) : device(device), size(size)
 {
     // Create buffer
@@ -31,7 +20,9 @@ VoidBuffer::VoidBuffer
         .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
         .size = size,
         .usage = usage,
-        .sharingMode = VK_SHARING_MODE_EXCLUSIVE
+        .sharingMode = queueFamilies.size() > 1 ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = queueFamilies.size() > 1 ? static_cast<uint32_t>(queueFamilies.size()) : 0,
+        .pQueueFamilyIndices = queueFamilies.size() > 1 ? queueFamilies.data() : nullptr
     };
     check::fail( vkCreateBuffer(device->getHandle(), &bufferInfo, nullptr, &handle), "vkCreateBuffer failed." );
 
@@ -44,7 +35,7 @@ VoidBuffer::VoidBuffer
     {
         .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
         .allocationSize = memoryRequirements.size,
-        .memoryTypeIndex = findMemoryType(memoryRequirements.memoryTypeBits, properties, physicalDevice)
+        .memoryTypeIndex = physicalDevice->findMemoryType(memoryRequirements.memoryTypeBits, properties)
     };
     check::fail( vkAllocateMemory(device->getHandle(), &allocInfo, nullptr, &memory), "vkAllocateMemory failed." );
 
@@ -92,6 +83,18 @@ void VoidBuffer::memcpy(size_t sourceDataSize, void const *sourceData)
     vkUnmapMemory(device->getHandle(), memory);
 }
 
+void *VoidBuffer::map()
+{
+    void *deviceData;
+    check::fail( vkMapMemory(device->getHandle(), memory, 0, VK_WHOLE_SIZE, 0, &deviceData), "vkMapMemory failed." );
+    return deviceData;
+}
+
+void VoidBuffer::unmap()
+{
+    vkUnmapMemory(device->getHandle(), memory);
+}
+
 void VoidBuffer::transfer(CommandPool *commandPool, Queue queue, VoidBuffer const &sourceBuffer)
 {
     // Create one-use command buffer
@@ -100,8 +103,7 @@ void VoidBuffer::transfer(CommandPool *commandPool, Queue queue, VoidBuffer cons
     // Record transfer command
     transferCommandBuffer.record([&](VkCommandBuffer const &commandBuffer)
     {
-        VkBufferCopy copyRegion { .size = sourceBuffer.size };
-        vkCmdCopyBuffer(commandBuffer, sourceBuffer.getHandle(), handle, 1, &copyRegion);
+        recordTransfer(commandBuffer, sourceBuffer);
     }, true);
 
     // Submit command buffer to main queue
@@ -110,3 +112,10 @@ void VoidBuffer::transfer(CommandPool *commandPool, Queue queue, VoidBuffer cons
     // Wait for transfer to finish before freeing command buffer - TODO: batch transfers together to avoid multiple waits
     vkQueueWaitIdle(queue.getHandle());
 }
+
+void VoidBuffer::recordTransfer(VkCommandBuffer const &commandBuffer, VoidBuffer const &sourceBuffer)
+{
+    VkBufferCopy copyRegion { .size = sourceBuffer.size };
+    vkCmdCopyBuffer(commandBuffer, sourceBuffer.getHandle(), handle, 1, &copyRegion);
+    counters::add(counters::BytesUploaded, copyRegion.size);
+}
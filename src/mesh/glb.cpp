@@ -0,0 +1,227 @@
+
+#include "mesh/glb.hpp"
+
+#include "utility/json.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+
+namespace
+{
+    uint32_t constexpr GLB_MAGIC = 0x46546C67;  // "glTF"
+    uint32_t constexpr CHUNK_JSON = 0x4E4F534A; // "JSON"
+    uint32_t constexpr CHUNK_BIN = 0x004E4942;  // "BIN\0"
+
+    enum ComponentType
+    {
+        Byte = 5120,
+        UnsignedByte = 5121,
+        Short = 5122,
+        UnsignedShort = 5123,
+        UnsignedInt = 5125,
+        Float = 5126
+    };
+
+    /** Strided view of one accessor's elements within the binary chunk */
+    struct Accessor
+    {
+        char const *data;
+        size_t stride;
+        uint32_t count;
+        int componentType;
+        int nComponents;
+        bool normalized;
+    };
+
+    size_t componentSize(int componentType)
+    {
+        switch (componentType)
+        {
+        case Byte: case UnsignedByte: return 1;
+        case Short: case UnsignedShort: return 2;
+        case UnsignedInt: case Float: return 4;
+        default: throw std::exception("glTF: unsupported component type.");
+        }
+    }
+
+    int componentCount(std::string const &type)
+    {
+        if (type == "SCALAR") return 1;
+        if (type == "VEC2") return 2;
+        if (type == "VEC3") return 3;
+        if (type == "VEC4") return 4;
+        throw std::exception("glTF: unsupported accessor type.");
+    }
+
+    /** Non-negative integer within 32 bits, as glTF indices, counts and offsets are, checked before any cast */
+    uint32_t toUnsigned(json::Value const &value, double fallback=0.0)
+    {
+        double const number = value.asNumber(fallback);
+        if (!(number >= 0.0 && number <= UINT32_MAX) || number != std::floor(number))
+            throw std::exception("glTF: expected a non-negative integer.");
+        return static_cast<uint32_t>(number);
+    }
+
+    /** Whether count strided elements at offset lie within size bytes, dividing rather than multiplying so crafted strides can't overflow */
+    bool fits(uint64_t offset, uint64_t count, uint64_t stride, uint64_t elementSize, uint64_t size)
+    {
+        if (offset > size)
+            return false;
+        if (count == 0)
+            return true;
+        return elementSize <= size - offset && (stride == 0 || count - 1 <= (size - offset - elementSize) / stride);
+    }
+
+    Accessor getAccessor(json::Value const &document, char const *bin, size_t binSize, json::Value const &index)
+    {
+        json::Value const &accessor = document["accessors"][toUnsigned(index, -1.0)];
+        if (accessor.type != json::Value::Object || !accessor.has("bufferView") || accessor.has("sparse"))
+            throw std::exception("glTF: unsupported or missing accessor.");
+        json::Value const &bufferView = document["bufferViews"][toUnsigned(accessor["bufferView"])];
+
+        // Resolve element layout
+        Accessor result
+        {
+            .count = toUnsigned(accessor["count"]),
+            .componentType = static_cast<int>(accessor["componentType"].asNumber()),
+            .nComponents = componentCount(accessor["type"].string),
+            .normalized = accessor["normalized"].boolean
+        };
+        size_t elementSize = componentSize(result.componentType) * result.nComponents;
+        result.stride = toUnsigned(bufferView["byteStride"], static_cast<double>(elementSize));
+        if (result.stride < elementSize)
+            throw std::exception("glTF: byte stride smaller than an element.");
+
+        // Bounds-check the view against the binary chunk, then the accessor against the view
+        uint64_t const viewOffset = toUnsigned(bufferView["byteOffset"]);
+        uint64_t const viewLength = toUnsigned(bufferView["byteLength"]);
+        uint64_t const offset = toUnsigned(accessor["byteOffset"]);
+        if (!fits(viewOffset, 1, 0, viewLength, binSize))
+            throw std::exception("glTF: buffer view exceeds buffer.");
+        if (!fits(offset, result.count, result.stride, elementSize, viewLength))
+            throw std::exception("glTF: accessor exceeds buffer view.");
+        result.data = bin + viewOffset + offset;
+        return result;
+    }
+
+    float readComponent(Accessor const &accessor, char const *element, int component)
+    {
+        switch (accessor.componentType)
+        {
+        case Float:
+        {
+            float value;
+            std::memcpy(&value, element + component*4, 4);
+            return value;
+        }
+        case UnsignedByte:
+        {
+            uint8_t value = reinterpret_cast<uint8_t const *>(element)[component];
+            return accessor.normalized ? value / 255.0f : value;
+        }
+        case UnsignedShort:
+        {
+            uint16_t value;
+            std::memcpy(&value, element + component*2, 2);
+            return accessor.normalized ? value / 65535.0f : value;
+        }
+        default:
+            throw std::exception("glTF: unsupported vertex component type.");
+        }
+    }
+
+    glm::vec3 readVec3(Accessor const &accessor, uint32_t index)
+    {
+        char const *element = accessor.data + index*accessor.stride;
+        return glm::vec3(readComponent(accessor, element, 0), readComponent(accessor, element, 1), readComponent(accessor, element, 2));
+    }
+
+    uint32_t readIndex(Accessor const &accessor, uint32_t index)
+    {
+        char const *element = accessor.data + index*accessor.stride;
+        switch (accessor.componentType)
+        {
+        case UnsignedByte: return reinterpret_cast<uint8_t const *>(element)[0];
+        case UnsignedShort: { uint16_t value; std::memcpy(&value, element, 2); return value; }
+        case UnsignedInt: { uint32_t value; std::memcpy(&value, element, 4); return value; }
+        default: throw std::exception("glTF: unsupported index component type.");
+        }
+    }
+}
+
+MeshData glb::parse(char const *data, size_t size)
+{
+    // Validate file header
+    uint32_t header[3];
+    if (size < sizeof(header))
+        throw std::exception("GLB truncated.");
+    std::memcpy(header, data, sizeof(header));
+    if (header[0] != GLB_MAGIC || header[1] != 2)
+        throw std::exception("Not a glTF 2.0 binary file.");
+
+    // Locate JSON and BIN chunks
+    char const *jsonChunk = nullptr, *bin = nullptr;
+    size_t jsonSize = 0, binSize = 0;
+    for (size_t offset=sizeof(header); offset+8 <= size; )
+    {
+        uint32_t chunkHeader[2];
+        std::memcpy(chunkHeader, data+offset, sizeof(chunkHeader));
+        if (offset + 8 + chunkHeader[0] > size)
+            throw std::exception("GLB chunk truncated.");
+        if (chunkHeader[1] == CHUNK_JSON && jsonChunk == nullptr)
+            jsonChunk = data+offset+8, jsonSize = chunkHeader[0];
+        else if (chunkHeader[1] == CHUNK_BIN && bin == nullptr)
+            bin = data+offset+8, binSize = chunkHeader[0];
+        offset += 8 + chunkHeader[0];
+    }
+    if (jsonChunk == nullptr || bin == nullptr)
+        throw std::exception("GLB missing JSON or BIN chunk.");
+    json::Value document = json::parse(jsonChunk, jsonSize);
+
+    // Merge triangle primitives of every mesh
+    MeshData meshData;
+    for (json::Value const &mesh : document["meshes"].array)
+        for (json::Value const &primitive : mesh["primitives"].array)
+        {
+            if (primitive["mode"].asNumber(4) != 4)
+                continue;
+
+            // Read vertices with normals, colouring by COLOR_0, then by normal, then white
+            json::Value const &attributes = primitive["attributes"];
+            Accessor positions = getAccessor(document, bin, binSize, attributes["POSITION"]);
+            bool hasColours = attributes.has("COLOR_0"), hasNormals = attributes.has("NORMAL");
+            Accessor colours = hasColours ? getAccessor(document, bin, binSize, attributes["COLOR_0"]) : positions;
+            Accessor normals = hasNormals ? getAccessor(document, bin, binSize, attributes["NORMAL"]) : positions;
+            if ((hasColours && colours.count < positions.count) || (hasNormals && normals.count < positions.count))
+                throw std::exception("glTF: attribute count mismatch.");
+            uint32_t const baseVertex = static_cast<uint32_t>(meshData.vertices.size());
+            meshData.vertices.reserve(baseVertex + positions.count);
+            for (uint32_t i=0; i<positions.count; i++)
+            {
+                glm::vec3 normal = hasNormals ? glm::normalize(readVec3(normals, i)) : glm::vec3(0.0f, 0.0f, 1.0f);
+                glm::vec3 colour = hasColours ? readVec3(colours, i) : hasNormals ? normal*0.5f + glm::vec3(0.5f) : glm::vec3(1.0f);
+                meshData.vertices.emplace_back(readVec3(positions, i), colour, normal);
+            }
+
+            // Read indices, or generate them for non-indexed primitives
+            if (primitive.has("indices"))
+            {
+                Accessor indices = getAccessor(document, bin, binSize, primitive["indices"]);
+                meshData.indices.reserve(meshData.indices.size() + indices.count);
+                for (uint32_t i=0; i<indices.count; i++)
+                {
+                    uint32_t index = readIndex(indices, i);
+                    if (index >= positions.count)
+                        throw std::exception("glTF: index out of range.");
+                    meshData.indices.push_back(baseVertex + index);
+                }
+            }
+            else
+                for (uint32_t i=0; i<positions.count; i++)
+                    meshData.indices.push_back(baseVertex + i);
+        }
+
+    return meshData;
+}
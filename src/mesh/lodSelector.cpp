@@ -0,0 +1,28 @@
+
+#include "mesh/lodSelector.hpp"
+
+#include "mesh/mesh.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+LodSelector::LodSelector(glm::mat4 const &proj, VkExtent2D const &viewportExtent, float pixelThreshold)
+    : pixelsPerUnit(std::abs(proj[1][1]) * viewportExtent.height * 0.5f), pixelThreshold(pixelThreshold)
+{ }
+
+uint32_t LodSelector::select(Mesh const *mesh, glm::mat4 const &modelView) const
+{
+    // Distance to the nearest point of the bounding sphere, in view space
+    MeshData::Bounds const &bounds = mesh->getBounds();
+    float scale = std::max({ glm::length(glm::vec3(modelView[0])), glm::length(glm::vec3(modelView[1])), glm::length(glm::vec3(modelView[2])) });
+    glm::vec3 centre = glm::vec3(modelView * glm::vec4(bounds.centre, 1.0f));
+    float distance = glm::length(centre) - bounds.radius*scale;
+    if (distance <= 0.0f)
+        return 0;
+
+    // Errors grow with level, so the first coarse level that fits is the answer
+    for (uint32_t level=mesh->getNLods()-1; level>0; level--)
+        if (mesh->getLod(level).error * scale / distance * pixelsPerUnit <= pixelThreshold)
+            return level;
+    return 0;
+}
@@ -0,0 +1,73 @@
+
+#include "mesh/mesh.hpp"
+
+#include "configuration/device.hpp"
+#include "configuration/physicalDevice.hpp"
+
+Mesh::Mesh
+(
+    Device const *device, PhysicalDevice const *physicalDevice, VertexLayout const &layout, quantize::Dequantization const &dequantization,
+    uint32_t nVertices, uint32_t nIndices, std::vector<MeshData::Lod> const &lods, MeshData::Bounds const &bounds
+) : layout(layout), dequantization(dequantization),
+    vertexBuffer(device, physicalDevice, nVertices*layout.getStride(), VK_BUFFER_USAGE_TRANSFER_DST_BIT|VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT),
+    indexBuffer(device, physicalDevice, nIndices*MeshData::getIndexSize(nVertices), VK_BUFFER_USAGE_TRANSFER_DST_BIT|VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT),
+    indexType(MeshData::getIndexSize(nVertices) == sizeof(uint16_t) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32),
+    lods(lods), bounds(bounds)
+{ }
+
+TypedBuffer<char> &Mesh::getVertexBuffer()
+{
+    return vertexBuffer;
+}
+
+TypedBuffer<char> &Mesh::getIndexBuffer()
+{
+    return indexBuffer;
+}
+
+VkIndexType Mesh::getIndexType() const
+{
+    return indexType;
+}
+
+VertexLayout const &Mesh::getLayout() const
+{
+    return layout;
+}
+
+glm::mat4 Mesh::getDequantizationTransform() const
+{
+    return dequantization.getTransform();
+}
+
+uint32_t Mesh::getNIndices() const
+{
+    return indexBuffer.getSize() / (indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t));
+}
+
+uint32_t Mesh::getNLods() const
+{
+    return static_cast<uint32_t>(lods.size());
+}
+
+MeshData::Lod const &Mesh::getLod(uint32_t level) const
+{
+    return lods[level];
+}
+
+MeshData::Bounds const &Mesh::getBounds() const
+{
+    return bounds;
+}
+
+VkDeviceSize Mesh::getSize() const
+{
+    return vertexBuffer.getSize() + indexBuffer.getSize();
+}
+
+void Mesh::bind(VkCommandBuffer const &commandBuffer) const
+{
+    VkDeviceSize vertexOffset = vertexBuffer.getOffset();
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer.getHandle(), &vertexOffset);
+    vkCmdBindIndexBuffer(commandBuffer, indexBuffer.getHandle(), indexBuffer.getOffset(), indexType);
+}
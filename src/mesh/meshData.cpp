@@ -0,0 +1,68 @@
+
+#include "mesh/meshData.hpp"
+
+#include "mesh/obj.hpp"
+#include "mesh/glb.hpp"
+#include "mesh/meshFormat.hpp"
+#include "utility/mappedFile.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+
+MeshData MeshData::parse(std::string const &filename)
+{
+    MappedFile file(filename);
+
+    // Choose parser by extension
+    if (filename.ends_with(".obj"))
+        return obj::parse(file.getData(), file.getSize());
+    if (filename.ends_with(".glb"))
+        return glb::parse(file.getData(), file.getSize());
+    if (filename.ends_with(".mesh"))
+        return meshFormat::deserialize(file.getData(), file.getSize());
+
+    throw std::exception("Unsupported mesh file extension.");
+}
+
+uint32_t MeshData::getIndexSize(uint64_t nVertices)
+{
+    return nVertices <= 0x10000 ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+void MeshData::writeIndices(void *destination) const
+{
+    // Narrow to 16 bits when every vertex is addressable
+    if (getIndexSize(vertices.size()) == sizeof(uint32_t))
+    {
+        std::memcpy(destination, indices.data(), indices.size()*sizeof(uint32_t));
+        return;
+    }
+    uint16_t *narrow = static_cast<uint16_t *>(destination);
+    for (size_t i=0; i<indices.size(); i++)
+        narrow[i] = static_cast<uint16_t>(indices[i]);
+}
+
+std::vector<MeshData::Lod> MeshData::getLods() const
+{
+    if (!lods.empty())
+        return lods;
+    return { Lod{ .firstIndex = 0, .nIndices = static_cast<uint32_t>(indices.size()), .error = 0.0f } };
+}
+
+MeshData::Bounds MeshData::computeBounds() const
+{
+    // Sphere around the box centre, loose but cheap and stable
+    if (vertices.empty())
+        return Bounds{ .centre = glm::vec3(0.0f), .radius = 0.0f };
+    glm::vec3 lower = vertices[0].position, upper = vertices[0].position;
+    for (Vertex const &vertex : vertices)
+    {
+        lower = glm::min(lower, vertex.position);
+        upper = glm::max(upper, vertex.position);
+    }
+    Bounds bounds{ .centre = (lower + upper) * 0.5f, .radius = 0.0f };
+    for (Vertex const &vertex : vertices)
+        bounds.radius = std::max(bounds.radius, glm::length(vertex.position - bounds.centre));
+    return bounds;
+}
@@ -0,0 +1,129 @@
+
+#include "mesh/meshFormat.hpp"
+
+#include <cstring>
+#include <exception>
+#include <fstream>
+
+namespace
+{
+    uint64_t align(uint64_t offset)
+    {
+        return (offset + meshFormat::ALIGNMENT - 1) / meshFormat::ALIGNMENT * meshFormat::ALIGNMENT;
+    }
+
+    /** Whether count elements at offset lie within size bytes, dividing rather than multiplying so crafted counts can't overflow */
+    bool fits(uint64_t offset, uint64_t count, uint64_t elementSize, size_t size)
+    {
+        return offset <= size && (elementSize == 0 || count <= (size - offset) / elementSize);
+    }
+
+    template<class Index>
+    bool indicesInRange(char const *indices, uint64_t nIndices, uint64_t nVertices)
+    {
+        for (uint64_t i=0; i<nIndices; i++)
+        {
+            Index index;
+            std::memcpy(&index, indices + i*sizeof(Index), sizeof(Index));
+            if (index >= nVertices)
+                return false;
+        }
+        return true;
+    }
+}
+
+meshFormat::Header const &meshFormat::readHeader(char const *data, size_t size)
+{
+    // Validate header against its declared vertex layout
+    if (size < sizeof(Header))
+        throw std::exception("Mesh file truncated.");
+    Header const &header = *reinterpret_cast<Header const *>(data);
+    if (header.magic != MAGIC || header.version != VERSION)
+        throw std::exception("Not a mesh file or unsupported version.");
+    if (header.vertexStride != VertexLayout::unpack(header.vertexLayout).getStride() || header.indexSize != MeshData::getIndexSize(header.nVertices))
+        throw std::exception("Mesh file vertex or index layout doesn't match.");
+
+    // Validate blobs lie within file
+    if (!fits(header.vertexOffset, header.nVertices, header.vertexStride, size) || !fits(header.indexOffset, header.nIndices, header.indexSize, size) || !fits(header.lodOffset, header.nLods, sizeof(MeshData::Lod), size))
+        throw std::exception("Mesh file truncated.");
+
+    // Validate detail levels lie within indices
+    for (MeshData::Lod const &lod : readLods(data, header))
+        if (static_cast<uint64_t>(lod.firstIndex) + lod.nIndices > header.nIndices)
+            throw std::exception("Mesh file LOD out of range.");
+
+    // Validate indices once here, as they are uploaded as stored and the GPU would read past the vertices otherwise
+    char const *indices = data + header.indexOffset;
+    if (header.indexSize == sizeof(uint32_t) ? !indicesInRange<uint32_t>(indices, header.nIndices, header.nVertices) : !indicesInRange<uint16_t>(indices, header.nIndices, header.nVertices))
+        throw std::exception("Mesh file index out of range.");
+
+    return header;
+}
+
+std::vector<MeshData::Lod> meshFormat::readLods(char const *data, Header const &header)
+{
+    std::vector<MeshData::Lod> lods(header.nLods);
+    std::memcpy(lods.data(), data + header.lodOffset, header.nLods*sizeof(MeshData::Lod));
+    return lods;
+}
+
+std::vector<char> meshFormat::serialize(MeshData const &meshData, VertexLayout const &layout)
+{
+    // Lay out aligned LOD table and blobs after header
+    std::vector<MeshData::Lod> lods = meshData.getLods();
+    Header header
+    {
+        .magic = MAGIC,
+        .version = VERSION,
+        .vertexStride = layout.getStride(),
+        .indexSize = MeshData::getIndexSize(meshData.vertices.size()),
+        .nVertices = meshData.vertices.size(),
+        .nIndices = meshData.indices.size(),
+        .vertexLayout = layout.pack(),
+        .dequantization = quantize::computeDequantization(meshData.vertices, layout),
+        .bounds = meshData.computeBounds(),
+        .nLods = static_cast<uint32_t>(lods.size())
+    };
+    header.lodOffset = align(sizeof(Header));
+    header.vertexOffset = align(header.lodOffset + lods.size()*sizeof(MeshData::Lod));
+    header.indexOffset = align(header.vertexOffset + header.nVertices*header.vertexStride);
+
+    // Copy header and blobs, padding is zeroed
+    std::vector<char> data(header.indexOffset + header.nIndices*header.indexSize);
+    std::memcpy(data.data(), &header, sizeof(Header));
+    std::memcpy(data.data() + header.lodOffset, lods.data(), lods.size()*sizeof(MeshData::Lod));
+    quantize::encode(meshData.vertices, layout, header.dequantization, data.data() + header.vertexOffset);
+    meshData.writeIndices(data.data() + header.indexOffset);
+    return data;
+}
+
+MeshData meshFormat::deserialize(char const *data, size_t size)
+{
+    // Unpack vertices and LODs, widening indices back to 32 bits
+    Header const &header = readHeader(data, size);
+    MeshData meshData
+    {
+        .vertices = quantize::decode(data+header.vertexOffset, header.nVertices, VertexLayout::unpack(header.vertexLayout), header.dequantization),
+        .lods = readLods(data, header)
+    };
+    meshData.indices.resize(header.nIndices);
+    if (header.indexSize == sizeof(uint32_t))
+        std::memcpy(meshData.indices.data(), data+header.indexOffset, header.nIndices*sizeof(uint32_t));
+    else
+        for (uint64_t i=0; i<header.nIndices; i++)
+        {
+            uint16_t index;
+            std::memcpy(&index, data + header.indexOffset + i*sizeof(uint16_t), sizeof(uint16_t));
+            meshData.indices[i] = index;
+        }
+    return meshData;
+}
+
+void meshFormat::write(std::string const &filename, MeshData const &meshData, VertexLayout const &layout)
+{
+    std::vector<char> data = serialize(meshData, layout);
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open())
+        throw std::exception("Failed to open mesh file for writing.");
+    file.write(data.data(), data.size());
+}
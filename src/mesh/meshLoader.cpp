@@ -0,0 +1,312 @@
+
+#include "mesh/meshLoader.hpp"
+
+#include "mesh/mesh.hpp"
+#include "mesh/meshFormat.hpp"
+#include "mesh/meshOptimizer.hpp"
+#include "mesh/meshLod.hpp"
+#include "asset/assetPack.hpp"
+#include "configuration/device.hpp"
+#include "configuration/physicalDevice.hpp"
+#include "configuration/queue.hpp"
+#include "command/commandPool.hpp"
+#include "command/commandBuffer.hpp"
+#include "profiling/cpuTrace.hpp"
+#include "utility/check.hpp"
+#include "utility/mappedFile.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <optional>
+#include <thread>
+
+MeshLoader::MeshLoader(Device const *device, PhysicalDevice const *physicalDevice, CommandPool *commandPool, AssetPack const *assetPack, VertexLayout const &layout)
+    : device(device), physicalDevice(physicalDevice), commandPool(commandPool), assetPack(assetPack), layout(layout)
+{
+    stagingThread = std::thread(&MeshLoader::work, this);
+}
+
+MeshLoader::~MeshLoader()
+{
+    // Stop worker, dropping unstarted requests
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    stagingThread.join();
+
+    // Wait for and discard batches never handed out
+    for (Batch &batch : batches)
+    {
+        vkWaitForFences(device->getHandle(), 1, &batch.fence, VK_TRUE, UINT64_MAX);
+        vkDestroyFence(device->getHandle(), batch.fence, nullptr);
+        for (Mesh *mesh : batch.meshes)
+            delete mesh;
+    }
+    batches.clear();
+}
+
+Mesh *MeshLoader::load(std::string const &filename) const
+{
+    return load(std::vector<std::string>{ filename })[0];
+}
+
+std::vector<Mesh *> MeshLoader::load(std::vector<std::string> const &filenames) const
+{
+    TRACE_ZONE("MeshLoader::load");
+    // Parse and stage files on worker threads, each pulling the next unclaimed file
+    std::vector<std::optional<StagedMesh>> stagedMeshes(filenames.size());
+    std::vector<std::exception_ptr> errors(filenames.size());
+    std::atomic<size_t> nextFile = 0;
+    auto worker = [&]()
+    {
+        for (size_t i=nextFile++; i<filenames.size(); i=nextFile++)
+        {
+            try
+            {
+                stagedMeshes[i].emplace(stage(filenames[i]));
+            }
+            catch (...)
+            {
+                errors[i] = std::current_exception();
+            }
+        }
+    };
+    size_t nWorkers = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), filenames.size());
+    std::vector<std::thread> workers;
+    for (size_t i=0; i<nWorkers; i++)
+        workers.emplace_back(worker);
+    for (std::thread &thread : workers)
+        thread.join();
+
+    // Propagate first failure
+    for (std::exception_ptr const &error : errors)
+        if (error)
+            std::rethrow_exception(error);
+
+    // Upload everything together
+    std::vector<StagedMesh> staged;
+    staged.reserve(stagedMeshes.size());
+    for (std::optional<StagedMesh> &stagedMesh : stagedMeshes)
+        staged.push_back(std::move(*stagedMesh));
+    return upload(staged);
+}
+
+Mesh *MeshLoader::upload(MeshData const &meshData) const
+{
+    std::vector<StagedMesh> staged;
+    staged.push_back(stage(meshData));
+    return upload(staged)[0];
+}
+
+void MeshLoader::loadAsync(std::string const &filename)
+{
+    {
+        std::lock_guard lock(mutex);
+        requests.push_back(filename);
+    }
+    wake.notify_one();
+}
+
+std::vector<std::pair<std::string, Mesh *>> MeshLoader::poll()
+{
+    TRACE_ZONE("MeshLoader::poll");
+    // Take everything the worker staged, rethrowing its failure
+    std::vector<std::pair<std::string, StagedMesh>> taken;
+    {
+        std::lock_guard lock(mutex);
+        if (error)
+            std::rethrow_exception(std::exchange(error, nullptr));
+        taken.swap(ready);
+    }
+
+    // Submit it as one batch, fenced rather than waited on
+    if (!taken.empty())
+    {
+        std::vector<std::string> names;
+        std::vector<StagedMesh> staged;
+        for (auto &[name, stagedMesh] : taken)
+        {
+            names.push_back(name);
+            staged.push_back(std::move(stagedMesh));
+        }
+        std::vector<Mesh *> meshes = createMeshes(staged);
+        CommandBuffer transferCommandBuffer = commandPool->allocateNewBuffer();
+        transferCommandBuffer.record([&](VkCommandBuffer const &commandBuffer)
+        {
+            for (size_t i=0; i<meshes.size(); i++)
+                recordUpload(commandBuffer, staged[i], meshes[i]);
+        }, true);
+
+        VkFenceCreateInfo fenceInfo { .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+        VkFence fence;
+        check::fail( vkCreateFence(device->getHandle(), &fenceInfo, nullptr, &fence), "vkCreateFence failed." );
+        device->getMainQueue().submit(device, transferCommandBuffer, fence);
+        batches.push_back(Batch
+        {
+            .names = std::move(names),
+            .staged = std::move(staged),
+            .meshes = std::move(meshes),
+            .commandBuffer = std::move(transferCommandBuffer),
+            .fence = fence
+        });
+    }
+
+    // Hand out meshes of completed batches, freeing their staging memory
+    std::vector<std::pair<std::string, Mesh *>> completed;
+    for (auto it=batches.begin(); it!=batches.end(); )
+    {
+        if (vkGetFenceStatus(device->getHandle(), it->fence) != VK_SUCCESS)
+        {
+            it++;
+            continue;
+        }
+        for (size_t i=0; i<it->meshes.size(); i++)
+            completed.emplace_back(it->names[i], it->meshes[i]);
+        vkDestroyFence(device->getHandle(), it->fence, nullptr);
+        it = batches.erase(it);
+    }
+    return completed;
+}
+
+MeshLoader::StagedMesh MeshLoader::stage(std::string const &filename) const
+{
+    TRACE_ZONE("MeshLoader::stage");
+    // Packed meshes are stored in native format, used in place unless compressed
+    if (assetPack != nullptr && assetPack->contains(filename))
+    {
+        AssetPack::Entry const &entry = assetPack->getEntry(filename);
+        if (entry.type != AssetMesh)
+            throw std::exception("Packed asset is not a mesh.");
+        if (!entry.compressed)
+            return stageNative(assetPack->view(filename), entry.size);
+        std::vector<char> data = assetPack->read(filename);
+        return stageNative(data.data(), data.size());
+    }
+
+    // Native meshes are copied straight from the file mapping into staging memory
+    if (filename.ends_with(".mesh"))
+    {
+        MappedFile file(filename);
+        return stageNative(file.getData(), file.getSize());
+    }
+
+    // Other formats need parsing, optimising and simplifying first
+    MeshData meshData = MeshData::parse(filename);
+    meshOptimizer::optimize(meshData);
+    meshLod::generate(meshData);
+    return stage(meshData);
+}
+
+MeshLoader::StagedMesh MeshLoader::stage(MeshData const &meshData) const
+{
+    TRACE_ZONE("MeshLoader::stage");
+    // Pack vertices straight into staging memory
+    StagedMesh staged = createStaging(meshData.vertices.size(), meshData.indices.size(), quantize::computeDequantization(meshData.vertices, layout));
+    quantize::encode(meshData.vertices, layout, staged.dequantization, staged.vertices.map());
+    staged.vertices.unmap();
+    meshData.writeIndices(staged.indices.map());
+    staged.indices.unmap();
+    staged.lods = meshData.getLods();
+    staged.bounds = meshData.computeBounds();
+    return staged;
+}
+
+MeshLoader::StagedMesh MeshLoader::stageNative(char const *data, size_t size) const
+{
+    // Repack meshes stored in another layout
+    meshFormat::Header const &header = meshFormat::readHeader(data, size);
+    if (VertexLayout::unpack(header.vertexLayout) != layout)
+        return stage(meshFormat::deserialize(data, size));
+
+    StagedMesh staged = createStaging(header.nVertices, header.nIndices, header.dequantization);
+    staged.vertices.memcpy(header.nVertices*header.vertexStride, data+header.vertexOffset);
+    staged.indices.memcpy(header.nIndices*header.indexSize, data+header.indexOffset);
+    staged.lods = meshFormat::readLods(data, header);
+    staged.bounds = header.bounds;
+    return staged;
+}
+
+MeshLoader::StagedMesh MeshLoader::createStaging(uint64_t nVertices, uint64_t nIndices, quantize::Dequantization const &dequantization) const
+{
+    if (nVertices > UINT32_MAX || nIndices > UINT32_MAX)
+        throw std::exception("Mesh too large.");
+    check::zero(nVertices != 0, "Mesh has no vertices.");
+    check::zero(nIndices != 0, "Mesh has no indices.");
+    return StagedMesh
+    {
+        .vertices = TypedBuffer<char>(device, physicalDevice, nVertices*layout.getStride(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT|VK_MEMORY_PROPERTY_HOST_COHERENT_BIT),
+        .indices = TypedBuffer<char>(device, physicalDevice, nIndices*MeshData::getIndexSize(nVertices), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT|VK_MEMORY_PROPERTY_HOST_COHERENT_BIT),
+        .dequantization = dequantization
+    };
+}
+
+std::vector<Mesh *> MeshLoader::createMeshes(std::vector<StagedMesh> const &stagedMeshes) const
+{
+    std::vector<Mesh *> meshes;
+    for (StagedMesh const &staged : stagedMeshes)
+    {
+        uint32_t nVertices = staged.vertices.getSize() / layout.getStride();
+        meshes.push_back(new Mesh(device, physicalDevice, layout, staged.dequantization, nVertices, staged.indices.getSize() / MeshData::getIndexSize(nVertices), staged.lods, staged.bounds));
+    }
+    return meshes;
+}
+
+void MeshLoader::recordUpload(VkCommandBuffer const &commandBuffer, StagedMesh const &staged, Mesh *mesh) const
+{
+    mesh->getVertexBuffer().recordTransfer(commandBuffer, staged.vertices);
+    mesh->getIndexBuffer().recordTransfer(commandBuffer, staged.indices);
+}
+
+std::vector<Mesh *> MeshLoader::upload(std::vector<StagedMesh> const &stagedMeshes) const
+{
+    TRACE_ZONE("MeshLoader::upload");
+    // Record every copy into one command buffer
+    std::vector<Mesh *> meshes = createMeshes(stagedMeshes);
+    CommandBuffer transferCommandBuffer = commandPool->allocateNewBuffer();
+    transferCommandBuffer.record([&](VkCommandBuffer const &commandBuffer)
+    {
+        for (size_t i=0; i<meshes.size(); i++)
+            recordUpload(commandBuffer, stagedMeshes[i], meshes[i]);
+    }, true);
+
+    // Submit and wait once for the whole batch before staging buffers are freed
+    Queue queue = device->getMainQueue();
+    queue.submit(device, transferCommandBuffer);
+    vkQueueWaitIdle(queue.getHandle());
+
+    return meshes;
+}
+
+void MeshLoader::work()
+{
+    TRACE_THREAD("Mesh staging");
+    while (true)
+    {
+        // Wait for the next request
+        std::string filename;
+        {
+            std::unique_lock lock(mutex);
+            wake.wait(lock, [&]() { return stopping || !requests.empty(); });
+            if (stopping)
+                return;
+            filename = std::move(requests.front());
+            requests.pop_front();
+        }
+
+        // Parse, optimise and stage outside the lock, publishing the result or failure for poll
+        try
+        {
+            StagedMesh staged = stage(filename);
+            std::lock_guard lock(mutex);
+            ready.emplace_back(filename, std::move(staged));
+        }
+        catch (...)
+        {
+            std::lock_guard lock(mutex);
+            error = std::current_exception();
+        }
+    }
+}
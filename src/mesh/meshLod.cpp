@@ -0,0 +1,216 @@
+
+#include "mesh/meshLod.hpp"
+
+#include "mesh/meshOptimizer.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <numeric>
+#include <unordered_set>
+
+namespace
+{
+    /** Sum of area-weighted squared distances to a set of planes */
+    struct Quadric
+    {
+        double a2=0, b2=0, c2=0, d2=0, ab=0, ac=0, ad=0, bc=0, bd=0, cd=0, weight=0;
+
+        static Quadric fromPlane(glm::vec3 const &normal, float distance, double weight)
+        {
+            double a = normal.x, b = normal.y, c = normal.z, d = distance;
+            return Quadric
+            {
+                .a2 = weight*a*a, .b2 = weight*b*b, .c2 = weight*c*c, .d2 = weight*d*d,
+                .ab = weight*a*b, .ac = weight*a*c, .ad = weight*a*d,
+                .bc = weight*b*c, .bd = weight*b*d, .cd = weight*c*d,
+                .weight = weight
+            };
+        }
+
+        void add(Quadric const &other)
+        {
+            a2 += other.a2; b2 += other.b2; c2 += other.c2; d2 += other.d2;
+            ab += other.ab; ac += other.ac; ad += other.ad;
+            bc += other.bc; bd += other.bd; cd += other.cd;
+            weight += other.weight;
+        }
+
+        /** Mean squared plane distance of a point */
+        double evaluate(glm::vec3 const &point) const
+        {
+            double x = point.x, y = point.y, z = point.z;
+            double sum = a2*x*x + b2*y*y + c2*z*z + d2
+                       + 2.0*(ab*x*y + ac*x*z + bc*y*z)
+                       + 2.0*(ad*x + bd*y + cd*z);
+            return weight > 0.0 ? std::abs(sum) / weight : 0.0;
+        }
+    };
+
+    struct Collapse
+    {
+        uint32_t from;
+        uint32_t to;
+        double cost;
+    };
+
+    glm::vec3 cross(glm::vec3 a, glm::vec3 b)
+    {
+        return glm::vec3(a.y*b.z - a.z*b.y, a.z*b.x - a.x*b.z, a.x*b.y - a.y*b.x);
+    }
+}
+
+std::vector<uint32_t> meshLod::simplify(std::vector<uint32_t> const &indices, std::vector<Vertex> const &vertices, size_t targetIndexCount, float maxError, float &error)
+{
+    size_t const nVertices = vertices.size();
+    std::vector<uint32_t> result = indices;
+    double maxCost = static_cast<double>(maxError) * maxError, reachedCost = 0.0;
+
+    // Lock vertices on open edges, which also covers attribute seams split into separate vertices
+    std::unordered_set<uint64_t> edges;
+    for (size_t i=0; i<result.size(); i+=3)
+        for (int corner=0; corner<3; corner++)
+            edges.insert((static_cast<uint64_t>(result[i+corner]) << 32) | result[i + (corner+1)%3]);
+    std::vector<bool> locked(nVertices, false);
+    for (size_t i=0; i<result.size(); i+=3)
+        for (int corner=0; corner<3; corner++)
+        {
+            uint32_t a = result[i+corner], b = result[i + (corner+1)%3];
+            if (!edges.contains((static_cast<uint64_t>(b) << 32) | a))
+                locked[a] = locked[b] = true;
+        }
+
+    // Accumulate each triangle's plane into its corners
+    std::vector<Quadric> quadrics(nVertices);
+    for (size_t i=0; i<result.size(); i+=3)
+    {
+        glm::vec3 const &a = vertices[result[i]].position, &b = vertices[result[i+1]].position, &c = vertices[result[i+2]].position;
+        glm::vec3 normal = cross(b - a, c - a);
+        float area = glm::length(normal);
+        if (area == 0.0f)
+            continue;
+        normal = normal * (1.0f / area);
+        Quadric plane = Quadric::fromPlane(normal, -glm::dot(normal, a), 0.5*area);
+        for (int corner=0; corner<3; corner++)
+            quadrics[result[i+corner]].add(plane);
+    }
+
+    std::vector<uint32_t> remap(nVertices), offsets(nVertices+1), adjacency;
+    std::vector<bool> touched(nVertices);
+    std::vector<Collapse> collapses;
+    while (result.size() > targetIndexCount)
+    {
+        // Vertex to triangle adjacency of the current mesh
+        std::fill(offsets.begin(), offsets.end(), 0);
+        for (uint32_t index : result)
+            offsets[index+1]++;
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end()-1);
+        adjacency.resize(result.size());
+        for (size_t i=0; i<result.size(); i++)
+            adjacency[fill[result[i]]++] = static_cast<uint32_t>(i/3);
+
+        // Cost every edge collapse onto an existing endpoint, cheapest first
+        collapses.clear();
+        for (size_t i=0; i<result.size(); i+=3)
+            for (int corner=0; corner<3; corner++)
+            {
+                uint32_t a = result[i+corner], b = result[i + (corner+1)%3];
+                for (auto [from, to] : { std::pair{a, b}, std::pair{b, a} })
+                    if (!locked[from])
+                    {
+                        Quadric combined = quadrics[from];
+                        combined.add(quadrics[to]);
+                        collapses.push_back(Collapse{ .from = from, .to = to, .cost = combined.evaluate(vertices[to].position) });
+                    }
+            }
+        std::sort(collapses.begin(), collapses.end(), [](Collapse const &a, Collapse const &b) { return a.cost < b.cost; });
+
+        // Rejects collapses that would fold a surviving neighbour triangle over
+        auto flips = [&](uint32_t from, uint32_t to)
+        {
+            for (uint32_t i=offsets[from]; i<offsets[from+1]; i++)
+            {
+                uint32_t const triangle = adjacency[i];
+                uint32_t corners[3] = { remap[result[triangle*3]], remap[result[triangle*3 + 1]], remap[result[triangle*3 + 2]] };
+                if (corners[0] == to || corners[1] == to || corners[2] == to)
+                    continue;
+                glm::vec3 before[3], after[3];
+                for (int corner=0; corner<3; corner++)
+                {
+                    before[corner] = vertices[corners[corner]].position;
+                    after[corner] = corners[corner] == from ? vertices[to].position : before[corner];
+                }
+                glm::vec3 normalBefore = cross(before[1] - before[0], before[2] - before[0]);
+                glm::vec3 normalAfter = cross(after[1] - after[0], after[2] - after[0]);
+                if (glm::dot(normalBefore, normalAfter) <= 0.25f * glm::length(normalBefore) * glm::length(normalAfter))
+                    return true;
+            }
+            return false;
+        };
+
+        // Apply independent collapses, each vertex moving at most once per pass
+        std::iota(remap.begin(), remap.end(), 0);
+        std::fill(touched.begin(), touched.end(), false);
+        size_t const nTriangles = result.size() / 3, targetTriangles = targetIndexCount / 3;
+        size_t removed = 0;
+        for (Collapse const &collapse : collapses)
+        {
+            if (collapse.cost > maxCost || removed + targetTriangles >= nTriangles)
+                break;
+            if (touched[collapse.from] || touched[collapse.to] || flips(collapse.from, collapse.to))
+                continue;
+            remap[collapse.from] = collapse.to;
+            quadrics[collapse.to].add(quadrics[collapse.from]);
+            touched[collapse.from] = touched[collapse.to] = true;
+            reachedCost = std::max(reachedCost, collapse.cost);
+            removed += 2;
+        }
+        if (removed == 0)
+            break;
+
+        // Drop triangles that became degenerate
+        size_t write = 0;
+        for (size_t i=0; i<result.size(); i+=3)
+        {
+            uint32_t a = remap[result[i]], b = remap[result[i+1]], c = remap[result[i+2]];
+            if (a != b && b != c && c != a)
+            {
+                result[write++] = a;
+                result[write++] = b;
+                result[write++] = c;
+            }
+        }
+        result.resize(write);
+    }
+
+    error = static_cast<float>(std::sqrt(reachedCost));
+    return result;
+}
+
+void meshLod::generate(MeshData &meshData, uint32_t maxLevels, float reduction)
+{
+    // Every level simplifies the full detail indices so errors are relative to the original surface
+    std::vector<uint32_t> const base = meshData.indices;
+    meshData.lods = { MeshData::Lod{ .firstIndex = 0, .nIndices = static_cast<uint32_t>(base.size()), .error = 0.0f } };
+    for (uint32_t level=1; level<maxLevels; level++)
+    {
+        size_t target = static_cast<size_t>(meshData.lods.back().nIndices * reduction) / 3 * 3;
+        if (target < 3)
+            break;
+        float error;
+        std::vector<uint32_t> simplified = simplify(base, meshData.vertices, target, FLT_MAX, error);
+
+        // Stop once locked borders leave little to collapse
+        if (simplified.empty() || simplified.size() > meshData.lods.back().nIndices * 0.9f)
+            break;
+        meshOptimizer::optimizeVertexCache(simplified, meshData.vertices.size());
+        meshData.lods.push_back(MeshData::Lod
+        {
+            .firstIndex = static_cast<uint32_t>(meshData.indices.size()),
+            .nIndices = static_cast<uint32_t>(simplified.size()),
+            .error = std::max(error, meshData.lods.back().error)
+        });
+        meshData.indices.insert(meshData.indices.end(), simplified.begin(), simplified.end());
+    }
+}
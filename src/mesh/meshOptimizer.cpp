@@ -0,0 +1,266 @@
+
+#include "mesh/meshOptimizer.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <numeric>
+
+namespace
+{
+    uint32_t constexpr NONE = UINT32_MAX;
+
+    /** FIFO post-transform cache simulation, a vertex stays cached until cacheSize newer misses */
+    class CacheSimulator
+    {
+    private:
+        std::vector<uint32_t> timestamps;
+        uint32_t const cacheSize;
+        uint32_t time;
+
+    public:
+        CacheSimulator(size_t nVertices, uint32_t cacheSize) : timestamps(nVertices, 0), cacheSize(cacheSize), time(cacheSize+1)
+        { }
+
+        bool access(uint32_t vertex)
+        {
+            if (time - timestamps[vertex] <= cacheSize)
+                return false;
+            timestamps[vertex] = time++;
+            return true;
+        }
+
+        void flush()
+        {
+            time += cacheSize+1;
+        }
+    };
+
+    glm::vec3 cross(glm::vec3 a, glm::vec3 b)
+    {
+        return glm::vec3(a.y*b.z - a.z*b.y, a.z*b.x - a.x*b.z, a.x*b.y - a.y*b.x);
+    }
+}
+
+meshOptimizer::Statistics meshOptimizer::analyze(std::vector<uint32_t> const &indices, size_t nVertices, uint32_t cacheSize)
+{
+    // Count misses and distinct vertices referenced
+    CacheSimulator cache(nVertices, cacheSize);
+    std::vector<bool> referenced(nVertices, false);
+    size_t misses = 0, nUnique = 0;
+    for (uint32_t index : indices)
+    {
+        misses += cache.access(index);
+        if (!referenced[index])
+        {
+            referenced[index] = true;
+            nUnique++;
+        }
+    }
+
+    size_t nTriangles = indices.size() / 3;
+    return Statistics
+    {
+        .acmr = nTriangles == 0 ? 0.0f : static_cast<float>(misses) / nTriangles,
+        .atvr = nUnique == 0 ? 0.0f : static_cast<float>(misses) / nUnique
+    };
+}
+
+std::vector<uint32_t> meshOptimizer::optimizeVertexCache(std::vector<uint32_t> &indices, size_t nVertices, uint32_t cacheSize)
+{
+    // Build vertex to triangle adjacency, live triangle counts double as fill cursors
+    size_t const nTriangles = indices.size() / 3;
+    std::vector<uint32_t> liveTriangles(nVertices, 0), offsets(nVertices+1, 0), adjacency(nTriangles*3);
+    for (uint32_t index : indices)
+    {
+        if (index >= nVertices)
+            throw std::exception("Mesh index out of range.");
+        liveTriangles[index]++;
+    }
+    std::partial_sum(liveTriangles.begin(), liveTriangles.end(), offsets.begin()+1);
+    std::vector<uint32_t> fill(offsets.begin(), offsets.end()-1);
+    for (size_t i=0; i<nTriangles*3; i++)
+        adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i/3);
+
+    // Tipsify: fan around the most recently cached vertex, falling back to dead ends then input order
+    std::vector<uint32_t> cacheTimes(nVertices, 0), deadEnd, candidates, output, clusters;
+    std::vector<bool> emitted(nTriangles, false);
+    output.reserve(nTriangles*3);
+    uint32_t time = cacheSize+1;
+    uint32_t cursor = 0;
+    auto skipDeadEnd = [&]()
+    {
+        while (!deadEnd.empty())
+        {
+            uint32_t vertex = deadEnd.back();
+            deadEnd.pop_back();
+            if (liveTriangles[vertex] > 0)
+                return vertex;
+        }
+        for (; cursor<nVertices; cursor++)
+            if (liveTriangles[cursor] > 0)
+                return cursor;
+        return NONE;
+    };
+
+    uint32_t fanning = skipDeadEnd();
+    if (fanning != NONE)
+        clusters.push_back(0);
+    while (fanning != NONE)
+    {
+        // Emit every remaining triangle around the fanning vertex
+        candidates.clear();
+        for (uint32_t i=offsets[fanning]; i<offsets[fanning+1]; i++)
+        {
+            uint32_t triangle = adjacency[i];
+            if (emitted[triangle])
+                continue;
+            emitted[triangle] = true;
+            for (int corner=0; corner<3; corner++)
+            {
+                uint32_t vertex = indices[triangle*3 + corner];
+                output.push_back(vertex);
+                deadEnd.push_back(vertex);
+                candidates.push_back(vertex);
+                liveTriangles[vertex]--;
+                if (time - cacheTimes[vertex] > cacheSize)
+                    cacheTimes[vertex] = time++;
+            }
+        }
+
+        // Prefer the oldest candidate still cached after emitting its remaining triangles
+        uint32_t next = NONE;
+        int64_t bestPriority = -1;
+        for (uint32_t vertex : candidates)
+        {
+            if (liveTriangles[vertex] == 0)
+                continue;
+            int64_t priority = 0;
+            if (time - cacheTimes[vertex] + 2*liveTriangles[vertex] <= cacheSize)
+                priority = time - cacheTimes[vertex];
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                next = vertex;
+            }
+        }
+
+        // Jumping elsewhere breaks locality, so starts a new cluster
+        if (next == NONE)
+        {
+            next = skipDeadEnd();
+            if (next != NONE)
+                clusters.push_back(static_cast<uint32_t>(output.size() / 3));
+        }
+        fanning = next;
+    }
+
+    indices = std::move(output);
+    return clusters;
+}
+
+void meshOptimizer::optimizeOverdraw(std::vector<uint32_t> &indices, std::vector<Vertex> const &vertices, std::vector<uint32_t> const &clusters, float threshold, uint32_t cacheSize)
+{
+    size_t const nTriangles = indices.size() / 3;
+    if (nTriangles == 0)
+        return;
+
+    // Split clusters further wherever the cache cost so far is within threshold of the whole mesh's
+    float const targetAcmr = analyze(indices, vertices.size(), cacheSize).acmr * threshold;
+    std::vector<uint32_t> starts;
+    CacheSimulator cache(vertices.size(), cacheSize);
+    for (size_t i=0; i<clusters.size(); i++)
+    {
+        uint32_t const end = (i+1 < clusters.size()) ? clusters[i+1] : static_cast<uint32_t>(nTriangles);
+        uint32_t start = clusters[i];
+        size_t misses = 0;
+        cache.flush();
+        for (uint32_t triangle=clusters[i]; triangle<end; triangle++)
+        {
+            for (int corner=0; corner<3; corner++)
+                misses += cache.access(indices[triangle*3 + corner]);
+            if (triangle+1 < end && misses <= targetAcmr * (triangle+1 - start))
+            {
+                starts.push_back(start);
+                start = triangle+1;
+                misses = 0;
+                cache.flush();
+            }
+        }
+        starts.push_back(start);
+    }
+
+    // Area-weighted centroid and normal per cluster
+    std::vector<glm::vec3> centroids(starts.size(), glm::vec3(0.0f)), normals(starts.size(), glm::vec3(0.0f));
+    glm::vec3 meshCentroid(0.0f);
+    float meshArea = 0.0f;
+    for (size_t i=0; i<starts.size(); i++)
+    {
+        uint32_t const end = (i+1 < starts.size()) ? starts[i+1] : static_cast<uint32_t>(nTriangles);
+        float clusterArea = 0.0f;
+        for (uint32_t triangle=starts[i]; triangle<end; triangle++)
+        {
+            glm::vec3 const &a = vertices[indices[triangle*3]].position;
+            glm::vec3 const &b = vertices[indices[triangle*3 + 1]].position;
+            glm::vec3 const &c = vertices[indices[triangle*3 + 2]].position;
+            glm::vec3 normal = cross(b - a, c - a);
+            float area = glm::length(normal);
+            centroids[i] = centroids[i] + (a + b + c) * (area / 3.0f);
+            normals[i] = normals[i] + normal;
+            clusterArea += area;
+        }
+        meshCentroid = meshCentroid + centroids[i];
+        meshArea += clusterArea;
+        if (clusterArea > 0.0f)
+            centroids[i] = centroids[i] * (1.0f / clusterArea);
+    }
+    if (meshArea > 0.0f)
+        meshCentroid = meshCentroid * (1.0f / meshArea);
+
+    // Draw outward-facing clusters far from the centre first, they are most likely to occlude the rest
+    std::vector<float> sortKeys(starts.size());
+    for (size_t i=0; i<starts.size(); i++)
+    {
+        float length = glm::length(normals[i]);
+        sortKeys[i] = length > 0.0f ? glm::dot(centroids[i] - meshCentroid, normals[i] * (1.0f / length)) : 0.0f;
+    }
+    std::vector<uint32_t> order(starts.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+    // Emit clusters in sorted order
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+    for (uint32_t cluster : order)
+    {
+        uint32_t const end = (cluster+1 < starts.size()) ? starts[cluster+1] : static_cast<uint32_t>(nTriangles);
+        output.insert(output.end(), indices.begin() + starts[cluster]*3, indices.begin() + end*3);
+    }
+    indices = std::move(output);
+}
+
+void meshOptimizer::optimizeVertexFetch(MeshData &meshData)
+{
+    // Renumber vertices in order of first use, dropping unreferenced ones
+    std::vector<uint32_t> remap(meshData.vertices.size(), NONE);
+    std::vector<Vertex> vertices;
+    vertices.reserve(meshData.vertices.size());
+    for (uint32_t &index : meshData.indices)
+    {
+        if (remap[index] == NONE)
+        {
+            remap[index] = static_cast<uint32_t>(vertices.size());
+            vertices.push_back(meshData.vertices[index]);
+        }
+        index = remap[index];
+    }
+    meshData.vertices = std::move(vertices);
+}
+
+void meshOptimizer::optimize(MeshData &meshData, float threshold)
+{
+    if (meshData.indices.empty())
+        return;
+    std::vector<uint32_t> clusters = optimizeVertexCache(meshData.indices, meshData.vertices.size());
+    optimizeOverdraw(meshData.indices, meshData.vertices, clusters, threshold);
+    optimizeVertexFetch(meshData);
+}
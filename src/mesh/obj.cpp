@@ -0,0 +1,139 @@
+
+#include "mesh/obj.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <exception>
+#include <unordered_map>
+
+namespace
+{
+    void skipSpaces(char const *&current, char const *end)
+    {
+        while (current != end && (*current==' ' || *current=='\t' || *current=='\r'))
+            current++;
+    }
+
+    bool parseFloat(char const *&current, char const *end, float &value)
+    {
+        skipSpaces(current, end);
+        std::from_chars_result result = std::from_chars(current, end, value);
+        if (result.ec != std::errc())
+            return false;
+        current = result.ptr;
+        return true;
+    }
+
+    bool parseIndex(char const *&current, char const *end, long long &value)
+    {
+        std::from_chars_result result = std::from_chars(current, end, value);
+        if (result.ec != std::errc())
+            return false;
+        current = result.ptr;
+        return true;
+    }
+
+    // Convert 1-based or negative relative OBJ index into 0-based index
+    uint32_t resolveIndex(long long index, size_t count)
+    {
+        long long resolved = index < 0 ? static_cast<long long>(count) + index : index - 1;
+        if (resolved < 0 || resolved >= static_cast<long long>(count))
+            throw std::exception("OBJ: face index out of range.");
+        return static_cast<uint32_t>(resolved);
+    }
+}
+
+MeshData obj::parse(char const *data, size_t size)
+{
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> colours;
+    std::vector<glm::vec3> normals;
+    std::unordered_map<uint64_t, uint32_t> vertexIndices;
+    std::vector<uint32_t> face;
+    MeshData meshData;
+
+    char const *current = data;
+    char const *const end = data + size;
+    while (current < end)
+    {
+        char const *lineEnd = std::find(current, end, '\n');
+        skipSpaces(current, lineEnd);
+
+        // Position with optional colour extension
+        if (lineEnd-current >= 2 && current[0]=='v' && (current[1]==' ' || current[1]=='\t'))
+        {
+            current += 2;
+            glm::vec3 position, colour;
+            if (!parseFloat(current, lineEnd, position.x) || !parseFloat(current, lineEnd, position.y) || !parseFloat(current, lineEnd, position.z))
+                throw std::exception("OBJ: malformed vertex position.");
+            positions.push_back(position);
+            if (parseFloat(current, lineEnd, colour.r) && parseFloat(current, lineEnd, colour.g) && parseFloat(current, lineEnd, colour.b))
+            {
+                colours.resize(positions.size(), glm::vec3(1.0f));
+                colours.back() = colour;
+            }
+        }
+
+        // Normal
+        else if (lineEnd-current >= 3 && current[0]=='v' && current[1]=='n')
+        {
+            current += 2;
+            glm::vec3 normal;
+            if (!parseFloat(current, lineEnd, normal.x) || !parseFloat(current, lineEnd, normal.y) || !parseFloat(current, lineEnd, normal.z))
+                throw std::exception("OBJ: malformed vertex normal.");
+            normals.push_back(normal);
+        }
+
+        // Face of position[/texcoord][/normal] references
+        else if (lineEnd-current >= 2 && current[0]=='f' && (current[1]==' ' || current[1]=='\t'))
+        {
+            current += 2;
+            face.clear();
+            while (true)
+            {
+                skipSpaces(current, lineEnd);
+                long long positionIndex, unusedIndex, normalIndex = 0;
+                if (!parseIndex(current, lineEnd, positionIndex))
+                    break;
+                if (current != lineEnd && *current == '/')
+                {
+                    current++;
+                    parseIndex(current, lineEnd, unusedIndex);
+                    if (current != lineEnd && *current == '/')
+                    {
+                        current++;
+                        parseIndex(current, lineEnd, normalIndex);
+                    }
+                }
+
+                // Deduplicate identical position/normal pairs
+                uint32_t position = resolveIndex(positionIndex, positions.size());
+                uint32_t normal = normalIndex==0 ? UINT32_MAX : resolveIndex(normalIndex, normals.size());
+                uint64_t key = (static_cast<uint64_t>(position) << 32) | normal;
+                auto [iterator, inserted] = vertexIndices.try_emplace(key, static_cast<uint32_t>(meshData.vertices.size()));
+                if (inserted)
+                {
+                    // Prefer explicit colour, then visualise normal, then white
+                    glm::vec3 colour(1.0f);
+                    if (position < colours.size())
+                        colour = colours[position];
+                    else if (normal != UINT32_MAX)
+                        colour = normals[normal]*0.5f + glm::vec3(0.5f);
+                    if (normal != UINT32_MAX)
+                        meshData.vertices.emplace_back(positions[position], colour, glm::normalize(normals[normal]));
+                    else
+                        meshData.vertices.emplace_back(positions[position], colour);
+                }
+                face.push_back(iterator->second);
+            }
+
+            // Fan-triangulate polygon
+            for (size_t i=2; i<face.size(); i++)
+                meshData.indices.insert(meshData.indices.end(), { face[0], face[i-1], face[i] });
+        }
+
+        current = lineEnd + 1;
+    }
+
+    return meshData;
+}
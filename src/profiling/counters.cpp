@@ -0,0 +1,37 @@
+
+#include "profiling/counters.hpp"
+
+#include <atomic>
+
+namespace
+{
+    std::atomic<uint64_t> values[counters::COUNTER_COUNT];
+
+    char const *const NAMES[counters::COUNTER_COUNT]
+    {
+        "draws",
+        "binds",
+        "bytes_uploaded",
+        "pipeline_creations",
+        "vertex_invocations",
+        "clipping_invocations",
+        "clipping_primitives",
+        "fragment_invocations",
+        "samples_passed"
+    };
+}
+
+void counters::add(Counter counter, uint64_t amount)
+{
+    values[counter].fetch_add(amount, std::memory_order_relaxed);
+}
+
+uint64_t counters::get(Counter counter)
+{
+    return values[counter].load(std::memory_order_relaxed);
+}
+
+char const *counters::getName(Counter counter)
+{
+    return NAMES[counter];
+}
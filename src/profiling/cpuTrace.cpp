@@ -0,0 +1,153 @@
+
+#include "profiling/cpuTrace.hpp"
+
+#include "utility/json.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    /** Ring of one thread's events, written only by that thread and published through count */
+    struct ThreadBuffer
+    {
+        uint32_t threadId;
+        std::string name;
+        std::unique_ptr<cpuTrace::Event[]> events{ new cpuTrace::Event[cpuTrace::EVENTS_PER_THREAD] };
+        std::atomic<uint64_t> count = 0;
+    };
+
+    // Buffers outlive their threads so a dump can still read them, and exited threads' buffers are reused by new ones
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> registry;
+    std::vector<ThreadBuffer *> freeBuffers;
+    std::atomic<bool> enabled = true;
+
+    /** Pairs a tick count with steady clock nanoseconds, two of them giving the tick rate */
+    struct Calibration
+    {
+        uint64_t ticks;
+        uint64_t nanoseconds;
+
+        static Calibration take()
+        {
+            return Calibration{ cpuTrace::now(), static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count()) };
+        }
+    };
+    Calibration const startCalibration = Calibration::take();
+
+    /** Oldest event a dump reads, skipping the oldest quarter of a full ring as its owner may be overwriting it */
+    uint64_t getFirstReadable(uint64_t count)
+    {
+        return count > cpuTrace::EVENTS_PER_THREAD ? count - cpuTrace::EVENTS_PER_THREAD + cpuTrace::EVENTS_PER_THREAD/4 : 0;
+    }
+
+    /** Claims a buffer for the calling thread and hands it back for reuse when the thread exits */
+    struct ThreadBufferOwner
+    {
+        ThreadBuffer *buffer;
+
+        ThreadBufferOwner()
+        {
+            std::lock_guard lock(registryMutex);
+            if (!freeBuffers.empty())
+            {
+                // Earlier events stay readable under the same track, only the name is reset
+                buffer = freeBuffers.back();
+                freeBuffers.pop_back();
+            }
+            else
+            {
+                registry.push_back(std::make_unique<ThreadBuffer>());
+                buffer = registry.back().get();
+                buffer->threadId = static_cast<uint32_t>(registry.size());
+            }
+            buffer->name = "Thread " + std::to_string(buffer->threadId);
+        }
+
+        ~ThreadBufferOwner()
+        {
+            std::lock_guard lock(registryMutex);
+            freeBuffers.push_back(buffer);
+        }
+    };
+
+    ThreadBuffer &getThreadBuffer()
+    {
+        // Registration is the only locked step, once per thread
+        thread_local ThreadBufferOwner owner;
+        return *owner.buffer;
+    }
+}
+
+void cpuTrace::record(Event const &event)
+{
+    if (!enabled.load(std::memory_order_relaxed))
+        return;
+    ThreadBuffer &buffer = getThreadBuffer();
+    uint64_t const count = buffer.count.load(std::memory_order_relaxed);
+    buffer.events[count % EVENTS_PER_THREAD] = event;
+    buffer.count.store(count + 1, std::memory_order_release);
+}
+
+void cpuTrace::setThreadName(std::string const &name)
+{
+    ThreadBuffer &buffer = getThreadBuffer();
+    std::lock_guard lock(registryMutex);
+    buffer.name = name;
+}
+
+void cpuTrace::setEnabled(bool value)
+{
+    enabled.store(value, std::memory_order_relaxed);
+}
+
+void cpuTrace::writeJson(std::ostream &stream)
+{
+    // Snapshot counts and time everything from the oldest readable event
+    Calibration const endCalibration = Calibration::take();
+    double const nanosecondsPerTick = endCalibration.ticks > startCalibration.ticks ? static_cast<double>(endCalibration.nanoseconds - startCalibration.nanoseconds) / (endCalibration.ticks - startCalibration.ticks) : 1.0;
+    std::lock_guard lock(registryMutex);
+    std::vector<uint64_t> counts;
+    uint64_t origin = UINT64_MAX;
+    for (auto const &buffer : registry)
+    {
+        counts.push_back(buffer->count.load(std::memory_order_acquire));
+        if (counts.back() > 0)
+            origin = std::min(origin, buffer->events[getFirstReadable(counts.back()) % EVENTS_PER_THREAD].start);
+    }
+
+    // Complete events in microseconds, one track per thread
+    stream << "{\"traceEvents\":[";
+    bool first = true;
+    for (size_t b=0; b<registry.size(); b++)
+    {
+        ThreadBuffer const *buffer = registry[b].get();
+        stream << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId << ",\"args\":{\"name\":" << json::quote(buffer->name) << "}}";
+        first = false;
+        for (uint64_t i=getFirstReadable(counts[b]); i<counts[b]; i++)
+        {
+            Event const &event = buffer->events[i % EVENTS_PER_THREAD];
+            double const start = (event.start > origin ? event.start - origin : 0) * nanosecondsPerTick / 1000.0;
+            double const duration = (event.end - event.start) * nanosecondsPerTick / 1000.0;
+            stream << ",\n{\"name\":" << json::quote(event.name) << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+                   << ",\"ts\":" << std::fixed << std::setprecision(3) << start << ",\"dur\":" << duration << std::defaultfloat << "}";
+        }
+    }
+    stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+void cpuTrace::dump(std::string const &filename)
+{
+    std::ofstream file(filename);
+    if (!file)
+        throw std::exception("Failed to open CPU trace for writing.");
+    writeJson(file);
+}
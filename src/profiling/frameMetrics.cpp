@@ -0,0 +1,195 @@
+
+#include "profiling/frameMetrics.hpp"
+
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+
+namespace
+{
+    char const *const PREFIX = "hellovulkan_";
+
+    struct Quantile
+    {
+        char const *label;
+        double p;
+    };
+
+    Quantile const QUANTILES[]
+    {
+        { "0.5", 0.50 },
+        { "0.95", 0.95 },
+        { "0.99", 0.99 }
+    };
+}
+
+FrameMetrics::FrameMetrics(std::string const &filename, Format format, double exportSeconds)
+    : filename(filename), format(format), exportSeconds(exportSeconds), startTime(Clock::now()), intervalTime(startTime)
+{
+    reset();
+}
+
+void FrameMetrics::recordFrame(double cpuMs, double gpuMs, double presentIntervalMs)
+{
+    double const samples[SERIES_COUNT] { cpuMs, gpuMs, presentIntervalMs };
+    for (int series=0; series<SERIES_COUNT; series++)
+    {
+        if (samples[series] < 0.0)
+            continue;
+        histograms[series].record(samples[series]);
+        totals[series].count++;
+        totals[series].sum += samples[series];
+    }
+
+    // Judge presents against a running average so gradual load changes aren't stutters, but sudden spikes are
+    if (presentIntervalMs <= 0.0)
+        return;
+    if (averageInterval > 0.0 && presentIntervalMs > STUTTER_FACTOR * averageInterval)
+    {
+        stutters++;
+        totalStutters++;
+    }
+    averageInterval = averageInterval > 0.0 ? averageInterval + AVERAGE_WEIGHT*(presentIntervalMs - averageInterval) : presentIntervalMs;
+}
+
+FrameMetrics::Summary FrameMetrics::getSummary(Series series) const
+{
+    Histogram const &histogram = histograms[series];
+    return Summary
+    {
+        .frames = histogram.getCount(),
+        .meanMs = histogram.getMean(),
+        .p50Ms = histogram.getPercentile(0.50),
+        .p95Ms = histogram.getPercentile(0.95),
+        .p99Ms = histogram.getPercentile(0.99),
+        .maxMs = histogram.getMax()
+    };
+}
+
+uint64_t FrameMetrics::getStutters() const
+{
+    return stutters;
+}
+
+uint64_t FrameMetrics::getCounter(counters::Counter counter) const
+{
+    return counters::get(counter) - intervalStart[counter];
+}
+
+double FrameMetrics::getIntervalSeconds() const
+{
+    return std::chrono::duration<double>(Clock::now() - intervalTime).count();
+}
+
+bool FrameMetrics::update()
+{
+    if (getIntervalSeconds() < exportSeconds)
+        return false;
+    if (!filename.empty())
+        exportFile();
+    return true;
+}
+
+void FrameMetrics::reset()
+{
+    for (Histogram &histogram : histograms)
+        histogram.reset();
+    stutters = 0;
+    for (int counter=0; counter<counters::COUNTER_COUNT; counter++)
+        intervalStart[counter] = counters::get(static_cast<counters::Counter>(counter));
+    intervalTime = Clock::now();
+}
+
+void FrameMetrics::writePrometheus(std::ostream &stream) const
+{
+    stream << std::fixed << std::setprecision(3);
+
+    // Quantiles cover the current interval, sums and counts the whole run
+    for (int series=0; series<SERIES_COUNT; series++)
+    {
+        std::string const name = std::string(PREFIX) + getName(static_cast<Series>(series)) + "_milliseconds";
+        Histogram const &histogram = histograms[series];
+        stream << "# TYPE " << name << " summary\n";
+        for (Quantile const &quantile : QUANTILES)
+            stream << name << "{quantile=\"" << quantile.label << "\"} " << histogram.getPercentile(quantile.p) << "\n";
+        stream << name << "_sum " << totals[series].sum << "\n";
+        stream << name << "_count " << totals[series].count << "\n";
+        stream << "# TYPE " << name << "_max gauge\n";
+        stream << name << "_max " << histogram.getMax() << "\n";
+    }
+
+    stream << "# TYPE " << PREFIX << "stutters_total counter\n";
+    stream << PREFIX << "stutters_total " << totalStutters << "\n";
+    for (int counter=0; counter<counters::COUNTER_COUNT; counter++)
+    {
+        char const *name = counters::getName(static_cast<counters::Counter>(counter));
+        stream << "# TYPE " << PREFIX << name << "_total counter\n";
+        stream << PREFIX << name << "_total " << counters::get(static_cast<counters::Counter>(counter)) << "\n";
+    }
+}
+
+void FrameMetrics::writeCsvHeader(std::ostream &stream) const
+{
+    stream << "seconds";
+    for (int series=0; series<SERIES_COUNT; series++)
+    {
+        std::string const name = getName(static_cast<Series>(series));
+        stream << "," << name << "_frames," << name << "_mean_ms," << name << "_p50_ms," << name << "_p95_ms," << name << "_p99_ms," << name << "_max_ms";
+    }
+    stream << ",stutters";
+    for (int counter=0; counter<counters::COUNTER_COUNT; counter++)
+        stream << "," << counters::getName(static_cast<counters::Counter>(counter));
+    stream << "\n";
+}
+
+void FrameMetrics::writeCsvRow(std::ostream &stream) const
+{
+    // One row per interval, counters as increments over it
+    stream << std::fixed << std::setprecision(3) << std::chrono::duration<double>(Clock::now() - startTime).count();
+    for (int series=0; series<SERIES_COUNT; series++)
+    {
+        Summary const summary = getSummary(static_cast<Series>(series));
+        stream << "," << summary.frames << "," << summary.meanMs << "," << summary.p50Ms << "," << summary.p95Ms << "," << summary.p99Ms << "," << summary.maxMs;
+    }
+    stream << "," << stutters;
+    for (int counter=0; counter<counters::COUNTER_COUNT; counter++)
+        stream << "," << getCounter(static_cast<counters::Counter>(counter));
+    stream << "\n";
+}
+
+void FrameMetrics::exportFile()
+{
+    if (format == Csv)
+    {
+        // Start a fresh file each run, appending afterwards
+        std::ofstream file(filename, csvStarted ? std::ios::app : std::ios::trunc);
+        if (!file)
+            throw std::exception("Failed to open metrics file for writing.");
+        if (!csvStarted)
+            writeCsvHeader(file);
+        writeCsvRow(file);
+        csvStarted = true;
+        return;
+    }
+
+    // Replace the file whole so scrapers never read it half written
+    std::string const temporary = filename + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::trunc);
+        if (!file)
+            throw std::exception("Failed to open metrics file for writing.");
+        writePrometheus(file);
+    }
+    std::filesystem::rename(temporary, filename);
+}
+
+char const *FrameMetrics::getName(Series series)
+{
+    switch (series)
+    {
+    case CpuTime: return "frame_cpu";
+    case GpuTime: return "frame_gpu";
+    default: return "present_interval";
+    }
+}
@@ -0,0 +1,185 @@
+
+#include "profiling/gpuProfiler.hpp"
+
+#include "configuration/device.hpp"
+#include "configuration/physicalDevice.hpp"
+#include "utility/check.hpp"
+#include "utility/json.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+
+GpuProfiler::GpuProfiler(Device const *device, PhysicalDevice const *physicalDevice, int framesInFlight) : device(device)
+{
+    // Timestamps need support on the main queue family
+    uint32_t nQueueFamilies = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice->getHandle(), &nQueueFamilies, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(nQueueFamilies);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice->getHandle(), &nQueueFamilies, queueFamilies.data());
+    uint32_t const validBits = queueFamilies[physicalDevice->getMainQueueFamilyIndex()].timestampValidBits;
+    supported = validBits > 0 && physicalDevice->getProperties().limits.timestampPeriod > 0.0f;
+    timestampPeriod = physicalDevice->getProperties().limits.timestampPeriod;
+    validMask = validBits >= 64 ? UINT64_MAX : (1ull << validBits) - 1;
+    if (!supported)
+        return;
+
+    // Two queries per scope in each frame's pool
+    for (int i=0; i<framesInFlight; i++)
+    {
+        VkQueryPoolCreateInfo poolInfo
+        {
+            .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+            .queryType = VK_QUERY_TYPE_TIMESTAMP,
+            .queryCount = 2*MAX_SCOPES
+        };
+        FrameQueries queries;
+        check::fail( vkCreateQueryPool(device->getHandle(), &poolInfo, nullptr, &queries.pool), "vkCreateQueryPool failed." );
+        frames.push_back(queries);
+    }
+}
+
+GpuProfiler::~GpuProfiler()
+{
+    for (FrameQueries &queries : frames)
+        vkDestroyQueryPool(device->getHandle(), queries.pool, nullptr);
+}
+
+void GpuProfiler::beginFrame(VkCommandBuffer const &commandBuffer)
+{
+    if (!supported)
+        return;
+
+    // The previous use of this frame's pool has completed, so reading it can't stall
+    current = &frames[frameCount++ % frames.size()];
+    collect(*current);
+    current->scopes.clear();
+    openScopes.clear();
+    vkCmdResetQueryPool(commandBuffer, current->pool, 0, 2*MAX_SCOPES);
+    current->recorded = true;
+    beginScope(commandBuffer, "Frame");
+}
+
+void GpuProfiler::endFrame(VkCommandBuffer const &commandBuffer)
+{
+    if (!supported)
+        return;
+    while (!openScopes.empty())
+        endScope(commandBuffer);
+}
+
+void GpuProfiler::beginScope(VkCommandBuffer const &commandBuffer, std::string const &name)
+{
+    if (!supported || current == nullptr)
+        return;
+    if (current->scopes.size() == MAX_SCOPES)
+        throw std::exception("Too many GPU profiler scopes in one frame.");
+
+    // Find or add rolling timing of this name
+    auto [it, added] = timingIds.try_emplace(name, static_cast<uint32_t>(timings.size()));
+    if (added)
+        timings.push_back(Timing{ .name = name, .depth = static_cast<uint32_t>(openScopes.size()) });
+
+    uint32_t const index = static_cast<uint32_t>(current->scopes.size());
+    current->scopes.push_back(Scope{ .timing = it->second, .depth = static_cast<uint32_t>(openScopes.size()) });
+    openScopes.push_back(index);
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, current->pool, 2*index);
+}
+
+void GpuProfiler::endScope(VkCommandBuffer const &commandBuffer)
+{
+    if (!supported || openScopes.empty())
+        return;
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, current->pool, 2*openScopes.back() + 1);
+    openScopes.pop_back();
+}
+
+bool GpuProfiler::isSupported() const
+{
+    return supported;
+}
+
+std::vector<GpuProfiler::Result> GpuProfiler::getResults() const
+{
+    std::vector<Result> results;
+    for (Timing const &timing : timings)
+    {
+        if (timing.samples.empty())
+            continue;
+        auto [min, max] = std::minmax_element(timing.samples.begin(), timing.samples.end());
+        results.push_back(Result
+        {
+            .name = timing.name,
+            .depth = timing.depth,
+            .lastMs = timing.last,
+            .averageMs = std::accumulate(timing.samples.begin(), timing.samples.end(), 0.0) / timing.samples.size(),
+            .minMs = *min,
+            .maxMs = *max
+        });
+    }
+    return results;
+}
+
+double GpuProfiler::getFrameMs() const
+{
+    auto it = timingIds.find("Frame");
+    if (it == timingIds.end() || timings[it->second].samples.empty())
+        return -1.0;
+    return timings[it->second].last;
+}
+
+void GpuProfiler::writeJson(std::ostream &stream) const
+{
+    stream << "{\n  \"timestampPeriodNs\": " << timestampPeriod << ",\n  \"window\": " << WINDOW << ",\n  \"scopes\": [";
+    std::vector<Result> results = getResults();
+    for (size_t i=0; i<results.size(); i++)
+    {
+        Result const &result = results[i];
+        stream << (i == 0 ? "\n" : ",\n") << "    { \"name\": " << json::quote(result.name) << ", \"depth\": " << result.depth
+               << ", \"lastMs\": " << result.lastMs << ", \"averageMs\": " << result.averageMs
+               << ", \"minMs\": " << result.minMs << ", \"maxMs\": " << result.maxMs << " }";
+    }
+    stream << "\n  ]\n}\n";
+}
+
+void GpuProfiler::exportJson(std::string const &filename) const
+{
+    std::ofstream file(filename);
+    if (!file)
+        throw std::exception("Failed to open GPU profile for writing.");
+    writeJson(file);
+}
+
+void GpuProfiler::collect(FrameQueries &queries)
+{
+    if (!queries.recorded || queries.scopes.empty())
+        return;
+
+    // Skip the frame rather than wait if results are somehow not available yet
+    std::vector<uint64_t> timestamps(2*queries.scopes.size());
+    VkResult result = vkGetQueryPoolResults(device->getHandle(), queries.pool, 0, static_cast<uint32_t>(timestamps.size()), timestamps.size()*sizeof(uint64_t), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    if (result == VK_NOT_READY)
+        return;
+    check::fail(result, "vkGetQueryPoolResults failed.");
+
+    // Convert ticks to milliseconds, accumulating scopes repeated within a frame
+    std::vector<double> durations(timings.size(), -1.0);
+    for (size_t i=0; i<queries.scopes.size(); i++)
+    {
+        uint64_t const ticks = ((timestamps[2*i + 1] & validMask) - (timestamps[2*i] & validMask)) & validMask;
+        double &duration = durations[queries.scopes[i].timing];
+        duration = std::max(duration, 0.0) + ticks * timestampPeriod / 1e6;
+    }
+    for (size_t i=0; i<timings.size(); i++)
+    {
+        if (durations[i] < 0.0)
+            continue;
+        Timing &timing = timings[i];
+        if (timing.samples.size() < WINDOW)
+            timing.samples.push_back(durations[i]);
+        else
+            timing.samples[timing.next] = durations[i];
+        timing.next = (timing.next + 1) % WINDOW;
+        timing.last = durations[i];
+    }
+}
@@ -0,0 +1,79 @@
+
+#include "profiling/histogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+Histogram::Histogram() : buckets(1 + (MAX_EXPONENT - MIN_EXPONENT)*SUB_BUCKETS, 0)
+{ }
+
+void Histogram::record(double milliseconds)
+{
+    buckets[getBucket(milliseconds)]++;
+    count++;
+    sum += milliseconds;
+    max = std::max(max, milliseconds);
+}
+
+void Histogram::reset()
+{
+    std::fill(buckets.begin(), buckets.end(), 0);
+    count = 0;
+    sum = 0.0;
+    max = 0.0;
+}
+
+uint64_t Histogram::getCount() const
+{
+    return count;
+}
+
+double Histogram::getMean() const
+{
+    return count == 0 ? 0.0 : sum / count;
+}
+
+double Histogram::getMax() const
+{
+    return max;
+}
+
+double Histogram::getPercentile(double p) const
+{
+    if (count == 0)
+        return 0.0;
+
+    // Walk buckets until the sample at rank ceil(p*count) is reached, never reporting above the exact maximum
+    uint64_t const rank = std::clamp<uint64_t>(static_cast<uint64_t>(std::ceil(p * count)), 1, count);
+    uint64_t seen = 0;
+    for (uint32_t bucket=0; bucket<buckets.size(); bucket++)
+    {
+        seen += buckets[bucket];
+        if (seen >= rank)
+            return std::min(getBucketMidpoint(bucket), max);
+    }
+    return max;
+}
+
+uint32_t Histogram::getBucket(double milliseconds)
+{
+    // Bucket 0 holds everything below the smallest power of two, the last bucket everything above the largest
+    int exponent;
+    double const mantissa = std::frexp(milliseconds, &exponent);
+    exponent--;
+    if (!(milliseconds > 0.0) || exponent < MIN_EXPONENT)
+        return 0;
+    if (exponent >= MAX_EXPONENT)
+        return (MAX_EXPONENT - MIN_EXPONENT)*SUB_BUCKETS;
+    uint32_t const sub = static_cast<uint32_t>((2.0*mantissa - 1.0) * SUB_BUCKETS);
+    return 1 + (exponent - MIN_EXPONENT)*SUB_BUCKETS + std::min(sub, SUB_BUCKETS-1);
+}
+
+double Histogram::getBucketMidpoint(uint32_t bucket)
+{
+    if (bucket == 0)
+        return std::ldexp(0.5, MIN_EXPONENT);
+    int const exponent = MIN_EXPONENT + static_cast<int>((bucket-1) / SUB_BUCKETS);
+    uint32_t const sub = (bucket-1) % SUB_BUCKETS;
+    return std::ldexp(1.0 + (sub + 0.5) / SUB_BUCKETS, exponent);
+}
@@ -0,0 +1,176 @@
+
+#include "profiling/pipelineStatistics.hpp"
+
+#include "configuration/device.hpp"
+#include "configuration/physicalDevice.hpp"
+#include "profiling/counters.hpp"
+#include "utility/check.hpp"
+
+namespace
+{
+    VkQueryPipelineStatisticFlags constexpr STATISTIC_FLAGS =
+        VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+
+    counters::Counter constexpr COUNTERS[PipelineStatistics::STATISTIC_COUNT]
+    {
+        counters::VertexInvocations,
+        counters::ClippingInvocations,
+        counters::ClippingPrimitives,
+        counters::FragmentInvocations
+    };
+}
+
+double PipelineStatistics::Result::getOverdraw() const
+{
+    return pixels > 0 ? static_cast<double>(statistics[FragmentInvocations]) / pixels : 0.0;
+}
+
+PipelineStatistics::PipelineStatistics(Device const *device, PhysicalDevice const *physicalDevice, int framesInFlight) : device(device)
+{
+    // The device enables both features wherever they are supported
+    VkPhysicalDeviceFeatures features;
+    vkGetPhysicalDeviceFeatures(physicalDevice->getHandle(), &features);
+    statisticsSupported = features.pipelineStatisticsQuery;
+    occlusionPrecise = features.occlusionQueryPrecise;
+    if (!statisticsSupported)
+        return;
+
+    // One query of each type per pass in each frame's pools
+    for (int i=0; i<framesInFlight; i++)
+    {
+        FrameQueries queries;
+        VkQueryPoolCreateInfo statisticsInfo
+        {
+            .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+            .queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS,
+            .queryCount = MAX_PASSES,
+            .pipelineStatistics = STATISTIC_FLAGS
+        };
+        check::fail( vkCreateQueryPool(device->getHandle(), &statisticsInfo, nullptr, &queries.statisticsPool), "vkCreateQueryPool failed." );
+        VkQueryPoolCreateInfo occlusionInfo
+        {
+            .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+            .queryType = VK_QUERY_TYPE_OCCLUSION,
+            .queryCount = MAX_PASSES
+        };
+        check::fail( vkCreateQueryPool(device->getHandle(), &occlusionInfo, nullptr, &queries.occlusionPool), "vkCreateQueryPool failed." );
+        frames.push_back(queries);
+    }
+}
+
+PipelineStatistics::~PipelineStatistics()
+{
+    for (FrameQueries &queries : frames)
+    {
+        vkDestroyQueryPool(device->getHandle(), queries.statisticsPool, nullptr);
+        vkDestroyQueryPool(device->getHandle(), queries.occlusionPool, nullptr);
+    }
+}
+
+void PipelineStatistics::beginFrame(VkCommandBuffer const &commandBuffer)
+{
+    if (!statisticsSupported)
+        return;
+
+    // The previous use of this frame's pools has completed, so reading them can't stall
+    current = &frames[frameCount++ % frames.size()];
+    collect(*current);
+    current->passes.clear();
+    open = false;
+    vkCmdResetQueryPool(commandBuffer, current->statisticsPool, 0, MAX_PASSES);
+    vkCmdResetQueryPool(commandBuffer, current->occlusionPool, 0, MAX_PASSES);
+    current->recorded = true;
+}
+
+void PipelineStatistics::beginPass(VkCommandBuffer const &commandBuffer, std::string const &name, VkExtent2D const &extent)
+{
+    if (!statisticsSupported || current == nullptr)
+        return;
+    if (open)
+        throw std::exception("Pipeline statistics passes cannot nest.");
+    if (current->passes.size() == MAX_PASSES)
+        throw std::exception("Too many pipeline statistics passes in one frame.");
+
+    // Find or add the result of this name
+    auto [it, added] = resultIds.try_emplace(name, static_cast<uint32_t>(results.size()));
+    if (added)
+        results.push_back(Result{ .name = name });
+
+    uint32_t const index = static_cast<uint32_t>(current->passes.size());
+    current->passes.push_back(Pass{ .result = it->second, .pixels = static_cast<uint64_t>(extent.width) * extent.height });
+    vkCmdBeginQuery(commandBuffer, current->statisticsPool, index, 0);
+    vkCmdBeginQuery(commandBuffer, current->occlusionPool, index, occlusionPrecise ? VK_QUERY_CONTROL_PRECISE_BIT : 0);
+    open = true;
+}
+
+void PipelineStatistics::endPass(VkCommandBuffer const &commandBuffer)
+{
+    if (!statisticsSupported || !open)
+        return;
+    uint32_t const index = static_cast<uint32_t>(current->passes.size()) - 1;
+    vkCmdEndQuery(commandBuffer, current->occlusionPool, index);
+    vkCmdEndQuery(commandBuffer, current->statisticsPool, index);
+    open = false;
+}
+
+bool PipelineStatistics::isSupported() const
+{
+    return statisticsSupported;
+}
+
+std::vector<PipelineStatistics::Result> const &PipelineStatistics::getResults() const
+{
+    return results;
+}
+
+char const *PipelineStatistics::getName(Statistic statistic)
+{
+    switch (statistic)
+    {
+    case VertexInvocations: return "vertex_invocations";
+    case ClippingInvocations: return "clipping_invocations";
+    case ClippingPrimitives: return "clipping_primitives";
+    default: return "fragment_invocations";
+    }
+}
+
+void PipelineStatistics::collect(FrameQueries &queries)
+{
+    if (!queries.recorded || queries.passes.empty())
+        return;
+
+    // Skip the frame rather than wait if results are somehow not available yet
+    uint32_t const nPasses = static_cast<uint32_t>(queries.passes.size());
+    std::vector<uint64_t> statistics(nPasses * STATISTIC_COUNT);
+    VkResult result = vkGetQueryPoolResults(device->getHandle(), queries.statisticsPool, 0, nPasses, statistics.size()*sizeof(uint64_t), statistics.data(), STATISTIC_COUNT*sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    if (result == VK_NOT_READY)
+        return;
+    check::fail(result, "vkGetQueryPoolResults failed.");
+    std::vector<uint64_t> samples(nPasses);
+    result = vkGetQueryPoolResults(device->getHandle(), queries.occlusionPool, 0, nPasses, samples.size()*sizeof(uint64_t), samples.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    if (result == VK_NOT_READY)
+        return;
+    check::fail(result, "vkGetQueryPoolResults failed.");
+
+    // Replace each pass's last frame, accumulating passes repeated within a frame, and add to the engine counters
+    for (Pass const &pass : queries.passes)
+        results[pass.result] = Result{ .name = results[pass.result].name };
+    for (uint32_t i=0; i<nPasses; i++)
+    {
+        Result &passResult = results[queries.passes[i].result];
+        for (int statistic=0; statistic<STATISTIC_COUNT; statistic++)
+        {
+            passResult.statistics[statistic] += statistics[i*STATISTIC_COUNT + statistic];
+            counters::add(COUNTERS[statistic], statistics[i*STATISTIC_COUNT + statistic]);
+        }
+        if (occlusionPrecise)
+        {
+            passResult.samplesPassed += samples[i];
+            counters::add(counters::SamplesPassed, samples[i]);
+        }
+        passResult.pixels += queries.passes[i].pixels;
+    }
+}
@@ -0,0 +1,298 @@
+
+#include "render/deferredRenderer.hpp"
+
+#include "configuration/device.hpp"
+#include "configuration/physicalDevice.hpp"
+#include "configuration/shaderModule.hpp"
+#include "swapchain/swapchain.hpp"
+#include "swapchain/renderPass.hpp"
+#include "swapchain/pipeline.hpp"
+#include "swapchain/image.hpp"
+#include "compute/asyncCompute.hpp"
+#include "compute/computePipeline.hpp"
+#include "memory/attachment.hpp"
+#include "memory/deletionQueue.hpp"
+#include "memory/descriptorAllocator.hpp"
+#include "memory/descriptorSetLayout.hpp"
+#include "memory/typedBuffer.hpp"
+#include "frame/frame.hpp"
+#include "asset/assetPack.hpp"
+#include "profiling/cpuTrace.hpp"
+#include "profiling/pipelineStatistics.hpp"
+#include "utility/check.hpp"
+#include "utility/io.hpp"
+
+namespace
+{
+    /** Matches the push constants of the light animation shader */
+    struct AnimateConstants
+    {
+        float time;
+        uint32_t count;
+    };
+
+    uint32_t const ANIMATE_GROUP_SIZE = 64;
+}
+
+std::vector<VkFormat> const DeferredRenderer::G_BUFFER_FORMATS
+{
+    VK_FORMAT_R8G8B8A8_UNORM,
+    VK_FORMAT_R16G16B16A16_SFLOAT,
+    VK_FORMAT_R16G16B16A16_SFLOAT
+};
+
+DeferredRenderer::DeferredRenderer(Device const *device, PhysicalDevice const *physicalDevice, DescriptorSetLayout const *descriptorSetLayout, VertexLayout const &vertexLayout, std::vector<PointLight> const &lights, AssetPack const *assetPack, DescriptorSetLayout const *bindlessLayout, DeletionQueue *deletionQueue, AsyncCompute *asyncCompute)
+    : device(device), physicalDevice(physicalDevice), descriptorSetLayout(descriptorSetLayout), bindlessLayout(bindlessLayout), assetPack(assetPack), deletionQueue(deletionQueue), vertexLayout(vertexLayout), asyncCompute(asyncCompute)
+{
+    if (lights.empty())
+        throw std::exception("Deferred rendering needs at least one light.");
+
+    // The G-buffer shader decodes normals from the octahedral map alone
+    if (vertexLayout.normal != VertexLayout::NormalOctahedral)
+        throw std::exception("Deferred rendering needs octahedral normals.");
+
+    // G-buffer input attachments followed by the lights, all read by the lighting subpass
+    std::vector<VkDescriptorSetLayoutBinding> bindings;
+    for (uint32_t i=0; i<G_BUFFER_FORMATS.size(); i++)
+        bindings.push_back(VkDescriptorSetLayoutBinding
+        {
+            .binding = i,
+            .descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT
+        });
+    bindings.push_back(VkDescriptorSetLayoutBinding
+    {
+        .binding = static_cast<uint32_t>(G_BUFFER_FORMATS.size()),
+        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .descriptorCount = 1,
+        .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT
+    });
+    lightingLayout = new DescriptorSetLayout(device, bindings);
+
+    // Lights are written once, so stay host visible rather than staged
+    lightBuffer = new TypedBuffer<PointLight>(
+        device, physicalDevice, sizeof(PointLight) * lights.size(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+    );
+    lightBuffer->memcpy(lights);
+    currentLights = lightBuffer;
+    if (asyncCompute == nullptr)
+        return;
+
+    // Animation reads the placed lights and writes the frame's copy
+    std::vector<VkDescriptorSetLayoutBinding> animateBindings;
+    for (uint32_t i=0; i<2; i++)
+        animateBindings.push_back(VkDescriptorSetLayoutBinding
+        {
+            .binding = i,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT
+        });
+    animateLayout = new DescriptorSetLayout(device, animateBindings);
+    animatePipeline = new ComputePipeline(
+        device, ShaderModule(device, readShader("shaders/bin/animateLights.comp.spv")), { animateLayout },
+        { VkPushConstantRange{ .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT, .offset = 0, .size = sizeof(AnimateConstants) } }
+    );
+
+    // Written on the compute queue and read on the main one, so shared between both families rather than transferred each frame
+    animateDescriptors = new DescriptorAllocator(device, asyncCompute->getFrameCount());
+    for (uint32_t i=0; i<asyncCompute->getFrameCount(); i++)
+    {
+        animatedLights.push_back(new TypedBuffer<PointLight>(
+            device, physicalDevice, sizeof(PointLight) * lights.size(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, asyncCompute->getQueueFamilies()
+        ));
+        animateSets.push_back(animateDescriptors->get(animateLayout, {
+            DescriptorAllocator::Binding::ofBuffer(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, *lightBuffer),
+            DescriptorAllocator::Binding::ofBuffer(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, *animatedLights.back())
+        }));
+    }
+}
+
+DeferredRenderer::~DeferredRenderer()
+{
+    release()();
+    delete animateDescriptors;
+    for (TypedBuffer<PointLight> *lights : animatedLights)
+        delete lights;
+    delete animatePipeline;
+    delete animateLayout;
+    delete lightBuffer;
+    delete lightingLayout;
+}
+
+void DeferredRenderer::prepare(Swapchain const *swapchain)
+{
+    // Recreating the swapchain replaces its depth attachment, and may change the extent and formats everything here was built for
+    Attachment const *depthAttachment = swapchain->getDepthAttachment();
+    if (depthAttachment->getImageView() == depthView)
+        return;
+    TRACE_ZONE("DeferredRenderer::prepare");
+    if (renderPass != nullptr)
+    {
+        std::function<void()> destroyOld = release();
+        if (deletionQueue != nullptr)
+            deletionQueue->retire(std::move(destroyOld));
+        else
+        {
+            vkDeviceWaitIdle(device->getHandle());
+            destroyOld();
+        }
+    }
+    depthView = depthAttachment->getImageView();
+    extent = swapchain->getExtent();
+
+    // Subpasses need a render pass object, so this is used with or without dynamic rendering
+    renderPass = new RenderPass(device, swapchain->getRenderPass()->getFormat(), depthAttachment->getFormat(), G_BUFFER_FORMATS);
+
+    // Transient and lazily allocated where the device allows, as nothing outside the pass reads them
+    for (VkFormat const &format : G_BUFFER_FORMATS)
+        gBuffer.push_back(new Attachment(
+            device, physicalDevice, format, extent,
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT, VK_IMAGE_ASPECT_COLOR_BIT
+        ));
+
+    // Geometry takes the same sets and constants as forward rendering, lighting only its own set and no vertices
+    std::vector<DescriptorSetLayout const *> setLayouts{ descriptorSetLayout };
+    if (bindlessLayout != nullptr)
+        setLayouts.push_back(bindlessLayout);
+    geometryPipeline = new Pipeline(
+        device,
+        ShaderModule(device, readShader("shaders/bin/gBuffer.vert.spv")),
+        ShaderModule(device, readShader(bindlessLayout != nullptr ? "shaders/bin/gBufferBindless.frag.spv" : "shaders/bin/gBuffer.frag.spv")),
+        renderPass, extent, setLayouts, vertexLayout.getVertexInput(), false, { DrawConstants::getRange() }, 0
+    );
+    lightingPipeline = new Pipeline(
+        device,
+        ShaderModule(device, readShader("shaders/bin/lighting.vert.spv")),
+        ShaderModule(device, readShader("shaders/bin/lighting.frag.spv")),
+        renderPass, extent, { lightingLayout }, vertexInput::State{}, false, {}, 1
+    );
+}
+
+RenderPass *DeferredRenderer::getRenderPass()
+{
+    return renderPass;
+}
+
+Pipeline const *DeferredRenderer::getGeometryPipeline() const
+{
+    return geometryPipeline;
+}
+
+void DeferredRenderer::setStatistics(PipelineStatistics *statistics)
+{
+    this->statistics = statistics;
+}
+
+VkSemaphore DeferredRenderer::animate(uint64_t frameIndex, float time)
+{
+    if (asyncCompute == nullptr)
+        return VK_NULL_HANDLE;
+    TRACE_ZONE("DeferredRenderer::animate");
+
+    // The frame's fence covers the lighting that last read this copy, so it is free to overwrite
+    uint32_t const slot = static_cast<uint32_t>(frameIndex % animatedLights.size());
+    currentLights = animatedLights[slot];
+    AnimateConstants const constants
+    {
+        .time = time,
+        .count = static_cast<uint32_t>(lightBuffer->getNElements())
+    };
+    return asyncCompute->submit(frameIndex, [&](VkCommandBuffer const &commandBuffer)
+    {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, animatePipeline->getHandle());
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, animatePipeline->getLayout(), 0, 1, &animateSets[slot]->getHandle(), 0, nullptr);
+        vkCmdPushConstants(commandBuffer, animatePipeline->getLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(AnimateConstants), &constants);
+        vkCmdDispatch(commandBuffer, ComputePipeline::getGroupCount(constants.count, ANIMATE_GROUP_SIZE), 1, 1);
+    });
+}
+
+void DeferredRenderer::run(Image const &image, Frame &frame, VkCommandBuffer const &commandBuffer, std::function<void()> geometry)
+{
+    TRACE_ZONE("DeferredRenderer::run");
+    if (renderPass == nullptr)
+        throw std::exception("Deferred renderer run before being prepared.");
+
+    // Lighting reads the G-buffer and lights through one of this frame's transient sets
+    std::vector<DescriptorAllocator::Binding> bindings;
+    for (uint32_t i=0; i<gBuffer.size(); i++)
+        bindings.push_back(DescriptorAllocator::Binding::ofImage(i, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, gBuffer[i]->getImageView(), VK_NULL_HANDLE));
+    bindings.push_back(DescriptorAllocator::Binding::ofBuffer(static_cast<uint32_t>(gBuffer.size()), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, *currentLights));
+    DescriptorSet const *lightingSet = frame.getTransientDescriptors().get(lightingLayout, bindings);
+
+    renderPass->run(getFramebuffer(image.imageView, depthView), extent, commandBuffer, [&]()
+    {
+        // Fill the G-buffer, queries having to end in the subpass they began in
+        if (statistics != nullptr)
+            statistics->beginPass(commandBuffer, "Geometry", extent);
+        geometry();
+        if (statistics != nullptr)
+            statistics->endPass(commandBuffer);
+
+        // Shade every pixel once, reading the G-buffer where it was written
+        renderPass->nextSubpass(commandBuffer);
+        if (statistics != nullptr)
+            statistics->beginPass(commandBuffer, "Lighting", extent);
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, lightingPipeline->getHandle());
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, lightingPipeline->getLayout(), 0, 1, &lightingSet->getHandle(), 0, nullptr);
+        vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+        if (statistics != nullptr)
+            statistics->endPass(commandBuffer);
+    });
+}
+
+std::function<void()> DeferredRenderer::release()
+{
+    // Hand over everything built for the current swapchain, leaving members free for the next
+    std::function<void()> destroy = [device = device, renderPass = renderPass, geometryPipeline = geometryPipeline, lightingPipeline = lightingPipeline, gBuffer = std::move(gBuffer), framebuffers = std::move(framebuffers)]()
+    {
+        for (auto const &[imageView, framebuffer] : framebuffers)
+            vkDestroyFramebuffer(device->getHandle(), framebuffer, nullptr);
+        for (Attachment *attachment : gBuffer)
+            delete attachment;
+        delete lightingPipeline;
+        delete geometryPipeline;
+        delete renderPass;
+    };
+    gBuffer.clear();
+    framebuffers.clear();
+    renderPass = nullptr;
+    geometryPipeline = nullptr;
+    lightingPipeline = nullptr;
+    return destroy;
+}
+
+VkFramebuffer DeferredRenderer::getFramebuffer(VkImageView const &imageView, VkImageView const &swapchainDepthView)
+{
+    // One per swapchain image, created on first use since the images are only seen through acquisition
+    auto [it, added] = framebuffers.try_emplace(imageView, VK_NULL_HANDLE);
+    if (!added)
+        return it->second;
+
+    std::vector<VkImageView> attachments{ imageView, swapchainDepthView };
+    for (Attachment const *attachment : gBuffer)
+        attachments.push_back(attachment->getImageView());
+    VkFramebufferCreateInfo framebufferInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+        .renderPass = renderPass->getHandle(),
+        .attachmentCount = static_cast<uint32_t>(attachments.size()),
+        .pAttachments = attachments.data(),
+        .width = extent.width,
+        .height = extent.height,
+        .layers = 1
+    };
+    check::fail( vkCreateFramebuffer(device->getHandle(), &framebufferInfo, nullptr, &it->second), "vkCreateFramebuffer failed." );
+    return it->second;
+}
+
+std::vector<char> DeferredRenderer::readShader(char const *filename) const
+{
+    // Prefer the mapped asset pack over loose files
+    if (assetPack != nullptr && assetPack->contains(filename))
+        return assetPack->read(filename);
+    return io::readFile(filename, std::ios::binary);
+}
@@ -0,0 +1,98 @@
+
+#include "render/radixSort.hpp"
+
+#include <algorithm>
+#include <array>
+#include <barrier>
+#include <thread>
+
+namespace
+{
+    uint32_t constexpr RADIX_BITS = 8;
+    uint32_t constexpr N_BUCKETS = 1 << RADIX_BITS;
+    uint32_t constexpr N_PASSES = 64 / RADIX_BITS;
+
+    using Histogram = std::array<size_t, N_BUCKETS>;
+
+    uint32_t digit(uint64_t key, uint32_t pass)
+    {
+        return static_cast<uint32_t>(key >> (pass*RADIX_BITS)) & (N_BUCKETS-1);
+    }
+}
+
+void radixSort::sort(std::vector<Entry> &entries, std::vector<Entry> &scratch, uint32_t nThreads)
+{
+    size_t const n = entries.size();
+    if (n < 2)
+        return;
+
+    // Only bytes that differ between some keys need a pass
+    uint64_t differing = 0;
+    for (Entry const &entry : entries)
+        differing |= entry.key ^ entries[0].key;
+    std::vector<uint32_t> passes;
+    for (uint32_t pass=0; pass<N_PASSES; pass++)
+        if (digit(differing, pass) != 0)
+            passes.push_back(pass);
+    if (passes.empty())
+        return;
+
+    // Split into contiguous chunks, one per thread, so scattering chunks in order keeps the sort stable
+    if (nThreads == 0)
+        nThreads = std::max(1u, std::thread::hardware_concurrency());
+    if (n < PARALLEL_THRESHOLD)
+        nThreads = 1;
+    size_t const chunkSize = (n + nThreads - 1) / nThreads;
+    std::vector<Histogram> histograms(nThreads);
+    scratch.resize(n);
+
+    auto worker = [&](uint32_t thread, auto &&synchronise)
+    {
+        size_t const begin = std::min(n, thread*chunkSize), end = std::min(n, begin+chunkSize);
+        Entry *source = entries.data(), *destination = scratch.data();
+        for (uint32_t pass : passes)
+        {
+            // Count this chunk's digits
+            Histogram &histogram = histograms[thread];
+            histogram.fill(0);
+            for (size_t i=begin; i<end; i++)
+                histogram[digit(source[i].key, pass)]++;
+            synchronise();
+
+            // Turn counts into this chunk's write cursors: every smaller bucket, then earlier chunks within this bucket
+            Histogram cursors;
+            size_t total = 0;
+            for (uint32_t bucket=0; bucket<N_BUCKETS; bucket++)
+                for (uint32_t other=0; other<nThreads; other++)
+                {
+                    if (other == thread)
+                        cursors[bucket] = total;
+                    total += histograms[other][bucket];
+                }
+            synchronise();
+
+            // Scatter
+            for (size_t i=begin; i<end; i++)
+                destination[cursors[digit(source[i].key, pass)]++] = source[i];
+            synchronise();
+            std::swap(source, destination);
+        }
+    };
+
+    if (nThreads == 1)
+        worker(0, []() {});
+    else
+    {
+        std::barrier barrier(nThreads);
+        std::vector<std::thread> workers;
+        for (uint32_t thread=1; thread<nThreads; thread++)
+            workers.emplace_back([&, thread]() { worker(thread, [&]() { barrier.arrive_and_wait(); }); });
+        worker(0, [&]() { barrier.arrive_and_wait(); });
+        for (std::thread &thread : workers)
+            thread.join();
+    }
+
+    // Odd pass counts leave the result in scratch
+    if (passes.size() % 2 == 1)
+        entries.swap(scratch);
+}
@@ -0,0 +1,671 @@
+
+#include "render/renderGraph.hpp"
+
+#include "configuration/device.hpp"
+#include "configuration/physicalDevice.hpp"
+#include "memory/deletionQueue.hpp"
+#include "profiling/cpuTrace.hpp"
+#include "profiling/pipelineStatistics.hpp"
+#include "utility/check.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+    /** Layout, synchronisation scope and image usage each access needs */
+    struct AccessInfo
+    {
+        VkImageLayout layout;
+        VkPipelineStageFlags stages;
+        VkAccessFlags access;
+        VkImageUsageFlags usage;
+        bool write;
+    };
+
+    AccessInfo const ACCESSES[RenderGraph::ACCESS_COUNT]
+    {
+        { VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_READ_BIT|VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, true },
+        { VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT|VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT|VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, true },
+        { VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_USAGE_SAMPLED_BIT, false },
+        { VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_USAGE_SAMPLED_BIT, false },
+        { VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_USAGE_STORAGE_BIT, false },
+        { VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT|VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_USAGE_STORAGE_BIT, true },
+        { VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT|VK_ACCESS_INDEX_READ_BIT, 0, false },
+        { VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT, 0, false },
+        { VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_USAGE_TRANSFER_SRC_BIT, false },
+        { VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_USAGE_TRANSFER_DST_BIT, true }
+    };
+
+    bool isAttachment(RenderGraph::Access access)
+    {
+        return access == RenderGraph::ColourAttachment || access == RenderGraph::DepthAttachment;
+    }
+
+    VkImageAspectFlags getBarrierAspect(VkFormat format, VkImageAspectFlags aspect)
+    {
+        // Without separate depth and stencil layouts, combined formats transition both aspects together
+        bool const stencil = format == VK_FORMAT_D16_UNORM_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT || format == VK_FORMAT_D32_SFLOAT_S8_UINT;
+        return (aspect & VK_IMAGE_ASPECT_DEPTH_BIT) && stencil ? aspect | VK_IMAGE_ASPECT_STENCIL_BIT : aspect;
+    }
+}
+
+RenderGraph::RenderGraph(Device const *device, PhysicalDevice const *physicalDevice, DeletionQueue *deletionQueue)
+    : device(device), physicalDevice(physicalDevice), deletionQueue(deletionQueue)
+{ }
+
+RenderGraph::~RenderGraph()
+{
+    release()();
+}
+
+RenderGraph::Resource RenderGraph::createImage(std::string const &name, VkFormat format, VkExtent2D const &extent, VkImageAspectFlags aspect)
+{
+    resources.push_back(ResourceInfo{ .name = name, .isImage = true, .imported = false, .format = format, .extent = extent, .aspect = aspect, .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED, .finalLayout = VK_IMAGE_LAYOUT_UNDEFINED });
+    compiled = false;
+    return static_cast<Resource>(resources.size() - 1);
+}
+
+RenderGraph::Resource RenderGraph::importImage(std::string const &name, VkFormat format, VkExtent2D const &extent, VkImageAspectFlags aspect, VkImageLayout initialLayout, VkImageLayout finalLayout)
+{
+    resources.push_back(ResourceInfo{ .name = name, .isImage = true, .imported = true, .format = format, .extent = extent, .aspect = aspect, .initialLayout = initialLayout, .finalLayout = finalLayout });
+    compiled = false;
+    return static_cast<Resource>(resources.size() - 1);
+}
+
+RenderGraph::Resource RenderGraph::importBuffer(std::string const &name)
+{
+    resources.push_back(ResourceInfo{ .name = name, .isImage = false, .imported = true, .format = VK_FORMAT_UNDEFINED, .extent = {}, .aspect = 0, .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED, .finalLayout = VK_IMAGE_LAYOUT_UNDEFINED });
+    compiled = false;
+    return static_cast<Resource>(resources.size() - 1);
+}
+
+void RenderGraph::addPass(std::string const &name, std::vector<Use> const &uses, Record record)
+{
+    for (Use const &use : uses)
+    {
+        if (use.resource >= resources.size())
+            throw std::exception("Render graph pass uses an undeclared resource.");
+        if (!resources[use.resource].isImage && (isAttachment(use.access) || use.access == FragmentSampled || use.access == ComputeSampled))
+            throw std::exception("Render graph buffers cannot be attachments or sampled.");
+    }
+    passes.push_back(Pass{ .name = name, .uses = uses, .record = std::move(record) });
+    compiled = false;
+}
+
+void RenderGraph::compile()
+{
+    TRACE_ZONE("RenderGraph::compile");
+    if (compiled)
+        return;
+    discard();
+    cull();
+    allocateTransients();
+    placeBarriers();
+    if (!device->supportsDynamicRendering())
+        createRenderPasses();
+    compiled = true;
+}
+
+void RenderGraph::reset()
+{
+    discard();
+    resources.clear();
+    passes.clear();
+    compiled = false;
+}
+
+void RenderGraph::setImage(Resource resource, VkImage image, VkImageView imageView)
+{
+    if (!resources[resource].imported || !resources[resource].isImage)
+        throw std::exception("Only imported render graph images can be set.");
+    resources[resource].image = image;
+    resources[resource].imageView = imageView;
+}
+
+void RenderGraph::setBuffer(Resource resource, VkBuffer buffer)
+{
+    if (resources[resource].isImage)
+        throw std::exception("Render graph resource is not a buffer.");
+    resources[resource].buffer = buffer;
+}
+
+VkImage RenderGraph::getImage(Resource resource) const
+{
+    return resources[resource].image;
+}
+
+VkImageView RenderGraph::getImageView(Resource resource) const
+{
+    return resources[resource].imageView;
+}
+
+void RenderGraph::setStatistics(PipelineStatistics *statistics)
+{
+    this->statistics = statistics;
+}
+
+void RenderGraph::execute(VkCommandBuffer const &commandBuffer)
+{
+    TRACE_ZONE("RenderGraph::execute");
+    if (!compiled)
+        throw std::exception("Render graph executed before being compiled.");
+
+    auto recordBarriers = [&](std::vector<Barrier> const &barriers, VkPipelineStageFlags srcStages, VkPipelineStageFlags dstStages)
+    {
+        std::vector<VkImageMemoryBarrier> imageBarriers;
+        std::vector<VkBufferMemoryBarrier> bufferBarriers;
+        for (Barrier const &barrier : barriers)
+        {
+            ResourceInfo const &resource = resources[barrier.resource];
+            if (resource.isImage)
+                imageBarriers.push_back(VkImageMemoryBarrier
+                {
+                    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                    .srcAccessMask = barrier.srcAccess,
+                    .dstAccessMask = barrier.dstAccess,
+                    .oldLayout = barrier.oldLayout,
+                    .newLayout = barrier.newLayout,
+                    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .image = resource.image,
+                    .subresourceRange = { getBarrierAspect(resource.format, resource.aspect), 0, 1, 0, 1 }
+                });
+            else
+                bufferBarriers.push_back(VkBufferMemoryBarrier
+                {
+                    .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+                    .srcAccessMask = barrier.srcAccess,
+                    .dstAccessMask = barrier.dstAccess,
+                    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .buffer = resource.buffer,
+                    .offset = 0,
+                    .size = VK_WHOLE_SIZE
+                });
+        }
+        if (!imageBarriers.empty() || !bufferBarriers.empty())
+            vkCmdPipelineBarrier(
+                commandBuffer, srcStages, dstStages, 0, 0, nullptr,
+                static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(),
+                static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data()
+            );
+    };
+
+    for (Pass &pass : passes)
+    {
+        if (pass.culled)
+            continue;
+        recordBarriers(pass.barriers, pass.srcStages, pass.dstStages);
+
+        // Passes without attachments record straight into the command buffer
+        if (pass.colourAttachments.empty() && pass.depthAttachment == UINT32_MAX)
+        {
+            pass.record(commandBuffer);
+            continue;
+        }
+
+        Resource const first = pass.colourAttachments.empty() ? pass.depthAttachment : pass.colourAttachments.front();
+        VkExtent2D const extent = resources[first].extent;
+        beginRendering(commandBuffer, pass, extent);
+        if (statistics != nullptr)
+            statistics->beginPass(commandBuffer, pass.name, extent);
+        pass.record(commandBuffer);
+        if (statistics != nullptr)
+            statistics->endPass(commandBuffer);
+        endRendering(commandBuffer, pass);
+    }
+
+    // Leave imported images as their owners expect
+    recordBarriers(finalBarriers, finalSrcStages, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+}
+
+bool RenderGraph::isCompiled() const
+{
+    return compiled;
+}
+
+uint32_t RenderGraph::getPassCount() const
+{
+    return static_cast<uint32_t>(passes.size());
+}
+
+uint32_t RenderGraph::getCulledCount() const
+{
+    return static_cast<uint32_t>(std::count_if(passes.begin(), passes.end(), [](Pass const &pass) { return pass.culled; }));
+}
+
+uint32_t RenderGraph::getBarrierCount() const
+{
+    uint32_t count = static_cast<uint32_t>(finalBarriers.size());
+    for (Pass const &pass : passes)
+        count += static_cast<uint32_t>(pass.barriers.size());
+    return count;
+}
+
+VkDeviceSize RenderGraph::getTransientSize() const
+{
+    return std::accumulate(blocks.begin(), blocks.end(), VkDeviceSize(0), [](VkDeviceSize total, Block const &block) { return total + block.size; });
+}
+
+void RenderGraph::cull()
+{
+    // Walk back from imported resources, keeping passes that produce something a kept pass or the caller uses
+    std::vector<bool> wanted(resources.size(), false);
+    for (size_t i=0; i<resources.size(); i++)
+        wanted[i] = resources[i].imported;
+    for (size_t i=passes.size(); i-- > 0; )
+    {
+        Pass &pass = passes[i];
+        pass.culled = std::none_of(pass.uses.begin(), pass.uses.end(), [&](Use const &use) { return ACCESSES[use.access].write && wanted[use.resource]; });
+        if (!pass.culled)
+            for (Use const &use : pass.uses)
+                wanted[use.resource] = true;
+    }
+
+    // Lifetimes and usage of what the remaining passes touch
+    for (uint32_t i=0; i<passes.size(); i++)
+    {
+        if (passes[i].culled)
+            continue;
+        for (Use const &use : passes[i].uses)
+        {
+            ResourceInfo &resource = resources[use.resource];
+            resource.firstPass = std::min(resource.firstPass, i);
+            resource.lastPass = std::max(resource.lastPass, i);
+            resource.usage |= ACCESSES[use.access].usage;
+        }
+    }
+}
+
+void RenderGraph::allocateTransients()
+{
+    // Create images, largest first so smaller ones fit into the blocks they make
+    std::vector<Resource> transients;
+    std::vector<VkMemoryRequirements> requirements(resources.size());
+    for (Resource i=0; i<resources.size(); i++)
+    {
+        ResourceInfo &resource = resources[i];
+        if (resource.imported || resource.firstPass == UINT32_MAX)
+            continue;
+        VkImageCreateInfo imageInfo
+        {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+            .imageType = VK_IMAGE_TYPE_2D,
+            .format = resource.format,
+            .extent = { resource.extent.width, resource.extent.height, 1 },
+            .mipLevels = 1,
+            .arrayLayers = 1,
+            .samples = VK_SAMPLE_COUNT_1_BIT,
+            .tiling = VK_IMAGE_TILING_OPTIMAL,
+            .usage = resource.usage,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
+        };
+        check::fail( vkCreateImage(device->getHandle(), &imageInfo, nullptr, &resource.image), "vkCreateImage failed." );
+        vkGetImageMemoryRequirements(device->getHandle(), resource.image, &requirements[i]);
+        transients.push_back(i);
+    }
+    std::sort(transients.begin(), transients.end(), [&](Resource a, Resource b) { return requirements[a].size > requirements[b].size; });
+
+    // Share a block with images whose lifetimes never overlap, every image bound at its start
+    for (Resource i : transients)
+    {
+        ResourceInfo &resource = resources[i];
+        auto overlaps = [&](Resource other) { return resource.firstPass <= resources[other].lastPass && resources[other].firstPass <= resource.lastPass; };
+        auto block = std::find_if(blocks.begin(), blocks.end(), [&](Block const &block)
+        {
+            return (block.memoryTypeBits & requirements[i].memoryTypeBits) != 0 && std::none_of(block.resources.begin(), block.resources.end(), overlaps);
+        });
+        if (block == blocks.end())
+        {
+            blocks.push_back(Block{ .size = 0, .memoryTypeBits = requirements[i].memoryTypeBits });
+            block = blocks.end() - 1;
+        }
+        block->size = std::max(block->size, requirements[i].size);
+        block->memoryTypeBits &= requirements[i].memoryTypeBits;
+        block->resources.push_back(i);
+        resource.block = static_cast<uint32_t>(block - blocks.begin());
+    }
+
+    // Allocate blocks, then bind and view their images
+    for (Block &block : blocks)
+    {
+        VkMemoryAllocateInfo allocInfo
+        {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+            .allocationSize = block.size,
+            .memoryTypeIndex = physicalDevice->findMemoryType(block.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+        };
+        check::fail( vkAllocateMemory(device->getHandle(), &allocInfo, nullptr, &block.memory), "vkAllocateMemory failed." );
+        for (Resource i : block.resources)
+        {
+            ResourceInfo &resource = resources[i];
+            check::fail( vkBindImageMemory(device->getHandle(), resource.image, block.memory, 0), "vkBindImageMemory failed." );
+            VkImageViewCreateInfo viewInfo
+            {
+                .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+                .image = resource.image,
+                .viewType = VK_IMAGE_VIEW_TYPE_2D,
+                .format = resource.format,
+                .subresourceRange = { resource.aspect, 0, 1, 0, 1 }
+            };
+            check::fail( vkCreateImageView(device->getHandle(), &viewInfo, nullptr, &resource.imageView), "vkCreateImageView failed." );
+        }
+    }
+}
+
+void RenderGraph::placeBarriers()
+{
+    // Imported resources may have been written by anything before the graph, and transient memory by the previous frame's graph
+    for (ResourceInfo &resource : resources)
+        resource.last = ResourceState{ resource.imported ? resource.initialLayout : VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_ACCESS_MEMORY_WRITE_BIT, true };
+
+    for (uint32_t i=0; i<passes.size(); i++)
+    {
+        Pass &pass = passes[i];
+        if (pass.culled)
+            continue;
+        for (Use const &use : pass.uses)
+        {
+            ResourceInfo &resource = resources[use.resource];
+            AccessInfo const &access = ACCESSES[use.access];
+            VkImageLayout const layout = resource.isImage ? access.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+
+            // An aliased image's first use waits for the last use of the image before it in the same memory
+            if (!resource.imported && resource.firstPass == i && resource.block != UINT32_MAX)
+            {
+                Resource previous = UINT32_MAX;
+                for (Resource other : blocks[resource.block].resources)
+                    if (resources[other].lastPass < i && (previous == UINT32_MAX || resources[other].lastPass > resources[previous].lastPass))
+                        previous = other;
+                if (previous != UINT32_MAX)
+                    resource.last = ResourceState{ VK_IMAGE_LAYOUT_UNDEFINED, resources[previous].last.stages, resources[previous].last.written ? resources[previous].last.access : 0, true };
+            }
+
+            // Reads of data already visible in the right layout need nothing, only widening the stages a later write waits on
+            ResourceState &last = resource.last;
+            if (!last.written && !access.write && last.layout == layout)
+            {
+                last.stages |= access.stages;
+                last.access |= access.access;
+                continue;
+            }
+
+            pass.barriers.push_back(Barrier
+            {
+                .resource = use.resource,
+                .oldLayout = last.layout,
+                .newLayout = layout,
+                .srcAccess = last.written ? last.access & (VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT|VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT|VK_ACCESS_SHADER_WRITE_BIT|VK_ACCESS_TRANSFER_WRITE_BIT|VK_ACCESS_MEMORY_WRITE_BIT) : 0,
+                .dstAccess = access.access
+            });
+            pass.srcStages |= last.stages;
+            pass.dstStages |= access.stages;
+
+            // Attachments clear what was discarded and keep what the caller or a later pass reads
+            if (isAttachment(use.access))
+            {
+                bool const readLater = std::any_of(passes.begin() + i + 1, passes.end(), [&](Pass const &later)
+                {
+                    return !later.culled && std::any_of(later.uses.begin(), later.uses.end(), [&](Use const &laterUse) { return laterUse.resource == use.resource; });
+                });
+                bool const keep = readLater || (resource.imported && resource.finalLayout != VK_IMAGE_LAYOUT_UNDEFINED);
+                if (use.access == ColourAttachment)
+                    pass.colourAttachments.push_back(use.resource);
+                else
+                    pass.depthAttachment = use.resource;
+                pass.loadOps.push_back(last.layout == VK_IMAGE_LAYOUT_UNDEFINED ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD);
+                pass.storeOps.push_back(keep ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE);
+            }
+            last = ResourceState{ layout, access.stages, access.access, access.write };
+        }
+
+        // Depth comes last among the attachments, after every colour one
+        if (pass.depthAttachment != UINT32_MAX)
+        {
+            auto depth = std::find_if(pass.uses.begin(), pass.uses.end(), [](Use const &use) { return use.access == DepthAttachment; });
+            size_t const index = std::count_if(pass.uses.begin(), depth, [](Use const &use) { return isAttachment(use.access); });
+            std::rotate(pass.loadOps.begin() + index, pass.loadOps.begin() + index + 1, pass.loadOps.end());
+            std::rotate(pass.storeOps.begin() + index, pass.storeOps.begin() + index + 1, pass.storeOps.end());
+        }
+    }
+
+    // Move imported images into the layouts their owners expect
+    for (Resource i=0; i<resources.size(); i++)
+    {
+        ResourceInfo &resource = resources[i];
+        if (!resource.imported || !resource.isImage || resource.finalLayout == VK_IMAGE_LAYOUT_UNDEFINED || resource.finalLayout == resource.last.layout)
+            continue;
+        finalBarriers.push_back(Barrier
+        {
+            .resource = i,
+            .oldLayout = resource.last.layout,
+            .newLayout = resource.finalLayout,
+            .srcAccess = resource.last.written ? resource.last.access : 0,
+            .dstAccess = 0
+        });
+        finalSrcStages |= resource.last.stages;
+    }
+}
+
+void RenderGraph::createRenderPasses()
+{
+    // Without dynamic rendering each graphics pass gets a single-subpass render pass, layouts staying put as the graph's barriers move them
+    for (Pass &pass : passes)
+    {
+        if (pass.culled || (pass.colourAttachments.empty() && pass.depthAttachment == UINT32_MAX))
+            continue;
+        std::vector<Resource> attachmentResources = pass.colourAttachments;
+        if (pass.depthAttachment != UINT32_MAX)
+            attachmentResources.push_back(pass.depthAttachment);
+
+        std::vector<VkAttachmentDescription> attachments;
+        std::vector<VkAttachmentReference> colourReferences;
+        for (size_t i=0; i<attachmentResources.size(); i++)
+        {
+            bool const depth = attachmentResources[i] == pass.depthAttachment;
+            VkImageLayout const layout = depth ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+            attachments.push_back(VkAttachmentDescription
+            {
+                .format = resources[attachmentResources[i]].format,
+                .samples = VK_SAMPLE_COUNT_1_BIT,
+                .loadOp = pass.loadOps[i],
+                .storeOp = pass.storeOps[i],
+                .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+                .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+                .initialLayout = layout,
+                .finalLayout = layout
+            });
+            if (!depth)
+                colourReferences.push_back(VkAttachmentReference{ static_cast<uint32_t>(i), layout });
+        }
+        VkAttachmentReference depthReference{ static_cast<uint32_t>(colourReferences.size()), VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+        VkSubpassDescription subpass
+        {
+            .pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
+            .colorAttachmentCount = static_cast<uint32_t>(colourReferences.size()),
+            .pColorAttachments = colourReferences.data(),
+            .pDepthStencilAttachment = pass.depthAttachment != UINT32_MAX ? &depthReference : nullptr
+        };
+        VkRenderPassCreateInfo renderPassInfo
+        {
+            .sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
+            .attachmentCount = static_cast<uint32_t>(attachments.size()),
+            .pAttachments = attachments.data(),
+            .subpassCount = 1,
+            .pSubpasses = &subpass
+        };
+        check::fail( vkCreateRenderPass(device->getHandle(), &renderPassInfo, nullptr, &pass.renderPass), "vkCreateRenderPass failed." );
+    }
+}
+
+VkFramebuffer RenderGraph::getFramebuffer(Pass &pass)
+{
+    // Imported images change between frames, so framebuffers are cached by the views they are bound to
+    std::vector<VkImageView> views;
+    for (Resource resource : pass.colourAttachments)
+        views.push_back(resources[resource].imageView);
+    if (pass.depthAttachment != UINT32_MAX)
+        views.push_back(resources[pass.depthAttachment].imageView);
+    auto [it, added] = pass.framebuffers.try_emplace(views, VK_NULL_HANDLE);
+    if (!added)
+        return it->second;
+
+    Resource const first = pass.colourAttachments.empty() ? pass.depthAttachment : pass.colourAttachments.front();
+    VkFramebufferCreateInfo framebufferInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+        .renderPass = pass.renderPass,
+        .attachmentCount = static_cast<uint32_t>(views.size()),
+        .pAttachments = views.data(),
+        .width = resources[first].extent.width,
+        .height = resources[first].extent.height,
+        .layers = 1
+    };
+    check::fail( vkCreateFramebuffer(device->getHandle(), &framebufferInfo, nullptr, &it->second), "vkCreateFramebuffer failed." );
+    return it->second;
+}
+
+void RenderGraph::beginRendering(VkCommandBuffer const &commandBuffer, Pass &pass, VkExtent2D const &extent)
+{
+    // Clear colour to black and depth to the far plane
+    VkClearValue const colourClear{ .color = {{0.0f, 0.0f, 0.0f, 1.0f}} };
+    VkClearValue const depthClear{ .depthStencil = {1.0f, 0} };
+    VkRect2D const area{ .offset = {0, 0}, .extent = extent };
+
+    if (device->supportsDynamicRendering())
+    {
+        std::vector<VkRenderingAttachmentInfo> colourAttachments;
+        for (size_t i=0; i<pass.colourAttachments.size(); i++)
+            colourAttachments.push_back(VkRenderingAttachmentInfo
+            {
+                .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+                .imageView = resources[pass.colourAttachments[i]].imageView,
+                .imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                .loadOp = pass.loadOps[i],
+                .storeOp = pass.storeOps[i],
+                .clearValue = colourClear
+            });
+        VkRenderingAttachmentInfo depthAttachment{};
+        if (pass.depthAttachment != UINT32_MAX)
+            depthAttachment = VkRenderingAttachmentInfo
+            {
+                .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+                .imageView = resources[pass.depthAttachment].imageView,
+                .imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                .loadOp = pass.loadOps.back(),
+                .storeOp = pass.storeOps.back(),
+                .clearValue = depthClear
+            };
+        VkRenderingInfo renderingInfo
+        {
+            .sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+            .renderArea = area,
+            .layerCount = 1,
+            .colorAttachmentCount = static_cast<uint32_t>(colourAttachments.size()),
+            .pColorAttachments = colourAttachments.data(),
+            .pDepthAttachment = pass.depthAttachment != UINT32_MAX ? &depthAttachment : nullptr
+        };
+        device->getCmdBeginRendering()(commandBuffer, &renderingInfo);
+    }
+    else
+    {
+        std::vector<VkClearValue> clearValues(pass.colourAttachments.size(), colourClear);
+        if (pass.depthAttachment != UINT32_MAX)
+            clearValues.push_back(depthClear);
+        VkRenderPassBeginInfo renderPassInfo
+        {
+            .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+            .renderPass = pass.renderPass,
+            .framebuffer = getFramebuffer(pass),
+            .renderArea = area,
+            .clearValueCount = static_cast<uint32_t>(clearValues.size()),
+            .pClearValues = clearValues.data()
+        };
+        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+    }
+
+    // Cover the whole area, for pipelines that leave viewport and scissor to record time
+    VkViewport const viewport
+    {
+        .x = 0.0f,
+        .y = 0.0f,
+        .width = (float) extent.width,
+        .height = (float) extent.height,
+        .minDepth = 0.0f,
+        .maxDepth = 1.0f
+    };
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    vkCmdSetScissor(commandBuffer, 0, 1, &area);
+}
+
+void RenderGraph::endRendering(VkCommandBuffer const &commandBuffer, Pass const &pass)
+{
+    if (device->supportsDynamicRendering())
+        device->getCmdEndRendering()(commandBuffer);
+    else
+        vkCmdEndRenderPass(commandBuffer);
+}
+
+void RenderGraph::discard()
+{
+    // Compiled objects may still be in use by frames in flight
+    std::function<void()> destroy = release();
+    if (deletionQueue != nullptr)
+        deletionQueue->retire(std::move(destroy));
+    else
+        destroy();
+}
+
+std::function<void()> RenderGraph::release()
+{
+    // Hand over compiled objects and forget what compiling found, leaving the graph free to compile again
+    std::vector<VkRenderPass> renderPasses;
+    std::vector<VkFramebuffer> framebuffers;
+    for (Pass &pass : passes)
+    {
+        if (pass.renderPass != VK_NULL_HANDLE)
+            renderPasses.push_back(pass.renderPass);
+        for (auto const &[views, framebuffer] : pass.framebuffers)
+            framebuffers.push_back(framebuffer);
+        pass = Pass{ .name = std::move(pass.name), .uses = std::move(pass.uses), .record = std::move(pass.record) };
+    }
+    std::vector<VkImage> images;
+    std::vector<VkImageView> imageViews;
+    for (ResourceInfo &resource : resources)
+    {
+        if (!resource.imported && resource.image != VK_NULL_HANDLE)
+        {
+            images.push_back(resource.image);
+            imageViews.push_back(resource.imageView);
+            resource.image = VK_NULL_HANDLE;
+            resource.imageView = VK_NULL_HANDLE;
+        }
+        resource.usage = 0;
+        resource.firstPass = UINT32_MAX;
+        resource.lastPass = 0;
+        resource.block = UINT32_MAX;
+        resource.last = {};
+    }
+    std::vector<VkDeviceMemory> memories;
+    for (Block const &block : blocks)
+        memories.push_back(block.memory);
+    blocks.clear();
+    finalBarriers.clear();
+    finalSrcStages = 0;
+
+    return [device = device, renderPasses, framebuffers, images, imageViews, memories]()
+    {
+        for (VkFramebuffer framebuffer : framebuffers)
+            vkDestroyFramebuffer(device->getHandle(), framebuffer, nullptr);
+        for (VkRenderPass renderPass : renderPasses)
+            vkDestroyRenderPass(device->getHandle(), renderPass, nullptr);
+        for (VkImageView imageView : imageViews)
+            vkDestroyImageView(device->getHandle(), imageView, nullptr);
+        for (VkImage image : images)
+            vkDestroyImage(device->getHandle(), image, nullptr);
+        for (VkDeviceMemory memory : memories)
+            vkFreeMemory(device->getHandle(), memory, nullptr);
+    };
+}
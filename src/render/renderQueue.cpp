@@ -0,0 +1,146 @@
+
+#include "render/renderQueue.hpp"
+
+#include "configuration/device.hpp"
+#include "swapchain/pipeline.hpp"
+#include "memory/descriptorSet.hpp"
+#include "memory/voidBuffer.hpp"
+#include "mesh/mesh.hpp"
+#include "profiling/cpuTrace.hpp"
+#include "profiling/counters.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <exception>
+
+RenderQueue::RenderQueue(Device const *device) : device(device)
+{ }
+
+void RenderQueue::clear()
+{
+    draws.clear();
+    entries.clear();
+    pipelineIds.clear();
+    materialIds.clear();
+    meshIds.clear();
+}
+
+void RenderQueue::submit(uint32_t pass, Draw const &draw, glm::mat4 const &modelView)
+{
+    // Depth of the nearest point of the mesh's bounding sphere along the view direction
+    MeshData::Bounds const &bounds = draw.mesh->getBounds();
+    float scale = std::max({ glm::length(glm::vec3(modelView[0])), glm::length(glm::vec3(modelView[1])), glm::length(glm::vec3(modelView[2])) });
+    float depth = -(modelView * glm::vec4(bounds.centre, 1.0f)).z - bounds.radius*scale;
+
+    // Key by state, ids are handed out on first sight within the frame, so they stay compact and never outlive a retired object
+    uint64_t key = makeKey(
+        pass,
+        getId(pipelineIds, draw.pipeline, PIPELINE_BITS),
+        getId(materialIds, draw.material != nullptr ? static_cast<void const *>(draw.material) : draw.uniforms, MATERIAL_BITS),
+        getId(meshIds, draw.mesh, MESH_BITS),
+        depth
+    );
+    entries.push_back(radixSort::Entry{ .key = key, .value = static_cast<uint32_t>(draws.size()) });
+    draws.push_back(draw);
+}
+
+void RenderQueue::sort()
+{
+    TRACE_ZONE("RenderQueue::sort");
+    radixSort::sort(entries, scratch);
+}
+
+void RenderQueue::record(VkCommandBuffer const &commandBuffer)
+{
+    TRACE_ZONE("RenderQueue::record");
+    // Only bind state that differs from the previous draw's
+    statistics = Statistics{};
+    Pipeline const *pipeline = nullptr;
+    DescriptorSet const *material = nullptr;
+    VoidBuffer const *uniforms = nullptr;
+    Mesh const *mesh = nullptr;
+    for (radixSort::Entry const &entry : entries)
+    {
+        Draw const &draw = draws[entry.value];
+        bool const pipelineChanged = draw.pipeline != pipeline;
+        if (pipelineChanged)
+        {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, draw.pipeline->getHandle());
+            statistics.pipelineBinds++;
+        }
+
+        // Pipelines each own their layout, so a new pipeline also needs its sets bound against that layout
+        if (pipelineChanged || draw.material != material || draw.uniforms != uniforms)
+        {
+            if (draw.material != nullptr)
+                vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, draw.pipeline->getLayout(), 0, 1, &draw.material->getHandle(), 0, nullptr);
+            else
+            {
+                // Write the uniform buffer into the command buffer, no set to allocate or update
+                VkDescriptorBufferInfo bufferInfo
+                {
+                    .buffer = draw.uniforms->getHandle(),
+                    .offset = 0,
+                    .range = VK_WHOLE_SIZE
+                };
+                VkWriteDescriptorSet descriptorWrite
+                {
+                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .dstBinding = 0,
+                    .dstArrayElement = 0,
+                    .descriptorCount = 1,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                    .pBufferInfo = &bufferInfo
+                };
+                device->getCmdPushDescriptorSet()(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, draw.pipeline->getLayout(), 0, 1, &descriptorWrite);
+            }
+            statistics.materialBinds++;
+        }
+        if (draw.mesh != mesh)
+        {
+            draw.mesh->bind(commandBuffer);
+            statistics.meshBinds++;
+        }
+        pipeline = draw.pipeline;
+        material = draw.material;
+        uniforms = draw.uniforms;
+        mesh = draw.mesh;
+
+        // Push per-draw constants and draw
+        vkCmdPushConstants(commandBuffer, draw.pipeline->getLayout(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(DrawConstants), &draw.constants);
+        MeshData::Lod const &lod = draw.mesh->getLod(draw.lod);
+        vkCmdDrawIndexed(commandBuffer, lod.nIndices, 1, lod.firstIndex, 0, 0);
+        statistics.draws++;
+    }
+    statistics.bindsAvoided = 3*statistics.draws - statistics.pipelineBinds - statistics.materialBinds - statistics.meshBinds;
+    counters::add(counters::Draws, statistics.draws);
+    counters::add(counters::Binds, statistics.pipelineBinds + statistics.materialBinds + statistics.meshBinds);
+}
+
+RenderQueue::Statistics const &RenderQueue::getStatistics() const
+{
+    return statistics;
+}
+
+uint64_t RenderQueue::makeKey(uint32_t pass, uint32_t pipelineId, uint32_t materialId, uint32_t meshId, float depth)
+{
+    if (pass >= (1u << PASS_BITS))
+        throw std::exception("RenderQueue pass out of range.");
+
+    // Non-negative floats order like their bit patterns, so the top bits are a monotonic depth
+    uint32_t const depthBits = std::bit_cast<uint32_t>(std::max(depth, 0.0f)) >> (32 - DEPTH_BITS);
+    uint64_t key = pass;
+    key = (key << PIPELINE_BITS) | pipelineId;
+    key = (key << MATERIAL_BITS) | materialId;
+    key = (key << MESH_BITS) | meshId;
+    key = (key << DEPTH_BITS) | depthBits;
+    return key;
+}
+
+uint32_t RenderQueue::getId(std::unordered_map<void const *, uint32_t> &ids, void const *object, uint32_t bits)
+{
+    uint32_t id = ids.try_emplace(object, static_cast<uint32_t>(ids.size())).first->second;
+    if (id >= (1u << bits))
+        throw std::exception("RenderQueue key field overflow, too many distinct objects.");
+    return id;
+}
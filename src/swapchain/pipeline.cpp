@@ -4,13 +4,13 @@
 #include "configuration/device.hpp"
 #include "configuration/shaderModule.hpp"
 #include "swapchain/renderPass.hpp"
-#include "vertex/vertex.hpp"
 #include "memory/descriptorSetLayout.hpp"
 #include "utility/check.hpp"
+#include "profiling/counters.hpp"
 
 #include <vector>
 
-Pipeline::Pipeline(Device const *device, ShaderModule const &vertShaderModule, ShaderModule const &fragShaderModule, RenderPass const *renderPass, VkExtent2D const &viewportExtent, DescriptorSetLayout const *descriptorSetLayout) : device(device)
+Pipeline::Pipeline(Device const *device, ShaderModule const &vertShaderModule, ShaderModule const &fragShaderModule, RenderPass const *renderPass, VkExtent2D const &viewportExtent, std::vector<DescriptorSetLayout const *> const &descriptorSetLayouts, vertexInput::State const &vertexInput, bool dynamicViewport, std::vector<VkPushConstantRange> const &pushConstantRanges, uint32_t subpass) : device(device)
 {
     // Specify shader stages
     std::vector<VkPipelineShaderStageCreateInfo> shaderStages
@@ -31,16 +31,14 @@ Pipeline::Pipeline(Device const *device, ShaderModule const &vertShaderModule, S
         }
     };
 
-    // Specify vertex input state
-    VkVertexInputBindingDescription vertexBindingDescription = Vertex::getBindingDescription();
-    std::vector<VkVertexInputAttributeDescription> vertexAttributeDescriptions = Vertex::getAttributeDescriptions();
+    // Specify vertex input state from compile-time descriptions
     VkPipelineVertexInputStateCreateInfo vertexInputInfo
     {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
-        .vertexBindingDescriptionCount = 1,
-        .pVertexBindingDescriptions = &vertexBindingDescription,
-        .vertexAttributeDescriptionCount = static_cast<uint32_t>(vertexAttributeDescriptions.size()),
-        .pVertexAttributeDescriptions = vertexAttributeDescriptions.data()
+        .vertexBindingDescriptionCount = static_cast<uint32_t>(vertexInput.bindings.size()),
+        .pVertexBindingDescriptions = vertexInput.bindings.data(),
+        .vertexAttributeDescriptionCount = static_cast<uint32_t>(vertexInput.attributes.size()),
+        .pVertexAttributeDescriptions = vertexInput.attributes.data()
     };
 
     // Specify input assembly state
@@ -75,6 +73,17 @@ Pipeline::Pipeline(Device const *device, ShaderModule const &vertShaderModule, S
         .pScissors = &scissor
     };
 
+    // Optionally leave viewport and scissor to be set at record time
+    std::vector<VkDynamicState> dynamicStates;
+    if (dynamicViewport)
+        dynamicStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+    VkPipelineDynamicStateCreateInfo dynamicState
+    {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+        .dynamicStateCount = static_cast<uint32_t>(dynamicStates.size()),
+        .pDynamicStates = dynamicStates.data()
+    };
+
     // Specify rasterization state
     VkPipelineRasterizationStateCreateInfo rasterizer
     {
@@ -96,35 +105,63 @@ Pipeline::Pipeline(Device const *device, ShaderModule const &vertShaderModule, S
         .sampleShadingEnable = VK_FALSE
     };
 
-    // Specify colour blending    
-    VkPipelineColorBlendAttachmentState colourBlendAttachment
+    // Specify depth state, test and write enabled whenever the subpass has a depth attachment
+    VkPipelineDepthStencilStateCreateInfo depthStencil
+    {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+        .depthTestEnable = renderPass->usesDepth(subpass) ? VK_TRUE : VK_FALSE,
+        .depthWriteEnable = renderPass->usesDepth(subpass) ? VK_TRUE : VK_FALSE,
+        .depthCompareOp = VK_COMPARE_OP_LESS,
+        .depthBoundsTestEnable = VK_FALSE,
+        .stencilTestEnable = VK_FALSE,
+        .minDepthBounds = 0.0f,
+        .maxDepthBounds = 1.0f
+    };
+
+    // Specify colour blending, the same for each of the subpass's colour attachments
+    std::vector<VkPipelineColorBlendAttachmentState> colourBlendAttachments(renderPass->getColourAttachmentCount(subpass), VkPipelineColorBlendAttachmentState
     {
         .blendEnable = VK_FALSE,
         .colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT
-    };
+    });
     VkPipelineColorBlendStateCreateInfo colorBlending
     {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
         .logicOpEnable = VK_FALSE,
         .logicOp = VK_LOGIC_OP_COPY,
-        .attachmentCount = 1,
-        .pAttachments = &colourBlendAttachment,
+        .attachmentCount = static_cast<uint32_t>(colourBlendAttachments.size()),
+        .pAttachments = colourBlendAttachments.data(),
         .blendConstants = {0.0f, 0.0f, 0.0f, 0.0f}
     };
 
-    // Create pipeline layout
+    // Create pipeline layout, one descriptor set per layout in order and push constant ranges carrying small per-draw data without descriptor updates
+    std::vector<VkDescriptorSetLayout> setLayouts;
+    for (DescriptorSetLayout const *descriptorSetLayout : descriptorSetLayouts)
+        setLayouts.push_back(descriptorSetLayout->getHandle());
     VkPipelineLayoutCreateInfo pipelineLayoutInfo
     {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-        .setLayoutCount = 1,
-        .pSetLayouts = &descriptorSetLayout->getHandle()
+        .setLayoutCount = static_cast<uint32_t>(setLayouts.size()),
+        .pSetLayouts = setLayouts.data(),
+        .pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size()),
+        .pPushConstantRanges = pushConstantRanges.data()
     };
     check::fail( vkCreatePipelineLayout(device->getHandle(), &pipelineLayoutInfo, nullptr, &pipelineLayout),  "vkCreatePipelineLayout failed.");
 
+    // Dynamic passes have no render pass object, their attachment formats are given directly
+    VkPipelineRenderingCreateInfo renderingInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+        .colorAttachmentCount = 1,
+        .pColorAttachmentFormats = &renderPass->getFormat(),
+        .depthAttachmentFormat = renderPass->getDepthFormat()
+    };
+
     // Create pipeline
     VkGraphicsPipelineCreateInfo pipelineInfo
     {
         .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .pNext = renderPass->isDynamic() ? &renderingInfo : nullptr,
         .stageCount = static_cast<uint32_t>(shaderStages.size()),
         .pStages = shaderStages.data(),
         .pVertexInputState = &vertexInputInfo,
@@ -132,13 +169,16 @@ Pipeline::Pipeline(Device const *device, ShaderModule const &vertShaderModule, S
         .pViewportState = &viewportState,
         .pRasterizationState = &rasterizer,
         .pMultisampleState = &multisampling,
+        .pDepthStencilState = &depthStencil,
         .pColorBlendState = &colorBlending,
+        .pDynamicState = &dynamicState,
         .layout = pipelineLayout,
         .renderPass = renderPass->getHandle(),
-        .subpass = 0,
+        .subpass = subpass,
         .basePipelineHandle = VK_NULL_HANDLE
     };
     check::fail( vkCreateGraphicsPipelines(device->getHandle(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &handle), "vkCreateGraphicsPipelines failed." );
+    counters::add(counters::PipelineCreations);
 }
 
 Pipeline::~Pipeline()
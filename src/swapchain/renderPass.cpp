@@ -2,24 +2,36 @@
 #include "swapchain/renderPass.hpp"
 
 #include "configuration/device.hpp"
-#include "swapchain/swapchain.hpp"
-#include "swapchain/image.hpp"
+#include "profiling/pipelineStatistics.hpp"
 #include "utility/check.hpp"
 
 #include <exception>
+#include <vector>
 
-RenderPass::RenderPass(Device const *device, VkFormat const &format) : device(device)
+RenderPass::RenderPass(Device const *device, VkFormat const &format, VkFormat const &depthFormat, VkImageLayout const &finalLayout, bool dynamic)
+    : device(device), format(format), depthFormat(depthFormat), finalLayout(finalLayout)
 {
-    VkAttachmentDescription colorAttachment
+    // Dynamic passes only need their formats, the rest is given when rendering begins
+    if (dynamic)
     {
-        .format = format,
-        .samples = VK_SAMPLE_COUNT_1_BIT,
-        .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
-        .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
-        .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
-        .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
-        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-        .finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
+        if (!device->supportsDynamicRendering())
+            throw std::exception("Dynamic rendering not supported.");
+        return;
+    }
+
+    std::vector<VkAttachmentDescription> attachments
+    {
+        VkAttachmentDescription
+        {
+            .format = format,
+            .samples = VK_SAMPLE_COUNT_1_BIT,
+            .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+            .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+            .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+            .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .finalLayout = finalLayout
+        }
     };
     VkAttachmentReference colourAttachmentRef
     {
@@ -32,24 +44,195 @@ RenderPass::RenderPass(Device const *device, VkFormat const &format) : device(de
         .colorAttachmentCount = 1,
         .pColorAttachments = &colourAttachmentRef
     };
-    VkSubpassDependency dependency
+    std::vector<VkSubpassDependency> dependencies
+    {
+        VkSubpassDependency
+        {
+            .srcSubpass = VK_SUBPASS_EXTERNAL,
+            .dstSubpass = 0,
+            .srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+            .dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+            .srcAccessMask = 0,
+            .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+        }
+    };
+
+    // Optionally add a depth attachment, cleared on load and discarded after so tilers can keep it on chip
+    VkAttachmentReference depthAttachmentRef
     {
-        .srcSubpass = VK_SUBPASS_EXTERNAL,
-        .dstSubpass = 0,
-        .srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-        .dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-        .srcAccessMask = 0,
-        .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+        .attachment = 1,
+        .layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
     };
+    if (hasDepth())
+    {
+        attachments.push_back(VkAttachmentDescription
+        {
+            .format = depthFormat,
+            .samples = VK_SAMPLE_COUNT_1_BIT,
+            .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+            .storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+            .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
+        });
+        subpass.pDepthStencilAttachment = &depthAttachmentRef;
+
+        // One depth image is shared by every frame in flight, so the previous pass's depth writes must finish before this clear
+        dependencies[0].srcStageMask |= VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        dependencies[0].dstStageMask |= VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+        dependencies[0].srcAccessMask |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        dependencies[0].dstAccessMask |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    }
+
+    // Make colour writes visible to transfers when the attachment is read back after the pass
+    if (finalLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL)
+        dependencies.push_back(VkSubpassDependency
+        {
+            .srcSubpass = 0,
+            .dstSubpass = VK_SUBPASS_EXTERNAL,
+            .srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+            .dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT,
+            .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT
+        });
     VkRenderPassCreateInfo renderPassInfo
     {
         .sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
-        .attachmentCount = 1,
-        .pAttachments = &colorAttachment,
+        .attachmentCount = static_cast<uint32_t>(attachments.size()),
+        .pAttachments = attachments.data(),
         .subpassCount = 1,
         .pSubpasses = &subpass,
-        .dependencyCount = 1,
-        .pDependencies = &dependency
+        .dependencyCount = static_cast<uint32_t>(dependencies.size()),
+        .pDependencies = dependencies.data()
+    };
+    check::fail( vkCreateRenderPass(device->getHandle(), &renderPassInfo, nullptr, &handle), "vkCreateRenderPass failed." );
+}
+
+RenderPass::RenderPass(Device const *device, VkFormat const &format, VkFormat const &depthFormat, std::vector<VkFormat> const &gBufferFormats, VkImageLayout const &finalLayout)
+    : device(device), format(format), depthFormat(depthFormat), finalLayout(finalLayout), gBufferFormats(gBufferFormats)
+{
+    if (gBufferFormats.empty())
+        throw std::exception("Deferred render passes need G-buffer attachments.");
+
+    // Colour is only written by the lighting subpass, which covers every pixel
+    std::vector<VkAttachmentDescription> attachments
+    {
+        VkAttachmentDescription
+        {
+            .format = format,
+            .samples = VK_SAMPLE_COUNT_1_BIT,
+            .loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+            .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+            .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+            .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .finalLayout = finalLayout
+        }
+    };
+    if (hasDepth())
+        attachments.push_back(VkAttachmentDescription
+        {
+            .format = depthFormat,
+            .samples = VK_SAMPLE_COUNT_1_BIT,
+            .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+            .storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+            .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
+        });
+
+    // G-buffer attachments are cleared and never stored, so tilers keep them on chip between the subpasses
+    std::vector<VkAttachmentReference> gBufferWriteRefs;
+    std::vector<VkAttachmentReference> gBufferReadRefs;
+    for (VkFormat const &gBufferFormat : gBufferFormats)
+    {
+        uint32_t const attachment = static_cast<uint32_t>(attachments.size());
+        attachments.push_back(VkAttachmentDescription
+        {
+            .format = gBufferFormat,
+            .samples = VK_SAMPLE_COUNT_1_BIT,
+            .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+            .storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+            .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+        });
+        gBufferWriteRefs.push_back(VkAttachmentReference{ attachment, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL });
+        gBufferReadRefs.push_back(VkAttachmentReference{ attachment, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL });
+    }
+    VkAttachmentReference colourAttachmentRef
+    {
+        .attachment = 0,
+        .layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+    };
+    VkAttachmentReference depthAttachmentRef
+    {
+        .attachment = 1,
+        .layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
+    };
+    std::vector<VkSubpassDescription> subpasses
+    {
+        VkSubpassDescription
+        {
+            .pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
+            .colorAttachmentCount = static_cast<uint32_t>(gBufferWriteRefs.size()),
+            .pColorAttachments = gBufferWriteRefs.data(),
+            .pDepthStencilAttachment = hasDepth() ? &depthAttachmentRef : nullptr
+        },
+        VkSubpassDescription
+        {
+            .pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
+            .inputAttachmentCount = static_cast<uint32_t>(gBufferReadRefs.size()),
+            .pInputAttachments = gBufferReadRefs.data(),
+            .colorAttachmentCount = 1,
+            .pColorAttachments = &colourAttachmentRef
+        }
+    };
+
+    // G-buffer writes wait on the previous frame's use of the shared attachments, colour on acquisition, and lighting reads each pixel's own G-buffer writes
+    std::vector<VkSubpassDependency> dependencies
+    {
+        VkSubpassDependency
+        {
+            .srcSubpass = VK_SUBPASS_EXTERNAL,
+            .dstSubpass = 0,
+            .srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+            .dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+            .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+        },
+        VkSubpassDependency
+        {
+            .srcSubpass = VK_SUBPASS_EXTERNAL,
+            .dstSubpass = 1,
+            .srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+            .dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+            .srcAccessMask = 0,
+            .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+        },
+        VkSubpassDependency
+        {
+            .srcSubpass = 0,
+            .dstSubpass = 1,
+            .srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+            .dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT,
+            .dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT
+        }
+    };
+    VkRenderPassCreateInfo renderPassInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
+        .attachmentCount = static_cast<uint32_t>(attachments.size()),
+        .pAttachments = attachments.data(),
+        .subpassCount = static_cast<uint32_t>(subpasses.size()),
+        .pSubpasses = subpasses.data(),
+        .dependencyCount = static_cast<uint32_t>(dependencies.size()),
+        .pDependencies = dependencies.data()
     };
     check::fail( vkCreateRenderPass(device->getHandle(), &renderPassInfo, nullptr, &handle), "vkCreateRenderPass failed." );
 }
@@ -64,26 +247,91 @@ VkRenderPass const &RenderPass::getHandle() const
     return handle;
 }
 
-void RenderPass::run(Swapchain const *swapchain, Image const &image, VkCommandBuffer const &commandBuffer, std::function<void()> commands)
+VkFormat const &RenderPass::getFormat() const
+{
+    return format;
+}
+
+VkFormat const &RenderPass::getDepthFormat() const
+{
+    return depthFormat;
+}
+
+bool RenderPass::hasDepth() const
+{
+    return depthFormat != VK_FORMAT_UNDEFINED;
+}
+
+bool RenderPass::isDynamic() const
+{
+    return handle == VK_NULL_HANDLE;
+}
+
+std::vector<VkFormat> const &RenderPass::getGBufferFormats() const
+{
+    return gBufferFormats;
+}
+
+uint32_t RenderPass::getSubpassCount() const
 {
-    // Start render pass
-    VkClearValue clearColour = {{{0.0f, 0.0f, 0.0f, 1.0f}}};
+    return gBufferFormats.empty() ? 1 : 2;
+}
+
+uint32_t RenderPass::getColourAttachmentCount(uint32_t subpass) const
+{
+    return !gBufferFormats.empty() && subpass == 0 ? static_cast<uint32_t>(gBufferFormats.size()) : 1;
+}
+
+bool RenderPass::usesDepth(uint32_t subpass) const
+{
+    return hasDepth() && subpass == 0;
+}
+
+void RenderPass::setStatistics(PipelineStatistics *statistics, std::string const &name)
+{
+    if (statistics != nullptr && getSubpassCount() > 1)
+        throw std::exception("Queries must end in the subpass they began in, so multi-subpass passes bracket each subpass themselves.");
+    this->statistics = statistics;
+    this->name = name;
+}
+
+void RenderPass::run(VkFramebuffer const &framebuffer, VkExtent2D const &extent, VkCommandBuffer const &commandBuffer, std::function<void()> commands)
+{
+    if (isDynamic())
+        throw std::exception("Dynamic render passes have no render pass object to run.");
+
+    // Start render pass, clearing depth to the far plane and G-buffer attachments to zero
+    std::vector<VkClearValue> clearValues{ VkClearValue{ .color = {{0.0f, 0.0f, 0.0f, 1.0f}} } };
+    if (hasDepth())
+        clearValues.push_back(VkClearValue{ .depthStencil = {1.0f, 0} });
+    clearValues.resize(clearValues.size() + gBufferFormats.size(), VkClearValue{ .color = {{0.0f, 0.0f, 0.0f, 0.0f}} });
     VkRenderPassBeginInfo renderPassInfo{
         .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
         .renderPass = handle,
-        .framebuffer = image.framebuffer,
+        .framebuffer = framebuffer,
         .renderArea{
             .offset = {0, 0},
-            .extent = swapchain->getExtent()
+            .extent = extent
         },
-        .clearValueCount = 1,
-        .pClearValues = &clearColour
+        .clearValueCount = static_cast<uint32_t>(clearValues.size()),
+        .pClearValues = clearValues.data()
     };
     vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
 
-    // Run commands
+    // Run commands, counting their work inside the pass so the clears are left out
+    if (statistics != nullptr)
+        statistics->beginPass(commandBuffer, name, extent);
     commands();
+    if (statistics != nullptr)
+        statistics->endPass(commandBuffer);
 
     // End render pass
     vkCmdEndRenderPass(commandBuffer);
 }
+
+void RenderPass::nextSubpass(VkCommandBuffer const &commandBuffer) const
+{
+    if (getSubpassCount() == 1)
+        throw std::exception("Render pass has a single subpass.");
+    vkCmdNextSubpass(commandBuffer, VK_SUBPASS_CONTENTS_INLINE);
+}
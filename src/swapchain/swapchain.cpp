@@ -8,51 +8,71 @@
 #include "swapchain/renderPass.hpp"
 #include "swapchain/pipeline.hpp"
 #include "swapchain/image.hpp"
+#include "memory/attachment.hpp"
+#include "memory/deletionQueue.hpp"
 #include "command/commandPool.hpp"
 #include "frame/frame.hpp"
 #include "configuration/shaderModule.hpp"
 #include "utility/check.hpp"
 #include "utility/io.hpp"
+#include "asset/assetPack.hpp"
+#include "profiling/cpuTrace.hpp"
 
 #include <iostream>
 
-Swapchain::Swapchain(Device const *device, PhysicalDevice const *physicalDevice, Window const *window, Surface const *surface, DescriptorSetLayout const *descriptorSetLayout) : device(device)
+Swapchain::Swapchain(Device const *device, PhysicalDevice const *physicalDevice, Window const *window, Surface const *surface, DescriptorSetLayout const *descriptorSetLayout, VertexLayout const &vertexLayout, AssetPack const *assetPack, DescriptorSetLayout const *bindlessLayout, DeletionQueue *deletionQueue)
+    : device(device), assetPack(assetPack), bindlessLayout(bindlessLayout), deletionQueue(deletionQueue), vertexLayout(vertexLayout)
 {
     create(physicalDevice, window, surface, descriptorSetLayout);
 }
 
 Swapchain::~Swapchain()
 {
-    destroy();
+    release()();
+    delete pipeline;
+    delete renderPass;
 }
 
 void Swapchain::create(PhysicalDevice const *physicalDevice, Window const *window, Surface const *surface, DescriptorSetLayout const *descriptorSetLayout)
 {
     createSwapchain(physicalDevice, surface, window);
     createImageViews();
-    renderPass = new RenderPass(device, format);
+    createDepthAttachment(physicalDevice);
+
+    // Dynamic passes depend only on formats and their pipelines take the viewport at record time, so survive recreation unless a format changes
+    if (renderPass != nullptr && renderPass->isDynamic() && renderPass->getFormat() == format && renderPass->getDepthFormat() == depthAttachment->getFormat())
+        return;
+
+    // Pipelines render straight to the images with dynamic rendering where supported, otherwise within a compatible render pass the render graph begins
+    renderPass = new RenderPass(device, format, depthAttachment->getFormat(), VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, device->supportsDynamicRendering());
+
+    // Uniforms at set 0, followed by the bindless table at set 1 when there is one, sampled by the fragment shader built for it
+    std::vector<DescriptorSetLayout const *> setLayouts{ descriptorSetLayout };
+    if (bindlessLayout != nullptr)
+        setLayouts.push_back(bindlessLayout);
     pipeline = new Pipeline(
         device,
-        ShaderModule(device, io::readFile("shaders/bin/shader.vert.spv", std::ios::binary)),
-        ShaderModule(device, io::readFile("shaders/bin/shader.frag.spv", std::ios::binary)),
-        renderPass, extent, descriptorSetLayout
+        ShaderModule(device, readShader("shaders/bin/shader.vert.spv")),
+        ShaderModule(device, readShader(bindlessLayout != nullptr ? "shaders/bin/shaderBindless.frag.spv" : "shaders/bin/shader.frag.spv")),
+        renderPass, extent, setLayouts, vertexLayout.getVertexInput(), renderPass->isDynamic(), { DrawConstants::getRange() }
     );
-    createFramebuffers();
 }
 
-void Swapchain::destroy()
+std::function<void()> Swapchain::release()
 {
-    for (VkFramebuffer const &framebuffer : framebuffers)
-        vkDestroyFramebuffer(device->getHandle(), framebuffer, nullptr);
-    delete pipeline;
-    delete renderPass;
-    for (auto imageView : imageViews)
-        vkDestroyImageView(device->getHandle(), imageView, nullptr);
-    vkDestroySwapchainKHR(device->getHandle(), handle, nullptr);
+    // Hand over the objects tied to the swapchain's images, leaving their members free for the next creation
+    return [device = device, handle = handle, depthAttachment = depthAttachment, imageViews = std::move(imageViews)]()
+    {
+        delete depthAttachment;
+        for (auto imageView : imageViews)
+            vkDestroyImageView(device->getHandle(), imageView, nullptr);
+        vkDestroySwapchainKHR(device->getHandle(), handle, nullptr);
+    };
 }
 
 void Swapchain::recreate(PhysicalDevice const *physicalDevice, Window const *window, Surface const *surface, DescriptorSetLayout const *descriptorSetLayout)
 {
+    TRACE_ZONE("Swapchain::recreate");
     // Get dimensions and block until window is visible
     int width=0, height=0;
     window->getFramebufferSize(width, height);
@@ -62,12 +82,26 @@ void Swapchain::recreate(PhysicalDevice const *physicalDevice, Window const *win
         window->getFramebufferSize(width, height);
     }
 
-    // Wait until safe to recreate
-    vkDeviceWaitIdle(device->getHandle());
+    // Without a deletion queue, wait until nothing can be using the old objects
+    if (deletionQueue == nullptr)
+        vkDeviceWaitIdle(device->getHandle());
 
-    // Recreate
-    destroy();
+    // Recreate from the old swapchain, then destroy it, and the pass and pipeline if they were replaced, once the frames in flight are done with it
+    std::function<void()> destroyOld = release();
+    RenderPass *oldRenderPass = renderPass;
+    Pipeline *oldPipeline = pipeline;
     create(physicalDevice, window, surface, descriptorSetLayout);
+    if (renderPass != oldRenderPass)
+        destroyOld = [destroyOld, oldPipeline, oldRenderPass]()
+        {
+            destroyOld();
+            delete oldPipeline;
+            delete oldRenderPass;
+        };
+    if (deletionQueue != nullptr)
+        deletionQueue->retire(std::move(destroyOld));
+    else
+        destroyOld();
 }
 
 VkSwapchainKHR const &Swapchain::getHandle() const
@@ -85,6 +119,11 @@ RenderPass *Swapchain::getRenderPass()
     return renderPass;
 }
 
+Attachment const *Swapchain::getDepthAttachment() const
+{
+    return depthAttachment;
+}
+
 Pipeline const *Swapchain::getPipeline() const
 {
     return pipeline;
@@ -92,6 +131,7 @@ Pipeline const *Swapchain::getPipeline() const
 
 Image const Swapchain::acquireNextImage(Frame const &frame, bool &framebufferResized, PhysicalDevice const *physicalDevice, Window const *window, Surface const *surface, DescriptorSetLayout const *descriptorSetLayout)
 {
+    TRACE_ZONE("Swapchain::acquireNextImage");
     uint32_t imageIndex;
     while (
         framebufferResized ||
@@ -101,7 +141,7 @@ Image const Swapchain::acquireNextImage(Frame const &frame, bool &framebufferRes
         recreate(physicalDevice, window, surface, descriptorSetLayout);
         framebufferResized = false;
     }
-    return Image(images[imageIndex], imageViews[imageIndex], framebuffers[imageIndex], imageIndex);
+    return Image(images[imageIndex], imageViews[imageIndex], imageIndex);
 }
 
 // Creation stages
@@ -140,7 +180,8 @@ void Swapchain::createSwapchain(PhysicalDevice const *physicalDevice, Surface co
         .preTransform = capabilities.currentTransform,
         .compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
         .presentMode = presentMode,
-        .clipped = VK_TRUE
+        .clipped = VK_TRUE,
+        .oldSwapchain = handle
     };
     check::fail( vkCreateSwapchainKHR(device->getHandle(), &swapchainCreateInfo, nullptr, &handle), "vkCreateSwapchainKHR failed." );
 
@@ -217,22 +258,19 @@ void Swapchain::createImageViews()
     }
 }
 
-void Swapchain::createFramebuffers()
+void Swapchain::createDepthAttachment(PhysicalDevice const *physicalDevice)
 {
-    // For each image view
-    framebuffers.resize(imageViews.size());
-    for (int i=0; i<imageViews.size(); i++)
-    {
-        std::vector<VkImageView> attachments = { imageViews[i] };
-        VkFramebufferCreateInfo framebufferInfo{
-            .sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
-            .renderPass = renderPass->getHandle(),
-            .attachmentCount = static_cast<uint32_t>(attachments.size()),
-            .pAttachments = attachments.data(),
-            .width = extent.width,
-            .height = extent.height,
-            .layers = 1
-        };
-        check::fail( vkCreateFramebuffer(device->getHandle(), &framebufferInfo, nullptr, &framebuffers[i]), "vkCreateFramebuffer failed." );
-    }
+    // Only ever used within a pass, so shared by all images and transient where the device allows
+    depthAttachment = new Attachment(
+        device, physicalDevice, physicalDevice->findDepthFormat(), extent,
+        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT, VK_IMAGE_ASPECT_DEPTH_BIT
+    );
+}
+
+std::vector<char> Swapchain::readShader(char const *filename) const
+{
+    // Prefer the mapped asset pack over loose files
+    if (assetPack != nullptr && assetPack->contains(filename))
+        return assetPack->read(filename);
+    return io::readFile(filename, std::ios::binary);
 }
@@ -0,0 +1,176 @@
+
+#include "texture/blockDecoder.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+
+namespace
+{
+    struct Rgba
+    {
+        uint8_t r, g, b, a;
+    };
+
+    uint32_t getBlockBytes(VkFormat format)
+    {
+        switch (format)
+        {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+            return 8;
+        case VK_FORMAT_BC2_UNORM_BLOCK:
+        case VK_FORMAT_BC2_SRGB_BLOCK:
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+            return 16;
+        default:
+            return 0;
+        }
+    }
+
+    Rgba expand565(uint16_t colour)
+    {
+        uint8_t r = (colour >> 11) & 0x1F, g = (colour >> 5) & 0x3F, b = colour & 0x1F;
+        return Rgba{ static_cast<uint8_t>((r << 3) | (r >> 2)), static_cast<uint8_t>((g << 2) | (g >> 4)), static_cast<uint8_t>((b << 3) | (b >> 2)), 255 };
+    }
+
+    uint8_t mix(uint8_t a, uint8_t b, int weightA, int weightB, int total)
+    {
+        return static_cast<uint8_t>((a*weightA + b*weightB + total/2) / total);
+    }
+
+    /** BC1 colour endpoints and 2-bit indices, three colours and transparent black when the endpoints are ordered low first */
+    void decodeColour(uint8_t const *block, bool alwaysFourColours, Rgba texels[16])
+    {
+        uint16_t c0 = block[0] | (block[1] << 8), c1 = block[2] | (block[3] << 8);
+        Rgba palette[4] = { expand565(c0), expand565(c1) };
+        if (c0 > c1 || alwaysFourColours)
+        {
+            palette[2] = Rgba{ mix(palette[0].r, palette[1].r, 2, 1, 3), mix(palette[0].g, palette[1].g, 2, 1, 3), mix(palette[0].b, palette[1].b, 2, 1, 3), 255 };
+            palette[3] = Rgba{ mix(palette[0].r, palette[1].r, 1, 2, 3), mix(palette[0].g, palette[1].g, 1, 2, 3), mix(palette[0].b, palette[1].b, 1, 2, 3), 255 };
+        }
+        else
+        {
+            palette[2] = Rgba{ mix(palette[0].r, palette[1].r, 1, 1, 2), mix(palette[0].g, palette[1].g, 1, 1, 2), mix(palette[0].b, palette[1].b, 1, 1, 2), 255 };
+            palette[3] = Rgba{ 0, 0, 0, 0 };
+        }
+        uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | (static_cast<uint32_t>(block[7]) << 24);
+        for (int i=0; i<16; i++)
+            texels[i] = palette[(indices >> (2*i)) & 0x3];
+    }
+
+    /** BC4 endpoints and 3-bit indices, six interpolated values plus 0 and 255 when the endpoints are ordered low first */
+    void decodeChannel(uint8_t const *block, uint8_t values[16])
+    {
+        uint8_t palette[8] = { block[0], block[1] };
+        if (block[0] > block[1])
+            for (int i=1; i<7; i++)
+                palette[i+1] = mix(block[0], block[1], 7-i, i, 7);
+        else
+        {
+            for (int i=1; i<5; i++)
+                palette[i+1] = mix(block[0], block[1], 5-i, i, 5);
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+        uint64_t indices = 0;
+        for (int i=0; i<6; i++)
+            indices |= static_cast<uint64_t>(block[2+i]) << (8*i);
+        for (int i=0; i<16; i++)
+            values[i] = palette[(indices >> (3*i)) & 0x7];
+    }
+
+    void decodeBlock(VkFormat format, uint8_t const *block, Rgba texels[16])
+    {
+        uint8_t channel[16];
+        switch (format)
+        {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+            decodeColour(block, false, texels);
+            for (int i=0; i<16; i++)
+                texels[i].a = 255;
+            break;
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+            decodeColour(block, false, texels);
+            break;
+        case VK_FORMAT_BC2_UNORM_BLOCK:
+        case VK_FORMAT_BC2_SRGB_BLOCK:
+            // Explicit 4-bit alpha precedes the colour block
+            decodeColour(block+8, true, texels);
+            for (int i=0; i<16; i++)
+                texels[i].a = ((block[i/2] >> (4*(i%2))) & 0xF) * 17;
+            break;
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+            // Interpolated alpha precedes the colour block
+            decodeColour(block+8, true, texels);
+            decodeChannel(block, channel);
+            for (int i=0; i<16; i++)
+                texels[i].a = channel[i];
+            break;
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+            decodeChannel(block, channel);
+            for (int i=0; i<16; i++)
+                texels[i] = Rgba{ channel[i], 0, 0, 255 };
+            break;
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+            decodeChannel(block, channel);
+            for (int i=0; i<16; i++)
+                texels[i] = Rgba{ channel[i], 0, 0, 255 };
+            decodeChannel(block+8, channel);
+            for (int i=0; i<16; i++)
+                texels[i].g = channel[i];
+            break;
+        default:
+            throw std::exception("Unsupported block compressed format.");
+        }
+    }
+}
+
+bool blockDecoder::canDecode(VkFormat format)
+{
+    return getBlockBytes(format) != 0;
+}
+
+VkFormat blockDecoder::getDecodedFormat(VkFormat format)
+{
+    switch (format)
+    {
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+    case VK_FORMAT_BC2_SRGB_BLOCK:
+    case VK_FORMAT_BC3_SRGB_BLOCK:
+        return VK_FORMAT_R8G8B8A8_SRGB;
+    default:
+        return VK_FORMAT_R8G8B8A8_UNORM;
+    }
+}
+
+size_t blockDecoder::getEncodedSize(VkFormat format, uint32_t width, uint32_t height)
+{
+    return static_cast<size_t>((width+3)/4) * ((height+3)/4) * getBlockBytes(format);
+}
+
+void blockDecoder::decode(VkFormat format, char const *data, uint32_t width, uint32_t height, void *destination)
+{
+    // Decode block rows, clipping blocks that overhang the level's edges
+    uint32_t const blockBytes = getBlockBytes(format);
+    uint8_t const *block = reinterpret_cast<uint8_t const *>(data);
+    Rgba *texels = reinterpret_cast<Rgba *>(destination);
+    Rgba decoded[16];
+    for (uint32_t y=0; y<height; y+=4)
+        for (uint32_t x=0; x<width; x+=4, block+=blockBytes)
+        {
+            decodeBlock(format, block, decoded);
+            uint32_t const rows = std::min(4u, height-y), columns = std::min(4u, width-x);
+            for (uint32_t row=0; row<rows; row++)
+                std::memcpy(texels + (y+row)*width + x, decoded + row*4, columns*sizeof(Rgba));
+        }
+}
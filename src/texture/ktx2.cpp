@@ -0,0 +1,113 @@
+
+#include "texture/ktx2.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+
+namespace
+{
+    uint8_t const IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+    /** Texel block extent and size of a format */
+    struct Block
+    {
+        uint32_t width;
+        uint32_t height;
+        uint32_t bytes;
+    };
+
+    bool within(VkFormat format, VkFormat first, VkFormat last)
+    {
+        return format >= first && format <= last;
+    }
+
+    Block getBlock(VkFormat format)
+    {
+        // Uncompressed formats by texel size
+        if (within(format, VK_FORMAT_R8_UNORM, VK_FORMAT_R8_SRGB)) return { 1, 1, 1 };
+        if (within(format, VK_FORMAT_R8G8_UNORM, VK_FORMAT_R8G8_SRGB) || within(format, VK_FORMAT_R16_UNORM, VK_FORMAT_R16_SFLOAT)) return { 1, 1, 2 };
+        if (within(format, VK_FORMAT_R8G8B8_UNORM, VK_FORMAT_B8G8R8_SRGB)) return { 1, 1, 3 };
+        if (within(format, VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_A2B10G10R10_SINT_PACK32) || within(format, VK_FORMAT_R16G16_UNORM, VK_FORMAT_R16G16_SFLOAT)
+            || within(format, VK_FORMAT_R32_UINT, VK_FORMAT_R32_SFLOAT) || within(format, VK_FORMAT_B10G11R11_UFLOAT_PACK32, VK_FORMAT_E5B9G9R9_UFLOAT_PACK32)) return { 1, 1, 4 };
+        if (within(format, VK_FORMAT_R16G16B16_UNORM, VK_FORMAT_R16G16B16_SFLOAT)) return { 1, 1, 6 };
+        if (within(format, VK_FORMAT_R16G16B16A16_UNORM, VK_FORMAT_R16G16B16A16_SFLOAT) || within(format, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32_SFLOAT)) return { 1, 1, 8 };
+        if (within(format, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32_SFLOAT)) return { 1, 1, 12 };
+        if (within(format, VK_FORMAT_R32G32B32A32_UINT, VK_FORMAT_R32G32B32A32_SFLOAT)) return { 1, 1, 16 };
+
+        // Block compressed formats, 8 bytes per 4x4 block for BC1, BC4, ETC2 without separate alpha and EAC R11, 16 otherwise
+        if (within(format, VK_FORMAT_BC1_RGB_UNORM_BLOCK, VK_FORMAT_BC1_RGBA_SRGB_BLOCK) || within(format, VK_FORMAT_BC4_UNORM_BLOCK, VK_FORMAT_BC4_SNORM_BLOCK)
+            || within(format, VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK, VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK) || within(format, VK_FORMAT_EAC_R11_UNORM_BLOCK, VK_FORMAT_EAC_R11_SNORM_BLOCK)) return { 4, 4, 8 };
+        if (within(format, VK_FORMAT_BC2_UNORM_BLOCK, VK_FORMAT_BC3_SRGB_BLOCK) || within(format, VK_FORMAT_BC5_UNORM_BLOCK, VK_FORMAT_BC7_SRGB_BLOCK)
+            || within(format, VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK, VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK) || within(format, VK_FORMAT_EAC_R11G11_UNORM_BLOCK, VK_FORMAT_EAC_R11G11_SNORM_BLOCK)) return { 4, 4, 16 };
+
+        // ASTC, 16 bytes per block of varying extent, UNORM and SRGB alternating
+        if (within(format, VK_FORMAT_ASTC_4x4_UNORM_BLOCK, VK_FORMAT_ASTC_12x12_SRGB_BLOCK))
+        {
+            static Block const ASTC[] = { {4,4,16}, {5,4,16}, {5,5,16}, {6,5,16}, {6,6,16}, {8,5,16}, {8,6,16}, {8,8,16}, {10,5,16}, {10,6,16}, {10,8,16}, {10,10,16}, {12,10,16}, {12,12,16} };
+            return ASTC[(format - VK_FORMAT_ASTC_4x4_UNORM_BLOCK) / 2];
+        }
+        return { 1, 1, 0 };
+    }
+}
+
+bool ktx2::isKtx2(char const *data, size_t size)
+{
+    return size >= sizeof(Header) && std::memcmp(data, IDENTIFIER, sizeof(IDENTIFIER)) == 0;
+}
+
+ktx2::Texture ktx2::parse(char const *data, size_t size)
+{
+    // Validate header, only plain 2D textures are supported
+    if (!isKtx2(data, size))
+        throw std::exception("Not a KTX2 file.");
+    Header const &header = *reinterpret_cast<Header const *>(data);
+    if (header.vkFormat == VK_FORMAT_UNDEFINED || header.supercompressionScheme != 0)
+        throw std::exception("Supercompressed KTX2 textures are not supported.");
+    if (header.pixelWidth == 0 || header.pixelHeight == 0 || header.pixelDepth > 1 || header.layerCount > 1 || header.faceCount != 1)
+        throw std::exception("Only 2D KTX2 textures are supported.");
+
+    if (header.levelCount > MAX_LEVELS)
+        throw std::exception("KTX2 file has too many levels.");
+    if (getBlock(static_cast<VkFormat>(header.vkFormat)).bytes == 0)
+        throw std::exception("KTX2 format not supported.");
+
+    // Level count of zero asks the loader to generate the chain from the base level
+    uint32_t const nLevels = std::max(header.levelCount, 1u);
+    if (sizeof(Header) + nLevels*sizeof(LevelIndex) > size)
+        throw std::exception("KTX2 file truncated.");
+    LevelIndex const *levelIndex = reinterpret_cast<LevelIndex const *>(data + sizeof(Header));
+
+    // Reference every level in place
+    Texture texture
+    {
+        .format = static_cast<VkFormat>(header.vkFormat),
+        .width = header.pixelWidth,
+        .height = header.pixelHeight,
+        .generateMips = header.levelCount == 0
+    };
+    for (uint32_t level=0; level<nLevels; level++)
+    {
+        // Compared so that crafted offsets and lengths can't wrap past the end
+        uint64_t const byteOffset = levelIndex[level].byteOffset, byteLength = levelIndex[level].byteLength;
+        if (byteLength > size || byteOffset > size - byteLength)
+            throw std::exception("KTX2 file truncated.");
+        Level const stored
+        {
+            .data = data + byteOffset,
+            .size = byteLength,
+            .width = std::max(header.pixelWidth >> level, 1u),
+            .height = std::max(header.pixelHeight >> level, 1u)
+        };
+        if (stored.size < getLevelSize(texture.format, stored.width, stored.height))
+            throw std::exception("KTX2 level truncated.");
+        texture.levels.push_back(stored);
+    }
+    return texture;
+}
+
+uint64_t ktx2::getLevelSize(VkFormat format, uint32_t width, uint32_t height)
+{
+    Block const block = getBlock(format);
+    return ((static_cast<uint64_t>(width) + block.width - 1) / block.width) * ((static_cast<uint64_t>(height) + block.height - 1) / block.height) * block.bytes;
+}
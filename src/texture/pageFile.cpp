@@ -0,0 +1,124 @@
+
+#include "texture/pageFile.hpp"
+
+#include <bit>
+#include <cstring>
+#include <exception>
+#include <fstream>
+
+namespace
+{
+    uint64_t align(uint64_t offset)
+    {
+        return (offset + pageFile::ALIGNMENT - 1) / pageFile::ALIGNMENT * pageFile::ALIGNMENT;
+    }
+}
+
+pageFile::Header const &pageFile::readHeader(char const *data, size_t size)
+{
+    // Validate header describes a whole chain of square pages
+    if (size < sizeof(Header))
+        throw std::exception("Page file truncated.");
+    Header const &header = *reinterpret_cast<Header const *>(data);
+    if (header.magic != MAGIC || header.version != VERSION)
+        throw std::exception("Not a page file or unsupported version.");
+    if (!std::has_single_bit(header.pageSize) || header.pageSize > MAX_PAGE_SIZE || !std::has_single_bit(header.size) || header.size < header.pageSize)
+        throw std::exception("Page file dimensions must be powers of two of at least one page, pages at most 4096 texels wide.");
+    if (!isSupportedFormat(static_cast<VkFormat>(header.format)))
+        throw std::exception("Page file format must be 8-bit RGBA or BGRA.");
+    if (header.nLevels != std::bit_width(header.size / header.pageSize) || header.nLevels > MAX_LEVELS || header.pageBytes != static_cast<uint64_t>(header.pageSize) * header.pageSize * 4)
+        throw std::exception("Page file layout doesn't match.");
+
+    // Validate pages lie within file, dividing rather than multiplying so crafted offsets can't wrap
+    if (header.pageOffset > size || getPageCount(header) > (size - header.pageOffset) / header.pageBytes)
+        throw std::exception("Page file truncated.");
+    return header;
+}
+
+bool pageFile::isSupportedFormat(VkFormat format)
+{
+    return format == VK_FORMAT_R8G8B8A8_UNORM || format == VK_FORMAT_R8G8B8A8_SRGB || format == VK_FORMAT_B8G8R8A8_UNORM || format == VK_FORMAT_B8G8R8A8_SRGB;
+}
+
+uint32_t pageFile::getPagesWide(Header const &header, uint32_t level)
+{
+    return (header.size / header.pageSize) >> level;
+}
+
+uint32_t pageFile::getLevelOffset(Header const &header, uint32_t level)
+{
+    uint32_t offset = 0;
+    for (uint32_t i=0; i<level; i++)
+        offset += getPagesWide(header, i) * getPagesWide(header, i);
+    return offset;
+}
+
+uint32_t pageFile::getPageCount(Header const &header)
+{
+    return getLevelOffset(header, header.nLevels);
+}
+
+char const *pageFile::getPage(char const *data, Header const &header, uint32_t pageIndex)
+{
+    return data + header.pageOffset + pageIndex*header.pageBytes;
+}
+
+std::vector<char> pageFile::serialize(std::vector<uint8_t> const &texels, uint32_t size, uint32_t pageSize, VkFormat format)
+{
+    if (texels.size() != static_cast<size_t>(size) * size * 4)
+        throw std::exception("Texel count doesn't match size.");
+    Header header
+    {
+        .magic = MAGIC,
+        .version = VERSION,
+        .format = static_cast<uint32_t>(format),
+        .pageSize = pageSize,
+        .size = size,
+        .nLevels = std::has_single_bit(size) && std::has_single_bit(pageSize) && size >= pageSize ? static_cast<uint32_t>(std::bit_width(size / pageSize)) : 0,
+        .pageBytes = static_cast<uint64_t>(pageSize) * pageSize * 4,
+        .pageOffset = align(sizeof(Header))
+    };
+    if (header.nLevels == 0 || header.nLevels > MAX_LEVELS || pageSize > MAX_PAGE_SIZE)
+        throw std::exception("Virtual texture size must be a power of two of at least one page.");
+    if (!isSupportedFormat(format))
+        throw std::exception("Virtual texture format must be 8-bit RGBA or BGRA.");
+
+    std::vector<char> data(header.pageOffset + getPageCount(header)*header.pageBytes, 0);
+    std::memcpy(data.data(), &header, sizeof(Header));
+    std::vector<uint8_t> level = texels, next;
+    for (uint32_t levelIndex=0; levelIndex<header.nLevels; levelIndex++)
+    {
+        // Cut level into pages
+        uint32_t const levelSize = size >> levelIndex, pagesWide = getPagesWide(header, levelIndex);
+        for (uint32_t pageY=0; pageY<pagesWide; pageY++)
+            for (uint32_t pageX=0; pageX<pagesWide; pageX++)
+            {
+                char *page = data.data() + header.pageOffset + (getLevelOffset(header, levelIndex) + pageY*pagesWide + pageX)*header.pageBytes;
+                for (uint32_t row=0; row<pageSize; row++)
+                    std::memcpy(page + row*pageSize*4, level.data() + ((pageY*pageSize + row)*levelSize + pageX*pageSize)*4, pageSize*4);
+            }
+
+        // Average 2x2 texels into the next level
+        uint32_t const nextSize = levelSize / 2;
+        next.assign(static_cast<size_t>(nextSize) * nextSize * 4, 0);
+        for (uint32_t y=0; y<nextSize; y++)
+            for (uint32_t x=0; x<nextSize; x++)
+                for (uint32_t channel=0; channel<4; channel++)
+                {
+                    uint32_t sum = level[((2*y)*levelSize + 2*x)*4 + channel] + level[((2*y)*levelSize + 2*x+1)*4 + channel]
+                                 + level[((2*y+1)*levelSize + 2*x)*4 + channel] + level[((2*y+1)*levelSize + 2*x+1)*4 + channel];
+                    next[(y*nextSize + x)*4 + channel] = static_cast<uint8_t>((sum + 2) / 4);
+                }
+        level.swap(next);
+    }
+    return data;
+}
+
+void pageFile::write(std::string const &filename, std::vector<uint8_t> const &texels, uint32_t size, uint32_t pageSize, VkFormat format)
+{
+    std::vector<char> data = serialize(texels, size, pageSize, format);
+    std::ofstream file(filename, std::ios::binary);
+    if (!file)
+        throw std::exception("Failed to open page file for writing.");
+    file.write(data.data(), data.size());
+}
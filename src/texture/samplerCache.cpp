@@ -0,0 +1,146 @@
+
+#include "texture/samplerCache.hpp"
+
+#include "configuration/device.hpp"
+#include "utility/check.hpp"
+#include "utility/util.hpp"
+
+namespace
+{
+    size_t hash(VkSamplerCreateInfo const &info)
+    {
+        size_t seed = 0;
+        for (auto value : { info.flags, static_cast<uint32_t>(info.magFilter), static_cast<uint32_t>(info.minFilter), static_cast<uint32_t>(info.mipmapMode),
+                            static_cast<uint32_t>(info.addressModeU), static_cast<uint32_t>(info.addressModeV), static_cast<uint32_t>(info.addressModeW),
+                            info.anisotropyEnable, info.compareEnable, static_cast<uint32_t>(info.compareOp), static_cast<uint32_t>(info.borderColor), info.unnormalizedCoordinates })
+            util::hashCombine(seed, value);
+        for (float value : { info.mipLodBias, info.maxAnisotropy, info.minLod, info.maxLod })
+            util::hashCombine(seed, value);
+        return seed;
+    }
+
+    size_t hash(VkImageViewCreateInfo const &info)
+    {
+        size_t seed = 0;
+        util::hashCombine(seed, info.image);
+        for (auto value : { info.flags, static_cast<uint32_t>(info.viewType), static_cast<uint32_t>(info.format),
+                            static_cast<uint32_t>(info.components.r), static_cast<uint32_t>(info.components.g), static_cast<uint32_t>(info.components.b), static_cast<uint32_t>(info.components.a),
+                            info.subresourceRange.aspectMask, info.subresourceRange.baseMipLevel, info.subresourceRange.levelCount,
+                            info.subresourceRange.baseArrayLayer, info.subresourceRange.layerCount })
+            util::hashCombine(seed, value);
+        return seed;
+    }
+
+    bool operator==(VkSamplerCreateInfo const &a, VkSamplerCreateInfo const &b)
+    {
+        return a.flags == b.flags && a.magFilter == b.magFilter && a.minFilter == b.minFilter && a.mipmapMode == b.mipmapMode
+            && a.addressModeU == b.addressModeU && a.addressModeV == b.addressModeV && a.addressModeW == b.addressModeW
+            && a.mipLodBias == b.mipLodBias && a.anisotropyEnable == b.anisotropyEnable && a.maxAnisotropy == b.maxAnisotropy
+            && a.compareEnable == b.compareEnable && a.compareOp == b.compareOp && a.minLod == b.minLod && a.maxLod == b.maxLod
+            && a.borderColor == b.borderColor && a.unnormalizedCoordinates == b.unnormalizedCoordinates;
+    }
+
+    bool operator==(VkImageViewCreateInfo const &a, VkImageViewCreateInfo const &b)
+    {
+        return a.flags == b.flags && a.image == b.image && a.viewType == b.viewType && a.format == b.format
+            && a.components.r == b.components.r && a.components.g == b.components.g && a.components.b == b.components.b && a.components.a == b.components.a
+            && a.subresourceRange.aspectMask == b.subresourceRange.aspectMask
+            && a.subresourceRange.baseMipLevel == b.subresourceRange.baseMipLevel && a.subresourceRange.levelCount == b.subresourceRange.levelCount
+            && a.subresourceRange.baseArrayLayer == b.subresourceRange.baseArrayLayer && a.subresourceRange.layerCount == b.subresourceRange.layerCount;
+    }
+}
+
+SamplerCache::SamplerCache(Device const *device) : device(device)
+{ }
+
+SamplerCache::~SamplerCache()
+{
+    for (auto &[hash, entry] : samplers)
+        vkDestroySampler(device->getHandle(), entry.sampler, nullptr);
+    for (auto &[hash, entry] : imageViews)
+        vkDestroyImageView(device->getHandle(), entry.imageView, nullptr);
+}
+
+VkSampler SamplerCache::getSampler(VkSamplerCreateInfo const &info)
+{
+    if (info.pNext != nullptr)
+        throw std::exception("Chained sampler create info can't be cached.");
+
+    // Reuse an identical sampler
+    size_t const key = hash(info);
+    auto [begin, end] = samplers.equal_range(key);
+    for (auto it=begin; it!=end; it++)
+        if (it->second.info == info)
+        {
+            cacheHits++;
+            return it->second.sampler;
+        }
+
+    // Otherwise create one
+    VkSampler sampler;
+    check::fail( vkCreateSampler(device->getHandle(), &info, nullptr, &sampler), "vkCreateSampler failed." );
+    samplers.emplace(key, SamplerEntry{ .info = info, .sampler = sampler });
+    return sampler;
+}
+
+VkImageView SamplerCache::getImageView(VkImageViewCreateInfo const &info)
+{
+    if (info.pNext != nullptr)
+        throw std::exception("Chained image view create info can't be cached.");
+
+    // Reuse an identical view
+    size_t const key = hash(info);
+    auto [begin, end] = imageViews.equal_range(key);
+    for (auto it=begin; it!=end; it++)
+        if (it->second.info == info)
+        {
+            cacheHits++;
+            return it->second.imageView;
+        }
+
+    // Otherwise create one
+    VkImageView imageView;
+    check::fail( vkCreateImageView(device->getHandle(), &info, nullptr, &imageView), "vkCreateImageView failed." );
+    imageViews.emplace(key, ImageViewEntry{ .info = info, .imageView = imageView });
+    return imageView;
+}
+
+void SamplerCache::releaseImageViews(VkImage image)
+{
+    for (auto it=imageViews.begin(); it!=imageViews.end(); )
+        if (it->second.info.image == image)
+        {
+            vkDestroyImageView(device->getHandle(), it->second.imageView, nullptr);
+            it = imageViews.erase(it);
+        }
+        else
+            it++;
+}
+
+SamplerCache::Statistics SamplerCache::getStatistics() const
+{
+    return Statistics{ .samplers = samplers.size(), .imageViews = imageViews.size(), .cacheHits = cacheHits };
+}
+
+VkSamplerCreateInfo SamplerCache::linear(float maxAnisotropy)
+{
+    return VkSamplerCreateInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+        .magFilter = VK_FILTER_LINEAR,
+        .minFilter = VK_FILTER_LINEAR,
+        .mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR,
+        .addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+        .addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+        .addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+        .mipLodBias = 0.0f,
+        .anisotropyEnable = maxAnisotropy > 1.0f ? VK_TRUE : VK_FALSE,
+        .maxAnisotropy = maxAnisotropy,
+        .compareEnable = VK_FALSE,
+        .compareOp = VK_COMPARE_OP_ALWAYS,
+        .minLod = 0.0f,
+        .maxLod = VK_LOD_CLAMP_NONE,
+        .borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK,
+        .unnormalizedCoordinates = VK_FALSE
+    };
+}
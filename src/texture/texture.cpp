@@ -0,0 +1,103 @@
+
+#include "texture/texture.hpp"
+
+#include "configuration/device.hpp"
+#include "configuration/physicalDevice.hpp"
+#include "texture/samplerCache.hpp"
+#include "utility/check.hpp"
+
+#include <algorithm>
+#include <bit>
+
+Texture::Texture(Device const *device, PhysicalDevice const *physicalDevice, SamplerCache *samplerCache, VkFormat format, VkExtent2D const &extent, uint32_t mipLevels, VkImageUsageFlags usage)
+    : device(device), samplerCache(samplerCache), format(format), extent(extent), mipLevels(mipLevels)
+{
+    // Create image
+    VkImageCreateInfo imageInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .imageType = VK_IMAGE_TYPE_2D,
+        .format = format,
+        .extent = { extent.width, extent.height, 1 },
+        .mipLevels = mipLevels,
+        .arrayLayers = 1,
+        .samples = VK_SAMPLE_COUNT_1_BIT,
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .usage = usage,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
+    };
+    check::fail( vkCreateImage(device->getHandle(), &imageInfo, nullptr, &image), "vkCreateImage failed." );
+
+    // Allocate and bind memory
+    VkMemoryRequirements memoryRequirements;
+    vkGetImageMemoryRequirements(device->getHandle(), image, &memoryRequirements);
+    size = memoryRequirements.size;
+    VkMemoryAllocateInfo allocInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .allocationSize = memoryRequirements.size,
+        .memoryTypeIndex = physicalDevice->findMemoryType(memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+    };
+    check::fail( vkAllocateMemory(device->getHandle(), &allocInfo, nullptr, &memory), "vkAllocateMemory failed." );
+    vkBindImageMemory(device->getHandle(), image, memory, 0);
+
+    // Get view of every level through the cache
+    imageView = samplerCache->getImageView(VkImageViewCreateInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+        .image = image,
+        .viewType = VK_IMAGE_VIEW_TYPE_2D,
+        .format = format,
+        .subresourceRange
+        {
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel = 0,
+            .levelCount = mipLevels,
+            .baseArrayLayer = 0,
+            .layerCount = 1
+        }
+    });
+}
+
+Texture::~Texture()
+{
+    samplerCache->releaseImageViews(image);
+    vkDestroyImage(device->getHandle(), image, nullptr);
+    vkFreeMemory(device->getHandle(), memory, nullptr);
+}
+
+VkImage const &Texture::getImage() const
+{
+    return image;
+}
+
+VkImageView const &Texture::getImageView() const
+{
+    return imageView;
+}
+
+VkFormat Texture::getFormat() const
+{
+    return format;
+}
+
+VkExtent2D const &Texture::getExtent() const
+{
+    return extent;
+}
+
+uint32_t Texture::getMipLevels() const
+{
+    return mipLevels;
+}
+
+VkDeviceSize Texture::getSize() const
+{
+    return size;
+}
+
+uint32_t Texture::countMipLevels(VkExtent2D const &extent)
+{
+    return std::bit_width(std::max(extent.width, extent.height));
+}
@@ -0,0 +1,383 @@
+
+#include "texture/textureLoader.hpp"
+
+#include "texture/blockDecoder.hpp"
+#include "texture/ktx2.hpp"
+#include "texture/samplerCache.hpp"
+#include "texture/texture.hpp"
+#include "asset/assetPack.hpp"
+#include "configuration/device.hpp"
+#include "configuration/physicalDevice.hpp"
+#include "configuration/queue.hpp"
+#include "command/commandPool.hpp"
+#include "profiling/cpuTrace.hpp"
+#include "profiling/counters.hpp"
+#include "utility/check.hpp"
+#include "utility/mappedFile.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <optional>
+
+namespace
+{
+    // Multiple of every texel block size, including 3 and 6 byte formats, as copy offsets require
+    VkDeviceSize constexpr STAGING_ALIGNMENT = 48;
+
+    VkDeviceSize align(VkDeviceSize offset)
+    {
+        return (offset + STAGING_ALIGNMENT - 1) / STAGING_ALIGNMENT * STAGING_ALIGNMENT;
+    }
+
+    void transition
+    (
+        VkCommandBuffer const &commandBuffer, VkImage image, uint32_t baseLevel, uint32_t levelCount,
+        VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccess, VkAccessFlags dstAccess,
+        VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage
+    )
+    {
+        VkImageMemoryBarrier barrier
+        {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .srcAccessMask = srcAccess,
+            .dstAccessMask = dstAccess,
+            .oldLayout = oldLayout,
+            .newLayout = newLayout,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = image,
+            .subresourceRange
+            {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .baseMipLevel = baseLevel,
+                .levelCount = levelCount,
+                .baseArrayLayer = 0,
+                .layerCount = 1
+            }
+        };
+        vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    }
+}
+
+TextureLoader::TextureLoader(Device const *device, PhysicalDevice const *physicalDevice, CommandPool *commandPool, AssetPack const *assetPack)
+    : device(device), physicalDevice(physicalDevice), commandPool(commandPool), assetPack(assetPack), samplerCache(new SamplerCache(device))
+{
+    stagingThread = std::thread(&TextureLoader::work, this);
+}
+
+TextureLoader::~TextureLoader()
+{
+    // Stop worker, dropping unstarted requests
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    stagingThread.join();
+
+    // Wait for and discard batches never handed out
+    for (Batch &batch : batches)
+    {
+        vkWaitForFences(device->getHandle(), 1, &batch.fence, VK_TRUE, UINT64_MAX);
+        vkDestroyFence(device->getHandle(), batch.fence, nullptr);
+        for (Texture *texture : batch.textures)
+            delete texture;
+    }
+    batches.clear();
+    delete samplerCache;
+}
+
+Texture *TextureLoader::load(std::string const &filename)
+{
+    return load(std::vector<std::string>{ filename })[0];
+}
+
+std::vector<Texture *> TextureLoader::load(std::vector<std::string> const &filenames)
+{
+    TRACE_ZONE("TextureLoader::load");
+    // Read, decode and stage files on worker threads, each pulling the next unclaimed file
+    std::vector<std::optional<StagedTexture>> stagedTextures(filenames.size());
+    std::vector<std::exception_ptr> errors(filenames.size());
+    std::atomic<size_t> nextFile = 0;
+    auto worker = [&]()
+    {
+        for (size_t i=nextFile++; i<filenames.size(); i=nextFile++)
+        {
+            try
+            {
+                stagedTextures[i].emplace(stage(filenames[i]));
+            }
+            catch (...)
+            {
+                errors[i] = std::current_exception();
+            }
+        }
+    };
+    size_t nWorkers = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), filenames.size());
+    std::vector<std::thread> workers;
+    for (size_t i=0; i<nWorkers; i++)
+        workers.emplace_back(worker);
+    for (std::thread &thread : workers)
+        thread.join();
+
+    // Propagate first failure
+    for (std::exception_ptr const &error : errors)
+        if (error)
+            std::rethrow_exception(error);
+
+    std::vector<StagedTexture> staged;
+    staged.reserve(stagedTextures.size());
+    for (std::optional<StagedTexture> &stagedTexture : stagedTextures)
+        staged.push_back(std::move(*stagedTexture));
+
+    // Record every upload into one command buffer
+    std::vector<Texture *> textures = createTextures(staged);
+    CommandBuffer transferCommandBuffer = commandPool->allocateNewBuffer();
+    transferCommandBuffer.record([&](VkCommandBuffer const &commandBuffer)
+    {
+        for (size_t i=0; i<textures.size(); i++)
+            recordUpload(commandBuffer, staged[i], textures[i]);
+    }, true);
+
+    // Submit and wait once for the whole batch before staging buffers are freed
+    Queue queue = device->getMainQueue();
+    queue.submit(device, transferCommandBuffer);
+    vkQueueWaitIdle(queue.getHandle());
+
+    return textures;
+}
+
+void TextureLoader::loadAsync(std::string const &filename)
+{
+    {
+        std::lock_guard lock(mutex);
+        requests.push_back(filename);
+    }
+    wake.notify_one();
+}
+
+std::vector<std::pair<std::string, Texture *>> TextureLoader::poll()
+{
+    TRACE_ZONE("TextureLoader::poll");
+    // Take everything the worker staged, rethrowing its failure
+    std::vector<std::pair<std::string, StagedTexture>> taken;
+    {
+        std::lock_guard lock(mutex);
+        if (error)
+            std::rethrow_exception(std::exchange(error, nullptr));
+        taken.swap(ready);
+    }
+
+    // Submit it as one batch, fenced rather than waited on
+    if (!taken.empty())
+    {
+        std::vector<std::string> names;
+        std::vector<StagedTexture> staged;
+        for (auto &[name, stagedTexture] : taken)
+        {
+            names.push_back(name);
+            staged.push_back(std::move(stagedTexture));
+        }
+        std::vector<Texture *> textures = createTextures(staged);
+        CommandBuffer transferCommandBuffer = commandPool->allocateNewBuffer();
+        transferCommandBuffer.record([&](VkCommandBuffer const &commandBuffer)
+        {
+            for (size_t i=0; i<textures.size(); i++)
+                recordUpload(commandBuffer, staged[i], textures[i]);
+        }, true);
+
+        VkFenceCreateInfo fenceInfo { .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+        VkFence fence;
+        check::fail( vkCreateFence(device->getHandle(), &fenceInfo, nullptr, &fence), "vkCreateFence failed." );
+        device->getMainQueue().submit(device, transferCommandBuffer, fence);
+        batches.push_back(Batch
+        {
+            .names = std::move(names),
+            .staged = std::move(staged),
+            .textures = std::move(textures),
+            .commandBuffer = std::move(transferCommandBuffer),
+            .fence = fence
+        });
+    }
+
+    // Hand out textures of completed batches, freeing their staging memory
+    std::vector<std::pair<std::string, Texture *>> completed;
+    for (auto it=batches.begin(); it!=batches.end(); )
+    {
+        if (vkGetFenceStatus(device->getHandle(), it->fence) != VK_SUCCESS)
+        {
+            it++;
+            continue;
+        }
+        for (size_t i=0; i<it->textures.size(); i++)
+            completed.emplace_back(it->names[i], it->textures[i]);
+        vkDestroyFence(device->getHandle(), it->fence, nullptr);
+        it = batches.erase(it);
+    }
+    return completed;
+}
+
+SamplerCache *TextureLoader::getSamplerCache() const
+{
+    return samplerCache;
+}
+
+TextureLoader::StagedTexture TextureLoader::stage(std::string const &filename) const
+{
+    TRACE_ZONE("TextureLoader::stage");
+    // Packed textures are used in place unless compressed
+    if (assetPack != nullptr && assetPack->contains(filename))
+    {
+        AssetPack::Entry const &entry = assetPack->getEntry(filename);
+        if (entry.type != AssetTexture)
+            throw std::exception("Packed asset is not a texture.");
+        if (!entry.compressed)
+            return stage(assetPack->view(filename), entry.size);
+        std::vector<char> data = assetPack->read(filename);
+        return stage(data.data(), data.size());
+    }
+
+    MappedFile file(filename);
+    return stage(file.getData(), file.getSize());
+}
+
+TextureLoader::StagedTexture TextureLoader::stage(char const *data, size_t size) const
+{
+    // Keep formats the device samples natively, decoding block compression it lacks
+    ktx2::Texture source = ktx2::parse(data, size);
+    bool const decode = !physicalDevice->supportsFormat(source.format, VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT);
+    if (decode && !blockDecoder::canDecode(source.format))
+        throw std::exception("Texture format not supported by the device.");
+    VkFormat const format = decode ? blockDecoder::getDecodedFormat(source.format) : source.format;
+
+    // Lay out levels in staging memory
+    std::vector<StagedTexture::Level> levels;
+    VkDeviceSize stagingSize = 0;
+    for (ktx2::Level const &level : source.levels)
+    {
+        // Parsing has checked each level covers its extent, so copies and decodes stay within it
+        levels.push_back(StagedTexture::Level{ .offset = align(stagingSize), .extent = { level.width, level.height } });
+        stagingSize = levels.back().offset + (decode ? static_cast<VkDeviceSize>(level.width) * level.height * 4 : level.size);
+    }
+
+    // Blit a full chain from the base level when asked to and the format allows filtered blits
+    VkExtent2D const extent{ source.width, source.height };
+    bool const generateMips = source.generateMips && physicalDevice->supportsFormat(format, VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT);
+    StagedTexture staged
+    {
+        .staging = TypedBuffer<char>(device, physicalDevice, stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT|VK_MEMORY_PROPERTY_HOST_COHERENT_BIT),
+        .format = format,
+        .extent = extent,
+        .levels = levels,
+        .mipLevels = generateMips ? Texture::countMipLevels(extent) : static_cast<uint32_t>(levels.size())
+    };
+
+    // Copy or decode every level straight into staging memory
+    char *mapped = static_cast<char *>(staged.staging.map());
+    for (size_t i=0; i<levels.size(); i++)
+    {
+        ktx2::Level const &level = source.levels[i];
+        if (decode)
+            blockDecoder::decode(source.format, level.data, level.width, level.height, mapped + levels[i].offset);
+        else
+            std::memcpy(mapped + levels[i].offset, level.data, level.size);
+    }
+    staged.staging.unmap();
+    return staged;
+}
+
+std::vector<Texture *> TextureLoader::createTextures(std::vector<StagedTexture> const &staged) const
+{
+    std::vector<Texture *> textures;
+    for (StagedTexture const &stagedTexture : staged)
+    {
+        VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        if (stagedTexture.mipLevels > stagedTexture.levels.size())
+            usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        textures.push_back(new Texture(device, physicalDevice, samplerCache, stagedTexture.format, stagedTexture.extent, stagedTexture.mipLevels, usage));
+    }
+    return textures;
+}
+
+void TextureLoader::recordUpload(VkCommandBuffer const &commandBuffer, StagedTexture const &staged, Texture const *texture) const
+{
+    VkImage const image = texture->getImage();
+    uint32_t const nStored = static_cast<uint32_t>(staged.levels.size());
+
+    // Copy every stored level
+    transition(commandBuffer, image, 0, staged.mipLevels, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    std::vector<VkBufferImageCopy> regions;
+    for (uint32_t level=0; level<nStored; level++)
+        regions.push_back(VkBufferImageCopy
+        {
+            .bufferOffset = staged.levels[level].offset,
+            .imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1 },
+            .imageOffset = { 0, 0, 0 },
+            .imageExtent = { staged.levels[level].extent.width, staged.levels[level].extent.height, 1 }
+        });
+    vkCmdCopyBufferToImage(commandBuffer, staged.staging.getHandle(), image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, nStored, regions.data());
+    counters::add(counters::BytesUploaded, staged.staging.getSize());
+
+    // Without generated levels everything goes straight to shader reads
+    if (staged.mipLevels == nStored)
+    {
+        transition(commandBuffer, image, 0, nStored, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+        return;
+    }
+
+    // Otherwise halve the base level repeatedly, each level becoming the source of the next
+    VkExtent2D extent = staged.extent;
+    for (uint32_t level=1; level<staged.mipLevels; level++)
+    {
+        transition(commandBuffer, image, level-1, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+        VkExtent2D const next{ std::max(extent.width/2, 1u), std::max(extent.height/2, 1u) };
+        VkImageBlit blit
+        {
+            .srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level-1, 0, 1 },
+            .srcOffsets = { { 0, 0, 0 }, { static_cast<int32_t>(extent.width), static_cast<int32_t>(extent.height), 1 } },
+            .dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1 },
+            .dstOffsets = { { 0, 0, 0 }, { static_cast<int32_t>(next.width), static_cast<int32_t>(next.height), 1 } }
+        };
+        vkCmdBlitImage(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+        extent = next;
+    }
+    transition(commandBuffer, image, 0, staged.mipLevels-1, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+    transition(commandBuffer, image, staged.mipLevels-1, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+}
+
+void TextureLoader::work()
+{
+    TRACE_THREAD("Texture staging");
+    while (true)
+    {
+        // Wait for the next request
+        std::string filename;
+        {
+            std::unique_lock lock(mutex);
+            wake.wait(lock, [&]() { return stopping || !requests.empty(); });
+            if (stopping)
+                return;
+            filename = std::move(requests.front());
+            requests.pop_front();
+        }
+
+        // Stage outside the lock, publishing the result or failure for poll
+        try
+        {
+            StagedTexture staged = stage(filename);
+            std::lock_guard lock(mutex);
+            ready.emplace_back(filename, std::move(staged));
+        }
+        catch (...)
+        {
+            std::lock_guard lock(mutex);
+            error = std::current_exception();
+        }
+    }
+}
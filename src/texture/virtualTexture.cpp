@@ -0,0 +1,380 @@
+
+#include "texture/virtualTexture.hpp"
+
+#include "texture/samplerCache.hpp"
+#include "texture/texture.hpp"
+#include "asset/assetPack.hpp"
+#include "configuration/device.hpp"
+#include "configuration/physicalDevice.hpp"
+#include "memory/descriptorSetLayout.hpp"
+#include "utility/mappedFile.hpp"
+#include "profiling/cpuTrace.hpp"
+#include "profiling/counters.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+VirtualTexture::VirtualTexture
+(
+    Device const *device, PhysicalDevice const *physicalDevice, SamplerCache *samplerCache, std::string const &filename,
+    AssetPack const *assetPack, uint32_t cachePagesWide, int framesInFlight
+) : device(device), framesInFlight(framesInFlight)
+{
+    // Feedback is written from fragment shaders
+    VkPhysicalDeviceFeatures features;
+    vkGetPhysicalDeviceFeatures(physicalDevice->getHandle(), &features);
+    if (!features.fragmentStoresAndAtomics)
+        throw std::exception("Virtual texturing needs fragment shader stores.");
+
+    // Pages are read in place, from the asset pack when packed
+    if (assetPack != nullptr && assetPack->contains(filename))
+    {
+        AssetPack::Entry const &entry = assetPack->getEntry(filename);
+        if (entry.type != AssetTexture || entry.compressed)
+            throw std::exception("Packed virtual textures must be stored uncompressed.");
+        file = nullptr;
+        data = assetPack->view(filename);
+        header = pageFile::readHeader(data, entry.size);
+    }
+    else
+    {
+        file = new MappedFile(filename);
+        data = file->getData();
+        header = pageFile::readHeader(data, file->getSize());
+    }
+
+    // Cache as many pages as indirection entries and the device's image size allow
+    uint32_t const nPages = pageFile::getPageCount(header);
+    this->cachePagesWide = std::min({ cachePagesWide, 256u, physicalDevice->getProperties().limits.maxImageDimension2D / header.pageSize });
+    uint32_t const cacheSize = this->cachePagesWide * header.pageSize;
+    cache = new Texture(device, physicalDevice, samplerCache, static_cast<VkFormat>(header.format), { cacheSize, cacheSize }, 1, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+
+    // Filtering is clamped inside pages by the shader, so no mips or wrapping here
+    VkSamplerCreateInfo samplerInfo = SamplerCache::linear();
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.addressModeU = samplerInfo.addressModeV = samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.maxLod = 0.0f;
+    sampler = samplerCache->getSampler(samplerInfo);
+
+    // Create layout of cache, indirection table and feedback
+    std::vector<VkDescriptorSetLayoutBinding> bindings
+    {
+        VkDescriptorSetLayoutBinding{ .binding = 0, .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, .descriptorCount = 1, .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT },
+        VkDescriptorSetLayoutBinding{ .binding = 1, .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, .descriptorCount = 1, .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT },
+        VkDescriptorSetLayoutBinding{ .binding = 2, .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, .descriptorCount = 1, .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT }
+    };
+    layout = new DescriptorSetLayout(device, bindings);
+
+    // Create per-frame buffers, feedback starting clear
+    VkMemoryPropertyFlags const hostVisible = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    std::vector<uint32_t> const clear(nPages, 0);
+    frames.reserve(framesInFlight);
+    for (int i=0; i<framesInFlight; i++)
+    {
+        frames.push_back(FrameResources
+        {
+            .indirection = TypedBuffer<char>(device, physicalDevice, sizeof(Parameters) + nPages*sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, hostVisible),
+            .feedback = TypedBuffer<uint32_t>(device, physicalDevice, nPages*sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, hostVisible),
+            .staging = TypedBuffer<char>(device, physicalDevice, MAX_UPLOADS_PER_FRAME*header.pageBytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, hostVisible)
+        });
+        frames.back().feedback.memcpy(clear);
+    }
+
+    // Start with every slot free and nothing resident
+    pageSlots.assign(nPages, INVALID_ENTRY);
+    pending.assign(nPages, false);
+    indirection.assign(nPages, INVALID_ENTRY);
+    slots.resize(this->cachePagesWide * this->cachePagesWide);
+    for (uint32_t slot=static_cast<uint32_t>(slots.size()); slot>0; slot--)
+        freeSlots.push_back(slot-1);
+
+    // The single page of the coarsest level backs every lookup, so is requested first and never evicted
+    pending[nPages-1] = true;
+    requests.push_back(nPages-1);
+    loaderThread = std::thread(&VirtualTexture::load, this);
+}
+
+VirtualTexture::~VirtualTexture()
+{
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    loaderThread.join();
+
+    delete layout;
+    delete cache;
+    delete file;
+}
+
+void VirtualTexture::update(uint64_t frame)
+{
+    TRACE_ZONE("VirtualTexture::update");
+    currentFrame = frame;
+    current = &frames[frame % framesInFlight];
+    current->uploads.clear();
+
+    // Reuse slots evicted long enough ago that no frame in flight still maps them
+    while (!retiringSlots.empty() && retiringSlots.front().second + framesInFlight <= frame)
+    {
+        freeSlots.push_back(retiringSlots.front().first);
+        retiringSlots.pop_front();
+    }
+
+    readFeedback();
+    stageLoadedPages();
+
+    // Publish this frame's view of residency
+    Parameters parameters
+    {
+        .pagesWide = pageFile::getPagesWide(header, 0),
+        .pageSize = header.pageSize,
+        .cachePagesWide = cachePagesWide,
+        .nLevels = header.nLevels,
+        .feedbackLodBias = static_cast<uint32_t>(std::countr_zero(FEEDBACK_DIVISOR))
+    };
+    for (uint32_t level=0; level<header.nLevels; level++)
+        parameters.levelOffsets[level] = pageFile::getLevelOffset(header, level);
+    char *mapped = static_cast<char *>(current->indirection.map());
+    std::memcpy(mapped, &parameters, sizeof(Parameters));
+    std::memcpy(mapped + sizeof(Parameters), indirection.data(), indirection.size()*sizeof(uint32_t));
+    current->indirection.unmap();
+}
+
+void VirtualTexture::recordUploads(VkCommandBuffer const &commandBuffer)
+{
+    TRACE_ZONE("VirtualTexture::recordUploads");
+    if (current == nullptr || (cacheInitialized && current->uploads.empty()))
+        return;
+
+    // Make the cache writable, discarding contents only the first time
+    VkImageMemoryBarrier barrier
+    {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .srcAccessMask = cacheInitialized ? VK_ACCESS_SHADER_READ_BIT : VkAccessFlags(0),
+        .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .oldLayout = cacheInitialized ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED,
+        .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = cache->getImage(),
+        .subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 }
+    };
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    // Copy each staged page into its slot
+    std::vector<VkBufferImageCopy> regions;
+    for (auto [slot, offset] : current->uploads)
+        regions.push_back(VkBufferImageCopy
+        {
+            .bufferOffset = offset,
+            .imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 },
+            .imageOffset = { static_cast<int32_t>(slot % cachePagesWide * header.pageSize), static_cast<int32_t>(slot / cachePagesWide * header.pageSize), 0 },
+            .imageExtent = { header.pageSize, header.pageSize, 1 }
+        });
+    if (!regions.empty())
+    {
+        vkCmdCopyBufferToImage(commandBuffer, current->staging.getHandle(), cache->getImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(regions.size()), regions.data());
+        counters::add(counters::BytesUploaded, regions.size() * header.pageBytes);
+    }
+
+    // Hand the cache back to fragment shaders
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    cacheInitialized = true;
+}
+
+void VirtualTexture::recordFeedbackBarrier(VkCommandBuffer const &commandBuffer) const
+{
+    VkMemoryBarrier barrier
+    {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_HOST_READ_BIT
+    };
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+VkExtent2D VirtualTexture::getFeedbackExtent(VkExtent2D extent)
+{
+    return { std::max(extent.width / FEEDBACK_DIVISOR, 1u), std::max(extent.height / FEEDBACK_DIVISOR, 1u) };
+}
+
+DescriptorSetLayout const *VirtualTexture::getLayout() const
+{
+    return layout;
+}
+
+std::vector<DescriptorAllocator::Binding> VirtualTexture::getBindings() const
+{
+    return
+    {
+        DescriptorAllocator::Binding::ofImage(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, cache->getImageView(), sampler),
+        DescriptorAllocator::Binding::ofBuffer(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, current->indirection),
+        DescriptorAllocator::Binding::ofBuffer(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, current->feedback)
+    };
+}
+
+Texture const *VirtualTexture::getCache() const
+{
+    return cache;
+}
+
+VirtualTexture::Statistics const &VirtualTexture::getStatistics() const
+{
+    return statistics;
+}
+
+void VirtualTexture::readFeedback()
+{
+    // Mark pages this frame last sampled as used, and collect missing ones
+    std::vector<uint32_t> missing;
+    uint32_t *requested = static_cast<uint32_t *>(current->feedback.map());
+    for (uint32_t page=0; page<pageSlots.size(); page++)
+    {
+        if (requested[page] == 0)
+            continue;
+        requested[page] = 0;
+        uint32_t const slot = pageSlots[page];
+        if (slot != INVALID_ENTRY)
+        {
+            slots[slot].lastUsedFrame = currentFrame;
+            lru.splice(lru.begin(), lru, slots[slot].lruPosition);
+        }
+        else if (!pending[page])
+        {
+            pending[page] = true;
+            missing.push_back(page);
+        }
+    }
+    current->feedback.unmap();
+    if (missing.empty())
+        return;
+
+    // Queue coarse levels first, as they cover the most screen until finer ones arrive
+    std::reverse(missing.begin(), missing.end());
+    statistics.requests += static_cast<uint32_t>(missing.size());
+    {
+        std::lock_guard lock(mutex);
+        requests.insert(requests.end(), missing.begin(), missing.end());
+    }
+    wake.notify_one();
+}
+
+void VirtualTexture::stageLoadedPages()
+{
+    // Take what the loader has read, up to this frame's upload budget
+    std::vector<std::pair<uint32_t, std::vector<char>>> pages;
+    {
+        std::lock_guard lock(mutex);
+        while (!loaded.empty() && pages.size() < MAX_UPLOADS_PER_FRAME)
+        {
+            pages.push_back(std::move(loaded.front()));
+            loaded.pop_front();
+        }
+    }
+    if (pages.empty())
+        return;
+
+    // Make room, pages left over wait for slots to finish retiring
+    if (freeSlots.size() < pages.size())
+        evict(static_cast<uint32_t>(pages.size() - freeSlots.size()));
+    size_t const nStaged = std::min(pages.size(), freeSlots.size());
+    {
+        std::lock_guard lock(mutex);
+        for (size_t i=pages.size(); i>nStaged; i--)
+            loaded.push_front(std::move(pages[i-1]));
+    }
+
+    // Copy pages into staging and map them to their slots
+    char *staging = static_cast<char *>(current->staging.map());
+    for (size_t i=0; i<nStaged; i++)
+    {
+        auto &[page, texels] = pages[i];
+        uint32_t const slot = freeSlots.back();
+        freeSlots.pop_back();
+        VkDeviceSize const offset = i*header.pageBytes;
+        std::memcpy(staging + offset, texels.data(), header.pageBytes);
+        current->uploads.emplace_back(slot, offset);
+
+        lru.push_front(slot);
+        slots[slot] = Slot{ .page = page, .lastUsedFrame = currentFrame, .lruPosition = lru.begin() };
+        pageSlots[page] = slot;
+        pending[page] = false;
+    }
+    current->staging.unmap();
+    statistics.uploads += static_cast<uint32_t>(nStaged);
+    statistics.residentPages += static_cast<uint32_t>(nStaged);
+    rebuildIndirection();
+}
+
+void VirtualTexture::evict(uint32_t count)
+{
+    // Unmap least recently used pages, keeping the coarsest and anything sampled this frame
+    uint32_t const coarsest = static_cast<uint32_t>(pageSlots.size()) - 1;
+    for (auto position = lru.end(); count > 0 && position != lru.begin(); )
+    {
+        position--;
+        Slot const &slot = slots[*position];
+        if (slot.page == coarsest || slot.lastUsedFrame == currentFrame)
+            continue;
+
+        pageSlots[slot.page] = INVALID_ENTRY;
+        retiringSlots.emplace_back(*position, currentFrame);
+        position = lru.erase(position);
+        statistics.evictions++;
+        statistics.residentPages--;
+        count--;
+    }
+    rebuildIndirection();
+}
+
+void VirtualTexture::rebuildIndirection()
+{
+    // Point every page at itself when resident, otherwise at what its parent points at
+    for (uint32_t level=header.nLevels; level>0; level--)
+    {
+        uint32_t const wide = pageFile::getPagesWide(header, level-1), offset = pageFile::getLevelOffset(header, level-1);
+        for (uint32_t y=0; y<wide; y++)
+            for (uint32_t x=0; x<wide; x++)
+            {
+                uint32_t const page = offset + y*wide + x, slot = pageSlots[page];
+                if (slot != INVALID_ENTRY)
+                    indirection[page] = (slot % cachePagesWide) | ((slot / cachePagesWide) << 8) | ((level-1) << 16);
+                else if (level == header.nLevels)
+                    indirection[page] = INVALID_ENTRY;
+                else
+                    indirection[page] = indirection[pageFile::getLevelOffset(header, level) + (y/2)*(wide/2) + x/2];
+            }
+    }
+}
+
+void VirtualTexture::load()
+{
+    TRACE_THREAD("Virtual texture loader");
+    while (true)
+    {
+        // Wait for the next request
+        uint32_t page;
+        {
+            std::unique_lock lock(mutex);
+            wake.wait(lock, [&]() { return stopping || !requests.empty(); });
+            if (stopping)
+                return;
+            page = requests.front();
+            requests.pop_front();
+        }
+
+        // Read outside the lock, faulting the page in from storage
+        TRACE_ZONE("VirtualTexture::loadPage");
+        char const *source = pageFile::getPage(data, header, page);
+        std::vector<char> texels(source, source + header.pageBytes);
+        std::lock_guard lock(mutex);
+        loaded.emplace_back(page, std::move(texels));
+    }
+}
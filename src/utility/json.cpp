@@ -0,0 +1,202 @@
+
+#include "utility/json.hpp"
+
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+
+namespace
+{
+    json::Value const NULL_VALUE{};
+
+    class Parser
+    {
+    private:
+        char const *current;
+        char const *end;
+
+    public:
+        Parser(char const *data, size_t size) : current(data), end(data+size)
+        { }
+
+        json::Value parseValue()
+        {
+            skipWhitespace();
+            if (current == end)
+                throw std::exception("JSON: unexpected end of input.");
+
+            json::Value value;
+            switch (*current)
+            {
+            case '{':
+                value.type = json::Value::Object;
+                current++;
+                if (consume('}'))
+                    return value;
+                do
+                {
+                    skipWhitespace();
+                    std::string key = parseString();
+                    if (!consume(':'))
+                        throw std::exception("JSON: expected ':'.");
+                    value.object.emplace_back(std::move(key), parseValue());
+                } while (consume(','));
+                if (!consume('}'))
+                    throw std::exception("JSON: expected '}'.");
+                return value;
+
+            case '[':
+                value.type = json::Value::Array;
+                current++;
+                if (consume(']'))
+                    return value;
+                do
+                    value.array.push_back(parseValue());
+                while (consume(','));
+                if (!consume(']'))
+                    throw std::exception("JSON: expected ']'.");
+                return value;
+
+            case '"':
+                value.type = json::Value::String;
+                value.string = parseString();
+                return value;
+
+            case 't':
+            case 'f':
+                value.type = json::Value::Bool;
+                value.boolean = (*current == 't');
+                parseLiteral(value.boolean ? "true" : "false");
+                return value;
+
+            case 'n':
+                parseLiteral("null");
+                return value;
+
+            default:
+                value.type = json::Value::Number;
+                std::from_chars_result result = std::from_chars(current, end, value.number);
+                if (result.ec != std::errc())
+                    throw std::exception("JSON: invalid number.");
+                current = result.ptr;
+                return value;
+            }
+        }
+
+    private:
+        void skipWhitespace()
+        {
+            while (current != end && (*current==' ' || *current=='\n' || *current=='\r' || *current=='\t'))
+                current++;
+        }
+
+        bool consume(char c)
+        {
+            skipWhitespace();
+            if (current != end && *current == c)
+            {
+                current++;
+                return true;
+            }
+            return false;
+        }
+
+        void parseLiteral(char const *literal)
+        {
+            size_t const length = std::strlen(literal);
+            if (static_cast<size_t>(end - current) < length || std::memcmp(current, literal, length) != 0)
+                throw std::exception("JSON: invalid literal.");
+            current += length;
+        }
+
+        std::string parseString()
+        {
+            if (current == end || *current != '"')
+                throw std::exception("JSON: expected string.");
+            current++;
+
+            // Copy characters, keeping escaped characters literally except for common control escapes
+            std::string string;
+            while (current != end && *current != '"')
+            {
+                if (*current == '\\' && current+1 != end)
+                {
+                    current++;
+                    switch (*current)
+                    {
+                    case 'n': string.push_back('\n'); break;
+                    case 't': string.push_back('\t'); break;
+                    case 'r': string.push_back('\r'); break;
+                    case 'b': string.push_back('\b'); break;
+                    case 'f': string.push_back('\f'); break;
+                    default: string.push_back(*current); break;
+                    }
+                }
+                else
+                    string.push_back(*current);
+                current++;
+            }
+            if (current == end)
+                throw std::exception("JSON: unterminated string.");
+            current++;
+            return string;
+        }
+    };
+}
+
+bool json::Value::has(std::string const &key) const
+{
+    for (std::pair<std::string, Value> const &member : object)
+        if (member.first == key)
+            return true;
+    return false;
+}
+
+json::Value const &json::Value::operator[](std::string const &key) const
+{
+    for (std::pair<std::string, Value> const &member : object)
+        if (member.first == key)
+            return member.second;
+    return NULL_VALUE;
+}
+
+json::Value const &json::Value::operator[](size_t index) const
+{
+    return index < array.size() ? array[index] : NULL_VALUE;
+}
+
+size_t json::Value::size() const
+{
+    return type == Object ? object.size() : array.size();
+}
+
+double json::Value::asNumber(double fallback) const
+{
+    return type == Number ? number : fallback;
+}
+
+json::Value json::parse(char const *data, size_t size)
+{
+    return Parser(data, size).parseValue();
+}
+
+std::string json::quote(std::string const &text)
+{
+    // Escape quotes, backslashes and control characters
+    std::string quoted = "\"";
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            quoted += '\\';
+        if (static_cast<unsigned char>(c) < 0x20)
+        {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            quoted += escaped;
+        }
+        else
+            quoted += c;
+    }
+    return quoted + "\"";
+}
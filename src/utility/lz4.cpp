@@ -0,0 +1,146 @@
+
+#include "utility/lz4.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <exception>
+
+namespace
+{
+    int constexpr HASH_BITS = 14;
+    size_t constexpr MIN_MATCH = 4;
+    size_t constexpr LAST_LITERALS = 5;  // Final bytes of a block are always literals
+    size_t constexpr MATCH_LIMIT = 12;   // Last match must start this far before block end
+    size_t constexpr MAX_OFFSET = 65535;
+
+    uint32_t read32(char const *data)
+    {
+        uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    void writeLength(std::vector<char> &output, size_t length)
+    {
+        for (; length >= 255; length -= 255)
+            output.push_back(static_cast<char>(255));
+        output.push_back(static_cast<char>(length));
+    }
+
+    void writeSequence(std::vector<char> &output, char const *literals, size_t nLiterals, size_t offset, size_t matchLength)
+    {
+        // Token holds both lengths, saturating at 15, the final literal-only sequence leaving its match length zero
+        size_t matchCode = matchLength != 0 ? matchLength - MIN_MATCH : 0;
+        output.push_back(static_cast<char>( ((nLiterals<15 ? nLiterals : 15) << 4) | (matchCode<15 ? matchCode : 15) ));
+        if (nLiterals >= 15)
+            writeLength(output, nLiterals - 15);
+        output.insert(output.end(), literals, literals + nLiterals);
+
+        // Final literal-only sequence has no match
+        if (matchLength == 0)
+            return;
+        output.push_back(static_cast<char>(offset & 0xFF));
+        output.push_back(static_cast<char>(offset >> 8));
+        if (matchCode >= 15)
+            writeLength(output, matchCode - 15);
+    }
+
+    size_t readLength(unsigned char const *&input, unsigned char const *end)
+    {
+        size_t length = 0;
+        unsigned char byte;
+        do
+        {
+            if (input == end)
+                throw std::exception("LZ4: truncated length.");
+            byte = *input++;
+            length += byte;
+        } while (byte == 255);
+        return length;
+    }
+}
+
+std::vector<char> lz4::compress(char const *source, size_t sourceSize)
+{
+    std::vector<char> output;
+    output.reserve(sourceSize + sourceSize/255 + 16);
+
+    // Greedy matching against the most recent position with the same 4-byte hash
+    size_t anchor = 0;
+    if (sourceSize > MATCH_LIMIT)
+    {
+        std::vector<uint32_t> table(size_t(1) << HASH_BITS, 0);
+        size_t const matchStartLimit = sourceSize - MATCH_LIMIT;
+        size_t const matchEndLimit = sourceSize - LAST_LITERALS;
+        size_t position = 0;
+        while (position < matchStartLimit)
+        {
+            uint32_t sequence = read32(source + position);
+            uint32_t hash = (sequence * 2654435761u) >> (32 - HASH_BITS);
+            size_t candidate = table[hash];
+            table[hash] = static_cast<uint32_t>(position + 1);
+
+            if (candidate != 0 && position - (candidate-1) <= MAX_OFFSET && read32(source + candidate - 1) == sequence)
+            {
+                size_t match = candidate - 1;
+                size_t length = MIN_MATCH;
+                while (position + length < matchEndLimit && source[match + length] == source[position + length])
+                    length++;
+                writeSequence(output, source + anchor, position - anchor, position - match, length);
+                position += length;
+                anchor = position;
+            }
+            else
+                position++;
+        }
+    }
+
+    // Remaining bytes as literals
+    writeSequence(output, source + anchor, sourceSize - anchor, 0, 0);
+    return output;
+}
+
+void lz4::decompress(char const *source, size_t sourceSize, char *destination, size_t destinationSize)
+{
+    unsigned char const *input = reinterpret_cast<unsigned char const *>(source);
+    unsigned char const *const inputEnd = input + sourceSize;
+    char *output = destination;
+    char *const outputEnd = destination + destinationSize;
+
+    while (input < inputEnd)
+    {
+        // Copy literals
+        unsigned char token = *input++;
+        size_t nLiterals = token >> 4;
+        if (nLiterals == 15)
+            nLiterals += readLength(input, inputEnd);
+        if (nLiterals > static_cast<size_t>(inputEnd - input) || nLiterals > static_cast<size_t>(outputEnd - output))
+            throw std::exception("LZ4: literals out of bounds.");
+        std::memcpy(output, input, nLiterals);
+        input += nLiterals;
+        output += nLiterals;
+
+        // Last sequence ends after its literals
+        if (input == inputEnd)
+            break;
+
+        // Copy match, byte by byte as it may overlap its own output
+        if (inputEnd - input < 2)
+            throw std::exception("LZ4: truncated offset.");
+        size_t offset = input[0] | (input[1] << 8);
+        input += 2;
+        size_t matchLength = token & 15;
+        if (matchLength == 15)
+            matchLength += readLength(input, inputEnd);
+        matchLength += MIN_MATCH;
+        if (offset == 0 || offset > static_cast<size_t>(output - destination) || matchLength > static_cast<size_t>(outputEnd - output))
+            throw std::exception("LZ4: match out of bounds.");
+        char const *match = output - offset;
+        for (size_t i=0; i<matchLength; i++)
+            output[i] = match[i];
+        output += matchLength;
+    }
+
+    if (output != outputEnd)
+        throw std::exception("LZ4: decompressed size mismatch.");
+}
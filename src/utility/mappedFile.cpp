@@ -0,0 +1,125 @@
+
+#include "utility/mappedFile.hpp"
+
+#include <exception>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(std::string const &filename) : data(nullptr), size(0), fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr)
+{
+    // Open file
+    fileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+        throw std::exception("File not found");
+
+    // Get size, empty files can't be mapped
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize))
+    {
+        CloseHandle(fileHandle);
+        throw std::exception("GetFileSizeEx failed.");
+    }
+    size = static_cast<size_t>(fileSize.QuadPart);
+    if (size == 0)
+        return;
+
+    // Map whole file, closing what is already open on failure as the destructor won't run
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle == nullptr)
+    {
+        CloseHandle(fileHandle);
+        throw std::exception("CreateFileMapping failed.");
+    }
+    data = static_cast<char const *>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (data == nullptr)
+    {
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        throw std::exception("MapViewOfFile failed.");
+    }
+}
+
+MappedFile::MappedFile(MappedFile &&old) : data(old.data), size(old.size), fileHandle(old.fileHandle), mappingHandle(old.mappingHandle)
+{
+    old.data = nullptr;
+    old.fileHandle = INVALID_HANDLE_VALUE;
+    old.mappingHandle = nullptr;
+}
+
+MappedFile::~MappedFile()
+{
+    if (data != nullptr)
+        UnmapViewOfFile(data);
+    if (mappingHandle != nullptr)
+        CloseHandle(mappingHandle);
+    if (fileHandle != INVALID_HANDLE_VALUE)
+        CloseHandle(fileHandle);
+}
+
+#else
+
+MappedFile::MappedFile(std::string const &filename) : data(nullptr), size(0), fileDescriptor(-1)
+{
+    // Open file
+    fileDescriptor = open(filename.c_str(), O_RDONLY);
+    if (fileDescriptor == -1)
+        throw std::exception("File not found");
+
+    // Get size, empty files can't be mapped
+    struct stat fileStat;
+    if (fstat(fileDescriptor, &fileStat) == -1)
+    {
+        close(fileDescriptor);
+        throw std::exception("fstat failed.");
+    }
+    size = static_cast<size_t>(fileStat.st_size);
+    if (size == 0)
+        return;
+
+    // Map whole file and hint that it will be read front to back, closing the file on failure as the destructor won't run
+    void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    if (mapping == MAP_FAILED)
+    {
+        close(fileDescriptor);
+        throw std::exception("mmap failed.");
+    }
+    madvise(mapping, size, MADV_SEQUENTIAL);
+    data = static_cast<char const *>(mapping);
+}
+
+MappedFile::MappedFile(MappedFile &&old) : data(old.data), size(old.size), fileDescriptor(old.fileDescriptor)
+{
+    old.data = nullptr;
+    old.fileDescriptor = -1;
+}
+
+MappedFile::~MappedFile()
+{
+    if (data != nullptr)
+        munmap(const_cast<char *>(data), size);
+    if (fileDescriptor != -1)
+        close(fileDescriptor);
+}
+
+#endif
+
+char const *MappedFile::getData() const
+{
+    return data;
+}
+
+size_t MappedFile::getSize() const
+{
+    return size;
+}
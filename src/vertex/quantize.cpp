@@ -0,0 +1,316 @@
+
+#include "vertex/quantize.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define QUANTIZE_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(__F16C__) || defined(__AVX2__)
+#define QUANTIZE_F16C
+#include <immintrin.h>
+#endif
+
+quantize::Dequantization const quantize::Dequantization::IDENTITY { glm::vec3(0.0f), glm::vec3(1.0f) };
+
+namespace
+{
+    template<class T>
+    void store(char *destination, T const &value)
+    {
+        std::memcpy(destination, &value, sizeof(T));
+    }
+
+    template<class T>
+    T load(char const *source)
+    {
+        T value;
+        std::memcpy(&value, source, sizeof(T));
+        return value;
+    }
+
+#ifdef QUANTIZE_SSE2
+    // Loads an attribute's xyz with w forced to one, reading one float past it within the Vertex
+    __m128 loadXyz1(glm::vec3 const &value)
+    {
+        __m128 const xyzMask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+        __m128 const wOne = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+        return _mm_or_ps(_mm_and_ps(_mm_loadu_ps(&value.x), xyzMask), wOne);
+    }
+#endif
+
+    void encodePositions(std::vector<Vertex> const &vertices, VertexLayout const &layout, quantize::Dequantization const &dequantization, char *destination, bool simd)
+    {
+        uint32_t const stride = layout.getStride();
+        glm::vec3 const inverseScale = 1.0f / dequantization.scale;
+        switch (layout.position)
+        {
+        case VertexLayout::PositionFloat:
+            for (size_t i=0; i<vertices.size(); i++)
+                store(destination + i*stride, vertices[i].position);
+            return;
+
+        case VertexLayout::PositionHalf:
+#ifdef QUANTIZE_F16C
+            if (simd)
+            {
+                for (size_t i=0; i<vertices.size(); i++)
+                    _mm_storel_epi64(reinterpret_cast<__m128i *>(destination + i*stride), _mm_cvtps_ph(loadXyz1(vertices[i].position), _MM_FROUND_TO_NEAREST_INT));
+                return;
+            }
+#endif
+            for (size_t i=0; i<vertices.size(); i++)
+            {
+                glm::vec3 const &position = vertices[i].position;
+                uint16_t const half[4] = { quantize::toHalf(position.x), quantize::toHalf(position.y), quantize::toHalf(position.z), quantize::toHalf(1.0f) };
+                store(destination + i*stride, half);
+            }
+            return;
+
+        case VertexLayout::PositionSnorm16:
+#ifdef QUANTIZE_SSE2
+            if (simd)
+            {
+                // Normalise to [-1, 1] within bounds, w passes through as one
+                __m128 const offset = _mm_set_ps(0.0f, dequantization.offset.z, dequantization.offset.y, dequantization.offset.x);
+                __m128 const scale = _mm_set_ps(1.0f, inverseScale.z, inverseScale.y, inverseScale.x);
+                __m128 const lower = _mm_set1_ps(-1.0f), upper = _mm_set1_ps(1.0f), range = _mm_set1_ps(32767.0f);
+                for (size_t i=0; i<vertices.size(); i++)
+                {
+                    __m128 normalised = _mm_mul_ps(_mm_sub_ps(loadXyz1(vertices[i].position), offset), scale);
+                    __m128i integer = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(normalised, lower), upper), range));
+                    _mm_storel_epi64(reinterpret_cast<__m128i *>(destination + i*stride), _mm_packs_epi32(integer, integer));
+                }
+                return;
+            }
+#endif
+            for (size_t i=0; i<vertices.size(); i++)
+            {
+                glm::vec3 normalised = (vertices[i].position - dequantization.offset) * inverseScale;
+                int16_t const snorm[4] = { quantize::toSnorm16(normalised.x), quantize::toSnorm16(normalised.y), quantize::toSnorm16(normalised.z), quantize::toSnorm16(1.0f) };
+                store(destination + i*stride, snorm);
+            }
+            return;
+        }
+    }
+
+    void encodeColours(std::vector<Vertex> const &vertices, VertexLayout const &layout, char *destination, bool simd)
+    {
+        uint32_t const stride = layout.getStride();
+        switch (layout.colour)
+        {
+        case VertexLayout::ColourFloat:
+            for (size_t i=0; i<vertices.size(); i++)
+                store(destination + i*stride, vertices[i].colour);
+            return;
+
+        case VertexLayout::ColourUnorm8:
+#ifdef QUANTIZE_SSE2
+            if (simd)
+            {
+                __m128 const lower = _mm_setzero_ps(), upper = _mm_set1_ps(1.0f), range = _mm_set1_ps(255.0f);
+                for (size_t i=0; i<vertices.size(); i++)
+                {
+                    __m128i integer = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(loadXyz1(vertices[i].colour), lower), upper), range));
+                    __m128i words = _mm_packs_epi32(integer, integer);
+                    store(destination + i*stride, _mm_cvtsi128_si32(_mm_packus_epi16(words, words)));
+                }
+                return;
+            }
+#endif
+            for (size_t i=0; i<vertices.size(); i++)
+            {
+                glm::vec3 const &colour = vertices[i].colour;
+                uint8_t const unorm[4] = { quantize::toUnorm8(colour.r), quantize::toUnorm8(colour.g), quantize::toUnorm8(colour.b), 255 };
+                store(destination + i*stride, unorm);
+            }
+            return;
+        }
+    }
+
+    void encodeNormals(std::vector<Vertex> const &vertices, VertexLayout const &layout, char *destination)
+    {
+        uint32_t const stride = layout.getStride();
+        switch (layout.normal)
+        {
+        case VertexLayout::NormalFloat:
+            for (size_t i=0; i<vertices.size(); i++)
+                store(destination + i*stride, vertices[i].normal);
+            return;
+
+        case VertexLayout::NormalOctahedral:
+            for (size_t i=0; i<vertices.size(); i++)
+            {
+                glm::vec2 encoded = quantize::encodeOctahedral(vertices[i].normal);
+                int16_t const snorm[2] = { quantize::toSnorm16(encoded.x), quantize::toSnorm16(encoded.y) };
+                store(destination + i*stride, snorm);
+            }
+            return;
+        }
+    }
+}
+
+glm::mat4 quantize::Dequantization::getTransform() const
+{
+    glm::mat4 transform(1.0f);
+    transform[0][0] = scale.x;
+    transform[1][1] = scale.y;
+    transform[2][2] = scale.z;
+    transform[3] = glm::vec4(offset, 1.0f);
+    return transform;
+}
+
+uint16_t quantize::toHalf(float value)
+{
+    uint32_t bits = load<uint32_t>(reinterpret_cast<char const *>(&value));
+    uint32_t const sign = (bits >> 16) & 0x8000;
+    bits &= 0x7FFFFFFF;
+
+    // Infinity and NaN, including values beyond half range
+    if (bits >= (127+16) << 23)
+        return sign | (bits > 0x7F800000 ? 0x7E00 : 0x7C00);
+
+    // Subnormal results, aligned by a float add so the FPU rounds to nearest even
+    if (bits < (127-14) << 23)
+    {
+        float magnitude = load<float>(reinterpret_cast<char const *>(&bits)) + 0.5f;
+        return sign | (load<uint32_t>(reinterpret_cast<char const *>(&magnitude)) - 0x3F000000);
+    }
+
+    // Normal results: rebias exponent and round mantissa to nearest even
+    bits += ((15u-127u) << 23) + 0xFFF + ((bits >> 13) & 1);
+    return sign | (bits >> 13);
+}
+
+float quantize::fromHalf(uint16_t value)
+{
+    uint32_t const sign = (value & 0x8000u) << 16;
+    uint32_t const exponent = (value >> 10) & 0x1F;
+    uint32_t const mantissa = value & 0x3FF;
+    if (exponent == 0)
+        return std::copysign(std::ldexp(static_cast<float>(mantissa), -24), sign ? -1.0f : 1.0f);
+    uint32_t bits = sign | (exponent == 31 ? 0x7F800000 : (exponent + 112) << 23) | (mantissa << 13);
+    return load<float>(reinterpret_cast<char const *>(&bits));
+}
+
+int16_t quantize::toSnorm16(float value)
+{
+    return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+float quantize::fromSnorm16(int16_t value)
+{
+    return std::max(value / 32767.0f, -1.0f);
+}
+
+uint8_t quantize::toUnorm8(float value)
+{
+    return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+}
+
+glm::vec2 quantize::encodeOctahedral(glm::vec3 normal)
+{
+    // Project onto octahedron, degenerate normals map to +Z
+    float const sum = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if (!(sum > 0.0f))
+        return glm::vec2(0.0f);
+    glm::vec2 projected(normal.x / sum, normal.y / sum);
+
+    // Fold lower hemisphere over the diagonals
+    if (normal.z < 0.0f)
+        projected = glm::vec2
+        (
+            (1.0f - std::abs(projected.y)) * (projected.x >= 0.0f ? 1.0f : -1.0f),
+            (1.0f - std::abs(projected.x)) * (projected.y >= 0.0f ? 1.0f : -1.0f)
+        );
+    return projected;
+}
+
+glm::vec3 quantize::decodeOctahedral(glm::vec2 encoded)
+{
+    glm::vec3 normal(encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y));
+    if (normal.z < 0.0f)
+    {
+        normal.x = (1.0f - std::abs(encoded.y)) * (encoded.x >= 0.0f ? 1.0f : -1.0f);
+        normal.y = (1.0f - std::abs(encoded.x)) * (encoded.y >= 0.0f ? 1.0f : -1.0f);
+    }
+    return glm::normalize(normal);
+}
+
+quantize::Dequantization quantize::computeDequantization(std::vector<Vertex> const &vertices, VertexLayout const &layout)
+{
+    // Only normalised positions need mapping back
+    if (layout.position != VertexLayout::PositionSnorm16 || vertices.empty())
+        return Dequantization::IDENTITY;
+
+    // Centre bounds on the origin, keeping flat axes invertible
+    glm::vec3 lower(std::numeric_limits<float>::max()), upper(std::numeric_limits<float>::lowest());
+    for (Vertex const &vertex : vertices)
+    {
+        lower = glm::min(lower, vertex.position);
+        upper = glm::max(upper, vertex.position);
+    }
+    return Dequantization
+    {
+        .offset = (lower + upper) * 0.5f,
+        .scale = glm::max((upper - lower) * 0.5f, glm::vec3(std::numeric_limits<float>::min()))
+    };
+}
+
+void quantize::encode(std::vector<Vertex> const &vertices, VertexLayout const &layout, Dequantization const &dequantization, void *destination, bool simd)
+{
+    // Float layout matches Vertex exactly
+    if (layout == VertexLayout::FLOAT)
+    {
+        std::memcpy(destination, vertices.data(), vertices.size()*sizeof(Vertex));
+        return;
+    }
+
+    // Pack one attribute at a time so each pass runs a single conversion
+    char *const bytes = static_cast<char *>(destination);
+    encodePositions(vertices, layout, dequantization, bytes + layout.getPositionOffset(), simd);
+    encodeColours(vertices, layout, bytes + layout.getColourOffset(), simd);
+    encodeNormals(vertices, layout, bytes + layout.getNormalOffset());
+}
+
+std::vector<Vertex> quantize::decode(void const *data, size_t nVertices, VertexLayout const &layout, Dequantization const &dequantization)
+{
+    std::vector<Vertex> vertices(nVertices, Vertex({}, {}));
+    uint32_t const stride = layout.getStride();
+    for (size_t i=0; i<nVertices; i++)
+    {
+        char const *vertex = static_cast<char const *>(data) + i*stride;
+        Vertex &result = vertices[i];
+
+        // Position
+        char const *position = vertex + layout.getPositionOffset();
+        if (layout.position == VertexLayout::PositionFloat)
+            result.position = load<glm::vec3>(position);
+        else if (layout.position == VertexLayout::PositionHalf)
+            for (int c=0; c<3; c++)
+                result.position[c] = fromHalf(load<uint16_t>(position + 2*c));
+        else
+            for (int c=0; c<3; c++)
+                result.position[c] = fromSnorm16(load<int16_t>(position + 2*c)) * dequantization.scale[c] + dequantization.offset[c];
+
+        // Colour
+        char const *colour = vertex + layout.getColourOffset();
+        if (layout.colour == VertexLayout::ColourFloat)
+            result.colour = load<glm::vec3>(colour);
+        else
+            for (int c=0; c<3; c++)
+                result.colour[c] = static_cast<uint8_t>(colour[c]) / 255.0f;
+
+        // Normal
+        char const *normal = vertex + layout.getNormalOffset();
+        if (layout.normal == VertexLayout::NormalFloat)
+            result.normal = load<glm::vec3>(normal);
+        else
+            result.normal = decodeOctahedral(glm::vec2(fromSnorm16(load<int16_t>(normal)), fromSnorm16(load<int16_t>(normal + 2))));
+    }
+    return vertices;
+}
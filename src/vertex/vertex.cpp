@@ -1,37 +1,12 @@
 
 #include "vertex/vertex.hpp"
 
-VkVertexInputBindingDescription Vertex::getBindingDescription()
-{
-    return VkVertexInputBindingDescription
-    {
-        .binding = 0,
-        .stride = sizeof(Vertex),
-        .inputRate = VK_VERTEX_INPUT_RATE_VERTEX
-    };
-}
-
-std::vector<VkVertexInputAttributeDescription> Vertex::getAttributeDescriptions()
-{
-    return std::vector<VkVertexInputAttributeDescription>
-    {
-        VkVertexInputAttributeDescription
-        {
-            .location = 0,
-            .binding = 0,
-            .format = VK_FORMAT_R32G32_SFLOAT,
-            .offset = offsetof(Vertex, position)
-        },
-        VkVertexInputAttributeDescription
-        {
-            .location = 1,
-            .binding = 0,
-            .format = VK_FORMAT_R32G32B32_SFLOAT,
-            .offset = offsetof(Vertex, colour)
-        }
-    };
-}
+// Float vertices and per-instance model matrices, checked at compile time
+using InstancedVertex = vertexInput::Description<vertexInput::Binding<Vertex>, vertexInput::Binding<glm::mat4, VK_VERTEX_INPUT_RATE_INSTANCE>>;
+static_assert(InstancedVertex::BINDINGS[0].stride == sizeof(Vertex) && InstancedVertex::BINDINGS[1].inputRate == VK_VERTEX_INPUT_RATE_INSTANCE);
+static_assert(InstancedVertex::ATTRIBUTES[2].location == 2 && InstancedVertex::ATTRIBUTES[2].offset == offsetof(Vertex, normal));
+static_assert(InstancedVertex::ATTRIBUTES[6].location == 6 && InstancedVertex::ATTRIBUTES[6].binding == 1 && InstancedVertex::ATTRIBUTES[6].offset == 3*sizeof(glm::vec4));
 
-Vertex::Vertex(glm::vec2 position, glm::vec3 colour) : position(position), colour(colour)
+Vertex::Vertex(glm::vec3 position, glm::vec3 colour, glm::vec3 normal) : position(position), colour(colour), normal(normal)
 {
 }
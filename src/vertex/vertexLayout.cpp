@@ -0,0 +1,135 @@
+
+#include "vertex/vertexLayout.hpp"
+
+#include "vertex/vertex.hpp"
+
+#include <exception>
+#include <type_traits>
+
+VertexLayout const VertexLayout::FLOAT   { PositionFloat, ColourFloat, NormalFloat };
+VertexLayout const VertexLayout::HALF    { PositionHalf, ColourUnorm8, NormalOctahedral };
+VertexLayout const VertexLayout::COMPACT { PositionSnorm16, ColourUnorm8, NormalOctahedral };
+
+namespace
+{
+    // Packed attribute storage, distinct types so each maps to its own format
+    struct Half4 { uint16_t value[4]; };
+    struct Snorm16x4 { int16_t value[4]; };
+    struct Unorm8x4 { uint8_t value[4]; };
+    struct Snorm16x2 { int16_t value[2]; };
+
+    /** Vertex struct equivalent to one layout, only used to derive its descriptions */
+    template<VertexLayout::Position P, VertexLayout::Colour C, VertexLayout::Normal N>
+    struct PackedVertex
+    {
+        std::conditional_t<P == VertexLayout::PositionFloat, glm::vec3, std::conditional_t<P == VertexLayout::PositionHalf, Half4, Snorm16x4>> position;
+        std::conditional_t<C == VertexLayout::ColourFloat, glm::vec3, Unorm8x4> colour;
+        std::conditional_t<N == VertexLayout::NormalFloat, glm::vec3, Snorm16x2> normal;
+    };
+}
+
+template<> struct vertexInput::Format<Half4>     { static constexpr VkFormat value = VK_FORMAT_R16G16B16A16_SFLOAT; static constexpr uint32_t nLocations = 1; };
+template<> struct vertexInput::Format<Snorm16x4> { static constexpr VkFormat value = VK_FORMAT_R16G16B16A16_SNORM;  static constexpr uint32_t nLocations = 1; };
+template<> struct vertexInput::Format<Unorm8x4>  { static constexpr VkFormat value = VK_FORMAT_R8G8B8A8_UNORM;      static constexpr uint32_t nLocations = 1; };
+template<> struct vertexInput::Format<Snorm16x2> { static constexpr VkFormat value = VK_FORMAT_R16G16_SNORM;        static constexpr uint32_t nLocations = 1; };
+
+template<VertexLayout::Position P, VertexLayout::Colour C, VertexLayout::Normal N>
+struct vertexInput::Attributes<PackedVertex<P, C, N>>
+{
+    using Type = PackedVertex<P, C, N>;
+    static constexpr std::array value
+    {
+        VERTEX_ATTRIBUTE(Type, position),
+        VERTEX_ATTRIBUTE(Type, colour),
+        VERTEX_ATTRIBUTE(Type, normal)
+    };
+};
+
+// Float layout is copied straight from Vertex arrays
+static_assert(sizeof(PackedVertex<VertexLayout::PositionFloat, VertexLayout::ColourFloat, VertexLayout::NormalFloat>) == sizeof(Vertex));
+
+namespace
+{
+    template<VertexLayout::Position P, VertexLayout::Colour C, VertexLayout::Normal N>
+    vertexInput::State const &getState()
+    {
+        return vertexInput::Description<vertexInput::Binding<PackedVertex<P, C, N>>>::STATE;
+    }
+
+    template<VertexLayout::Position P, VertexLayout::Colour C>
+    vertexInput::State const &getState(VertexLayout::Normal normal)
+    {
+        return normal == VertexLayout::NormalFloat ? getState<P, C, VertexLayout::NormalFloat>() : getState<P, C, VertexLayout::NormalOctahedral>();
+    }
+
+    template<VertexLayout::Position P>
+    vertexInput::State const &getState(VertexLayout::Colour colour, VertexLayout::Normal normal)
+    {
+        return colour == VertexLayout::ColourFloat ? getState<P, VertexLayout::ColourFloat>(normal) : getState<P, VertexLayout::ColourUnorm8>(normal);
+    }
+}
+
+VertexLayout VertexLayout::fromName(std::string const &name)
+{
+    if (name == "float") return FLOAT;
+    if (name == "half") return HALF;
+    if (name == "compact") return COMPACT;
+    throw std::exception("Unknown vertex layout, expected float, half or compact.");
+}
+
+VertexLayout VertexLayout::unpack(uint32_t packed)
+{
+    VertexLayout layout
+    {
+        .position = static_cast<Position>(packed & 0xFF),
+        .colour = static_cast<Colour>((packed >> 8) & 0xFF),
+        .normal = static_cast<Normal>((packed >> 16) & 0xFF)
+    };
+    if (layout.position > PositionSnorm16 || layout.colour > ColourUnorm8 || layout.normal > NormalOctahedral)
+        throw std::exception("Unknown vertex layout.");
+    return layout;
+}
+
+uint32_t VertexLayout::pack() const
+{
+    return position | (colour << 8) | (normal << 16);
+}
+
+char const *VertexLayout::getName() const
+{
+    if (*this == FLOAT) return "float";
+    if (*this == HALF) return "half";
+    if (*this == COMPACT) return "compact";
+    return "custom";
+}
+
+uint32_t VertexLayout::getStride() const
+{
+    return getVertexInput().bindings[0].stride;
+}
+
+uint32_t VertexLayout::getPositionOffset() const
+{
+    return getVertexInput().attributes[0].offset;
+}
+
+uint32_t VertexLayout::getColourOffset() const
+{
+    return getVertexInput().attributes[1].offset;
+}
+
+uint32_t VertexLayout::getNormalOffset() const
+{
+    return getVertexInput().attributes[2].offset;
+}
+
+vertexInput::State const &VertexLayout::getVertexInput() const
+{
+    // Select the descriptions generated for this combination of formats
+    switch (position)
+    {
+    case PositionFloat: return getState<PositionFloat>(colour, normal);
+    case PositionHalf: return getState<PositionHalf>(colour, normal);
+    default: return getState<PositionSnorm16>(colour, normal);
+    }
+}